@@ -27,6 +27,7 @@
 #include <gst/vaapi/gstvaapicontext.h>
 #include "gstvaapicodec_objects.h"
 #include "gstvaapidecoder_priv.h"
+#include "gstvaapicontext_buffers.h"
 #include "gstvaapicompat.h"
 #include "gstvaapiutils.h"
 
@@ -100,6 +101,7 @@ gst_vaapi_codec_object_new (const GstVaapiCodecObjectClass * object_class,
 #define GET_DECODER(obj)    GST_VAAPI_DECODER_CAST((obj)->parent_instance.codec)
 #define GET_VA_DISPLAY(obj) GET_DECODER(obj)->va_display
 #define GET_VA_CONTEXT(obj) GET_DECODER(obj)->va_context
+#define GET_CONTEXT(obj)    GET_DECODER(obj)->context
 
 /* ------------------------------------------------------------------------- */
 /* --- Inverse Quantization Matrices                                     --- */
@@ -110,7 +112,8 @@ GST_VAAPI_CODEC_DEFINE_TYPE (GstVaapiIqMatrix, gst_vaapi_iq_matrix);
 void
 gst_vaapi_iq_matrix_destroy (GstVaapiIqMatrix * iq_matrix)
 {
-  vaapi_destroy_buffer (GET_VA_DISPLAY (iq_matrix), &iq_matrix->param_id);
+  gst_vaapi_context_destroy_buffer (GET_CONTEXT (iq_matrix),
+      &iq_matrix->param_id);
   iq_matrix->param = NULL;
 }
 
@@ -119,9 +122,9 @@ gst_vaapi_iq_matrix_create (GstVaapiIqMatrix * iq_matrix,
     const GstVaapiCodecObjectConstructorArgs * args)
 {
   iq_matrix->param_id = VA_INVALID_ID;
-  return vaapi_create_buffer (GET_VA_DISPLAY (iq_matrix),
-      GET_VA_CONTEXT (iq_matrix), VAIQMatrixBufferType,
-      args->param_size, args->param, &iq_matrix->param_id, &iq_matrix->param);
+  return gst_vaapi_context_create_buffer (GET_CONTEXT (iq_matrix),
+      VAIQMatrixBufferType, args->param_size, args->param, &iq_matrix->param_id,
+      &iq_matrix->param);
 }
 
 GstVaapiIqMatrix *
@@ -146,7 +149,7 @@ GST_VAAPI_CODEC_DEFINE_TYPE (GstVaapiBitPlane, gst_vaapi_bitplane);
 void
 gst_vaapi_bitplane_destroy (GstVaapiBitPlane * bitplane)
 {
-  vaapi_destroy_buffer (GET_VA_DISPLAY (bitplane), &bitplane->data_id);
+  gst_vaapi_context_destroy_buffer (GET_CONTEXT (bitplane), &bitplane->data_id);
   bitplane->data = NULL;
 }
 
@@ -155,9 +158,9 @@ gst_vaapi_bitplane_create (GstVaapiBitPlane * bitplane,
     const GstVaapiCodecObjectConstructorArgs * args)
 {
   bitplane->data_id = VA_INVALID_ID;
-  return vaapi_create_buffer (GET_VA_DISPLAY (bitplane),
-      GET_VA_CONTEXT (bitplane), VABitPlaneBufferType, args->param_size,
-      args->param, &bitplane->data_id, (void **) &bitplane->data);
+  return gst_vaapi_context_create_buffer (GET_CONTEXT (bitplane),
+      VABitPlaneBufferType, args->param_size, args->param, &bitplane->data_id,
+      (void **) &bitplane->data);
 }
 
 
@@ -184,7 +187,8 @@ GST_VAAPI_CODEC_DEFINE_TYPE (GstVaapiHuffmanTable, gst_vaapi_huffman_table);
 void
 gst_vaapi_huffman_table_destroy (GstVaapiHuffmanTable * huf_table)
 {
-  vaapi_destroy_buffer (GET_VA_DISPLAY (huf_table), &huf_table->param_id);
+  gst_vaapi_context_destroy_buffer (GET_CONTEXT (huf_table),
+      &huf_table->param_id);
   huf_table->param = NULL;
 }
 
@@ -193,9 +197,9 @@ gst_vaapi_huffman_table_create (GstVaapiHuffmanTable * huf_table,
     const GstVaapiCodecObjectConstructorArgs * args)
 {
   huf_table->param_id = VA_INVALID_ID;
-  return vaapi_create_buffer (GET_VA_DISPLAY (huf_table),
-      GET_VA_CONTEXT (huf_table), VAHuffmanTableBufferType, args->param_size,
-      args->param, &huf_table->param_id, (void **) &huf_table->param);
+  return gst_vaapi_context_create_buffer (GET_CONTEXT (huf_table),
+      VAHuffmanTableBufferType, args->param_size, args->param,
+      &huf_table->param_id, (void **) &huf_table->param);
 }
 
 GstVaapiHuffmanTable *
@@ -218,7 +222,8 @@ GST_VAAPI_CODEC_DEFINE_TYPE (GstVaapiProbabilityTable,
 void
 gst_vaapi_probability_table_destroy (GstVaapiProbabilityTable * prob_table)
 {
-  vaapi_destroy_buffer (GET_VA_DISPLAY (prob_table), &prob_table->param_id);
+  gst_vaapi_context_destroy_buffer (GET_CONTEXT (prob_table),
+      &prob_table->param_id);
   prob_table->param = NULL;
 }
 
@@ -227,10 +232,9 @@ gst_vaapi_probability_table_create (GstVaapiProbabilityTable * prob_table,
     const GstVaapiCodecObjectConstructorArgs * args)
 {
   prob_table->param_id = VA_INVALID_ID;
-  return vaapi_create_buffer (GET_VA_DISPLAY (prob_table),
-      GET_VA_CONTEXT (prob_table),
-      VAProbabilityBufferType,
-      args->param_size, args->param, &prob_table->param_id, &prob_table->param);
+  return gst_vaapi_context_create_buffer (GET_CONTEXT (prob_table),
+      VAProbabilityBufferType, args->param_size, args->param,
+      &prob_table->param_id, &prob_table->param);
 }
 
 GstVaapiProbabilityTable *
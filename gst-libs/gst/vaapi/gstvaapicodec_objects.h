@@ -230,7 +230,7 @@ gst_vaapi_probability_table_new (GstVaapiDecoder * decoder,
 /* --- Helpers to create codec-dependent objects                         --- */
 /* ------------------------------------------------------------------------- */
 
-#define GST_VAAPI_CODEC_DEFINE_TYPE(type, prefix)                       \
+#define GST_VAAPI_CODEC_DEFINE_TYPE_FULL(type, prefix, reset, release) \
 G_GNUC_INTERNAL                                                         \
 void                                                                    \
 G_PASTE (prefix, _destroy) (type *);                                    \
@@ -240,16 +240,27 @@ gboolean                                                                \
 G_PASTE (prefix, _create) (type *,                                      \
     const GstVaapiCodecObjectConstructorArgs * args);                   \
                                                                         \
+static GstVaapiMiniObjectCache G_PASTE (type, Cache) = {                \
+  .reset = (GDestroyNotify) (reset),                                    \
+  .release = (GDestroyNotify) (release),                                \
+};                                                                      \
+                                                                        \
 static const GstVaapiCodecObjectClass G_PASTE (type, Class) = {         \
   .parent_class = {                                                     \
     .size = sizeof (type),                                              \
     .finalize = (GstVaapiCodecObjectDestroyFunc)                        \
-        G_PASTE (prefix, _destroy)                                      \
+        G_PASTE (prefix, _destroy),                                     \
+    .cache = &G_PASTE (type, Cache)                                     \
   },                                                                    \
   .create = (GstVaapiCodecObjectCreateFunc)                             \
       G_PASTE (prefix, _create),                                        \
 }
 
+/* Codec objects are created and destroyed for every frame, so their
+   memory is recycled through a per-class cache */
+#define GST_VAAPI_CODEC_DEFINE_TYPE(type, prefix) \
+  GST_VAAPI_CODEC_DEFINE_TYPE_FULL (type, prefix, NULL, NULL)
+
 #define GST_VAAPI_IQ_MATRIX_NEW(codec, decoder)                         \
   gst_vaapi_iq_matrix_new (GST_VAAPI_DECODER_CAST (decoder),            \
       NULL, sizeof (G_PASTE (VAIQMatrixBuffer, codec)))
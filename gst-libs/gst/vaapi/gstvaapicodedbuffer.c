@@ -187,10 +187,14 @@ gssize
 gst_vaapi_coded_buffer_get_size (GstVaapiCodedBuffer * buf)
 {
   VACodedBufferSegment *segment;
+  gboolean was_mapped;
   gssize size;
 
   g_return_val_if_fail (buf != NULL, -1);
 
+  /* Keep any mapping held by wrapped memories (see
+     gst_vaapi_coded_buffer_proxy_wrap_into()) */
+  was_mapped = buf->segment_list != NULL;
   if (!coded_buffer_map (buf))
     return -1;
 
@@ -198,7 +202,8 @@ gst_vaapi_coded_buffer_get_size (GstVaapiCodedBuffer * buf)
   for (segment = buf->segment_list; segment != NULL; segment = segment->next)
     size += segment->size;
 
-  coded_buffer_unmap (buf);
+  if (!was_mapped)
+    coded_buffer_unmap (buf);
   return size;
 }
 
@@ -215,12 +220,14 @@ gboolean
 gst_vaapi_coded_buffer_copy_into (GstBuffer * dest, GstVaapiCodedBuffer * src)
 {
   VACodedBufferSegment *segment;
+  gboolean was_mapped;
   goffset offset;
   gsize size;
 
   g_return_val_if_fail (src != NULL, FALSE);
   g_return_val_if_fail (dest != NULL, FALSE);
 
+  was_mapped = src->segment_list != NULL;
   if (!coded_buffer_map (src))
     return FALSE;
 
@@ -232,6 +239,7 @@ gst_vaapi_coded_buffer_copy_into (GstBuffer * dest, GstVaapiCodedBuffer * src)
     offset += segment->size;
   }
 
-  coded_buffer_unmap (src);
+  if (!was_mapped)
+    coded_buffer_unmap (src);
   return segment == NULL;
 }
@@ -43,6 +43,8 @@ static void
 coded_buffer_proxy_finalize (GstVaapiCodedBufferProxy * proxy)
 {
   if (proxy->buffer) {
+    /* Drop any mapping left by gst_vaapi_coded_buffer_proxy_wrap_into() */
+    gst_vaapi_coded_buffer_unmap (proxy->buffer);
     if (proxy->pool)
       gst_vaapi_video_pool_put_object (proxy->pool, proxy->buffer);
     gst_vaapi_object_unref (proxy->buffer);
@@ -254,3 +256,57 @@ gst_vaapi_coded_buffer_proxy_set_user_data (GstVaapiCodedBufferProxy * proxy,
 
   coded_buffer_proxy_set_user_data (proxy, user_data, destroy_func);
 }
+
+/**
+ * gst_vaapi_coded_buffer_proxy_wrap_into:
+ * @dest: the destination #GstBuffer
+ * @proxy: the source #GstVaapiCodedBufferProxy
+ *
+ * Appends the coded data held in @proxy to @dest without copying
+ * it. Each VA coded buffer segment is wrapped into a #GstMemory that
+ * holds a reference to @proxy, so the underlying VA coded buffer
+ * stays mapped until the last memory is released. Only then is the
+ * coded buffer pushed back to its parent pool.
+ *
+ * Note: the pool cannot reuse the VA coded buffer while @dest is
+ * alive, so downstream elements holding on to many buffers can stall
+ * the encoder until the pool gets a free coded buffer again.
+ *
+ * Return value: %TRUE if successful, %FALSE otherwise
+ */
+gboolean
+gst_vaapi_coded_buffer_proxy_wrap_into (GstBuffer * dest,
+    GstVaapiCodedBufferProxy * proxy)
+{
+  VACodedBufferSegment *segment;
+  GstMemory *mem;
+
+  g_return_val_if_fail (dest != NULL, FALSE);
+  g_return_val_if_fail (proxy != NULL, FALSE);
+  g_return_val_if_fail (proxy->buffer != NULL, FALSE);
+
+  if (!gst_vaapi_coded_buffer_map (proxy->buffer, &segment))
+    return FALSE;
+
+  for (; segment != NULL; segment = segment->next) {
+    if (segment->size == 0)
+      continue;
+
+    mem = gst_memory_new_wrapped (0, segment->buf, segment->size, 0,
+        segment->size, gst_vaapi_coded_buffer_proxy_ref (proxy),
+        (GDestroyNotify) gst_vaapi_coded_buffer_proxy_unref);
+    if (!mem)
+      goto error_wrap_memory;
+    gst_buffer_append_memory (dest, mem);
+  }
+  return TRUE;
+
+  /* ERRORS */
+error_wrap_memory:
+  {
+    GST_ERROR ("failed to wrap coded buffer segment of size %u",
+        segment->size);
+    gst_vaapi_coded_buffer_proxy_unref (proxy);
+    return FALSE;
+  }
+}
@@ -77,6 +77,10 @@ void
 gst_vaapi_coded_buffer_proxy_set_user_data (GstVaapiCodedBufferProxy * proxy,
     gpointer user_data, GDestroyNotify destroy_func);
 
+gboolean
+gst_vaapi_coded_buffer_proxy_wrap_into (GstBuffer * dest,
+    GstVaapiCodedBufferProxy * proxy);
+
 G_END_DECLS
 
 #endif /* GST_VAAPI_CODED_BUFFER_PROXY_H */
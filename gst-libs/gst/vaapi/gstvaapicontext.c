@@ -31,6 +31,7 @@
 #include "gstvaapicompat.h"
 #include "gstvaapicontext.h"
 #include "gstvaapicontext_overlay.h"
+#include "gstvaapicontext_buffers.h"
 #include "gstvaapidisplay_priv.h"
 #include "gstvaapiobject_priv.h"
 #include "gstvaapisurface.h"
@@ -77,6 +78,94 @@ context_get_attribute (GstVaapiContext * context, VAConfigAttribType type,
       context->va_profile, context->va_entrypoint, type, out_value_ptr);
 }
 
+/* Checks whether @pool can hold the surfaces to decode into */
+static gboolean
+context_can_adopt_pool (GstVaapiContext * context, GstVaapiVideoPool * pool)
+{
+  const GstVaapiContextInfo *const cip = &context->info;
+  GstVaapiDisplay *const display = GST_VAAPI_OBJECT_DISPLAY (context);
+
+  if (!pool || cip->usage != GST_VAAPI_CONTEXT_USAGE_DECODE)
+    return FALSE;
+
+  /* The decoder waits for free surfaces once the pool is exhausted,
+     which never happens if it is not bounded */
+  if (!gst_vaapi_video_pool_get_capacity (pool))
+    return FALSE;
+
+  /* Surfaces are moved along with the memory they are charged for */
+  if (GST_VAAPI_DISPLAY_BUDGET (pool->display) !=
+      GST_VAAPI_DISPLAY_BUDGET (display))
+    return FALSE;
+  return gst_vaapi_surface_pool_is_decodable (GST_VAAPI_SURFACE_POOL (pool),
+      cip->chroma_type, cip->width, cip->height);
+}
+
+/* Moves the surfaces of the pool used before adopting an external
+   one, as they are released */
+static void
+context_migrate_surfaces (GstVaapiContext * context)
+{
+  while (context->num_retired_surfaces > 0 &&
+      gst_vaapi_video_pool_transfer_free_object (context->retired_pool,
+          context->surfaces_pool))
+    context->num_retired_surfaces--;
+
+  if (!context->num_retired_surfaces)
+    gst_vaapi_video_pool_replace (&context->retired_pool, NULL);
+}
+
+/* Makes room for the surfaces of the context in the shared pool, in
+   addition to those of its owner. The amount added is recorded so
+   that it is given back later */
+static void
+context_update_shared_capacity (GstVaapiContext * context)
+{
+  GstVaapiVideoPool *const pool = context->surfaces_pool;
+  guint capacity;
+
+  capacity = gst_vaapi_video_pool_get_capacity (pool);
+  if (!capacity)
+    return;
+
+  capacity -= MIN (capacity, context->shared_capacity);
+  gst_vaapi_video_pool_set_capacity (pool, capacity + context->surfaces->len);
+  context->shared_capacity = context->surfaces->len;
+}
+
+/* Gives back the capacity the context added to the shared pool */
+static void
+context_release_shared_capacity (GstVaapiContext * context)
+{
+  GstVaapiVideoPool *const pool = context->surfaces_pool;
+  guint capacity;
+
+  capacity = gst_vaapi_video_pool_get_capacity (pool);
+  if (capacity > context->shared_capacity)
+    gst_vaapi_video_pool_set_capacity (pool,
+        capacity - context->shared_capacity);
+  context->shared_capacity = 0;
+}
+
+/* Switches an existing context over to the external pool */
+static void
+context_adopt_surface_pool (GstVaapiContext * context)
+{
+  GstVaapiVideoPool *const pool = context->external_pool;
+
+  if (!context->surfaces_pool || context->has_shared_surfaces ||
+      !context_can_adopt_pool (context, pool))
+    return;
+
+  GST_DEBUG ("adopting surface pool %p", pool);
+  context->retired_pool = context->surfaces_pool;
+  context->num_retired_surfaces = context->surfaces->len;
+  context->surfaces_pool = gst_vaapi_video_pool_ref (pool);
+  context->has_shared_surfaces = TRUE;
+  context_update_shared_capacity (context);
+  context_migrate_surfaces (context);
+}
+
 static void
 context_destroy_surfaces (GstVaapiContext * context)
 {
@@ -86,7 +175,12 @@ context_destroy_surfaces (GstVaapiContext * context)
     g_ptr_array_unref (context->surfaces);
     context->surfaces = NULL;
   }
+  if (context->has_shared_surfaces)
+    context_release_shared_capacity (context);
   gst_vaapi_video_pool_replace (&context->surfaces_pool, NULL);
+  gst_vaapi_video_pool_replace (&context->retired_pool, NULL);
+  context->num_retired_surfaces = 0;
+  context->has_shared_surfaces = FALSE;
 }
 
 static void
@@ -100,6 +194,7 @@ context_destroy (GstVaapiContext * context)
   GST_DEBUG ("context 0x%08x", context_id);
 
   if (context_id != VA_INVALID_ID) {
+    gst_vaapi_context_buffers_reset (context);
     GST_VAAPI_DISPLAY_LOCK (display);
     status = vaDestroyContext (GST_VAAPI_DISPLAY_VADISPLAY (display),
         context_id);
@@ -143,7 +238,11 @@ context_ensure_surfaces (GstVaapiContext * context)
     if (!gst_vaapi_video_pool_add_object (context->surfaces_pool, surface))
       return FALSE;
   }
-  gst_vaapi_video_pool_set_capacity (context->surfaces_pool, num_surfaces);
+
+  if (context->has_shared_surfaces)
+    context_update_shared_capacity (context);
+  else
+    gst_vaapi_video_pool_set_capacity (context->surfaces_pool, num_surfaces);
   return TRUE;
 }
 
@@ -165,6 +264,14 @@ context_create_surfaces (GstVaapiContext * context)
       return FALSE;
   }
 
+  if (!context->surfaces_pool &&
+      context_can_adopt_pool (context, context->external_pool)) {
+    GST_DEBUG ("adopting surface pool %p", context->external_pool);
+    context->surfaces_pool =
+        gst_vaapi_video_pool_ref (context->external_pool);
+    context->has_shared_surfaces = TRUE;
+  }
+
   if (!context->surfaces_pool) {
     context->surfaces_pool =
         gst_vaapi_surface_pool_new_with_chroma_type (display, cip->chroma_type,
@@ -342,6 +449,7 @@ gst_vaapi_context_init (GstVaapiContext * context,
   context->va_config = VA_INVALID_ID;
   context->reset_on_resize = TRUE;
   gst_vaapi_context_overlay_init (context);
+  gst_vaapi_context_buffers_init (context);
 
   context->formats = NULL;
 }
@@ -351,7 +459,9 @@ gst_vaapi_context_finalize (GstVaapiContext * context)
 {
   context_destroy (context);
   context_destroy_surfaces (context);
+  gst_vaapi_video_pool_replace (&context->external_pool, NULL);
   gst_vaapi_context_overlay_finalize (context);
+  gst_vaapi_context_buffers_finalize (context);
 }
 
 GST_VAAPI_OBJECT_DEFINE_CLASS (GstVaapiContext, gst_vaapi_context);
@@ -370,6 +480,27 @@ GST_VAAPI_OBJECT_DEFINE_CLASS (GstVaapiContext, gst_vaapi_context);
 GstVaapiContext *
 gst_vaapi_context_new (GstVaapiDisplay * display,
     const GstVaapiContextInfo * cip)
+{
+  return gst_vaapi_context_new_full (display, cip, NULL);
+}
+
+/**
+ * gst_vaapi_context_new_full:
+ * @display: a #GstVaapiDisplay
+ * @cip: a pointer to the #GstVaapiContextInfo
+ * @pool: (allow-none): a #GstVaapiVideoPool of surfaces to adopt
+ *
+ * Creates a new #GstVaapiContext like gst_vaapi_context_new(). If
+ * @pool is suitable for decoding with the configuration specified by
+ * @cip, the surfaces of the context are added to @pool and allocated
+ * from it, rather than from a pool private to the context. See
+ * gst_vaapi_context_set_surface_pool().
+ *
+ * Return value: the newly allocated #GstVaapiContext object
+ */
+GstVaapiContext *
+gst_vaapi_context_new_full (GstVaapiDisplay * display,
+    const GstVaapiContextInfo * cip, GstVaapiVideoPool * pool)
 {
   GstVaapiContext *context;
 
@@ -383,6 +514,7 @@ gst_vaapi_context_new (GstVaapiDisplay * display,
     return NULL;
 
   gst_vaapi_context_init (context, cip);
+  gst_vaapi_video_pool_replace (&context->external_pool, pool);
   if (!context_create (context))
     goto error;
   return context;
@@ -502,6 +634,8 @@ gst_vaapi_context_get_surface_proxy (GstVaapiContext * context)
 {
   g_return_val_if_fail (context != NULL, NULL);
 
+  if (context->retired_pool)
+    context_migrate_surfaces (context);
   return
       gst_vaapi_surface_proxy_new_from_pool (GST_VAAPI_SURFACE_POOL
       (context->surfaces_pool));
@@ -511,16 +645,61 @@ gst_vaapi_context_get_surface_proxy (GstVaapiContext * context)
  * gst_vaapi_context_get_surface_count:
  * @context: a #GstVaapiContext
  *
- * Retrieves the number of free surfaces left in the pool.
+ * Retrieves the number of free surfaces left in the pool. If the
+ * surfaces are allocated from a shared pool, this is the number of
+ * surfaces that can still be acquired from it, within its capacity.
  *
  * Return value: the number of free surfaces available in the pool
  */
 guint
 gst_vaapi_context_get_surface_count (GstVaapiContext * context)
 {
+  GstVaapiVideoPoolStats stats;
+  guint capacity;
+
   g_return_val_if_fail (context != NULL, 0);
 
-  return gst_vaapi_video_pool_get_size (context->surfaces_pool);
+  if (!context->has_shared_surfaces)
+    return gst_vaapi_video_pool_get_size (context->surfaces_pool);
+
+  capacity = gst_vaapi_video_pool_get_capacity (context->surfaces_pool);
+  gst_vaapi_video_pool_get_stats (context->surfaces_pool, &stats);
+  return capacity > stats.num_used ? capacity - stats.num_used : 0;
+}
+
+/**
+ * gst_vaapi_context_set_surface_pool:
+ * @context: a #GstVaapiContext
+ * @pool: (allow-none): a #GstVaapiVideoPool of surfaces, or %NULL
+ *
+ * Sets the pool of surfaces a decode @context shall share with other
+ * users, e.g. the elements downstream of a decoder, instead of
+ * allocating a pool of its own. The pool is only adopted if its
+ * surfaces have the chroma type and size of the context, and a native
+ * pixel format, and if it has a capacity: the decoder relies on the
+ * pool running out of free surfaces to wait for downstream.
+ *
+ * The surfaces bound to the VA context are moved to @pool, along with
+ * the budget they are charged for, as soon as they are free, and the
+ * capacity of @pool is raised by their number. @pool can allocate
+ * more of them on demand, up to that capacity. Those are not render
+ * targets the VA context was created with, which VA drivers accept
+ * for decoding. A pool
+ * the @context already shares is only replaced the next time its
+ * surfaces are created, i.e. on gst_vaapi_context_reset() to another
+ * size or chroma type.
+ *
+ * This function shall be called from the thread the @context decodes
+ * pictures from.
+ */
+void
+gst_vaapi_context_set_surface_pool (GstVaapiContext * context,
+    GstVaapiVideoPool * pool)
+{
+  g_return_if_fail (context != NULL);
+
+  gst_vaapi_video_pool_replace (&context->external_pool, pool);
+  context_adopt_surface_pool (context);
 }
 
 /**
@@ -106,10 +106,20 @@ struct _GstVaapiContext
   VAConfigID va_config;
   GPtrArray *surfaces;
   GstVaapiVideoPool *surfaces_pool;
+  GstVaapiVideoPool *external_pool;
+  GstVaapiVideoPool *retired_pool;
+  guint num_retired_surfaces;
+  gboolean has_shared_surfaces;
+  guint shared_capacity;
   GPtrArray *overlays[2];
   guint overlay_id;
   gboolean reset_on_resize;
   GArray *formats;
+  GHashTable *free_buffers;
+  GHashTable *used_buffers;
+  GMutex buffers_lock;
+  guint buffers_serial;
+  gboolean recycle_buffers;
 };
 
 /**
@@ -128,6 +138,11 @@ GstVaapiContext *
 gst_vaapi_context_new (GstVaapiDisplay * display,
     const GstVaapiContextInfo * cip);
 
+G_GNUC_INTERNAL
+GstVaapiContext *
+gst_vaapi_context_new_full (GstVaapiDisplay * display,
+    const GstVaapiContextInfo * cip, GstVaapiVideoPool * pool);
+
 G_GNUC_INTERNAL
 gboolean
 gst_vaapi_context_reset (GstVaapiContext * context,
@@ -145,6 +160,11 @@ G_GNUC_INTERNAL
 guint
 gst_vaapi_context_get_surface_count (GstVaapiContext * context);
 
+G_GNUC_INTERNAL
+void
+gst_vaapi_context_set_surface_pool (GstVaapiContext * context,
+    GstVaapiVideoPool * pool);
+
 G_GNUC_INTERNAL
 void
 gst_vaapi_context_reset_on_resize (GstVaapiContext * context,
@@ -0,0 +1,397 @@
+/*
+ *  gstvaapicontext_buffers.c - VA buffer recycling
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation; either version 2.1
+ *  of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free
+ *  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Codec objects used to create and destroy their VA buffers for every
+ * picture. Instead, the buffers of a picture that was successfully
+ * submitted are handed back to the context, which keeps them in free
+ * lists keyed by buffer type and size class, and reuses them for the
+ * next objects of the same kind.
+ *
+ * Parameter buffers are only reused for the exact same size, since
+ * drivers may derive the number of elements from it. Data buffers
+ * (slice data, bitplanes, packed headers) carry their effective size
+ * in the associated parameter buffer, so their allocation is rounded
+ * up to the next power of two in order to be shared among objects of
+ * similar sizes.
+ *
+ * A recycled buffer is not handed out again before RECYCLE_DELAY more
+ * pictures were submitted, so that the hardware is unlikely to still
+ * be reading from it. Recycling is only enabled for drivers known to
+ * keep buffers alive across vaRenderPicture(); other drivers keep on
+ * using plain create/destroy calls.
+ */
+
+#include "sysdeps.h"
+#include "gstvaapicontext_buffers.h"
+#include "gstvaapidisplay_priv.h"
+#include "gstvaapiutils.h"
+
+#define DEBUG 1
+#include "gstvaapidebug.h"
+
+/* Number of pictures submitted before a buffer may be reused */
+#define RECYCLE_DELAY 4
+
+/* Maximum number of free buffers per buffer type and size class */
+#define MAX_FREE_BUFFERS 32
+
+/* Smallest size class of data buffers */
+#define MIN_DATA_SIZE 4096
+
+typedef struct
+{
+  VABufferID id;
+  guint serial;
+} FreeBuffer;
+
+#define free_buffer_new()       g_slice_new (FreeBuffer)
+#define free_buffer_free(buf)   g_slice_free (FreeBuffer, buf)
+
+static gboolean
+is_data_buffer_type (guint type)
+{
+  switch (type) {
+    case VASliceDataBufferType:
+    case VABitPlaneBufferType:
+#if USE_ENCODERS
+    case VAEncPackedHeaderDataBufferType:
+#endif
+      return TRUE;
+    default:
+      break;
+  }
+  return FALSE;
+}
+
+/* Returns the allocation size of a buffer of the supplied type and size */
+static guint
+get_alloc_size (guint type, guint size)
+{
+  guint alloc_size;
+
+  if (!is_data_buffer_type (type) || size > G_MAXUINT / 2)
+    return size;
+
+  for (alloc_size = MIN_DATA_SIZE; alloc_size < size; alloc_size <<= 1);
+  return alloc_size;
+}
+
+/* Buffer types all fit into 8 bits, and parameter buffers are much
+   smaller than 16 MB, whereas data buffer sizes are powers of two */
+static inline gpointer
+make_key (guint type, guint alloc_size)
+{
+  if (is_data_buffer_type (type))
+    alloc_size = g_bit_storage (alloc_size);
+  return GUINT_TO_POINTER ((alloc_size << 8) | (type & 0xff));
+}
+
+static gboolean
+is_recycling_supported (GstVaapiContext * context)
+{
+  const gchar *const vendor_string =
+      gst_vaapi_display_get_vendor_string (GST_VAAPI_OBJECT_DISPLAY (context));
+  struct map
+  {
+    const gchar *str;
+    guint str_len;
+  };
+  static const struct map drv_names[] = {
+    {"Intel i965 driver", 17},
+    {"GStreamer VA-API mock driver", 28},
+    {NULL, 0}
+  };
+  const struct map *m;
+
+  if (!vendor_string)
+    return FALSE;
+
+  // Drivers that never destroy buffers implicitly from vaRenderPicture()
+  for (m = drv_names; m->str != NULL; m++) {
+    if (g_ascii_strncasecmp (vendor_string, m->str, m->str_len) == 0)
+      return TRUE;
+  }
+  return FALSE;
+}
+
+static void
+free_queue_destroy (VADisplay dpy, GQueue * queue)
+{
+  FreeBuffer *buf;
+
+  while ((buf = g_queue_pop_head (queue)) != NULL) {
+    vaapi_destroy_buffer (dpy, &buf->id);
+    free_buffer_free (buf);
+  }
+  g_slice_free (GQueue, queue);
+}
+
+void
+gst_vaapi_context_buffers_init (GstVaapiContext * context)
+{
+  g_mutex_init (&context->buffers_lock);
+  context->free_buffers = g_hash_table_new (NULL, NULL);
+  context->used_buffers = g_hash_table_new (NULL, NULL);
+  context->buffers_serial = 0;
+  context->recycle_buffers = is_recycling_supported (context);
+}
+
+void
+gst_vaapi_context_buffers_finalize (GstVaapiContext * context)
+{
+  gst_vaapi_context_buffers_reset (context);
+  g_hash_table_unref (context->free_buffers);
+  g_hash_table_unref (context->used_buffers);
+  g_mutex_clear (&context->buffers_lock);
+}
+
+/**
+ * gst_vaapi_context_buffers_reset:
+ * @context: a #GstVaapiContext
+ *
+ * Destroys all the free buffers and forgets about the buffers in use,
+ * e.g. before the underlying VA context is destroyed. The buffers in
+ * use will be destroyed instead of being recycled.
+ */
+void
+gst_vaapi_context_buffers_reset (GstVaapiContext * context)
+{
+  VADisplay const dpy =
+      GST_VAAPI_DISPLAY_VADISPLAY (GST_VAAPI_OBJECT_DISPLAY (context));
+  GHashTableIter iter;
+  gpointer queue;
+
+  g_mutex_lock (&context->buffers_lock);
+  g_hash_table_iter_init (&iter, context->free_buffers);
+  while (g_hash_table_iter_next (&iter, NULL, &queue)) {
+    free_queue_destroy (dpy, queue);
+    g_hash_table_iter_remove (&iter);
+  }
+  g_hash_table_remove_all (context->used_buffers);
+  g_mutex_unlock (&context->buffers_lock);
+}
+
+/* Returns a free buffer of the supplied type and size class, if any */
+static VABufferID
+acquire_free_buffer (GstVaapiContext * context, gpointer key)
+{
+  VABufferID buf_id = VA_INVALID_ID;
+  GQueue *queue;
+  FreeBuffer *buf;
+
+  g_mutex_lock (&context->buffers_lock);
+  queue = g_hash_table_lookup (context->free_buffers, key);
+  if (queue) {
+    buf = g_queue_peek_head (queue);
+    if (buf && context->buffers_serial - buf->serial >= RECYCLE_DELAY) {
+      g_queue_pop_head (queue);
+      buf_id = buf->id;
+      free_buffer_free (buf);
+    }
+  }
+  g_mutex_unlock (&context->buffers_lock);
+  return buf_id;
+}
+
+/* Fills in the recycled buffer with the supplied data */
+static gboolean
+fill_buffer (VADisplay dpy, VABufferID buf_id, guint size, gconstpointer data,
+    gpointer * mapped_data)
+{
+  gpointer buf_data;
+
+  buf_data = vaapi_map_buffer (dpy, buf_id);
+  if (!buf_data)
+    return FALSE;
+
+  if (data)
+    memcpy (buf_data, data, size);
+  else
+    memset (buf_data, 0, size);
+
+  if (mapped_data)
+    *mapped_data = buf_data;
+  else
+    vaapi_unmap_buffer (dpy, buf_id, NULL);
+  return TRUE;
+}
+
+/**
+ * gst_vaapi_context_create_buffer:
+ * @context: a #GstVaapiContext
+ * @type: the VA buffer type
+ * @size: the size of the buffer, in bytes
+ * @data: (allow-none): the initial contents of the buffer
+ * @buf_id_ptr: return location for the VA buffer
+ * @mapped_data: (allow-none): return location for the mapped buffer
+ *
+ * Same as vaapi_create_buffer(), but reuses a previously submitted
+ * buffer of the same type and size class, if any. The contents of a
+ * recycled buffer are cleared if @data is %NULL.
+ *
+ * Return value: %TRUE on success
+ */
+gboolean
+gst_vaapi_context_create_buffer (GstVaapiContext * context, guint type,
+    guint size, gconstpointer data, VABufferID * buf_id_ptr,
+    gpointer * mapped_data)
+{
+  VADisplay dpy;
+  VAContextID ctx;
+  VABufferID buf_id;
+  gpointer key;
+  guint alloc_size;
+
+  g_return_val_if_fail (context != NULL, FALSE);
+  g_return_val_if_fail (buf_id_ptr != NULL, FALSE);
+
+  dpy = GST_VAAPI_DISPLAY_VADISPLAY (GST_VAAPI_OBJECT_DISPLAY (context));
+  ctx = GST_VAAPI_OBJECT_ID (context);
+  if (!context->recycle_buffers || size == 0)
+    return vaapi_create_buffer (dpy, ctx, type, size, data, buf_id_ptr,
+        mapped_data);
+
+  alloc_size = get_alloc_size (type, size);
+  key = make_key (type, alloc_size);
+
+  buf_id = acquire_free_buffer (context, key);
+  if (buf_id == VA_INVALID_ID && alloc_size == size) {
+    if (!vaapi_create_buffer (dpy, ctx, type, size, data, &buf_id,
+            mapped_data))
+      return FALSE;
+  } else {
+    if (buf_id == VA_INVALID_ID &&
+        !vaapi_create_buffer (dpy, ctx, type, alloc_size, NULL, &buf_id, NULL))
+      return FALSE;
+    if (!fill_buffer (dpy, buf_id, size, data, mapped_data)) {
+      vaapi_destroy_buffer (dpy, &buf_id);
+      return FALSE;
+    }
+  }
+
+  g_mutex_lock (&context->buffers_lock);
+  g_hash_table_insert (context->used_buffers, GUINT_TO_POINTER (buf_id), key);
+  g_mutex_unlock (&context->buffers_lock);
+  *buf_id_ptr = buf_id;
+  return TRUE;
+}
+
+/**
+ * gst_vaapi_context_destroy_buffer:
+ * @context: a #GstVaapiContext
+ * @buf_id_ptr: the VA buffer to destroy
+ *
+ * Destroys a buffer created with gst_vaapi_context_create_buffer()
+ * that was not submitted, and may thus still be mapped. @buf_id_ptr
+ * is reset to %VA_INVALID_ID.
+ */
+void
+gst_vaapi_context_destroy_buffer (GstVaapiContext * context,
+    VABufferID * buf_id_ptr)
+{
+  if (!buf_id_ptr || *buf_id_ptr == VA_INVALID_ID)
+    return;
+
+  g_return_if_fail (context != NULL);
+
+  if (context->recycle_buffers) {
+    g_mutex_lock (&context->buffers_lock);
+    g_hash_table_remove (context->used_buffers,
+        GUINT_TO_POINTER (*buf_id_ptr));
+    g_mutex_unlock (&context->buffers_lock);
+  }
+  vaapi_destroy_buffer (GST_VAAPI_DISPLAY_VADISPLAY (GST_VAAPI_OBJECT_DISPLAY
+          (context)), buf_id_ptr);
+}
+
+/**
+ * gst_vaapi_context_recycle_buffers:
+ * @context: a #GstVaapiContext
+ * @buf_id_ptrs: the VA buffers of a picture
+ * @num_buffers: the number of VA buffers
+ *
+ * Hands back the unmapped buffers of a picture that was submitted,
+ * for reuse by gst_vaapi_context_create_buffer(). The buffers that
+ * cannot be recycled are destroyed. All @buf_id_ptrs are reset to
+ * %VA_INVALID_ID.
+ *
+ * Return value: the number of buffers that were destroyed
+ */
+guint
+gst_vaapi_context_recycle_buffers (GstVaapiContext * context,
+    VABufferID ** buf_id_ptrs, guint num_buffers)
+{
+  VADisplay dpy;
+  GQueue *queue;
+  FreeBuffer *buf;
+  gpointer key;
+  guint i, num_destroyed = 0;
+
+  g_return_val_if_fail (context != NULL, 0);
+
+  dpy = GST_VAAPI_DISPLAY_VADISPLAY (GST_VAAPI_OBJECT_DISPLAY (context));
+  if (!context->recycle_buffers) {
+    for (i = 0; i < num_buffers; i++) {
+      if (*buf_id_ptrs[i] == VA_INVALID_ID)
+        continue;
+      vaapi_destroy_buffer (dpy, buf_id_ptrs[i]);
+      num_destroyed++;
+    }
+    return num_destroyed;
+  }
+
+  g_mutex_lock (&context->buffers_lock);
+  for (i = 0; i < num_buffers; i++) {
+    const VABufferID buf_id = *buf_id_ptrs[i];
+
+    if (buf_id == VA_INVALID_ID)
+      continue;
+    *buf_id_ptrs[i] = VA_INVALID_ID;
+
+    if (!g_hash_table_lookup_extended (context->used_buffers,
+            GUINT_TO_POINTER (buf_id), NULL, &key))
+      goto destroy;
+    g_hash_table_remove (context->used_buffers, GUINT_TO_POINTER (buf_id));
+
+    queue = g_hash_table_lookup (context->free_buffers, key);
+    if (!queue) {
+      queue = g_slice_new (GQueue);
+      g_queue_init (queue);
+      g_hash_table_insert (context->free_buffers, key, queue);
+    }
+    if (queue->length >= MAX_FREE_BUFFERS)
+      goto destroy;
+
+    buf = free_buffer_new ();
+    buf->id = buf_id;
+    buf->serial = context->buffers_serial;
+    g_queue_push_tail (queue, buf);
+    continue;
+
+  destroy:
+    vaDestroyBuffer (dpy, buf_id);
+    num_destroyed++;
+  }
+  context->buffers_serial++;
+  g_mutex_unlock (&context->buffers_lock);
+  return num_destroyed;
+}
@@ -0,0 +1,59 @@
+/*
+ *  gstvaapicontext_buffers.h - VA buffer recycling
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation; either version 2.1
+ *  of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free
+ *  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301 USA
+ */
+
+#ifndef GST_VAAPI_CONTEXT_BUFFERS_H
+#define GST_VAAPI_CONTEXT_BUFFERS_H
+
+#include "gstvaapicontext.h"
+
+G_BEGIN_DECLS
+
+G_GNUC_INTERNAL
+void
+gst_vaapi_context_buffers_init (GstVaapiContext * context);
+
+G_GNUC_INTERNAL
+void
+gst_vaapi_context_buffers_finalize (GstVaapiContext * context);
+
+G_GNUC_INTERNAL
+void
+gst_vaapi_context_buffers_reset (GstVaapiContext * context);
+
+G_GNUC_INTERNAL
+gboolean
+gst_vaapi_context_create_buffer (GstVaapiContext * context, guint type,
+    guint size, gconstpointer data, VABufferID * buf_id_ptr,
+    gpointer * mapped_data);
+
+G_GNUC_INTERNAL
+void
+gst_vaapi_context_destroy_buffer (GstVaapiContext * context,
+    VABufferID * buf_id_ptr);
+
+G_GNUC_INTERNAL
+guint
+gst_vaapi_context_recycle_buffers (GstVaapiContext * context,
+    VABufferID ** buf_id_ptrs, guint num_buffers);
+
+G_END_DECLS
+
+#endif /* GST_VAAPI_CONTEXT_BUFFERS_H */
@@ -465,11 +465,21 @@ gst_vaapi_decoder_finalize (GstVaapiDecoder * decoder)
     decoder->frames = NULL;
   }
 
+  if (decoder->parse_pool) {
+    g_thread_pool_free (decoder->parse_pool, FALSE, TRUE);
+    decoder->parse_pool = NULL;
+  }
+
   gst_vaapi_object_replace (&decoder->context, NULL);
   decoder->va_context = VA_INVALID_ID;
 
   gst_vaapi_display_replace (&decoder->display, NULL);
   decoder->va_display = NULL;
+
+  g_free (decoder->owner);
+  decoder->owner = NULL;
+
+  gst_vaapi_video_pool_replace (&decoder->surface_pool, NULL);
 }
 
 static gboolean
@@ -496,6 +506,9 @@ gst_vaapi_decoder_init (GstVaapiDecoder * decoder, GstVaapiDisplay * display,
   decoder->codec_state = codec_state;
   decoder->codec_state_changed_func = NULL;
   decoder->codec_state_changed_data = NULL;
+  decoder->parse_threads = 1;
+  decoder->parse_pool = NULL;
+  memset (&decoder->stats, 0, sizeof (decoder->stats));
 
   decoder->buffers = g_async_queue_new_full ((GDestroyNotify) gst_buffer_unref);
   decoder->frames = g_async_queue_new_full ((GDestroyNotify)
@@ -958,18 +971,39 @@ gboolean
 gst_vaapi_decoder_ensure_context (GstVaapiDecoder * decoder,
     GstVaapiContextInfo * cip)
 {
+  GstVaapiContextInfo info;
+
   gst_vaapi_decoder_set_picture_size (decoder, cip->width, cip->height);
 
   cip->usage = GST_VAAPI_CONTEXT_USAGE_DECODE;
+
+  /* Keep the VA context and its surfaces at the maximum resolution, so
+     that only the picture size and cropping rectangle change */
+  info = *cip;
+  if (decoder->max_width > 0 && decoder->max_height > 0) {
+    if (cip->width <= decoder->max_width &&
+        cip->height <= decoder->max_height) {
+      info.width = decoder->max_width;
+      info.height = decoder->max_height;
+    } else
+      GST_WARNING ("picture size %ux%u exceeds maximum resolution %ux%u",
+          cip->width, cip->height, decoder->max_width, decoder->max_height);
+  }
+
   if (decoder->context) {
-    if (!gst_vaapi_context_reset (decoder->context, cip))
+    if (!gst_vaapi_context_reset (decoder->context, &info))
       return FALSE;
   } else {
-    decoder->context = gst_vaapi_context_new (decoder->display, cip);
+    decoder->context = gst_vaapi_context_new_full (decoder->display, &info,
+        decoder->surface_pool);
     if (!decoder->context)
       return FALSE;
   }
   decoder->va_context = gst_vaapi_context_get_id (decoder->context);
+
+  if (decoder->owner && decoder->context->surfaces_pool)
+    gst_vaapi_video_pool_set_owner (decoder->context->surfaces_pool,
+        decoder->owner);
   return TRUE;
 }
 
@@ -1085,3 +1119,328 @@ gst_vaapi_decoder_get_surface_formats (GstVaapiDecoder * decoder)
     return gst_vaapi_context_get_surface_formats (decoder->context);
   return NULL;
 }
+
+/**
+ * gst_vaapi_decoder_get_stats:
+ * @decoder: a #GstVaapiDecoder
+ * @stats: (out): return location for the #GstVaapiDecoderStats
+ *
+ * Retrieves the statistics about the pictures submitted to the VA
+ * driver since @decoder was created, or since the last call to
+ * gst_vaapi_decoder_reset_stats(). This is mostly useful for
+ * benchmarking, e.g. to compute the number of VA calls per frame.
+ */
+void
+gst_vaapi_decoder_get_stats (GstVaapiDecoder * decoder,
+    GstVaapiDecoderStats * stats)
+{
+  g_return_if_fail (decoder != NULL);
+  g_return_if_fail (stats != NULL);
+
+  *stats = decoder->stats;
+}
+
+/**
+ * gst_vaapi_decoder_reset_stats:
+ * @decoder: a #GstVaapiDecoder
+ *
+ * Resets the statistics returned by gst_vaapi_decoder_get_stats().
+ */
+void
+gst_vaapi_decoder_reset_stats (GstVaapiDecoder * decoder)
+{
+  g_return_if_fail (decoder != NULL);
+
+  memset (&decoder->stats, 0, sizeof (decoder->stats));
+}
+
+/**
+ * gst_vaapi_decoder_set_parse_threads:
+ * @decoder: a #GstVaapiDecoder
+ * @num_threads: the number of threads used to parse the bitstream
+ *
+ * Sets the number of threads, including the calling thread, that can
+ * be used to parse the headers of the independent units of a frame,
+ * e.g. the slice headers of H.264 or H.265 pictures. Units are still
+ * split and submitted for decoding in bitstream order. VP9 decoders
+ * rather submit each frame from another thread, while the next frame
+ * of the same superframe is parsed, if it does not adapt the
+ * probabilities of the next frames. A value of 1 parses everything
+ * serially, which is the default; 0 selects the number of available
+ * processors.
+ */
+void
+gst_vaapi_decoder_set_parse_threads (GstVaapiDecoder * decoder,
+    guint num_threads)
+{
+  g_return_if_fail (decoder != NULL);
+
+  if (num_threads == 0)
+    num_threads = g_get_num_processors ();
+  if (decoder->parse_threads == num_threads)
+    return;
+
+  if (decoder->parse_pool) {
+    g_thread_pool_free (decoder->parse_pool, FALSE, TRUE);
+    decoder->parse_pool = NULL;
+  }
+  decoder->parse_threads = num_threads;
+}
+
+/**
+ * gst_vaapi_decoder_get_parse_threads:
+ * @decoder: a #GstVaapiDecoder
+ *
+ * Returns the number of threads used to parse the bitstream, as set
+ * with gst_vaapi_decoder_set_parse_threads().
+ *
+ * Return value: the number of parser threads
+ */
+guint
+gst_vaapi_decoder_get_parse_threads (GstVaapiDecoder * decoder)
+{
+  g_return_val_if_fail (decoder != NULL, 1);
+
+  return decoder->parse_threads;
+}
+
+/**
+ * gst_vaapi_decoder_set_owner:
+ * @decoder: a #GstVaapiDecoder
+ * @owner: (allow-none): the name of the owner, e.g. an element name
+ *
+ * Labels the surfaces allocated for the VA context of the @decoder
+ * with @owner, so that their memory can be monitored through
+ * gst_vaapi_display_get_surface_usage().
+ */
+void
+gst_vaapi_decoder_set_owner (GstVaapiDecoder * decoder, const gchar * owner)
+{
+  g_return_if_fail (decoder != NULL);
+
+  g_free (decoder->owner);
+  decoder->owner = g_strdup (owner);
+
+  if (decoder->context && decoder->context->surfaces_pool)
+    gst_vaapi_video_pool_set_owner (decoder->context->surfaces_pool, owner);
+}
+
+/**
+ * gst_vaapi_decoder_set_surface_pool:
+ * @decoder: a #GstVaapiDecoder
+ * @pool: (allow-none): a #GstVaapiVideoPool of surfaces, or %NULL
+ *
+ * Makes the @decoder decode into surfaces allocated from @pool, e.g.
+ * the surface pool of the buffers downstream elements use, so that
+ * decoded and downstream surfaces are recycled together instead of
+ * being allocated twice. The @pool is only used if its surfaces match
+ * the coded size and chroma type of the stream, and have a native
+ * pixel format. Otherwise, the @decoder allocates its own surfaces.
+ *
+ * This takes effect when the VA context is created, or reset to
+ * another size or chroma type.
+ */
+void
+gst_vaapi_decoder_set_surface_pool (GstVaapiDecoder * decoder,
+    GstVaapiVideoPool * pool)
+{
+  g_return_if_fail (decoder != NULL);
+
+  gst_vaapi_video_pool_replace (&decoder->surface_pool, pool);
+  if (decoder->context)
+    gst_vaapi_context_set_surface_pool (decoder->context, pool);
+}
+
+/**
+ * gst_vaapi_decoder_set_max_resolution:
+ * @decoder: a #GstVaapiDecoder
+ * @max_width: the maximum picture width, or 0
+ * @max_height: the maximum picture height, or 0
+ *
+ * Makes the @decoder allocate its VA context and surfaces for pictures
+ * of up to @max_width x @max_height pixels, whatever the actual picture
+ * size is. Then, switching to another resolution within these bounds,
+ * e.g. to another rendition of an adaptive stream, only updates the
+ * picture size and the cropping rectangle of the decoded surfaces,
+ * instead of destroying and re-creating the VA context and all its
+ * surfaces. Larger pictures are still decoded, with the VA context
+ * allocated at their own size.
+ *
+ * Setting either dimension to 0 disables this mode, which is the
+ * default. This takes effect when the VA context is next created, or
+ * reset to another size or chroma type.
+ */
+void
+gst_vaapi_decoder_set_max_resolution (GstVaapiDecoder * decoder,
+    guint max_width, guint max_height)
+{
+  g_return_if_fail (decoder != NULL);
+
+  decoder->max_width = max_width;
+  decoder->max_height = max_height;
+}
+
+/**
+ * gst_vaapi_decoder_set_coalesce_slices:
+ * @decoder: a #GstVaapiDecoder
+ * @coalesce_slices: flag: %TRUE to submit all slices of a picture at once
+ *
+ * Makes the @decoder pack the data of all the slices of a picture into
+ * a single VA slice data buffer, described by a single VA slice
+ * parameter buffer holding an array of slice parameters, instead of
+ * creating a pair of VA buffers per slice. This mostly benefits
+ * streams with many slices per picture, e.g. MPEG-2 streams with one
+ * slice per macroblock row, but it costs an extra copy of the slice
+ * data. Only the MPEG-2 and H.264 decoders support this mode, which is
+ * disabled by default. This takes effect from the next picture.
+ */
+void
+gst_vaapi_decoder_set_coalesce_slices (GstVaapiDecoder * decoder,
+    gboolean coalesce_slices)
+{
+  g_return_if_fail (decoder != NULL);
+
+  decoder->coalesce_slices = coalesce_slices;
+}
+
+/**
+ * gst_vaapi_decoder_get_coalesce_slices:
+ * @decoder: a #GstVaapiDecoder
+ *
+ * Returns whether the slices of a picture are submitted at once, as
+ * set with gst_vaapi_decoder_set_coalesce_slices().
+ *
+ * Return value: %TRUE if slices are coalesced
+ */
+gboolean
+gst_vaapi_decoder_get_coalesce_slices (GstVaapiDecoder * decoder)
+{
+  g_return_val_if_fail (decoder != NULL, FALSE);
+
+  return decoder->coalesce_slices;
+}
+
+typedef struct
+{
+  GstVaapiDecoderJobFunc func;
+  gpointer *jobs;
+  guint num_jobs;
+  gpointer user_data;
+  volatile gint next_job;
+  guint num_done_jobs;
+  gint ref_count;
+
+  GMutex lock;
+  GCond done;
+} JobBatch;
+
+/* Processes jobs until there is none left */
+static void
+job_batch_run (JobBatch * batch)
+{
+  const gint num_jobs = batch->num_jobs;
+  guint n = 0;
+  gint i;
+
+  while ((i = g_atomic_int_add (&batch->next_job, 1)) < num_jobs) {
+    batch->func (batch->jobs[i], batch->user_data);
+    n++;
+  }
+
+  if (n > 0) {
+    g_mutex_lock (&batch->lock);
+    batch->num_done_jobs += n;
+    if (batch->num_done_jobs == batch->num_jobs)
+      g_cond_signal (&batch->done);
+    g_mutex_unlock (&batch->lock);
+  }
+}
+
+static void
+job_batch_unref (JobBatch * batch)
+{
+  if (!g_atomic_int_dec_and_test (&batch->ref_count))
+    return;
+  g_mutex_clear (&batch->lock);
+  g_cond_clear (&batch->done);
+  g_slice_free (JobBatch, batch);
+}
+
+static void
+job_batch_worker (gpointer data, gpointer user_data)
+{
+  JobBatch *const batch = data;
+
+  job_batch_run (batch);
+  job_batch_unref (batch);
+}
+
+/**
+ * gst_vaapi_decoder_run_jobs:
+ * @decoder: a #GstVaapiDecoder
+ * @func: the function processing each job
+ * @jobs: the array of jobs
+ * @num_jobs: the number of @jobs
+ * @user_data: data to pass to @func
+ *
+ * Processes all @jobs with @func, using the parser threads of
+ * @decoder if gst_vaapi_decoder_set_parse_threads() enabled them. The
+ * calling thread processes jobs too, and this function only returns
+ * once all of them are complete.
+ */
+void
+gst_vaapi_decoder_run_jobs (GstVaapiDecoder * decoder,
+    GstVaapiDecoderJobFunc func, gpointer * jobs, guint num_jobs,
+    gpointer user_data)
+{
+  JobBatch *batch;
+  guint i, num_workers;
+
+  g_return_if_fail (decoder != NULL);
+  g_return_if_fail (func != NULL);
+
+  if (num_jobs == 0)
+    return;
+
+  num_workers = MIN (decoder->parse_threads, num_jobs) - 1;
+  if (num_workers > 0 && !decoder->parse_pool) {
+    decoder->parse_pool = g_thread_pool_new (job_batch_worker, NULL,
+        decoder->parse_threads - 1, FALSE, NULL);
+    if (!decoder->parse_pool)
+      num_workers = 0;
+  }
+
+  if (num_jobs < 2 || num_workers == 0) {
+    for (i = 0; i < num_jobs; i++)
+      func (jobs[i], user_data);
+    return;
+  }
+
+  batch = g_slice_new (JobBatch);
+  batch->func = func;
+  batch->jobs = jobs;
+  batch->num_jobs = num_jobs;
+  batch->user_data = user_data;
+  batch->next_job = 0;
+  batch->num_done_jobs = 0;
+  batch->ref_count = 1;
+  g_mutex_init (&batch->lock);
+  g_cond_init (&batch->done);
+
+  /* The batch is freed by whoever drops the last reference, since the
+     last worker may still be signalling or unlocking it when this
+     thread sees all the jobs complete */
+  for (i = 0; i < num_workers; i++) {
+    g_atomic_int_inc (&batch->ref_count);
+    if (!g_thread_pool_push (decoder->parse_pool, batch, NULL))
+      g_atomic_int_add (&batch->ref_count, -1);
+  }
+
+  job_batch_run (batch);
+
+  g_mutex_lock (&batch->lock);
+  while (batch->num_done_jobs < batch->num_jobs)
+    g_cond_wait (&batch->done, &batch->lock);
+  g_mutex_unlock (&batch->lock);
+  job_batch_unref (batch);
+}
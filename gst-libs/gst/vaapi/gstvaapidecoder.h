@@ -73,6 +73,22 @@ typedef enum {
   GST_VAAPI_DECODER_STATUS_ERROR_UNKNOWN = -1
 } GstVaapiDecoderStatus;
 
+/**
+ * GstVaapiDecoderStats:
+ * @num_pictures: number of pictures submitted to the VA driver
+ * @num_va_calls: number of VA calls issued to submit those pictures,
+ *   i.e. buffer unmap, render, destroy and begin/end picture calls
+ * @num_render_calls: number of vaRenderPicture() calls
+ *
+ * Statistics about the submission of pictures to the VA driver, see
+ * gst_vaapi_decoder_get_stats().
+ */
+typedef struct {
+  guint64 num_pictures;
+  guint64 num_va_calls;
+  guint64 num_render_calls;
+} GstVaapiDecoderStats;
+
 GstVaapiDecoder *
 gst_vaapi_decoder_ref (GstVaapiDecoder * decoder);
 
@@ -135,6 +151,38 @@ gst_vaapi_decoder_flush (GstVaapiDecoder * decoder);
 GstVaapiDecoderStatus
 gst_vaapi_decoder_check_status (GstVaapiDecoder * decoder);
 
+void
+gst_vaapi_decoder_get_stats (GstVaapiDecoder * decoder,
+    GstVaapiDecoderStats * stats);
+
+void
+gst_vaapi_decoder_reset_stats (GstVaapiDecoder * decoder);
+
+void
+gst_vaapi_decoder_set_parse_threads (GstVaapiDecoder * decoder,
+    guint num_threads);
+
+guint
+gst_vaapi_decoder_get_parse_threads (GstVaapiDecoder * decoder);
+
+void
+gst_vaapi_decoder_set_owner (GstVaapiDecoder * decoder, const gchar * owner);
+
+void
+gst_vaapi_decoder_set_surface_pool (GstVaapiDecoder * decoder,
+    GstVaapiVideoPool * pool);
+
+void
+gst_vaapi_decoder_set_max_resolution (GstVaapiDecoder * decoder,
+    guint max_width, guint max_height);
+
+void
+gst_vaapi_decoder_set_coalesce_slices (GstVaapiDecoder * decoder,
+    gboolean coalesce_slices);
+
+gboolean
+gst_vaapi_decoder_get_coalesce_slices (GstVaapiDecoder * decoder);
+
 G_END_DECLS
 
 #endif /* GST_VAAPI_DECODER_H */
@@ -31,10 +31,13 @@
 #include <gst/codecparsers/gsth264parser.h>
 #include "gstvaapidecoder_h264.h"
 #include "gstvaapidecoder_objects.h"
+#include "gstvaapidecoder_paramsets.h"
 #include "gstvaapidecoder_priv.h"
+#include "gstvaapidecoder_refs.h"
 #include "gstvaapidisplay_priv.h"
 #include "gstvaapiobject_priv.h"
 #include "gstvaapiutils_h264_priv.h"
+#include "gstvaapiutils_startcode.h"
 
 #define DEBUG 1
 #include "gstvaapidebug.h"
@@ -95,11 +98,15 @@ struct _GstVaapiParserInfoH264
   guint flags;                  // Same as decoder unit flags (persistent)
   guint view_id;                // View ID of slice
   guint voc;                    // View order index (VOIdx) of slice
+  GstVaapiParserInfoH264 *param_set;    // Byte-identical SPS or PPS reused
 };
 
 static void
 gst_vaapi_parser_info_h264_finalize (GstVaapiParserInfoH264 * pi)
 {
+  gst_vaapi_mini_object_replace ((GstVaapiMiniObject **) & pi->param_set,
+      NULL);
+
   switch (pi->nalu.type) {
     case GST_H264_NAL_SPS:
     case GST_H264_NAL_SUBSET_SPS:
@@ -120,9 +127,11 @@ gst_vaapi_parser_info_h264_finalize (GstVaapiParserInfoH264 * pi)
 static inline const GstVaapiMiniObjectClass *
 gst_vaapi_parser_info_h264_class (void)
 {
+  static GstVaapiMiniObjectCache GstVaapiParserInfoH264Cache;
   static const GstVaapiMiniObjectClass GstVaapiParserInfoH264Class = {
     .size = sizeof (GstVaapiParserInfoH264),
-    .finalize = (GDestroyNotify) gst_vaapi_parser_info_h264_finalize
+    .finalize = (GDestroyNotify) gst_vaapi_parser_info_h264_finalize,
+    .cache = &GstVaapiParserInfoH264Cache
   };
   return &GstVaapiParserInfoH264Class;
 }
@@ -228,7 +237,8 @@ struct _GstVaapiPictureH264
   guint output_needed:1;
 };
 
-GST_VAAPI_CODEC_DEFINE_TYPE (GstVaapiPictureH264, gst_vaapi_picture_h264);
+GST_VAAPI_CODEC_DEFINE_TYPE_FULL (GstVaapiPictureH264, gst_vaapi_picture_h264,
+    gst_vaapi_picture_reset, gst_vaapi_picture_release);
 
 void
 gst_vaapi_picture_h264_destroy (GstVaapiPictureH264 * picture)
@@ -322,9 +332,11 @@ gst_vaapi_frame_store_new (GstVaapiPictureH264 * picture)
 {
   GstVaapiFrameStore *fs;
 
+  static GstVaapiMiniObjectCache GstVaapiFrameStoreCache;
   static const GstVaapiMiniObjectClass GstVaapiFrameStoreClass = {
     sizeof (GstVaapiFrameStore),
-    gst_vaapi_frame_store_finalize
+    gst_vaapi_frame_store_finalize,
+    &GstVaapiFrameStoreCache
   };
 
   fs = (GstVaapiFrameStore *)
@@ -485,6 +497,10 @@ struct _GstVaapiDecoderH264Private
   GstVaapiParserInfoH264 *active_sps;
   GstVaapiParserInfoH264 *pps[GST_H264_MAX_PPS_COUNT];
   GstVaapiParserInfoH264 *active_pps;
+  GstVaapiParserInfoH264 *context_sps;  // SPS the VA context was set up for
+  GstVaapiParamSetCache sps_cache;
+  GstVaapiParamSetCache pps_cache;
+  guint64 num_skipped_contexts;
   GstVaapiParserInfoH264 *prev_pi;
   GstVaapiParserInfoH264 *prev_slice_pi;
   GstVaapiFrameStore **prev_ref_frames;
@@ -494,6 +510,7 @@ struct _GstVaapiDecoderH264Private
   guint dpb_count;
   guint dpb_size;
   guint dpb_size_max;
+  guint max_num_reorder_frames;
   guint max_views;
   GstVaapiProfile profile;
   GstVaapiEntrypoint entrypoint;
@@ -503,6 +520,9 @@ struct _GstVaapiDecoderH264Private
   guint short_ref_count;
   GstVaapiPictureH264 *long_ref[32];
   guint long_ref_count;
+  GstVaapiRefIndex short_ref_by_frame_num_wrap;
+  GstVaapiRefIndex short_ref_by_poc;
+  GstVaapiRefIndex long_ref_by_long_term_frame_idx;
   GstVaapiPictureH264 *RefPicList0[32];
   guint RefPicList0_count;
   GstVaapiPictureH264 *RefPicList1[32];
@@ -523,11 +543,14 @@ struct _GstVaapiDecoderH264Private
   gboolean prev_pic_has_mmco5;  // prevMmco5Pic
   gboolean prev_pic_reference;  // previous picture is a reference
   guint prev_pic_structure;     // previous picture structure
+  GQueue preparsed_slices;      // slices parsed ahead (SliceParseJob)
   guint is_opened:1;
   guint is_avcC:1;
   guint has_context:1;
   guint progressive_sequence:1;
   guint top_field_first:1;
+  guint low_latency:1;
+  guint has_ref_index:1;
 };
 
 /**
@@ -560,6 +583,9 @@ exec_ref_pic_marking (GstVaapiDecoderH264 * decoder,
 static gboolean
 exec_ref_pic_marking_sliding_window (GstVaapiDecoderH264 * decoder);
 
+static void
+clear_preparsed_slices (GstVaapiDecoderH264 * decoder);
+
 static gboolean
 is_inter_view_reference_for_next_pictures (GstVaapiDecoderH264 * decoder,
     GstVaapiPictureH264 * picture);
@@ -669,6 +695,32 @@ get_max_dec_frame_buffering (GstH264SPS * sps)
   return MAX (1, max_dec_frame_buffering);
 }
 
+/* Get the maximum number of frames that precede any frame in decoding
+   order and follow it in output order, or the DPB size if unknown */
+static guint
+get_max_num_reorder_frames (GstVaapiDecoderH264 * decoder, GstH264SPS * sps,
+    guint dpb_size)
+{
+  GstVaapiDecoderH264Private *const priv = &decoder->priv;
+  guint max_num_reorder_frames = dpb_size;
+
+  if (sps->vui_parameters_present_flag &&
+      sps->vui_parameters.bitstream_restriction_flag)
+    max_num_reorder_frames = sps->vui_parameters.num_reorder_frames;
+
+  /* 8.2.1.3 - Output order is the same as decoding order */
+  else if (sps->pic_order_cnt_type == 2)
+    max_num_reorder_frames = 0;
+
+  /* Baseline profiles have no B-slices, and encoders practically never
+     reorder their P-frames, though nothing in the standard forbids it */
+  else if (priv->low_latency &&
+      sps->profile_idc == GST_H264_PROFILE_BASELINE)
+    max_num_reorder_frames = 0;
+
+  return MIN (max_num_reorder_frames, dpb_size);
+}
+
 static void
 array_remove_index_fast (void *array, guint * array_length_ptr, guint index)
 {
@@ -906,6 +958,47 @@ dpb_bump (GstVaapiDecoderH264 * decoder, GstVaapiPictureH264 * picture)
   return success;
 }
 
+/* Returns the number of complete frames waiting for output */
+static guint
+dpb_get_num_need_output (GstVaapiDecoderH264 * decoder)
+{
+  GstVaapiDecoderH264Private *const priv = &decoder->priv;
+  guint i, n = 0;
+
+  for (i = 0; i < priv->dpb_count; i++) {
+    GstVaapiFrameStore *const fs = priv->dpb[i];
+    if (fs->output_needed && gst_vaapi_frame_store_is_complete (fs))
+      n++;
+  }
+  return n;
+}
+
+/* C.4.5.3 - Outputs the frames that can no longer be preceded by the
+   next frames in output order, instead of waiting for the DPB to fill */
+static gboolean
+dpb_bump_reordered (GstVaapiDecoderH264 * decoder,
+    GstVaapiPictureH264 * picture)
+{
+  GstVaapiDecoderH264Private *const priv = &decoder->priv;
+  guint num_need_output, prev_num_need_output;
+
+  if (priv->max_views > 1)
+    return TRUE;
+
+  num_need_output = dpb_get_num_need_output (decoder);
+  while (num_need_output > priv->max_num_reorder_frames) {
+    if (!dpb_bump (decoder, picture))
+      return FALSE;
+
+    /* Stop on a frame still waiting for its second field */
+    prev_num_need_output = num_need_output;
+    num_need_output = dpb_get_num_need_output (decoder);
+    if (num_need_output >= prev_num_need_output)
+      break;
+  }
+  return TRUE;
+}
+
 static void
 dpb_clear (GstVaapiDecoderH264 * decoder, GstVaapiPictureH264 * picture)
 {
@@ -1025,7 +1118,7 @@ dpb_add (GstVaapiDecoderH264 * decoder, GstVaapiPictureH264 * picture)
 
     if (fs->output_called)
       return dpb_output (decoder, fs);
-    return TRUE;
+    return dpb_bump_reordered (decoder, picture);
   }
   // Try to output the previous frame again if it was not submitted yet
   // e.g. delayed while waiting for the next field, or a field gap was closed
@@ -1074,7 +1167,7 @@ dpb_add (GstVaapiDecoderH264 * decoder, GstVaapiPictureH264 * picture)
     }
   }
   gst_vaapi_frame_store_replace (&priv->dpb[priv->dpb_count++], fs);
-  return TRUE;
+  return dpb_bump_reordered (decoder, picture);
 }
 
 static gboolean
@@ -1185,9 +1278,20 @@ gst_vaapi_decoder_h264_close (GstVaapiDecoderH264 * decoder)
   gst_vaapi_picture_replace (&priv->missing_picture, NULL);
   gst_vaapi_parser_info_h264_replace (&priv->prev_slice_pi, NULL);
   gst_vaapi_parser_info_h264_replace (&priv->prev_pi, NULL);
+  gst_vaapi_parser_info_h264_replace (&priv->context_sps, NULL);
+  clear_preparsed_slices (decoder);
 
   dpb_clear (decoder, NULL);
 
+  if (priv->sps_cache.num_hits + priv->pps_cache.num_hits > 0)
+    GST_INFO ("skipped parsing %" G_GUINT64_FORMAT " SPS and %"
+        G_GUINT64_FORMAT " PPS, and %" G_GUINT64_FORMAT
+        " context updates", priv->sps_cache.num_hits,
+        priv->pps_cache.num_hits, priv->num_skipped_contexts);
+
+  /* The cached parameter sets only match the state of the parser */
+  gst_vaapi_param_set_cache_clear (&priv->sps_cache);
+
   if (priv->inter_views) {
     g_ptr_array_unref (priv->inter_views);
     priv->inter_views = NULL;
@@ -1239,6 +1343,9 @@ gst_vaapi_decoder_h264_destroy (GstVaapiDecoder * base_decoder)
   for (i = 0; i < G_N_ELEMENTS (priv->sps); i++)
     gst_vaapi_parser_info_h264_replace (&priv->sps[i], NULL);
   gst_vaapi_parser_info_h264_replace (&priv->active_sps, NULL);
+
+  gst_vaapi_param_set_cache_finalize (&priv->sps_cache);
+  gst_vaapi_param_set_cache_finalize (&priv->pps_cache);
 }
 
 static gboolean
@@ -1254,6 +1361,13 @@ gst_vaapi_decoder_h264_create (GstVaapiDecoder * base_decoder)
   priv->prev_pic_structure = GST_VAAPI_PICTURE_STRUCTURE_FRAME;
   priv->progressive_sequence = TRUE;
   priv->top_field_first = FALSE;
+  /* The parser parses SEI messages against the last SPS, so only that
+     one can be reused without parsing. The PPS are parsed against the
+     SPS they refer to */
+  gst_vaapi_param_set_cache_init (&priv->sps_cache, GST_H264_MAX_SPS_COUNT,
+      TRUE, &priv->pps_cache);
+  gst_vaapi_param_set_cache_init (&priv->pps_cache, GST_H264_MAX_PPS_COUNT,
+      FALSE, NULL);
   return TRUE;
 }
 
@@ -1504,6 +1618,9 @@ ensure_context (GstVaapiDecoderH264 * decoder, GstH264SPS * sps)
   gst_vaapi_decoder_set_pixel_aspect_ratio (base_decoder,
       sps->vui_parameters.par_n, sps->vui_parameters.par_d);
 
+  priv->max_num_reorder_frames =
+      get_max_num_reorder_frames (decoder, sps, dpb_size);
+
   if (!reset_context && priv->has_context)
     return GST_VAAPI_DECODER_STATUS_SUCCESS;
 
@@ -1665,6 +1782,9 @@ parse_sps (GstVaapiDecoderH264 * decoder, GstVaapiDecoderUnit * unit)
   if (result != GST_H264_PARSER_OK)
     return get_status (result);
 
+  gst_vaapi_param_set_cache_insert (&priv->sps_cache, sps->id,
+      pi->nalu.data + pi->nalu.offset, pi->nalu.size, pi);
+
   priv->parser_state |= GST_H264_VIDEO_STATE_GOT_SPS;
   return GST_VAAPI_DECODER_STATUS_SUCCESS;
 }
@@ -1688,6 +1808,9 @@ parse_subset_sps (GstVaapiDecoderH264 * decoder, GstVaapiDecoderUnit * unit)
   if (result != GST_H264_PARSER_OK)
     return get_status (result);
 
+  /* Subset SPS share their ids with SPS in the parser, don't cache them */
+  gst_vaapi_param_set_cache_clear (&priv->sps_cache);
+
   priv->parser_state |= GST_H264_VIDEO_STATE_GOT_SPS;
   return GST_VAAPI_DECODER_STATUS_SUCCESS;
 }
@@ -1714,10 +1837,62 @@ parse_pps (GstVaapiDecoderH264 * decoder, GstVaapiDecoderUnit * unit)
   if (result != GST_H264_PARSER_OK)
     return get_status (result);
 
+  gst_vaapi_param_set_cache_insert (&priv->pps_cache, pps->id,
+      pi->nalu.data + pi->nalu.offset, pi->nalu.size, pi);
+
   priv->parser_state |= GST_H264_VIDEO_STATE_GOT_PPS;
   return GST_VAAPI_DECODER_STATUS_SUCCESS;
 }
 
+/* Links the parser info of @unit to the one of a byte-identical SPS
+   or PPS parsed earlier, if any, so that it is not parsed again and
+   decoding it keeps the same parser info. The parser state is updated
+   as parse_sps() and parse_pps() would have */
+static gboolean
+reuse_param_set (GstVaapiDecoderH264 * decoder, GstVaapiDecoderUnit * unit)
+{
+  GstVaapiDecoderH264Private *const priv = &decoder->priv;
+  GstVaapiParserInfoH264 *const pi = unit->parsed_info;
+  const guint8 *const data = pi->nalu.data + pi->nalu.offset;
+  GstVaapiParserInfoH264 *cached_pi;
+
+  switch (pi->nalu.type) {
+    case GST_H264_NAL_SPS:
+      cached_pi = gst_vaapi_param_set_cache_lookup (&priv->sps_cache,
+          data, pi->nalu.size);
+      if (!cached_pi)
+        return FALSE;
+      GST_DEBUG ("reuse SPS (%" G_GUINT64_FORMAT " hits)",
+          priv->sps_cache.num_hits);
+      priv->parser_state = GST_H264_VIDEO_STATE_GOT_SPS;
+      break;
+    case GST_H264_NAL_PPS:
+      cached_pi = gst_vaapi_param_set_cache_lookup (&priv->pps_cache,
+          data, pi->nalu.size);
+      if (!cached_pi)
+        return FALSE;
+      GST_DEBUG ("reuse PPS (%" G_GUINT64_FORMAT " hits)",
+          priv->pps_cache.num_hits);
+      priv->parser_state &= GST_H264_VIDEO_STATE_GOT_SPS;
+      priv->parser_state |= GST_H264_VIDEO_STATE_GOT_PPS;
+      break;
+    default:
+      return FALSE;
+  }
+
+  gst_vaapi_parser_info_h264_replace (&pi->param_set, cached_pi);
+  return TRUE;
+}
+
+/* Returns the parser info holding the SPS or PPS of @unit */
+static inline GstVaapiParserInfoH264 *
+get_param_set_info (GstVaapiDecoderUnit * unit)
+{
+  GstVaapiParserInfoH264 *const pi = unit->parsed_info;
+
+  return pi->param_set ? pi->param_set : pi;
+}
+
 static GstVaapiDecoderStatus
 parse_sei (GstVaapiDecoderH264 * decoder, GstVaapiDecoderUnit * unit)
 {
@@ -1736,26 +1911,16 @@ parse_sei (GstVaapiDecoderH264 * decoder, GstVaapiDecoderUnit * unit)
   return GST_VAAPI_DECODER_STATUS_SUCCESS;
 }
 
-static GstVaapiDecoderStatus
-parse_slice (GstVaapiDecoderH264 * decoder, GstVaapiDecoderUnit * unit)
+/* Propagates Prefix NAL unit info to a base view slice, if necessary */
+static void
+propagate_prefix_nal_unit (GstVaapiParserInfoH264 * pi,
+    GstVaapiParserInfoH264 * prev_pi)
 {
-  GstVaapiDecoderH264Private *const priv = &decoder->priv;
-  GstVaapiParserInfoH264 *const pi = unit->parsed_info;
-  GstH264SliceHdr *const slice_hdr = &pi->data.slice_hdr;
   GstH264NalUnit *const nalu = &pi->nalu;
-  GstH264SPS *sps;
-  GstH264ParserResult result;
-
-  GST_DEBUG ("parse slice");
 
-  priv->parser_state &= (GST_H264_VIDEO_STATE_GOT_SPS |
-      GST_H264_VIDEO_STATE_GOT_PPS);
-
-  /* Propagate Prefix NAL unit info, if necessary */
   switch (nalu->type) {
     case GST_H264_NAL_SLICE:
     case GST_H264_NAL_SLICE_IDR:{
-      GstVaapiParserInfoH264 *const prev_pi = priv->prev_pi;
       if (prev_pi && prev_pi->nalu.type == GST_H264_NAL_PREFIX_UNIT) {
         /* MVC sequences shall have a Prefix NAL unit immediately
            preceding this NAL unit */
@@ -1777,6 +1942,18 @@ parse_slice (GstVaapiDecoderH264 * decoder, GstVaapiDecoderUnit * unit)
       break;
     }
   }
+}
+
+/* Parses the slice header, including the pred_weight_table() and
+   dec_ref_pic_marking() syntax elements. This only reads the active
+   SPS and PPS from the parser, so this can run on the parser threads */
+static GstVaapiDecoderStatus
+parse_slice_header (GstVaapiDecoderH264 * decoder, GstVaapiParserInfoH264 * pi)
+{
+  GstVaapiDecoderH264Private *const priv = &decoder->priv;
+  GstH264SliceHdr *const slice_hdr = &pi->data.slice_hdr;
+  GstH264SPS *sps;
+  GstH264ParserResult result;
 
   /* Variables that don't have inferred values per the H.264
      standard but that should get a default value anyway */
@@ -1793,10 +1970,39 @@ parse_slice (GstVaapiDecoderH264 * decoder, GstVaapiDecoderUnit * unit)
   /* Update MVC data */
   pi->view_id = get_view_id (&pi->nalu);
   pi->voc = get_view_order_index (sps, pi->view_id);
+  return GST_VAAPI_DECODER_STATUS_SUCCESS;
+}
+
+static void
+update_slice_parser_state (GstVaapiDecoderH264 * decoder,
+    GstVaapiParserInfoH264 * pi)
+{
+  GstVaapiDecoderH264Private *const priv = &decoder->priv;
 
   priv->parser_state |= GST_H264_VIDEO_STATE_GOT_SLICE;
-  if (!GST_H264_IS_I_SLICE (slice_hdr))
+  if (!GST_H264_IS_I_SLICE (&pi->data.slice_hdr))
     priv->parser_state |= GST_H264_VIDEO_STATE_GOT_P_SLICE;
+}
+
+static GstVaapiDecoderStatus
+parse_slice (GstVaapiDecoderH264 * decoder, GstVaapiDecoderUnit * unit)
+{
+  GstVaapiDecoderH264Private *const priv = &decoder->priv;
+  GstVaapiParserInfoH264 *const pi = unit->parsed_info;
+  GstVaapiDecoderStatus status;
+
+  GST_DEBUG ("parse slice");
+
+  priv->parser_state &= (GST_H264_VIDEO_STATE_GOT_SPS |
+      GST_H264_VIDEO_STATE_GOT_PPS);
+
+  propagate_prefix_nal_unit (pi, priv->prev_pi);
+
+  status = parse_slice_header (decoder, pi);
+  if (status != GST_VAAPI_DECODER_STATUS_SUCCESS)
+    return status;
+
+  update_slice_parser_state (decoder, pi);
   return GST_VAAPI_DECODER_STATUS_SUCCESS;
 }
 
@@ -1804,7 +2010,7 @@ static GstVaapiDecoderStatus
 decode_sps (GstVaapiDecoderH264 * decoder, GstVaapiDecoderUnit * unit)
 {
   GstVaapiDecoderH264Private *const priv = &decoder->priv;
-  GstVaapiParserInfoH264 *const pi = unit->parsed_info;
+  GstVaapiParserInfoH264 *const pi = get_param_set_info (unit);
   GstH264SPS *const sps = &pi->data.sps;
 
   GST_DEBUG ("decode SPS");
@@ -1830,7 +2036,7 @@ static GstVaapiDecoderStatus
 decode_pps (GstVaapiDecoderH264 * decoder, GstVaapiDecoderUnit * unit)
 {
   GstVaapiDecoderH264Private *const priv = &decoder->priv;
-  GstVaapiParserInfoH264 *const pi = unit->parsed_info;
+  GstVaapiParserInfoH264 *const pi = get_param_set_info (unit);
   GstH264PPS *const pps = &pi->data.pps;
 
   GST_DEBUG ("decode PPS");
@@ -1883,6 +2089,7 @@ decode_sequence_end (GstVaapiDecoderH264 * decoder)
 
   /* Reset defaults, should there be a new sequence available next */
   priv->max_views = 1;
+  gst_vaapi_parser_info_h264_replace (&priv->context_sps, NULL);
   return GST_VAAPI_DECODER_STATUS_SUCCESS;
 }
 
@@ -2087,60 +2294,6 @@ init_picture_poc (GstVaapiDecoderH264 * decoder,
   picture->base.poc = MIN (picture->field_poc[0], picture->field_poc[1]);
 }
 
-static int
-compare_picture_pic_num_dec (const void *a, const void *b)
-{
-  const GstVaapiPictureH264 *const picA = *(GstVaapiPictureH264 **) a;
-  const GstVaapiPictureH264 *const picB = *(GstVaapiPictureH264 **) b;
-
-  return picB->pic_num - picA->pic_num;
-}
-
-static int
-compare_picture_long_term_pic_num_inc (const void *a, const void *b)
-{
-  const GstVaapiPictureH264 *const picA = *(GstVaapiPictureH264 **) a;
-  const GstVaapiPictureH264 *const picB = *(GstVaapiPictureH264 **) b;
-
-  return picA->long_term_pic_num - picB->long_term_pic_num;
-}
-
-static int
-compare_picture_poc_dec (const void *a, const void *b)
-{
-  const GstVaapiPictureH264 *const picA = *(GstVaapiPictureH264 **) a;
-  const GstVaapiPictureH264 *const picB = *(GstVaapiPictureH264 **) b;
-
-  return picB->base.poc - picA->base.poc;
-}
-
-static int
-compare_picture_poc_inc (const void *a, const void *b)
-{
-  const GstVaapiPictureH264 *const picA = *(GstVaapiPictureH264 **) a;
-  const GstVaapiPictureH264 *const picB = *(GstVaapiPictureH264 **) b;
-
-  return picA->base.poc - picB->base.poc;
-}
-
-static int
-compare_picture_frame_num_wrap_dec (const void *a, const void *b)
-{
-  const GstVaapiPictureH264 *const picA = *(GstVaapiPictureH264 **) a;
-  const GstVaapiPictureH264 *const picB = *(GstVaapiPictureH264 **) b;
-
-  return picB->frame_num_wrap - picA->frame_num_wrap;
-}
-
-static int
-compare_picture_long_term_frame_idx_inc (const void *a, const void *b)
-{
-  const GstVaapiPictureH264 *const picA = *(GstVaapiPictureH264 **) a;
-  const GstVaapiPictureH264 *const picB = *(GstVaapiPictureH264 **) b;
-
-  return picA->long_term_frame_idx - picB->long_term_frame_idx;
-}
-
 /* 8.2.4.1 - Decoding process for picture numbers */
 static void
 init_picture_refs_pic_num (GstVaapiDecoderH264 * decoder,
@@ -2196,8 +2349,43 @@ init_picture_refs_pic_num (GstVaapiDecoderH264 * decoder,
   }
 }
 
-#define SORT_REF_LIST(list, n, compare_func) \
-    qsort(list, n, sizeof(*(list)), compare_picture_##compare_func)
+/* Sorts the short-term and long-term reference pictures once per
+   picture, so that the reference picture lists of every slice are
+   initialized by copying ranges of the indexes. For frames, PicNum is
+   FrameNumWrap and LongTermPicNum is LongTermFrameIdx (8-28, 8-29) */
+static void
+init_picture_ref_index (GstVaapiDecoderH264 * decoder)
+{
+  GstVaapiDecoderH264Private *const priv = &decoder->priv;
+  guint i;
+
+  gst_vaapi_ref_index_clear (&priv->short_ref_by_frame_num_wrap);
+  gst_vaapi_ref_index_clear (&priv->short_ref_by_poc);
+  for (i = 0; i < priv->short_ref_count; i++) {
+    GstVaapiPictureH264 *const pic = priv->short_ref[i];
+    gst_vaapi_ref_index_insert (&priv->short_ref_by_frame_num_wrap,
+        pic->frame_num_wrap, pic);
+    gst_vaapi_ref_index_insert (&priv->short_ref_by_poc, pic->base.poc, pic);
+  }
+
+  gst_vaapi_ref_index_clear (&priv->long_ref_by_long_term_frame_idx);
+  for (i = 0; i < priv->long_ref_count; i++) {
+    GstVaapiPictureH264 *const pic = priv->long_ref[i];
+    gst_vaapi_ref_index_insert (&priv->long_ref_by_long_term_frame_idx,
+        pic->long_term_frame_idx, pic);
+  }
+  priv->has_ref_index = TRUE;
+}
+
+/* Copies the pictures of @index from @start to @end into @ref_list,
+   by increasing key or by decreasing key if @reverse is set */
+static inline guint
+copy_ref_list (GstVaapiRefIndex * index, guint start, guint end,
+    gboolean reverse, GstVaapiPictureH264 ** ref_list)
+{
+  return gst_vaapi_ref_index_copy (index, start, end, reverse,
+      (gpointer *) ref_list);
+}
 
 static void
 init_picture_refs_fields_1 (guint picture_structure,
@@ -2395,48 +2583,28 @@ init_picture_refs_p_slice (GstVaapiDecoderH264 * decoder,
     GstVaapiPictureH264 * picture, GstH264SliceHdr * slice_hdr)
 {
   GstVaapiDecoderH264Private *const priv = &decoder->priv;
-  GstVaapiPictureH264 **ref_list;
-  guint i;
+  GstVaapiRefIndex *const short_index = &priv->short_ref_by_frame_num_wrap;
+  GstVaapiRefIndex *const long_index = &priv->long_ref_by_long_term_frame_idx;
 
   GST_DEBUG ("decode reference picture list for P and SP slices");
 
   if (GST_VAAPI_PICTURE_IS_FRAME (picture)) {
     /* 8.2.4.2.1 - P and SP slices in frames */
-    if (priv->short_ref_count > 0) {
-      ref_list = priv->RefPicList0;
-      for (i = 0; i < priv->short_ref_count; i++)
-        ref_list[i] = priv->short_ref[i];
-      SORT_REF_LIST (ref_list, i, pic_num_dec);
-      priv->RefPicList0_count += i;
-    }
-
-    if (priv->long_ref_count > 0) {
-      ref_list = &priv->RefPicList0[priv->RefPicList0_count];
-      for (i = 0; i < priv->long_ref_count; i++)
-        ref_list[i] = priv->long_ref[i];
-      SORT_REF_LIST (ref_list, i, long_term_pic_num_inc);
-      priv->RefPicList0_count += i;
-    }
+    priv->RefPicList0_count += copy_ref_list (short_index, 0,
+        short_index->count, TRUE, priv->RefPicList0);
+    priv->RefPicList0_count += copy_ref_list (long_index, 0,
+        long_index->count, FALSE, &priv->RefPicList0[priv->RefPicList0_count]);
   } else {
     /* 8.2.4.2.2 - P and SP slices in fields */
     GstVaapiPictureH264 *short_ref[32];
-    guint short_ref_count = 0;
+    guint short_ref_count;
     GstVaapiPictureH264 *long_ref[32];
-    guint long_ref_count = 0;
-
-    if (priv->short_ref_count > 0) {
-      for (i = 0; i < priv->short_ref_count; i++)
-        short_ref[i] = priv->short_ref[i];
-      SORT_REF_LIST (short_ref, i, frame_num_wrap_dec);
-      short_ref_count = i;
-    }
+    guint long_ref_count;
 
-    if (priv->long_ref_count > 0) {
-      for (i = 0; i < priv->long_ref_count; i++)
-        long_ref[i] = priv->long_ref[i];
-      SORT_REF_LIST (long_ref, i, long_term_frame_idx_inc);
-      long_ref_count = i;
-    }
+    short_ref_count = copy_ref_list (short_index, 0, short_index->count,
+        TRUE, short_ref);
+    long_ref_count = copy_ref_list (long_index, 0, long_index->count,
+        FALSE, long_ref);
 
     init_picture_refs_fields (picture,
         priv->RefPicList0, &priv->RefPicList0_count,
@@ -2454,125 +2622,62 @@ init_picture_refs_b_slice (GstVaapiDecoderH264 * decoder,
     GstVaapiPictureH264 * picture, GstH264SliceHdr * slice_hdr)
 {
   GstVaapiDecoderH264Private *const priv = &decoder->priv;
-  GstVaapiPictureH264 **ref_list;
-  guint i, n;
+  GstVaapiRefIndex *const poc_index = &priv->short_ref_by_poc;
+  GstVaapiRefIndex *const long_index = &priv->long_ref_by_long_term_frame_idx;
+  guint lb, ub, n;
 
   GST_DEBUG ("decode reference picture list for B slices");
 
+  /* Short-term references with a POC lower than, or equal to, the POC
+     of the current picture are [0, lb), respectively [0, ub) */
+  lb = gst_vaapi_ref_index_lower_bound (poc_index, picture->base.poc);
+  ub = gst_vaapi_ref_index_upper_bound (poc_index, picture->base.poc);
+
   if (GST_VAAPI_PICTURE_IS_FRAME (picture)) {
     /* 8.2.4.2.3 - B slices in frames */
 
     /* RefPicList0 */
-    if (priv->short_ref_count > 0) {
-      // 1. Short-term references
-      ref_list = priv->RefPicList0;
-      for (n = 0, i = 0; i < priv->short_ref_count; i++) {
-        if (priv->short_ref[i]->base.poc < picture->base.poc)
-          ref_list[n++] = priv->short_ref[i];
-      }
-      SORT_REF_LIST (ref_list, n, poc_dec);
-      priv->RefPicList0_count += n;
-
-      ref_list = &priv->RefPicList0[priv->RefPicList0_count];
-      for (n = 0, i = 0; i < priv->short_ref_count; i++) {
-        if (priv->short_ref[i]->base.poc >= picture->base.poc)
-          ref_list[n++] = priv->short_ref[i];
-      }
-      SORT_REF_LIST (ref_list, n, poc_inc);
-      priv->RefPicList0_count += n;
-    }
-
-    if (priv->long_ref_count > 0) {
-      // 2. Long-term references
-      ref_list = &priv->RefPicList0[priv->RefPicList0_count];
-      for (n = 0, i = 0; i < priv->long_ref_count; i++)
-        ref_list[n++] = priv->long_ref[i];
-      SORT_REF_LIST (ref_list, n, long_term_pic_num_inc);
-      priv->RefPicList0_count += n;
-    }
+    // 1. Short-term references
+    n = copy_ref_list (poc_index, 0, lb, TRUE, priv->RefPicList0);
+    n += copy_ref_list (poc_index, lb, poc_index->count, FALSE,
+        &priv->RefPicList0[n]);
+    // 2. Long-term references
+    n += copy_ref_list (long_index, 0, long_index->count, FALSE,
+        &priv->RefPicList0[n]);
+    priv->RefPicList0_count += n;
 
     /* RefPicList1 */
-    if (priv->short_ref_count > 0) {
-      // 1. Short-term references
-      ref_list = priv->RefPicList1;
-      for (n = 0, i = 0; i < priv->short_ref_count; i++) {
-        if (priv->short_ref[i]->base.poc > picture->base.poc)
-          ref_list[n++] = priv->short_ref[i];
-      }
-      SORT_REF_LIST (ref_list, n, poc_inc);
-      priv->RefPicList1_count += n;
-
-      ref_list = &priv->RefPicList1[priv->RefPicList1_count];
-      for (n = 0, i = 0; i < priv->short_ref_count; i++) {
-        if (priv->short_ref[i]->base.poc <= picture->base.poc)
-          ref_list[n++] = priv->short_ref[i];
-      }
-      SORT_REF_LIST (ref_list, n, poc_dec);
-      priv->RefPicList1_count += n;
-    }
-
-    if (priv->long_ref_count > 0) {
-      // 2. Long-term references
-      ref_list = &priv->RefPicList1[priv->RefPicList1_count];
-      for (n = 0, i = 0; i < priv->long_ref_count; i++)
-        ref_list[n++] = priv->long_ref[i];
-      SORT_REF_LIST (ref_list, n, long_term_pic_num_inc);
-      priv->RefPicList1_count += n;
-    }
+    // 1. Short-term references
+    n = copy_ref_list (poc_index, ub, poc_index->count, FALSE,
+        priv->RefPicList1);
+    n += copy_ref_list (poc_index, 0, ub, TRUE, &priv->RefPicList1[n]);
+    // 2. Long-term references
+    n += copy_ref_list (long_index, 0, long_index->count, FALSE,
+        &priv->RefPicList1[n]);
+    priv->RefPicList1_count += n;
   } else {
     /* 8.2.4.2.4 - B slices in fields */
     GstVaapiPictureH264 *short_ref0[32];
-    guint short_ref0_count = 0;
+    guint short_ref0_count;
     GstVaapiPictureH264 *short_ref1[32];
-    guint short_ref1_count = 0;
+    guint short_ref1_count;
     GstVaapiPictureH264 *long_ref[32];
-    guint long_ref_count = 0;
+    guint long_ref_count;
 
     /* refFrameList0ShortTerm */
-    if (priv->short_ref_count > 0) {
-      ref_list = short_ref0;
-      for (n = 0, i = 0; i < priv->short_ref_count; i++) {
-        if (priv->short_ref[i]->base.poc <= picture->base.poc)
-          ref_list[n++] = priv->short_ref[i];
-      }
-      SORT_REF_LIST (ref_list, n, poc_dec);
-      short_ref0_count += n;
-
-      ref_list = &short_ref0[short_ref0_count];
-      for (n = 0, i = 0; i < priv->short_ref_count; i++) {
-        if (priv->short_ref[i]->base.poc > picture->base.poc)
-          ref_list[n++] = priv->short_ref[i];
-      }
-      SORT_REF_LIST (ref_list, n, poc_inc);
-      short_ref0_count += n;
-    }
+    short_ref0_count = copy_ref_list (poc_index, 0, ub, TRUE, short_ref0);
+    short_ref0_count += copy_ref_list (poc_index, ub, poc_index->count,
+        FALSE, &short_ref0[short_ref0_count]);
 
     /* refFrameList1ShortTerm */
-    if (priv->short_ref_count > 0) {
-      ref_list = short_ref1;
-      for (n = 0, i = 0; i < priv->short_ref_count; i++) {
-        if (priv->short_ref[i]->base.poc > picture->base.poc)
-          ref_list[n++] = priv->short_ref[i];
-      }
-      SORT_REF_LIST (ref_list, n, poc_inc);
-      short_ref1_count += n;
-
-      ref_list = &short_ref1[short_ref1_count];
-      for (n = 0, i = 0; i < priv->short_ref_count; i++) {
-        if (priv->short_ref[i]->base.poc <= picture->base.poc)
-          ref_list[n++] = priv->short_ref[i];
-      }
-      SORT_REF_LIST (ref_list, n, poc_dec);
-      short_ref1_count += n;
-    }
+    short_ref1_count = copy_ref_list (poc_index, ub, poc_index->count,
+        FALSE, short_ref1);
+    short_ref1_count += copy_ref_list (poc_index, 0, ub, TRUE,
+        &short_ref1[short_ref1_count]);
 
     /* refFrameListLongTerm */
-    if (priv->long_ref_count > 0) {
-      for (i = 0; i < priv->long_ref_count; i++)
-        long_ref[i] = priv->long_ref[i];
-      SORT_REF_LIST (long_ref, i, long_term_frame_idx_inc);
-      long_ref_count = i;
-    }
+    long_ref_count = copy_ref_list (long_index, 0, long_index->count,
+        FALSE, long_ref);
 
     init_picture_refs_fields (picture,
         priv->RefPicList0, &priv->RefPicList0_count,
@@ -2603,8 +2708,6 @@ init_picture_refs_b_slice (GstVaapiDecoderH264 * decoder,
   }
 }
 
-#undef SORT_REF_LIST
-
 static gint
 find_short_term_reference (GstVaapiDecoderH264 * decoder, gint32 pic_num)
 {
@@ -2635,6 +2738,56 @@ find_long_term_reference (GstVaapiDecoderH264 * decoder,
   return -1;
 }
 
+/* Returns the index key, i.e. FrameNumWrap or LongTermFrameIdx, of the
+   pictures with the supplied PicNum or LongTermPicNum (8-28 to 8-33) */
+static inline gint32
+get_ref_index_key (GstVaapiPictureH264 * picture, gint32 pic_num)
+{
+  if (GST_VAAPI_PICTURE_IS_FRAME (picture))
+    return pic_num;
+  return (pic_num - (pic_num < 0)) / 2;
+}
+
+/* Same as find_short_term_reference(), looked up in the index */
+static GstVaapiPictureH264 *
+lookup_short_term_reference (GstVaapiDecoderH264 * decoder,
+    GstVaapiPictureH264 * picture, gint32 pic_num)
+{
+  GstVaapiRefIndex *const index = &decoder->priv.short_ref_by_frame_num_wrap;
+  const gint32 key = get_ref_index_key (picture, pic_num);
+  guint i;
+
+  for (i = gst_vaapi_ref_index_lower_bound (index, key);
+      i < index->count && index->entries[i].key == key; i++) {
+    GstVaapiPictureH264 *const pic = index->entries[i].picture;
+    if (pic->pic_num == pic_num)
+      return pic;
+  }
+  GST_ERROR ("found no short-term reference picture with PicNum = %d", pic_num);
+  return NULL;
+}
+
+/* Same as find_long_term_reference(), looked up in the index */
+static GstVaapiPictureH264 *
+lookup_long_term_reference (GstVaapiDecoderH264 * decoder,
+    GstVaapiPictureH264 * picture, gint32 long_term_pic_num)
+{
+  GstVaapiRefIndex *const index =
+      &decoder->priv.long_ref_by_long_term_frame_idx;
+  const gint32 key = get_ref_index_key (picture, long_term_pic_num);
+  guint i;
+
+  for (i = gst_vaapi_ref_index_lower_bound (index, key);
+      i < index->count && index->entries[i].key == key; i++) {
+    GstVaapiPictureH264 *const pic = index->entries[i].picture;
+    if (pic->long_term_pic_num == long_term_pic_num)
+      return pic;
+  }
+  GST_ERROR ("found no long-term reference picture with LongTermPicNum = %d",
+      long_term_pic_num);
+  return NULL;
+}
+
 static void
 exec_picture_refs_modification_1 (GstVaapiDecoderH264 * decoder,
     GstVaapiPictureH264 * picture, GstH264SliceHdr * slice_hdr, guint list)
@@ -2647,7 +2800,6 @@ exec_picture_refs_modification_1 (GstVaapiDecoderH264 * decoder,
   guint *ref_list_count_ptr, ref_list_idx = 0;
   const guint16 *view_ids = NULL;
   guint i, j, n, num_refs, num_view_ids = 0;
-  gint found_ref_idx;
   gint32 MaxPicNum, CurrPicNum, picNumPred, picViewIdxPred;
 
   GST_DEBUG ("modification process of reference picture list %u", list);
@@ -2736,9 +2888,8 @@ exec_picture_refs_modification_1 (GstVaapiDecoderH264 * decoder,
       // (8-37)
       for (j = num_refs; j > ref_list_idx; j--)
         ref_list[j] = ref_list[j - 1];
-      found_ref_idx = find_short_term_reference (decoder, picNum);
       ref_list[ref_list_idx++] =
-          found_ref_idx >= 0 ? priv->short_ref[found_ref_idx] : NULL;
+          lookup_short_term_reference (decoder, picture, picNum);
       n = ref_list_idx;
       for (j = ref_list_idx; j <= num_refs; j++) {
         gint32 PicNumF;
@@ -2758,10 +2909,8 @@ exec_picture_refs_modification_1 (GstVaapiDecoderH264 * decoder,
 
       for (j = num_refs; j > ref_list_idx; j--)
         ref_list[j] = ref_list[j - 1];
-      found_ref_idx =
-          find_long_term_reference (decoder, l->value.long_term_pic_num);
-      ref_list[ref_list_idx++] =
-          found_ref_idx >= 0 ? priv->long_ref[found_ref_idx] : NULL;
+      ref_list[ref_list_idx++] = lookup_long_term_reference (decoder,
+          picture, l->value.long_term_pic_num);
       n = ref_list_idx;
       for (j = ref_list_idx; j <= num_refs; j++) {
         gint32 LongTermPicNumF;
@@ -2923,6 +3072,7 @@ init_picture_ref_lists (GstVaapiDecoderH264 * decoder,
   for (i = long_ref_count; i < priv->long_ref_count; i++)
     priv->long_ref[i] = NULL;
   priv->long_ref_count = long_ref_count;
+  priv->has_ref_index = FALSE;
 }
 
 static void
@@ -2932,8 +3082,12 @@ init_picture_refs (GstVaapiDecoderH264 * decoder,
   GstVaapiDecoderH264Private *const priv = &decoder->priv;
   guint i, num_refs;
 
-  init_picture_ref_lists (decoder, picture);
-  init_picture_refs_pic_num (decoder, picture, slice_hdr);
+  /* The DPB does not change between the slices of a picture */
+  if (!priv->has_ref_index) {
+    init_picture_ref_lists (decoder, picture);
+    init_picture_refs_pic_num (decoder, picture, slice_hdr);
+    init_picture_ref_index (decoder);
+  }
 
   priv->RefPicList0_count = 0;
   priv->RefPicList1_count = 0;
@@ -3258,6 +3412,7 @@ init_picture (GstVaapiDecoderH264 * decoder,
   picture->frame_num = priv->frame_num;
   picture->frame_num_wrap = priv->frame_num;
   picture->output_flag = TRUE;  /* XXX: conformant to Annex A only */
+  priv->has_ref_index = FALSE;
   base_picture->pts = GST_VAAPI_DECODER_CODEC_FRAME (decoder)->pts;
   base_picture->type = GST_VAAPI_PICTURE_TYPE_NONE;
   base_picture->view_id = pi->view_id;
@@ -3603,6 +3758,7 @@ exec_ref_pic_marking (GstVaapiDecoderH264 * decoder,
   priv->prev_pic_reference = GST_VAAPI_PICTURE_IS_REFERENCE (picture);
   priv->prev_pic_has_mmco5 = FALSE;
   priv->prev_pic_structure = picture->structure;
+  priv->has_ref_index = FALSE;
 
   if (GST_VAAPI_PICTURE_IS_INTER_VIEW (picture))
     g_ptr_array_add (priv->inter_views, gst_vaapi_picture_ref (picture));
@@ -3933,9 +4089,15 @@ decode_picture (GstVaapiDecoderH264 * decoder, GstVaapiDecoderUnit * unit)
       break;
   }
 
-  status = ensure_context (decoder, sps);
-  if (status != GST_VAAPI_DECODER_STATUS_SUCCESS)
-    return status;
+  /* Repeated SPS reuse the parser info of the active one, and then
+     there is nothing to reconfigure */
+  if (!priv->has_context || priv->context_sps != priv->active_sps) {
+    status = ensure_context (decoder, sps);
+    if (status != GST_VAAPI_DECODER_STATUS_SUCCESS)
+      return status;
+    gst_vaapi_parser_info_h264_replace (&priv->context_sps, priv->active_sps);
+  } else
+    priv->num_skipped_contexts++;
 
   priv->decoder_state = 0;
   gst_vaapi_picture_replace (&priv->missing_picture, NULL);
@@ -4180,7 +4342,7 @@ decode_slice (GstVaapiDecoderH264 * decoder, GstVaapiDecoderUnit * unit)
   if (pi->flags & GST_VAAPI_DECODER_UNIT_FLAG_AU_END)
     GST_VAAPI_PICTURE_FLAG_SET (picture, GST_VAAPI_PICTURE_FLAG_AU_END);
 
-  slice = GST_VAAPI_SLICE_NEW (H264, decoder,
+  slice = GST_VAAPI_SLICE_NEW_FOR_PICTURE (H264, picture,
       (map_info.data + unit->offset + pi->nalu.offset), pi->nalu.size);
   gst_buffer_unmap (buffer, &map_info);
   if (!slice) {
@@ -4202,8 +4364,196 @@ decode_slice (GstVaapiDecoderH264 * decoder, GstVaapiDecoderUnit * unit)
 static inline gint
 scan_for_start_code (GstAdapter * adapter, guint ofs, guint size, guint32 * scp)
 {
-  return (gint) gst_adapter_masked_scan_uint32_peek (adapter,
-      0xffffff00, 0x00000100, ofs, size, scp);
+  return gst_vaapi_adapter_scan_for_start_code (adapter, ofs, size, scp);
+}
+
+/* ------------------------------------------------------------------------- */
+/* --- Parallel slice parsing                                            --- */
+/* ------------------------------------------------------------------------- */
+
+/* Maximum number of slices parsed ahead at once */
+#define MAX_PREPARSED_SLICES 64
+
+/* Number of leading bytes used to check a pre-parsed slice matches */
+#define PREPARSED_SLICE_HEAD_SIZE 16
+
+typedef struct
+{
+  GstVaapiParserInfoH264 *pi;
+  guint offset;
+  guint size;
+  guint8 head[PREPARSED_SLICE_HEAD_SIZE];
+  GstVaapiDecoderStatus status;
+} SliceParseJob;
+
+static void
+slice_parse_job_free (SliceParseJob * job)
+{
+  gst_vaapi_parser_info_h264_replace (&job->pi, NULL);
+  g_slice_free (SliceParseJob, job);
+}
+
+static void
+clear_preparsed_slices (GstVaapiDecoderH264 * decoder)
+{
+  GstVaapiDecoderH264Private *const priv = &decoder->priv;
+  SliceParseJob *job;
+
+  while ((job = g_queue_pop_head (&priv->preparsed_slices)))
+    slice_parse_job_free (job);
+}
+
+static void
+slice_parse_job_run (gpointer data, gpointer user_data)
+{
+  SliceParseJob *const job = data;
+
+  job->status = parse_slice_header (user_data, job->pi);
+}
+
+/* Returns the pre-parsed slice info matching the NAL unit in buf[], if
+   any. Any mismatch discards the whole batch of pre-parsed slices */
+static SliceParseJob *
+pop_preparsed_slice (GstVaapiDecoderH264 * decoder, const guchar * buf,
+    guint buf_size)
+{
+  GstVaapiDecoderH264Private *const priv = &decoder->priv;
+  SliceParseJob *job;
+
+  job = g_queue_peek_head (&priv->preparsed_slices);
+  if (!job)
+    return NULL;
+
+  if (job->size != buf_size ||
+      memcmp (job->head, buf, MIN (buf_size, PREPARSED_SLICE_HEAD_SIZE))) {
+    GST_DEBUG ("discard pre-parsed slices");
+    clear_preparsed_slices (decoder);
+    return NULL;
+  }
+  return g_queue_pop_head (&priv->preparsed_slices);
+}
+
+/* Checks whether the NAL unit header byte denotes a slice that can be
+   parsed ahead, i.e. a base view slice. Any other NAL unit type may
+   update the parser state and thus terminates the batch */
+static inline gboolean
+is_preparsable_slice (guint8 nal_header)
+{
+  const guint nal_type = nal_header & 0x1f;
+
+  return nal_type == GST_H264_NAL_SLICE || nal_type == GST_H264_NAL_SLICE_IDR;
+}
+
+/* Splits the slice NAL units that follow the one at the start of the
+   adapter, and parses their headers in parallel. They will be
+   committed in order, as they get parsed, by subsequent calls to
+   gst_vaapi_decoder_h264_parse() */
+static void
+preparse_slices (GstVaapiDecoderH264 * decoder, GstAdapter * adapter,
+    guint ofs, guint size)
+{
+  GstVaapiDecoderH264Private *const priv = &decoder->priv;
+  SliceParseJob *jobs[MAX_PREPARSED_SLICES];
+  GstH264ParserResult result;
+  const guchar *buf;
+  guint8 header[4];
+  guint i, n, nalu_size, num_jobs = 0;
+  gint next_ofs;
+
+  if (priv->stream_alignment == GST_VAAPI_STREAM_ALIGN_H264_NALU)
+    return;
+
+  /* Split NAL units, this only needs to peek the adapter */
+  while (num_jobs < MAX_PREPARSED_SLICES && ofs < size) {
+    if (priv->is_avcC) {
+      if (size - ofs < priv->nal_length_size + 1)
+        break;
+      gst_adapter_copy (adapter, header, ofs, priv->nal_length_size);
+      for (i = 0, nalu_size = 0; i < priv->nal_length_size; i++)
+        nalu_size = (nalu_size << 8) | header[i];
+      nalu_size += priv->nal_length_size;
+      if (size - ofs < nalu_size)
+        break;
+      gst_adapter_copy (adapter, header, ofs + priv->nal_length_size, 1);
+      if (!is_preparsable_slice (header[0]))
+        break;
+    } else {
+      if (size - ofs < 4)
+        break;
+      gst_adapter_copy (adapter, header, ofs, 4);
+      if (header[0] != 0 || header[1] != 0 || header[2] != 1)
+        break;
+      if (!is_preparsable_slice (header[3]))
+        break;
+      next_ofs = size - ofs < 8 ? -1 :
+          scan_for_start_code (adapter, ofs + 4, size - ofs - 4, NULL);
+      if (next_ofs < 0) {
+        // The last NAL unit is only complete if stream buffers are
+        // aligned on access unit boundaries
+        if (priv->stream_alignment != GST_VAAPI_STREAM_ALIGN_H264_AU)
+          break;
+        next_ofs = size;
+      }
+      nalu_size = next_ofs - ofs;
+    }
+
+    jobs[num_jobs] = g_slice_new0 (SliceParseJob);
+    jobs[num_jobs]->offset = ofs;
+    jobs[num_jobs]->size = nalu_size;
+    num_jobs++;
+    ofs += nalu_size;
+  }
+  if (num_jobs < 2)
+    goto cleanup;
+
+  buf = gst_adapter_map (adapter, ofs);
+  if (!buf)
+    goto cleanup;
+
+  /* Identify NAL units in order, then parse slice headers in parallel */
+  for (i = 0, n = 0; i < num_jobs; i++, n++) {
+    SliceParseJob *const job = jobs[i];
+
+    job->pi = gst_vaapi_parser_info_h264_new ();
+    if (!job->pi)
+      break;
+
+    if (priv->is_avcC)
+      result = gst_h264_parser_identify_nalu_avc (priv->parser,
+          buf + job->offset, 0, job->size, priv->nal_length_size,
+          &job->pi->nalu);
+    else
+      result = gst_h264_parser_identify_nalu_unchecked (priv->parser,
+          buf + job->offset, 0, job->size, &job->pi->nalu);
+    if (result != GST_H264_PARSER_OK)
+      break;
+
+    /* Previous NAL unit is a slice, so there is no Prefix NAL unit */
+    propagate_prefix_nal_unit (job->pi, NULL);
+    memcpy (job->head, buf + job->offset,
+        MIN (job->size, PREPARSED_SLICE_HEAD_SIZE));
+  }
+  if (n < 2) {
+    gst_adapter_unmap (adapter);
+    goto cleanup;
+  }
+
+  gst_vaapi_decoder_run_jobs (GST_VAAPI_DECODER_CAST (decoder),
+      slice_parse_job_run, (gpointer *) jobs, n, decoder);
+
+  GST_DEBUG ("pre-parsed %u slices", n);
+  for (i = 0; i < n; i++) {
+    jobs[i]->pi->nalu.data = NULL;
+    g_queue_push_tail (&priv->preparsed_slices, jobs[i]);
+  }
+  for (; i < num_jobs; i++)
+    slice_parse_job_free (jobs[i]);
+  gst_adapter_unmap (adapter);
+  return;
+
+cleanup:
+  for (i = 0; i < num_jobs; i++)
+    slice_parse_job_free (jobs[i]);
 }
 
 static GstVaapiDecoderStatus
@@ -4375,6 +4725,8 @@ gst_vaapi_decoder_h264_parse (GstVaapiDecoder * base_decoder,
   guint32 start_code;
   gint ofs, ofs2;
   gboolean at_au_end = FALSE;
+  gboolean do_preparse = FALSE;
+  SliceParseJob *job;
 
   status = ensure_decoder (decoder);
   if (status != GST_VAAPI_DECODER_STATUS_SUCCESS)
@@ -4454,6 +4806,24 @@ gst_vaapi_decoder_h264_parse (GstVaapiDecoder * base_decoder,
 
   unit->size = buf_size;
 
+  job = pop_preparsed_slice (decoder, buf, buf_size);
+  if (job) {
+    pi = job->pi;
+    job->pi = NULL;
+    status = job->status;
+    slice_parse_job_free (job);
+
+    gst_vaapi_decoder_unit_set_parsed_info (unit,
+        pi, (GDestroyNotify) gst_vaapi_mini_object_unref);
+
+    priv->parser_state &= (GST_H264_VIDEO_STATE_GOT_SPS |
+        GST_H264_VIDEO_STATE_GOT_PPS);
+    if (status != GST_VAAPI_DECODER_STATUS_SUCCESS)
+      goto exit;
+    update_slice_parser_state (decoder, pi);
+    goto set_flags;
+  }
+
   pi = gst_vaapi_parser_info_h264_new ();
   if (!pi)
     return GST_VAAPI_DECODER_STATUS_ERROR_ALLOCATION_FAILED;
@@ -4471,6 +4841,9 @@ gst_vaapi_decoder_h264_parse (GstVaapiDecoder * base_decoder,
   if (status != GST_VAAPI_DECODER_STATUS_SUCCESS)
     goto exit;
 
+  if (reuse_param_set (decoder, unit))
+    goto set_flags;
+
   switch (pi->nalu.type) {
     case GST_H264_NAL_SPS:
       status = parse_sps (decoder, unit);
@@ -4501,6 +4874,12 @@ gst_vaapi_decoder_h264_parse (GstVaapiDecoder * base_decoder,
   if (status != GST_VAAPI_DECODER_STATUS_SUCCESS)
     goto exit;
 
+  if ((pi->nalu.type == GST_H264_NAL_SLICE ||
+          pi->nalu.type == GST_H264_NAL_SLICE_IDR) &&
+      decoder->parent_instance.parse_threads > 1)
+    do_preparse = TRUE;
+
+set_flags:
   flags = 0;
   if (at_au_end) {
     flags |= GST_VAAPI_DECODER_UNIT_FLAG_FRAME_END |
@@ -4573,6 +4952,9 @@ gst_vaapi_decoder_h264_parse (GstVaapiDecoder * base_decoder,
   pi->state = priv->parser_state;
   pi->flags = flags;
   gst_vaapi_parser_info_h264_replace (&priv->prev_pi, pi);
+
+  if (do_preparse)
+    preparse_slices (decoder, adapter, buf_size, size);
   return GST_VAAPI_DECODER_STATUS_SUCCESS;
 
 exit:
@@ -4622,6 +5004,9 @@ gst_vaapi_decoder_h264_flush (GstVaapiDecoder * base_decoder)
       GST_VAAPI_DECODER_H264_CAST (base_decoder);
 
   dpb_flush (decoder, NULL);
+
+  /* The pre-parsed slices refer to the input data being discarded */
+  clear_preparsed_slices (decoder);
   return GST_VAAPI_DECODER_STATUS_SUCCESS;
 }
 
@@ -4677,6 +5062,44 @@ gst_vaapi_decoder_h264_set_alignment (GstVaapiDecoderH264 * decoder,
   decoder->priv.stream_alignment = alignment;
 }
 
+/**
+ * gst_vaapi_decoder_h264_set_low_latency:
+ * @decoder: a #GstVaapiDecoderH264
+ * @low_latency: %TRUE to output frames as early as possible
+ *
+ * Makes the @decoder output the frames of Baseline profile streams as
+ * soon as they are decoded, assuming that they are not reordered, which
+ * live sources practically never do. Otherwise, frames are only output
+ * early if the VUI bitstream restrictions, or a pic_order_cnt_type of
+ * 2, guarantee that no later frame precedes them in output order.
+ *
+ * This can be changed while decoding, in which case it applies from
+ * the next decoded picture on. It shall not be called concurrently
+ * with the decoding functions.
+ */
+void
+gst_vaapi_decoder_h264_set_low_latency (GstVaapiDecoderH264 * decoder,
+    gboolean low_latency)
+{
+  GstVaapiDecoderH264Private *priv;
+
+  g_return_if_fail (decoder != NULL);
+
+  priv = &decoder->priv;
+  if (priv->low_latency == !!low_latency)
+    return;
+  priv->low_latency = !!low_latency;
+
+  /* Repeated SPS do not set up the context again, so update the number
+     of frames to reorder for the one in use right now */
+  if (priv->context_sps) {
+    GstH264SPS *const sps = &priv->context_sps->data.sps;
+
+    priv->max_num_reorder_frames = get_max_num_reorder_frames (decoder, sps,
+        get_max_dec_frame_buffering (sps));
+  }
+}
+
 /**
  * gst_vaapi_decoder_h264_new:
  * @display: a #GstVaapiDisplay
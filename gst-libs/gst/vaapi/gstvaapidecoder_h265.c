@@ -33,10 +33,13 @@
 #include "gstvaapicompat.h"
 #include "gstvaapidecoder_h265.h"
 #include "gstvaapidecoder_objects.h"
+#include "gstvaapidecoder_paramsets.h"
 #include "gstvaapidecoder_priv.h"
+#include "gstvaapidecoder_refs.h"
 #include "gstvaapidisplay_priv.h"
 #include "gstvaapiobject_priv.h"
 #include "gstvaapiutils_h265_priv.h"
+#include "gstvaapiutils_startcode.h"
 
 #define DEBUG 1
 #include "gstvaapidebug.h"
@@ -52,6 +55,7 @@ typedef struct _GstVaapiParserInfoH265 GstVaapiParserInfoH265;
 typedef struct _GstVaapiPictureH265 GstVaapiPictureH265;
 
 static gboolean nal_is_slice (guint8 nal_type);
+static void clear_preparsed_slices (GstVaapiDecoderH265 * decoder);
 
 /* ------------------------------------------------------------------------- */
 /* --- H.265 Parser Info                                                 --- */
@@ -90,11 +94,15 @@ struct _GstVaapiParserInfoH265
   } data;
   guint state;
   guint flags;                  // Same as decoder unit flags (persistent)
+  GstVaapiParserInfoH265 *param_set;    // Byte-identical VPS, SPS or PPS reused
 };
 
 static void
 gst_vaapi_parser_info_h265_finalize (GstVaapiParserInfoH265 * pi)
 {
+  gst_vaapi_mini_object_replace ((GstVaapiMiniObject **) & pi->param_set,
+      NULL);
+
   if (nal_is_slice (pi->nalu.type))
     gst_h265_slice_hdr_free (&pi->data.slice_hdr);
   else {
@@ -117,9 +125,11 @@ gst_vaapi_parser_info_h265_finalize (GstVaapiParserInfoH265 * pi)
 static inline const GstVaapiMiniObjectClass *
 gst_vaapi_parser_info_h265_class (void)
 {
+  static GstVaapiMiniObjectCache GstVaapiParserInfoH265Cache;
   static const GstVaapiMiniObjectClass GstVaapiParserInfoH265Class = {
     .size = sizeof (GstVaapiParserInfoH265),
-    .finalize = (GDestroyNotify) gst_vaapi_parser_info_h265_finalize
+    .finalize = (GDestroyNotify) gst_vaapi_parser_info_h265_finalize,
+    .cache = &GstVaapiParserInfoH265Cache
   };
   return &GstVaapiParserInfoH265Class;
 }
@@ -231,7 +241,8 @@ struct _GstVaapiPictureH265
   guint IntraPicFlag:1;         // Intra pic (only Intra slices)
 };
 
-GST_VAAPI_CODEC_DEFINE_TYPE (GstVaapiPictureH265, gst_vaapi_picture_h265);
+GST_VAAPI_CODEC_DEFINE_TYPE_FULL (GstVaapiPictureH265, gst_vaapi_picture_h265,
+    gst_vaapi_picture_reset, gst_vaapi_picture_release);
 
 void
 gst_vaapi_picture_h265_destroy (GstVaapiPictureH265 * picture)
@@ -298,9 +309,11 @@ gst_vaapi_frame_store_new (GstVaapiPictureH265 * picture)
 {
   GstVaapiFrameStore *fs;
 
+  static GstVaapiMiniObjectCache GstVaapiFrameStoreCache;
   static const GstVaapiMiniObjectClass GstVaapiFrameStoreClass = {
     sizeof (GstVaapiFrameStore),
-    gst_vaapi_frame_store_finalize
+    gst_vaapi_frame_store_finalize,
+    &GstVaapiFrameStoreCache
   };
 
   fs = (GstVaapiFrameStore *)
@@ -365,11 +378,17 @@ struct _GstVaapiDecoderH265Private
   GstVaapiParserInfoH265 *active_sps;
   GstVaapiParserInfoH265 *pps[GST_H265_MAX_PPS_COUNT];
   GstVaapiParserInfoH265 *active_pps;
+  GstVaapiParserInfoH265 *context_sps;  // SPS the VA context was set up for
+  GstVaapiParamSetCache vps_cache;
+  GstVaapiParamSetCache sps_cache;
+  GstVaapiParamSetCache pps_cache;
+  guint64 num_skipped_contexts;
   GstVaapiParserInfoH265 *prev_pi;
   GstVaapiParserInfoH265 *prev_slice_pi;
   GstVaapiParserInfoH265 *prev_independent_slice_pi;
   GstVaapiFrameStore **dpb;
   guint dpb_count;
+  GstVaapiRefIndex dpb_by_poc;
   guint dpb_size;
   guint dpb_size_max;
   GstVaapiProfile profile;
@@ -413,6 +432,7 @@ struct _GstVaapiDecoderH265Private
   guint NumPocLtCurr;
   guint NumPocLtFoll;
   guint NumPocTotalCurr;
+  GQueue preparsed_slices;      // slices parsed ahead (SliceParseJob)
   guint is_opened:1;
   guint is_hvcC:1;
   guint has_context:1;
@@ -683,22 +703,38 @@ dpb_get_picture (GstVaapiDecoderH265 * decoder, gint poc, gboolean match_lsb)
   return NULL;
 }
 
-/* Get the dpb picture having the specifed poc and shor/long ref flags */
-static GstVaapiPictureH265 *
-dpb_get_ref_picture (GstVaapiDecoderH265 * decoder, gint poc, gboolean is_short)
+/* Sorts the dpb pictures by poc, keeping the dpb order for equal pocs */
+static void
+dpb_init_poc_index (GstVaapiDecoderH265 * decoder)
 {
   GstVaapiDecoderH265Private *const priv = &decoder->priv;
   guint i;
 
+  gst_vaapi_ref_index_clear (&priv->dpb_by_poc);
   for (i = 0; i < priv->dpb_count; i++) {
     GstVaapiPictureH265 *const picture = priv->dpb[i]->buffer;
 
-    if (picture && picture->poc == poc) {
-      if (is_short && GST_VAAPI_PICTURE_IS_SHORT_TERM_REFERENCE (picture))
-        return picture;
-      else if (GST_VAAPI_PICTURE_IS_LONG_TERM_REFERENCE (picture))
-        return picture;
-    }
+    if (picture)
+      gst_vaapi_ref_index_insert (&priv->dpb_by_poc, picture->poc, picture);
+  }
+}
+
+/* Get the dpb picture having the specifed poc and shor/long ref flags,
+   looked up in the index built by dpb_init_poc_index() */
+static GstVaapiPictureH265 *
+dpb_get_ref_picture (GstVaapiDecoderH265 * decoder, gint poc, gboolean is_short)
+{
+  GstVaapiRefIndex *const index = &decoder->priv.dpb_by_poc;
+  guint i;
+
+  for (i = gst_vaapi_ref_index_lower_bound (index, poc);
+      i < index->count && index->entries[i].key == poc; i++) {
+    GstVaapiPictureH265 *const picture = index->entries[i].picture;
+
+    if (is_short && GST_VAAPI_PICTURE_IS_SHORT_TERM_REFERENCE (picture))
+      return picture;
+    else if (GST_VAAPI_PICTURE_IS_LONG_TERM_REFERENCE (picture))
+      return picture;
   }
 
   return NULL;
@@ -950,9 +986,22 @@ gst_vaapi_decoder_h265_close (GstVaapiDecoderH265 * decoder)
   gst_vaapi_parser_info_h265_replace (&priv->prev_slice_pi, NULL);
   gst_vaapi_parser_info_h265_replace (&priv->prev_independent_slice_pi, NULL);
   gst_vaapi_parser_info_h265_replace (&priv->prev_pi, NULL);
+  gst_vaapi_parser_info_h265_replace (&priv->context_sps, NULL);
+  clear_preparsed_slices (decoder);
 
   dpb_clear (decoder, TRUE);
 
+  if (priv->vps_cache.num_hits + priv->sps_cache.num_hits +
+      priv->pps_cache.num_hits > 0)
+    GST_INFO ("skipped parsing %" G_GUINT64_FORMAT " VPS, %"
+        G_GUINT64_FORMAT " SPS and %" G_GUINT64_FORMAT " PPS, and %"
+        G_GUINT64_FORMAT " context updates", priv->vps_cache.num_hits,
+        priv->sps_cache.num_hits, priv->pps_cache.num_hits,
+        priv->num_skipped_contexts);
+
+  /* The cached parameter sets only match the state of the parser */
+  gst_vaapi_param_set_cache_clear (&priv->vps_cache);
+
   if (priv->parser) {
     gst_h265_parser_free (priv->parser);
     priv->parser = NULL;
@@ -992,6 +1041,10 @@ gst_vaapi_decoder_h265_destroy (GstVaapiDecoder * base_decoder)
   for (i = 0; i < G_N_ELEMENTS (priv->vps); i++)
     gst_vaapi_parser_info_h265_replace (&priv->vps[i], NULL);
   gst_vaapi_parser_info_h265_replace (&priv->active_vps, NULL);
+
+  gst_vaapi_param_set_cache_finalize (&priv->vps_cache);
+  gst_vaapi_param_set_cache_finalize (&priv->sps_cache);
+  gst_vaapi_param_set_cache_finalize (&priv->pps_cache);
 }
 
 static gboolean
@@ -1007,6 +1060,15 @@ gst_vaapi_decoder_h265_create (GstVaapiDecoder * base_decoder)
   priv->progressive_sequence = TRUE;
   priv->new_bitstream = TRUE;
   priv->prev_nal_is_eos = FALSE;
+  /* The parser also remembers the last VPS and SPS it parsed, so only
+     those can be reused without parsing. The SPS are parsed against
+     the VPS, and the PPS against the SPS, they refer to */
+  gst_vaapi_param_set_cache_init (&priv->vps_cache, GST_H265_MAX_VPS_COUNT,
+      TRUE, &priv->sps_cache);
+  gst_vaapi_param_set_cache_init (&priv->sps_cache, GST_H265_MAX_SPS_COUNT,
+      TRUE, &priv->pps_cache);
+  gst_vaapi_param_set_cache_init (&priv->pps_cache, GST_H265_MAX_PPS_COUNT,
+      FALSE, NULL);
   return TRUE;
 }
 
@@ -1340,6 +1402,9 @@ parse_vps (GstVaapiDecoderH265 * decoder, GstVaapiDecoderUnit * unit)
   if (result != GST_H265_PARSER_OK)
     return get_status (result);
 
+  gst_vaapi_param_set_cache_insert (&priv->vps_cache, vps->id,
+      pi->nalu.data + pi->nalu.offset, pi->nalu.size, pi);
+
   priv->parser_state |= GST_H265_VIDEO_STATE_GOT_VPS;
   return GST_VAAPI_DECODER_STATUS_SUCCESS;
 }
@@ -1361,6 +1426,9 @@ parse_sps (GstVaapiDecoderH265 * decoder, GstVaapiDecoderUnit * unit)
   if (result != GST_H265_PARSER_OK)
     return get_status (result);
 
+  gst_vaapi_param_set_cache_insert (&priv->sps_cache, sps->id,
+      pi->nalu.data + pi->nalu.offset, pi->nalu.size, pi);
+
   priv->parser_state |= GST_H265_VIDEO_STATE_GOT_SPS;
   return GST_VAAPI_DECODER_STATUS_SUCCESS;
 }
@@ -1386,10 +1454,71 @@ parse_pps (GstVaapiDecoderH265 * decoder, GstVaapiDecoderUnit * unit)
   if (result != GST_H265_PARSER_OK)
     return get_status (result);
 
+  gst_vaapi_param_set_cache_insert (&priv->pps_cache, pps->id,
+      pi->nalu.data + pi->nalu.offset, pi->nalu.size, pi);
+
   priv->parser_state |= GST_H265_VIDEO_STATE_GOT_PPS;
   return GST_VAAPI_DECODER_STATUS_SUCCESS;
 }
 
+/* Links the parser info of @unit to the one of a byte-identical VPS,
+   SPS or PPS parsed earlier, if any, so that it is not parsed again and
+   decoding it keeps the same parser info. The parser state is updated
+   as parse_vps(), parse_sps() and parse_pps() would have */
+static gboolean
+reuse_param_set (GstVaapiDecoderH265 * decoder, GstVaapiDecoderUnit * unit)
+{
+  GstVaapiDecoderH265Private *const priv = &decoder->priv;
+  GstVaapiParserInfoH265 *const pi = unit->parsed_info;
+  const guint8 *const data = pi->nalu.data + pi->nalu.offset;
+  GstVaapiParserInfoH265 *cached_pi;
+
+  switch (pi->nalu.type) {
+    case GST_H265_NAL_VPS:
+      cached_pi = gst_vaapi_param_set_cache_lookup (&priv->vps_cache,
+          data, pi->nalu.size);
+      if (!cached_pi)
+        return FALSE;
+      GST_DEBUG ("reuse VPS (%" G_GUINT64_FORMAT " hits)",
+          priv->vps_cache.num_hits);
+      priv->parser_state = GST_H265_VIDEO_STATE_GOT_VPS;
+      break;
+    case GST_H265_NAL_SPS:
+      cached_pi = gst_vaapi_param_set_cache_lookup (&priv->sps_cache,
+          data, pi->nalu.size);
+      if (!cached_pi)
+        return FALSE;
+      GST_DEBUG ("reuse SPS (%" G_GUINT64_FORMAT " hits)",
+          priv->sps_cache.num_hits);
+      priv->parser_state = GST_H265_VIDEO_STATE_GOT_SPS;
+      break;
+    case GST_H265_NAL_PPS:
+      cached_pi = gst_vaapi_param_set_cache_lookup (&priv->pps_cache,
+          data, pi->nalu.size);
+      if (!cached_pi)
+        return FALSE;
+      GST_DEBUG ("reuse PPS (%" G_GUINT64_FORMAT " hits)",
+          priv->pps_cache.num_hits);
+      priv->parser_state &= GST_H265_VIDEO_STATE_GOT_SPS;
+      priv->parser_state |= GST_H265_VIDEO_STATE_GOT_PPS;
+      break;
+    default:
+      return FALSE;
+  }
+
+  gst_vaapi_parser_info_h265_replace (&pi->param_set, cached_pi);
+  return TRUE;
+}
+
+/* Returns the parser info holding the VPS, SPS or PPS of @unit */
+static inline GstVaapiParserInfoH265 *
+get_param_set_info (GstVaapiDecoderUnit * unit)
+{
+  GstVaapiParserInfoH265 *const pi = unit->parsed_info;
+
+  return pi->param_set ? pi->param_set : pi;
+}
+
 static GstVaapiDecoderStatus
 parse_sei (GstVaapiDecoderH265 * decoder, GstVaapiDecoderUnit * unit)
 {
@@ -1408,25 +1537,38 @@ parse_sei (GstVaapiDecoderH265 * decoder, GstVaapiDecoderUnit * unit)
   return GST_VAAPI_DECODER_STATUS_SUCCESS;
 }
 
+/* Parses the slice segment header, including the pred_weight_table()
+   syntax elements. This only reads the active VPS, SPS and PPS from
+   the parser, so this can run on the parser threads */
 static GstVaapiDecoderStatus
-parse_slice (GstVaapiDecoderH265 * decoder, GstVaapiDecoderUnit * unit)
+parse_slice_header (GstVaapiDecoderH265 * decoder, GstVaapiParserInfoH265 * pi)
 {
   GstVaapiDecoderH265Private *const priv = &decoder->priv;
-  GstVaapiParserInfoH265 *const pi = unit->parsed_info;
   GstH265SliceHdr *const slice_hdr = &pi->data.slice_hdr;
   GstH265ParserResult result;
 
-  GST_DEBUG ("parse slice");
-  priv->parser_state &= (GST_H265_VIDEO_STATE_GOT_SPS |
-      GST_H265_VIDEO_STATE_GOT_PPS);
-
-  slice_hdr->short_term_ref_pic_set_idx = 0;
-
   memset (slice_hdr, 0, sizeof (GstH265SliceHdr));
 
   result = gst_h265_parser_parse_slice_hdr (priv->parser, &pi->nalu, slice_hdr);
   if (result != GST_H265_PARSER_OK)
     return get_status (result);
+  return GST_VAAPI_DECODER_STATUS_SUCCESS;
+}
+
+static GstVaapiDecoderStatus
+parse_slice (GstVaapiDecoderH265 * decoder, GstVaapiDecoderUnit * unit)
+{
+  GstVaapiDecoderH265Private *const priv = &decoder->priv;
+  GstVaapiParserInfoH265 *const pi = unit->parsed_info;
+  GstVaapiDecoderStatus status;
+
+  GST_DEBUG ("parse slice");
+  priv->parser_state &= (GST_H265_VIDEO_STATE_GOT_SPS |
+      GST_H265_VIDEO_STATE_GOT_PPS);
+
+  status = parse_slice_header (decoder, pi);
+  if (status != GST_VAAPI_DECODER_STATUS_SUCCESS)
+    return status;
 
   priv->parser_state |= GST_H265_VIDEO_STATE_GOT_SLICE;
   return GST_VAAPI_DECODER_STATUS_SUCCESS;
@@ -1436,7 +1578,7 @@ static GstVaapiDecoderStatus
 decode_vps (GstVaapiDecoderH265 * decoder, GstVaapiDecoderUnit * unit)
 {
   GstVaapiDecoderH265Private *const priv = &decoder->priv;
-  GstVaapiParserInfoH265 *const pi = unit->parsed_info;
+  GstVaapiParserInfoH265 *const pi = get_param_set_info (unit);
   GstH265VPS *const vps = &pi->data.vps;
 
   GST_DEBUG ("decode VPS");
@@ -1450,7 +1592,7 @@ static GstVaapiDecoderStatus
 decode_sps (GstVaapiDecoderH265 * decoder, GstVaapiDecoderUnit * unit)
 {
   GstVaapiDecoderH265Private *const priv = &decoder->priv;
-  GstVaapiParserInfoH265 *const pi = unit->parsed_info;
+  GstVaapiParserInfoH265 *const pi = get_param_set_info (unit);
   GstH265SPS *const sps = &pi->data.sps;
   guint high_precision_offsets_enabled_flag = 0, bitdepthC = 0;
 
@@ -1477,7 +1619,7 @@ static GstVaapiDecoderStatus
 decode_pps (GstVaapiDecoderH265 * decoder, GstVaapiDecoderUnit * unit)
 {
   GstVaapiDecoderH265Private *const priv = &decoder->priv;
-  GstVaapiParserInfoH265 *const pi = unit->parsed_info;
+  GstVaapiParserInfoH265 *const pi = get_param_set_info (unit);
   GstH265PPS *const pps = &pi->data.pps;
 
   GST_DEBUG ("decode PPS");
@@ -2030,6 +2172,7 @@ derive_and_mark_rps (GstVaapiDecoderH265 * decoder,
   }
 
   /* (8-7) */
+  dpb_init_poc_index (decoder);
   for (i = 0; i < priv->NumPocStCurrBefore; i++) {
     dpb_pic = dpb_get_ref_picture (decoder, priv->PocStCurrBefore[i], TRUE);
     if (dpb_pic) {
@@ -2221,9 +2364,15 @@ decode_picture (GstVaapiDecoderH265 * decoder, GstVaapiDecoderUnit * unit)
   g_return_val_if_fail (pps != NULL, GST_VAAPI_DECODER_STATUS_ERROR_UNKNOWN);
   g_return_val_if_fail (sps != NULL, GST_VAAPI_DECODER_STATUS_ERROR_UNKNOWN);
 
-  status = ensure_context (decoder, sps);
-  if (status != GST_VAAPI_DECODER_STATUS_SUCCESS)
-    return status;
+  /* Repeated SPS reuse the parser info of the active one, and then
+     there is nothing to reconfigure */
+  if (!priv->has_context || priv->context_sps != priv->active_sps) {
+    status = ensure_context (decoder, sps);
+    if (status != GST_VAAPI_DECODER_STATUS_SUCCESS)
+      return status;
+    gst_vaapi_parser_info_h265_replace (&priv->context_sps, priv->active_sps);
+  } else
+    priv->num_skipped_contexts++;
 
   priv->decoder_state = 0;
 
@@ -2567,8 +2716,196 @@ decode_slice (GstVaapiDecoderH265 * decoder, GstVaapiDecoderUnit * unit)
 static inline gint
 scan_for_start_code (GstAdapter * adapter, guint ofs, guint size, guint32 * scp)
 {
-  return (gint) gst_adapter_masked_scan_uint32_peek (adapter,
-      0xffffff00, 0x00000100, ofs, size, scp);
+  return gst_vaapi_adapter_scan_for_start_code (adapter, ofs, size, scp);
+}
+
+/* ------------------------------------------------------------------------- */
+/* --- Parallel slice parsing                                            --- */
+/* ------------------------------------------------------------------------- */
+
+/* Maximum number of slices parsed ahead at once */
+#define MAX_PREPARSED_SLICES 64
+
+/* Number of leading bytes used to check a pre-parsed slice matches */
+#define PREPARSED_SLICE_HEAD_SIZE 16
+
+typedef struct
+{
+  GstVaapiParserInfoH265 *pi;
+  guint offset;
+  guint size;
+  guint8 head[PREPARSED_SLICE_HEAD_SIZE];
+  GstVaapiDecoderStatus status;
+} SliceParseJob;
+
+static void
+slice_parse_job_free (SliceParseJob * job)
+{
+  gst_vaapi_parser_info_h265_replace (&job->pi, NULL);
+  g_slice_free (SliceParseJob, job);
+}
+
+static void
+clear_preparsed_slices (GstVaapiDecoderH265 * decoder)
+{
+  GstVaapiDecoderH265Private *const priv = &decoder->priv;
+  SliceParseJob *job;
+
+  while ((job = g_queue_pop_head (&priv->preparsed_slices)))
+    slice_parse_job_free (job);
+}
+
+static void
+slice_parse_job_run (gpointer data, gpointer user_data)
+{
+  SliceParseJob *const job = data;
+
+  job->status = parse_slice_header (user_data, job->pi);
+}
+
+/* Returns the pre-parsed slice info matching the NAL unit in buf[], if
+   any. Any mismatch discards the whole batch of pre-parsed slices */
+static SliceParseJob *
+pop_preparsed_slice (GstVaapiDecoderH265 * decoder, const guchar * buf,
+    guint buf_size)
+{
+  GstVaapiDecoderH265Private *const priv = &decoder->priv;
+  SliceParseJob *job;
+
+  job = g_queue_peek_head (&priv->preparsed_slices);
+  if (!job)
+    return NULL;
+
+  if (job->size != buf_size ||
+      memcmp (job->head, buf, MIN (buf_size, PREPARSED_SLICE_HEAD_SIZE))) {
+    GST_DEBUG ("discard pre-parsed slices");
+    clear_preparsed_slices (decoder);
+    return NULL;
+  }
+  return g_queue_pop_head (&priv->preparsed_slices);
+}
+
+/* Checks whether the first NAL unit header byte denotes a slice
+   segment. Any other NAL unit type may update the parser state and
+   thus terminates the batch */
+static inline gboolean
+is_preparsable_slice (guint8 nal_header)
+{
+  const guint8 nal_type = (nal_header >> 1) & 0x3f;
+
+  /* Skip reserved VCL NAL unit types, they are not parsed */
+  return nal_is_slice (nal_type) && (nal_type <= GST_H265_NAL_SLICE_RASL_R ||
+      nal_type >= GST_H265_NAL_SLICE_BLA_W_LP);
+}
+
+/* Splits the slice NAL units that follow the one at the start of the
+   adapter, and parses their headers in parallel. They will be
+   committed in order, as they get parsed, by subsequent calls to
+   gst_vaapi_decoder_h265_parse() */
+static void
+preparse_slices (GstVaapiDecoderH265 * decoder, GstAdapter * adapter,
+    guint ofs, guint size)
+{
+  GstVaapiDecoderH265Private *const priv = &decoder->priv;
+  SliceParseJob *jobs[MAX_PREPARSED_SLICES];
+  GstH265ParserResult result;
+  const guchar *buf;
+  guint8 header[4];
+  guint i, n, nalu_size, num_jobs = 0;
+  gint next_ofs;
+
+  if (priv->stream_alignment == GST_VAAPI_STREAM_ALIGN_H265_NALU)
+    return;
+
+  /* Split NAL units, this only needs to peek the adapter */
+  while (num_jobs < MAX_PREPARSED_SLICES && ofs < size) {
+    if (priv->is_hvcC) {
+      if (size - ofs < priv->nal_length_size + 2)
+        break;
+      gst_adapter_copy (adapter, header, ofs, priv->nal_length_size);
+      for (i = 0, nalu_size = 0; i < priv->nal_length_size; i++)
+        nalu_size = (nalu_size << 8) | header[i];
+      nalu_size += priv->nal_length_size;
+      if (size - ofs < nalu_size)
+        break;
+      gst_adapter_copy (adapter, header, ofs + priv->nal_length_size, 1);
+      if (!is_preparsable_slice (header[0]))
+        break;
+    } else {
+      if (size - ofs < 5)
+        break;
+      gst_adapter_copy (adapter, header, ofs, 4);
+      if (header[0] != 0 || header[1] != 0 || header[2] != 1)
+        break;
+      if (!is_preparsable_slice (header[3]))
+        break;
+      next_ofs = size - ofs < 8 ? -1 :
+          scan_for_start_code (adapter, ofs + 4, size - ofs - 4, NULL);
+      if (next_ofs < 0) {
+        // The last NAL unit is only complete if stream buffers are
+        // aligned on access unit boundaries
+        if (priv->stream_alignment != GST_VAAPI_STREAM_ALIGN_H265_AU)
+          break;
+        next_ofs = size;
+      }
+      nalu_size = next_ofs - ofs;
+    }
+
+    jobs[num_jobs] = g_slice_new0 (SliceParseJob);
+    jobs[num_jobs]->offset = ofs;
+    jobs[num_jobs]->size = nalu_size;
+    num_jobs++;
+    ofs += nalu_size;
+  }
+  if (num_jobs < 2)
+    goto cleanup;
+
+  buf = gst_adapter_map (adapter, ofs);
+  if (!buf)
+    goto cleanup;
+
+  /* Identify NAL units in order, then parse slice headers in parallel */
+  for (i = 0, n = 0; i < num_jobs; i++, n++) {
+    SliceParseJob *const job = jobs[i];
+
+    job->pi = gst_vaapi_parser_info_h265_new ();
+    if (!job->pi)
+      break;
+
+    if (priv->is_hvcC)
+      result = gst_h265_parser_identify_nalu_hevc (priv->parser,
+          buf + job->offset, 0, job->size, priv->nal_length_size,
+          &job->pi->nalu);
+    else
+      result = gst_h265_parser_identify_nalu_unchecked (priv->parser,
+          buf + job->offset, 0, job->size, &job->pi->nalu);
+    if (result != GST_H265_PARSER_OK)
+      break;
+
+    memcpy (job->head, buf + job->offset,
+        MIN (job->size, PREPARSED_SLICE_HEAD_SIZE));
+  }
+  if (n < 2) {
+    gst_adapter_unmap (adapter);
+    goto cleanup;
+  }
+
+  gst_vaapi_decoder_run_jobs (GST_VAAPI_DECODER_CAST (decoder),
+      slice_parse_job_run, (gpointer *) jobs, n, decoder);
+
+  GST_DEBUG ("pre-parsed %u slices", n);
+  for (i = 0; i < n; i++) {
+    jobs[i]->pi->nalu.data = NULL;
+    g_queue_push_tail (&priv->preparsed_slices, jobs[i]);
+  }
+  for (; i < num_jobs; i++)
+    slice_parse_job_free (jobs[i]);
+  gst_adapter_unmap (adapter);
+  return;
+
+cleanup:
+  for (i = 0; i < num_jobs; i++)
+    slice_parse_job_free (jobs[i]);
 }
 
 static GstVaapiDecoderStatus
@@ -2770,6 +3107,8 @@ gst_vaapi_decoder_h265_parse (GstVaapiDecoder * base_decoder,
   guint32 start_code;
   gint ofs, ofs2;
   gboolean at_au_end = FALSE;
+  gboolean do_preparse = FALSE;
+  SliceParseJob *job;
 
   status = ensure_decoder (decoder);
   if (status != GST_VAAPI_DECODER_STATUS_SUCCESS)
@@ -2840,6 +3179,25 @@ gst_vaapi_decoder_h265_parse (GstVaapiDecoder * base_decoder,
   if (!buf)
     return GST_VAAPI_DECODER_STATUS_ERROR_NO_DATA;
   unit->size = buf_size;
+
+  job = pop_preparsed_slice (decoder, buf, buf_size);
+  if (job) {
+    pi = job->pi;
+    job->pi = NULL;
+    status = job->status;
+    slice_parse_job_free (job);
+
+    gst_vaapi_decoder_unit_set_parsed_info (unit,
+        pi, (GDestroyNotify) gst_vaapi_mini_object_unref);
+
+    priv->parser_state &= (GST_H265_VIDEO_STATE_GOT_SPS |
+        GST_H265_VIDEO_STATE_GOT_PPS);
+    if (status != GST_VAAPI_DECODER_STATUS_SUCCESS)
+      goto exit;
+    priv->parser_state |= GST_H265_VIDEO_STATE_GOT_SLICE;
+    goto set_flags;
+  }
+
   pi = gst_vaapi_parser_info_h265_new ();
   if (!pi)
     return GST_VAAPI_DECODER_STATUS_ERROR_ALLOCATION_FAILED;
@@ -2854,6 +3212,8 @@ gst_vaapi_decoder_h265_parse (GstVaapiDecoder * base_decoder,
   status = get_status (result);
   if (status != GST_VAAPI_DECODER_STATUS_SUCCESS)
     goto exit;
+  if (reuse_param_set (decoder, unit))
+    goto set_flags;
   switch (pi->nalu.type) {
     case GST_H265_NAL_VPS:
       status = parse_vps (decoder, unit);
@@ -2892,6 +3252,11 @@ gst_vaapi_decoder_h265_parse (GstVaapiDecoder * base_decoder,
   }
   if (status != GST_VAAPI_DECODER_STATUS_SUCCESS)
     goto exit;
+
+  if (nal_is_slice (pi->nalu.type) && decoder->parent_instance.parse_threads > 1)
+    do_preparse = TRUE;
+
+set_flags:
   flags = 0;
   if (at_au_end) {
     flags |= GST_VAAPI_DECODER_UNIT_FLAG_FRAME_END |
@@ -2965,6 +3330,9 @@ gst_vaapi_decoder_h265_parse (GstVaapiDecoder * base_decoder,
   pi->state = priv->parser_state;
   pi->flags = flags;
   gst_vaapi_parser_info_h265_replace (&priv->prev_pi, pi);
+
+  if (do_preparse)
+    preparse_slices (decoder, adapter, buf_size, size);
   return GST_VAAPI_DECODER_STATUS_SUCCESS;
 
 exit:
@@ -3012,6 +3380,9 @@ gst_vaapi_decoder_h265_flush (GstVaapiDecoder * base_decoder)
       GST_VAAPI_DECODER_H265_CAST (base_decoder);
 
   dpb_flush (decoder);
+
+  /* The pre-parsed slices refer to the input data being discarded */
+  clear_preparsed_slices (decoder);
   return GST_VAAPI_DECODER_STATUS_SUCCESS;
 }
 
@@ -35,6 +35,7 @@
 #include "gstvaapidecoder_priv.h"
 #include "gstvaapidisplay_priv.h"
 #include "gstvaapiobject_priv.h"
+#include "gstvaapiutils_startcode.h"
 
 #define DEBUG 1
 #include "gstvaapidebug.h"
@@ -179,9 +180,11 @@ struct _GstVaapiParserInfoMpeg2
 static inline const GstVaapiMiniObjectClass *
 gst_vaapi_parser_info_mpeg2_class (void)
 {
+  static GstVaapiMiniObjectCache GstVaapiParserInfoMpeg2Cache;
   static const GstVaapiMiniObjectClass GstVaapiParserInfoMpeg2Class = {
     sizeof (GstVaapiParserInfoMpeg2),
-    NULL
+    NULL,
+    &GstVaapiParserInfoMpeg2Cache
   };
   return &GstVaapiParserInfoMpeg2Class;
 }
@@ -1167,7 +1170,7 @@ decode_slice (GstVaapiDecoderMpeg2 * decoder, GstVaapiDecoderUnit * unit)
 
   GST_DEBUG ("slice %d (%u bytes)", slice_hdr->mb_row, unit->size);
 
-  slice = GST_VAAPI_SLICE_NEW (MPEG2, decoder,
+  slice = GST_VAAPI_SLICE_NEW_FOR_PICTURE (MPEG2, picture,
       (map_info.data + unit->offset), unit->size);
   gst_buffer_unmap (buffer, &map_info);
   if (!slice) {
@@ -1192,25 +1195,11 @@ static inline gint
 scan_for_start_code (const guchar * buf, guint buf_size,
     GstMpegVideoPacketTypeCode * type_ptr)
 {
-  guint i = 0;
-
-  while (i <= (buf_size - 4)) {
-    if (buf[i + 2] > 1)
-      i += 3;
-    else if (buf[i + 1])
-      i += 2;
-    else if (buf[i] || buf[i + 2] != 1)
-      i++;
-    else
-      break;
-  }
+  const gint i = gst_vaapi_scan_for_start_code (buf, buf_size);
 
-  if (i <= (buf_size - 4)) {
-    if (type_ptr)
-      *type_ptr = buf[i + 3];
-    return i;
-  }
-  return -1;
+  if (i >= 0 && type_ptr)
+    *type_ptr = buf[i + 3];
+  return i;
 }
 
 static GstVaapiDecoderStatus
@@ -34,6 +34,7 @@
 #include "gstvaapidecoder_priv.h"
 #include "gstvaapidisplay_priv.h"
 #include "gstvaapiobject_priv.h"
+#include "gstvaapiutils_startcode.h"
 
 #define DEBUG 1
 #include "gstvaapidebug.h"
@@ -1040,17 +1041,32 @@ gst_vaapi_decoder_mpeg4_parse (GstVaapiDecoder * base_decoder,
   GstVaapiDecoderMpeg4 *const decoder =
       GST_VAAPI_DECODER_MPEG4_CAST (base_decoder);
   GstVaapiDecoderMpeg4Private *const priv = &decoder->priv;
+  GstVaapiParserState *const ps = GST_VAAPI_PARSER_STATE (base_decoder);
   GstVaapiDecoderStatus status;
   GstMpeg4Packet packet;
   GstMpeg4ParseResult result;
   const guchar *buf;
   guint size, buf_size, flags = 0;
+  gint ofs;
 
   status = ensure_decoder (decoder);
   if (status != GST_VAAPI_DECODER_STATUS_SUCCESS)
     return status;
 
   size = gst_adapter_available (adapter);
+
+  /* The end of the current packet was not found yet: don't run the
+     packet parser again until new data holds a start code */
+  if (!priv->is_svh && !at_eos && ps->input_offset2 > 4) {
+    ofs = ps->input_offset2 - 4;
+    if (size < ofs + 4 ||
+        gst_vaapi_adapter_scan_for_start_code (adapter, ofs, size - ofs,
+            NULL) < 0) {
+      ps->input_offset2 = size;
+      return GST_VAAPI_DECODER_STATUS_ERROR_NO_DATA;
+    }
+  }
+
   buf = gst_adapter_map (adapter, size);
   if (!buf)
     return GST_VAAPI_DECODER_STATUS_ERROR_NO_DATA;
@@ -1064,8 +1080,12 @@ gst_vaapi_decoder_mpeg4_parse (GstVaapiDecoder * base_decoder,
     packet.size = size - packet.offset;
   else if (result == GST_MPEG4_PARSER_ERROR)
     return GST_VAAPI_DECODER_STATUS_ERROR_BITSTREAM_PARSER;
-  else if (result != GST_MPEG4_PARSER_OK)
+  else if (result != GST_MPEG4_PARSER_OK) {
+    if (result == GST_MPEG4_PARSER_NO_PACKET_END)
+      ps->input_offset2 = size;
     return GST_VAAPI_DECODER_STATUS_ERROR_NO_DATA;
+  }
+  ps->input_offset2 = 0;
 
   buf_size = packet.size;
   gst_adapter_flush (adapter, packet.offset);
@@ -27,6 +27,7 @@
 #include <gst/vaapi/gstvaapicontext.h>
 #include "gstvaapidecoder_objects.h"
 #include "gstvaapidecoder_priv.h"
+#include "gstvaapicontext_buffers.h"
 #include "gstvaapisurfaceproxy_priv.h"
 #include "gstvaapicompat.h"
 #include "gstvaapiutils.h"
@@ -52,7 +53,21 @@ gst_video_codec_frame_clear (GstVideoCodecFrame ** frame_ptr)
 /* --- Pictures                                                          --- */
 /* ------------------------------------------------------------------------- */
 
-GST_VAAPI_CODEC_DEFINE_TYPE (GstVaapiPicture, gst_vaapi_picture);
+GST_VAAPI_CODEC_DEFINE_TYPE_FULL (GstVaapiPicture, gst_vaapi_picture,
+    gst_vaapi_picture_reset, gst_vaapi_picture_release);
+
+static void
+picture_set_default_crop_rect (GstVaapiPicture * picture)
+{
+  GstVideoCodecState *const codec_state =
+      GST_VAAPI_DECODER_CODEC_STATE (GET_DECODER (picture));
+
+  picture->has_crop_rect = TRUE;
+  picture->crop_rect.x = 0;
+  picture->crop_rect.y = 0;
+  picture->crop_rect.width = GST_VIDEO_INFO_WIDTH (&codec_state->info);
+  picture->crop_rect.height = GST_VIDEO_INFO_HEIGHT (&codec_state->info);
+}
 
 enum
 {
@@ -80,13 +95,71 @@ gst_vaapi_picture_destroy (GstVaapiPicture * picture)
   picture->surface_id = VA_INVALID_ID;
   picture->surface = NULL;
 
-  vaapi_destroy_buffer (GET_VA_DISPLAY (picture), &picture->param_id);
+  gst_vaapi_context_destroy_buffer (GET_CONTEXT (picture), &picture->param_id);
   picture->param = NULL;
 
+  gst_vaapi_context_destroy_buffer (GET_CONTEXT (picture),
+      &picture->slice_data_id);
+  gst_vaapi_context_destroy_buffer (GET_CONTEXT (picture),
+      &picture->slice_params_id);
+  if (picture->slice_data) {
+    g_byte_array_unref (picture->slice_data);
+    picture->slice_data = NULL;
+  }
+  if (picture->slice_params) {
+    g_byte_array_unref (picture->slice_params);
+    picture->slice_params = NULL;
+  }
+
   gst_video_codec_frame_clear (&picture->frame);
   gst_vaapi_picture_replace (&picture->parent_picture, NULL);
 }
 
+/* Destroys the picture, of any derived class, but keeps the array of
+   slices, and the staging arrays of coalesced slices, so that the
+   picture is reused with them */
+void
+gst_vaapi_picture_reset (GstVaapiPicture * picture)
+{
+  const GstVaapiMiniObjectClass *const klass =
+      GST_VAAPI_MINI_OBJECT_GET_CLASS (picture);
+  GPtrArray *const slices = picture->slices;
+  GByteArray *const slice_data = picture->slice_data;
+  GByteArray *const slice_params = picture->slice_params;
+
+  picture->slices = NULL;
+  if (slices)
+    g_ptr_array_set_size (slices, 0);
+  picture->slice_data = NULL;
+  if (slice_data)
+    g_byte_array_set_size (slice_data, 0);
+  picture->slice_params = NULL;
+
+  klass->finalize (picture);
+  memset ((guchar *) picture + sizeof (GstVaapiMiniObject), 0,
+      klass->size - sizeof (GstVaapiMiniObject));
+  picture->slices = slices;
+  picture->slice_data = slice_data;
+  picture->slice_params = slice_params;
+}
+
+void
+gst_vaapi_picture_release (GstVaapiPicture * picture)
+{
+  if (picture->slices) {
+    g_ptr_array_unref (picture->slices);
+    picture->slices = NULL;
+  }
+  if (picture->slice_data) {
+    g_byte_array_unref (picture->slice_data);
+    picture->slice_data = NULL;
+  }
+  if (picture->slice_params) {
+    g_byte_array_unref (picture->slice_params);
+    picture->slice_params = NULL;
+  }
+}
+
 gboolean
 gst_vaapi_picture_create (GstVaapiPicture * picture,
     const GstVaapiCodecObjectConstructorArgs * args)
@@ -94,6 +167,9 @@ gst_vaapi_picture_create (GstVaapiPicture * picture,
   gboolean success;
 
   picture->param_id = VA_INVALID_ID;
+  picture->slice_data_id = VA_INVALID_ID;
+  picture->slice_params_id = VA_INVALID_ID;
+  picture->coalesce_slices = GET_DECODER (picture)->coalesce_slices;
 
   if (args->flags & GST_VAAPI_CREATE_PICTURE_FLAG_CLONE) {
     GstVaapiPicture *const parent_picture = GST_VAAPI_PICTURE (args->data);
@@ -150,21 +226,27 @@ gst_vaapi_picture_create (GstVaapiPicture * picture,
     if (!picture->proxy)
       return FALSE;
 
+    /* Surfaces allocated at the maximum resolution hold the picture in
+       their top-left corner, unless the codec specifies otherwise */
+    if (GET_DECODER (picture)->max_width > 0)
+      picture_set_default_crop_rect (picture);
+
     picture->structure = GST_VAAPI_PICTURE_STRUCTURE_FRAME;
     GST_VAAPI_PICTURE_FLAG_SET (picture, GST_VAAPI_PICTURE_FLAG_FF);
   }
   picture->surface = GST_VAAPI_SURFACE_PROXY_SURFACE (picture->proxy);
   picture->surface_id = GST_VAAPI_SURFACE_PROXY_SURFACE_ID (picture->proxy);
 
-  success = vaapi_create_buffer (GET_VA_DISPLAY (picture),
-      GET_VA_CONTEXT (picture), VAPictureParameterBufferType,
-      args->param_size, args->param, &picture->param_id, &picture->param);
+  success = gst_vaapi_context_create_buffer (GET_CONTEXT (picture),
+      VAPictureParameterBufferType, args->param_size, args->param,
+      &picture->param_id, &picture->param);
   if (!success)
     return FALSE;
   picture->param_size = args->param_size;
 
-  picture->slices = g_ptr_array_new_with_free_func ((GDestroyNotify)
-      gst_vaapi_mini_object_unref);
+  if (!picture->slices)
+    picture->slices = g_ptr_array_new_with_free_func ((GDestroyNotify)
+        gst_vaapi_mini_object_unref);
   if (!picture->slices)
     return FALSE;
 
@@ -226,24 +308,116 @@ gst_vaapi_picture_add_slice (GstVaapiPicture * picture, GstVaapiSlice * slice)
   g_ptr_array_add (picture->slices, slice);
 }
 
-static gboolean
-do_decode (VADisplay dpy, VAContextID ctx, VABufferID * buf_id, void **buf_ptr)
+/* Number of VA buffers that can be submitted without extra allocation */
+#define MAX_STATIC_VA_BUFFERS 64
+
+typedef struct
 {
-  VAStatus status;
+  VABufferID *va_buffers;
+  VABufferID **buf_id_ptrs;
+  guint num_buffers;
+  guint num_va_calls;
+  VABufferID static_va_buffers[MAX_STATIC_VA_BUFFERS];
+  VABufferID *static_buf_id_ptrs[MAX_STATIC_VA_BUFFERS];
+} RenderBatch;
+
+static void
+render_batch_init (RenderBatch * batch, guint max_buffers)
+{
+  if (max_buffers <= MAX_STATIC_VA_BUFFERS) {
+    batch->va_buffers = batch->static_va_buffers;
+    batch->buf_id_ptrs = batch->static_buf_id_ptrs;
+  } else {
+    batch->va_buffers = g_new (VABufferID, max_buffers);
+    batch->buf_id_ptrs = g_new (VABufferID *, max_buffers);
+  }
+  batch->num_buffers = 0;
+  batch->num_va_calls = 0;
+}
+
+static void
+render_batch_clear (RenderBatch * batch)
+{
+  if (batch->va_buffers != batch->static_va_buffers) {
+    g_free (batch->va_buffers);
+    g_free (batch->buf_id_ptrs);
+  }
+}
+
+/* Queues the VA buffer, that is not mapped, for submission */
+static void
+render_batch_add_unmapped (RenderBatch * batch, VABufferID * buf_id)
+{
+  batch->buf_id_ptrs[batch->num_buffers] = buf_id;
+  batch->va_buffers[batch->num_buffers] = *buf_id;
+  batch->num_buffers++;
+}
 
+/* Unmaps the VA buffer and queues it for submission */
+static void
+render_batch_add (RenderBatch * batch, VADisplay dpy, VABufferID * buf_id,
+    void **buf_ptr)
+{
   vaapi_unmap_buffer (dpy, *buf_id, buf_ptr);
+  batch->num_va_calls++;
 
-  status = vaRenderPicture (dpy, ctx, buf_id, 1);
-  if (!vaapi_check_status (status, "vaRenderPicture()"))
+  render_batch_add_unmapped (batch, buf_id);
+}
+
+/* Recycles all VA buffers once the picture was submitted */
+static void
+render_batch_release (RenderBatch * batch, GstVaapiContext * context)
+{
+  batch->num_va_calls += gst_vaapi_context_recycle_buffers (context,
+      batch->buf_id_ptrs, batch->num_buffers);
+}
+
+/* Creates the VA buffers holding the data and the array of parameters
+   of all the slices of @picture, which must all be coalesced */
+static gboolean
+create_coalesced_slice_buffers (GstVaapiPicture * picture)
+{
+  GstVaapiSlice *slice;
+  guint i, param_size;
+
+  slice = g_ptr_array_index (picture->slices, 0);
+  param_size = slice->param_size;
+
+  g_byte_array_set_size (picture->slice_params, 0);
+  for (i = 0; i < picture->slices->len; i++) {
+    slice = g_ptr_array_index (picture->slices, i);
+    g_return_val_if_fail (slice->coalesced, FALSE);
+    g_byte_array_append (picture->slice_params, slice->param, param_size);
+  }
+
+  if (!gst_vaapi_context_create_buffer (GET_CONTEXT (picture),
+          VASliceDataBufferType, picture->slice_data->len,
+          picture->slice_data->data, &picture->slice_data_id, NULL))
     return FALSE;
 
-  /* XXX: vaRenderPicture() is meant to destroy the VA buffer implicitly */
-  vaapi_destroy_buffer (dpy, buf_id);
-  return TRUE;
+  /* Parameter buffers are only recycled with a single element, so this
+     one is destroyed once the picture was submitted */
+  return vaapi_create_n_elements_buffer (GET_VA_DISPLAY (picture),
+      GET_VA_CONTEXT (picture), VASliceParameterBufferType, param_size,
+      picture->slices->len, picture->slice_params->data,
+      &picture->slice_params_id, NULL);
 }
 
 gboolean
 gst_vaapi_picture_decode (GstVaapiPicture * picture)
+{
+  g_return_val_if_fail (GST_VAAPI_IS_PICTURE (picture), FALSE);
+
+  return gst_vaapi_picture_decode_with_stats (picture,
+      &GET_DECODER (picture)->stats);
+}
+
+/* Submits @picture, like gst_vaapi_picture_decode(), but accounts the
+   submission into @stats rather than into the decoder statistics, so
+   that it can be called from a thread other than the streaming one */
+gboolean
+gst_vaapi_picture_decode_with_stats (GstVaapiPicture * picture,
+    GstVaapiDecoderStats * stats)
 {
   GstVaapiIqMatrix *iq_matrix;
   GstVaapiBitPlane *bitplane;
@@ -252,67 +426,96 @@ gst_vaapi_picture_decode (GstVaapiPicture * picture)
   VADisplay va_display;
   VAContextID va_context;
   VAStatus status;
+  RenderBatch batch;
+  gboolean success = FALSE;
   guint i;
 
   g_return_val_if_fail (GST_VAAPI_IS_PICTURE (picture), FALSE);
+  g_return_val_if_fail (stats != NULL, FALSE);
 
   va_display = GET_VA_DISPLAY (picture);
   va_context = GET_VA_CONTEXT (picture);
 
   GST_DEBUG ("decode picture 0x%08x", picture->surface_id);
 
-  status = vaBeginPicture (va_display, va_context, picture->surface_id);
-  if (!vaapi_check_status (status, "vaBeginPicture()"))
-    return FALSE;
+  /* Submit all the picture and slice buffers with a single
+     vaRenderPicture() call, in the order they used to be rendered:
+     picture level buffers, then (Huffman table,) slice parameter and
+     slice data buffers for each slice, or for all coalesced slices */
+  render_batch_init (&batch, 5 + 3 * picture->slices->len);
 
-  if (!do_decode (va_display, va_context, &picture->param_id, &picture->param))
-    return FALSE;
+  render_batch_add (&batch, va_display, &picture->param_id, &picture->param);
 
   iq_matrix = picture->iq_matrix;
-  if (iq_matrix && !do_decode (va_display, va_context,
-          &iq_matrix->param_id, &iq_matrix->param))
-    return FALSE;
+  if (iq_matrix)
+    render_batch_add (&batch, va_display, &iq_matrix->param_id,
+        &iq_matrix->param);
 
   bitplane = picture->bitplane;
-  if (bitplane && !do_decode (va_display, va_context,
-          &bitplane->data_id, (void **) &bitplane->data))
-    return FALSE;
+  if (bitplane)
+    render_batch_add (&batch, va_display, &bitplane->data_id,
+        (void **) &bitplane->data);
 
   huf_table = picture->huf_table;
-  if (huf_table && !do_decode (va_display, va_context,
-          &huf_table->param_id, (void **) &huf_table->param))
-    return FALSE;
+  if (huf_table)
+    render_batch_add (&batch, va_display, &huf_table->param_id,
+        (void **) &huf_table->param);
 
   prob_table = picture->prob_table;
-  if (prob_table && !do_decode (va_display, va_context,
-          &prob_table->param_id, (void **) &prob_table->param))
-    return FALSE;
+  if (prob_table)
+    render_batch_add (&batch, va_display, &prob_table->param_id,
+        (void **) &prob_table->param);
+
+  if (picture->slices->len > 0 &&
+      GST_VAAPI_SLICE (g_ptr_array_index (picture->slices, 0))->coalesced) {
+    if (!create_coalesced_slice_buffers (picture))
+      goto cleanup;
+    render_batch_add_unmapped (&batch, &picture->slice_params_id);
+    render_batch_add_unmapped (&batch, &picture->slice_data_id);
+  }
 
   for (i = 0; i < picture->slices->len; i++) {
     GstVaapiSlice *const slice = g_ptr_array_index (picture->slices, i);
-    VABufferID va_buffers[2];
 
-    huf_table = slice->huf_table;
-    if (huf_table && !do_decode (va_display, va_context,
-            &huf_table->param_id, (void **) &huf_table->param))
-      return FALSE;
+    if (slice->coalesced)
+      continue;
 
-    vaapi_unmap_buffer (va_display, slice->param_id, NULL);
-    va_buffers[0] = slice->param_id;
-    va_buffers[1] = slice->data_id;
+    huf_table = slice->huf_table;
+    if (huf_table)
+      render_batch_add (&batch, va_display, &huf_table->param_id,
+          (void **) &huf_table->param);
 
-    status = vaRenderPicture (va_display, va_context, va_buffers, 2);
-    if (!vaapi_check_status (status, "vaRenderPicture()"))
-      return FALSE;
+    render_batch_add (&batch, va_display, &slice->param_id, NULL);
 
-    vaapi_destroy_buffer (va_display, &slice->param_id);
-    vaapi_destroy_buffer (va_display, &slice->data_id);
+    /* Slice data buffers are not mapped */
+    render_batch_add_unmapped (&batch, &slice->data_id);
   }
 
+  status = vaBeginPicture (va_display, va_context, picture->surface_id);
+  batch.num_va_calls++;
+  if (!vaapi_check_status (status, "vaBeginPicture()"))
+    goto cleanup;
+
+  status = vaRenderPicture (va_display, va_context, batch.va_buffers,
+      batch.num_buffers);
+  batch.num_va_calls++;
+  if (!vaapi_check_status (status, "vaRenderPicture()"))
+    goto cleanup;
+
   status = vaEndPicture (va_display, va_context);
+  batch.num_va_calls++;
   if (!vaapi_check_status (status, "vaEndPicture()"))
-    return FALSE;
-  return TRUE;
+    goto cleanup;
+
+  render_batch_release (&batch, GET_CONTEXT (picture));
+  stats->num_pictures++;
+  stats->num_render_calls++;
+  success = TRUE;
+
+cleanup:
+  stats->num_va_calls += batch.num_va_calls;
+  render_batch_clear (&batch);
+  return success;
 }
 
 /* Mark picture as output for internal purposes only. Don't push frame out */
@@ -425,15 +628,22 @@ gst_vaapi_picture_set_crop_rect (GstVaapiPicture * picture,
 
 GST_VAAPI_CODEC_DEFINE_TYPE (GstVaapiSlice, gst_vaapi_slice);
 
+enum
+{
+  GST_VAAPI_CREATE_SLICE_FLAG_COALESCED = 1 << 0,
+};
+
 void
 gst_vaapi_slice_destroy (GstVaapiSlice * slice)
 {
-  VADisplay const va_display = GET_VA_DISPLAY (slice);
+  GstVaapiContext *const context = GET_CONTEXT (slice);
 
   gst_vaapi_codec_object_replace (&slice->huf_table, NULL);
 
-  vaapi_destroy_buffer (va_display, &slice->data_id);
-  vaapi_destroy_buffer (va_display, &slice->param_id);
+  gst_vaapi_context_destroy_buffer (context, &slice->data_id);
+  gst_vaapi_context_destroy_buffer (context, &slice->param_id);
+  if (slice->coalesced)
+    g_free (slice->param);
   slice->param = NULL;
 }
 
@@ -446,19 +656,30 @@ gst_vaapi_slice_create (GstVaapiSlice * slice,
 
   slice->param_id = VA_INVALID_ID;
   slice->data_id = VA_INVALID_ID;
+  slice->param_size = args->param_size;
+
+  /* Coalesced slices only hold their parameters, their data is copied
+     to the picture by gst_vaapi_slice_new_for_picture() */
+  if (args->flags & GST_VAAPI_CREATE_SLICE_FLAG_COALESCED) {
+    slice->coalesced = TRUE;
+    slice->param = args->param ? g_memdup (args->param, args->param_size) :
+        g_malloc0 (args->param_size);
+    goto set_data_size;
+  }
 
-  success = vaapi_create_buffer (GET_VA_DISPLAY (slice), GET_VA_CONTEXT (slice),
+  success = gst_vaapi_context_create_buffer (GET_CONTEXT (slice),
       VASliceDataBufferType, args->data_size, args->data, &slice->data_id,
       NULL);
   if (!success)
     return FALSE;
 
-  success = vaapi_create_buffer (GET_VA_DISPLAY (slice), GET_VA_CONTEXT (slice),
+  success = gst_vaapi_context_create_buffer (GET_CONTEXT (slice),
       VASliceParameterBufferType, args->param_size, args->param,
       &slice->param_id, &slice->param);
   if (!success)
     return FALSE;
 
+set_data_size:
   slice_param = slice->param;
   slice_param->slice_data_size = args->data_size;
   slice_param->slice_data_offset = 0;
@@ -476,3 +697,35 @@ gst_vaapi_slice_new (GstVaapiDecoder * decoder,
       GST_VAAPI_CODEC_BASE (decoder), param, param_size, data, data_size, 0);
   return GST_VAAPI_SLICE_CAST (object);
 }
+
+/* Creates a slice of @picture. If the decoder coalesces slices, its
+   data is appended to the slice data of @picture, so that all slices
+   are submitted with a single slice data buffer and a single slice
+   parameter buffer. Otherwise, this is gst_vaapi_slice_new() */
+GstVaapiSlice *
+gst_vaapi_slice_new_for_picture (GstVaapiPicture * picture,
+    gconstpointer param, guint param_size, const guchar * data, guint data_size)
+{
+  GstVaapiDecoder *const decoder = GET_DECODER (picture);
+  GstVaapiCodecObject *object;
+  VASliceParameterBufferBase *slice_param;
+
+  if (!picture->coalesce_slices)
+    return gst_vaapi_slice_new (decoder, param, param_size, data, data_size);
+
+  if (!picture->slice_data)
+    picture->slice_data = g_byte_array_new ();
+  if (!picture->slice_params)
+    picture->slice_params = g_byte_array_new ();
+
+  object = gst_vaapi_codec_object_new (&GstVaapiSliceClass,
+      GST_VAAPI_CODEC_BASE (decoder), param, param_size, data, data_size,
+      GST_VAAPI_CREATE_SLICE_FLAG_COALESCED);
+  if (!object)
+    return NULL;
+
+  slice_param = GST_VAAPI_SLICE_CAST (object)->param;
+  slice_param->slice_data_offset = picture->slice_data->len;
+  g_byte_array_append (picture->slice_data, data, data_size);
+  return GST_VAAPI_SLICE_CAST (object);
+}
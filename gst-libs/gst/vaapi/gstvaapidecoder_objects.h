@@ -148,6 +148,13 @@ struct _GstVaapiPicture
   VABufferID param_id;
   guint param_size;
 
+  /* Data and parameters of coalesced slices */
+  GByteArray *slice_data;
+  GByteArray *slice_params;
+  VABufferID slice_data_id;
+  VABufferID slice_params_id;
+  guint coalesce_slices:1;
+
   /*< public >*/
   GstVaapiPictureType type;
   VASurfaceID surface_id;
@@ -175,6 +182,14 @@ gboolean
 gst_vaapi_picture_create (GstVaapiPicture * picture,
     const GstVaapiCodecObjectConstructorArgs * args);
 
+G_GNUC_INTERNAL
+void
+gst_vaapi_picture_reset (GstVaapiPicture * picture);
+
+G_GNUC_INTERNAL
+void
+gst_vaapi_picture_release (GstVaapiPicture * picture);
+
 G_GNUC_INTERNAL
 GstVaapiPicture *
 gst_vaapi_picture_new (GstVaapiDecoder * decoder,
@@ -196,6 +211,11 @@ G_GNUC_INTERNAL
 gboolean
 gst_vaapi_picture_decode (GstVaapiPicture * picture);
 
+G_GNUC_INTERNAL
+gboolean
+gst_vaapi_picture_decode_with_stats (GstVaapiPicture * picture,
+    GstVaapiDecoderStats * stats);
+
 G_GNUC_INTERNAL
 gboolean
 gst_vaapi_picture_output (GstVaapiPicture * picture);
@@ -236,6 +256,8 @@ struct _GstVaapiSlice
 {
   /*< private >*/
   GstVaapiCodecObject parent_instance;
+  guint param_size;
+  guint coalesced:1;
 
   /*< public >*/
   VABufferID param_id;
@@ -260,6 +282,12 @@ GstVaapiSlice *
 gst_vaapi_slice_new (GstVaapiDecoder * decoder, gconstpointer param,
     guint param_size, const guchar * data, guint data_size);
 
+G_GNUC_INTERNAL
+GstVaapiSlice *
+gst_vaapi_slice_new_for_picture (GstVaapiPicture * picture,
+    gconstpointer param, guint param_size, const guchar * data,
+    guint data_size);
+
 /* ------------------------------------------------------------------------- */
 /* --- Helpers to create codec-dependent objects                         --- */
 /* ------------------------------------------------------------------------- */
@@ -273,6 +301,11 @@ gst_vaapi_slice_new (GstVaapiDecoder * decoder, gconstpointer param,
       NULL, sizeof (G_PASTE (VASliceParameterBuffer, codec)),   \
       buf, buf_size)
 
+#define GST_VAAPI_SLICE_NEW_FOR_PICTURE(codec, picture, buf, buf_size)  \
+  gst_vaapi_slice_new_for_picture (GST_VAAPI_PICTURE_CAST (picture),    \
+      NULL, sizeof (G_PASTE (VASliceParameterBuffer, codec)),           \
+      buf, buf_size)
+
 G_END_DECLS
 
 #endif /* GST_VAAPI_DECODER_OBJECTS_H */
@@ -0,0 +1,189 @@
+/*
+ *  gstvaapidecoder_paramsets.c - Parameter set cache
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation; either version 2.1
+ *  of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free
+ *  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301 USA
+ */
+
+#include "sysdeps.h"
+#include <string.h>
+#include "gstvaapidecoder_paramsets.h"
+
+/* 32-bit FNV-1a hash */
+static guint32
+hash_bytes (const guint8 * data, guint size)
+{
+  guint32 hash = 2166136261U;
+  guint i;
+
+  for (i = 0; i < size; i++)
+    hash = (hash ^ data[i]) * 16777619U;
+  return hash;
+}
+
+static void
+entry_clear (GstVaapiParamSetEntry * entry)
+{
+  g_free (entry->data);
+  entry->data = NULL;
+  entry->size = 0;
+  entry->hash = 0;
+  gst_vaapi_mini_object_replace (&entry->info, NULL);
+}
+
+static inline gboolean
+entry_equals (const GstVaapiParamSetEntry * entry, guint32 hash,
+    const guint8 * data, guint size)
+{
+  return entry->info && entry->hash == hash && entry->size == size &&
+      memcmp (entry->data, data, size) == 0;
+}
+
+/**
+ * gst_vaapi_param_set_cache_init:
+ * @cache: a #GstVaapiParamSetCache
+ * @num_ids: the number of parameter set ids
+ * @last_only: flag: only match the last inserted parameter set
+ * @dependent: (allow-none): the cache of the parameter sets parsed
+ *   against these ones, or %NULL
+ *
+ * Initializes @cache for parameter sets with ids in [0, @num_ids). If
+ * @last_only is set, lookups only consider the last inserted parameter
+ * set, e.g. because the codec parser also remembers which one it parsed
+ * last. @dependent is cleared along with @cache, and whenever a new
+ * parameter set is inserted into @cache.
+ */
+void
+gst_vaapi_param_set_cache_init (GstVaapiParamSetCache * cache, guint num_ids,
+    gboolean last_only, GstVaapiParamSetCache * dependent)
+{
+  cache->entries = g_new0 (GstVaapiParamSetEntry, num_ids);
+  cache->num_entries = num_ids;
+  cache->last_id = num_ids;
+  cache->last_only = last_only;
+  cache->dependent = dependent;
+  cache->num_hits = 0;
+  cache->num_misses = 0;
+}
+
+/**
+ * gst_vaapi_param_set_cache_finalize:
+ * @cache: a #GstVaapiParamSetCache
+ *
+ * Releases all the resources held by @cache.
+ */
+void
+gst_vaapi_param_set_cache_finalize (GstVaapiParamSetCache * cache)
+{
+  gst_vaapi_param_set_cache_clear (cache);
+  g_free (cache->entries);
+  cache->entries = NULL;
+  cache->num_entries = 0;
+}
+
+/**
+ * gst_vaapi_param_set_cache_clear:
+ * @cache: a #GstVaapiParamSetCache
+ *
+ * Forgets all the parameter sets, and those of the dependent cache,
+ * e.g. when the codec parser state they were parsed against changed.
+ * Statistics are preserved.
+ */
+void
+gst_vaapi_param_set_cache_clear (GstVaapiParamSetCache * cache)
+{
+  guint i;
+
+  for (i = 0; i < cache->num_entries; i++)
+    entry_clear (&cache->entries[i]);
+  cache->last_id = cache->num_entries;
+
+  if (cache->dependent)
+    gst_vaapi_param_set_cache_clear (cache->dependent);
+}
+
+/**
+ * gst_vaapi_param_set_cache_lookup:
+ * @cache: a #GstVaapiParamSetCache
+ * @data: the parameter set NAL unit
+ * @size: the size of @data, in bytes
+ *
+ * Looks up a parameter set byte-identical to @data. Only the last
+ * inserted one is considered if @cache was initialized with last_only.
+ *
+ * Return value: the parser info of the matching parameter set, or
+ *   %NULL if there is none. The cache keeps the reference
+ */
+gpointer
+gst_vaapi_param_set_cache_lookup (GstVaapiParamSetCache * cache,
+    const guint8 * data, guint size)
+{
+  const guint32 hash = hash_bytes (data, size);
+  guint i;
+
+  if (cache->last_only) {
+    if (cache->last_id < cache->num_entries &&
+        entry_equals (&cache->entries[cache->last_id], hash, data, size))
+      goto found;
+  } else {
+    for (i = 0; i < cache->num_entries; i++) {
+      if (entry_equals (&cache->entries[i], hash, data, size)) {
+        cache->last_id = i;
+        goto found;
+      }
+    }
+  }
+  cache->num_misses++;
+  return NULL;
+
+found:
+  cache->num_hits++;
+  return cache->entries[cache->last_id].info;
+}
+
+/**
+ * gst_vaapi_param_set_cache_insert:
+ * @cache: a #GstVaapiParamSetCache
+ * @id: the parameter set id
+ * @data: the parameter set NAL unit
+ * @size: the size of @data, in bytes
+ * @info: the parser info resulting from @data
+ *
+ * Records @data as the last parameter set parsed with @id, replacing
+ * any previous one, and clears the dependent cache since its parameter
+ * sets may have been parsed against another one. @cache takes a new
+ * reference to @info.
+ */
+void
+gst_vaapi_param_set_cache_insert (GstVaapiParamSetCache * cache, guint id,
+    const guint8 * data, guint size, gpointer info)
+{
+  GstVaapiParamSetEntry *entry;
+
+  g_return_if_fail (id < cache->num_entries);
+
+  entry = &cache->entries[id];
+  entry_clear (entry);
+  entry->data = g_memdup (data, size);
+  entry->size = size;
+  entry->hash = hash_bytes (data, size);
+  gst_vaapi_mini_object_replace (&entry->info, info);
+  cache->last_id = id;
+
+  if (cache->dependent)
+    gst_vaapi_param_set_cache_clear (cache->dependent);
+}
@@ -0,0 +1,93 @@
+/*
+ *  gstvaapidecoder_paramsets.h - Parameter set cache
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation; either version 2.1
+ *  of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free
+ *  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301 USA
+ */
+
+#ifndef GST_VAAPI_DECODER_PARAMSETS_H
+#define GST_VAAPI_DECODER_PARAMSETS_H
+
+#include "gstvaapiminiobject.h"
+
+G_BEGIN_DECLS
+
+typedef struct _GstVaapiParamSetCache GstVaapiParamSetCache;
+typedef struct _GstVaapiParamSetEntry GstVaapiParamSetEntry;
+
+struct _GstVaapiParamSetEntry
+{
+  guint32 hash;
+  guint size;
+  guint8 *data;
+  GstVaapiMiniObject *info;
+};
+
+/**
+ * GstVaapiParamSetCache:
+ * @num_hits: the number of parameter sets found in the cache
+ * @num_misses: the number of parameter sets that had to be parsed
+ *
+ * The raw bytes of the last parameter set parsed for each id, along
+ * with the parser info holding the result. Streams that repeat their
+ * parameter sets before every key frame can then reuse the parser
+ * info of a byte-identical parameter set instead of parsing it again.
+ *
+ * The parameter sets that are parsed against those of this cache,
+ * e.g. the PPS against the SPS, are held in a dependent cache, which
+ * is cleared whenever a parameter set is inserted into this one.
+ */
+struct _GstVaapiParamSetCache
+{
+  /*< private > */
+  GstVaapiParamSetEntry *entries;
+  guint num_entries;
+  guint last_id;
+  gboolean last_only;
+  GstVaapiParamSetCache *dependent;
+
+  /*< public > */
+  guint64 num_hits;
+  guint64 num_misses;
+};
+
+G_GNUC_INTERNAL
+void
+gst_vaapi_param_set_cache_init (GstVaapiParamSetCache * cache, guint num_ids,
+    gboolean last_only, GstVaapiParamSetCache * dependent);
+
+G_GNUC_INTERNAL
+void
+gst_vaapi_param_set_cache_finalize (GstVaapiParamSetCache * cache);
+
+G_GNUC_INTERNAL
+void
+gst_vaapi_param_set_cache_clear (GstVaapiParamSetCache * cache);
+
+G_GNUC_INTERNAL
+gpointer
+gst_vaapi_param_set_cache_lookup (GstVaapiParamSetCache * cache,
+    const guint8 * data, guint size);
+
+G_GNUC_INTERNAL
+void
+gst_vaapi_param_set_cache_insert (GstVaapiParamSetCache * cache, guint id,
+    const guint8 * data, guint size, gpointer info);
+
+G_END_DECLS
+
+#endif /* GST_VAAPI_DECODER_PARAMSETS_H */
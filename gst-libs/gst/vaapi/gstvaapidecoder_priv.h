@@ -202,6 +202,14 @@ struct _GstVaapiDecoder
   GstVaapiParserState parser_state;
   GstVaapiDecoderStateChangedFunc codec_state_changed_func;
   gpointer codec_state_changed_data;
+  guint parse_threads;
+  GThreadPool *parse_pool;
+  GstVaapiDecoderStats stats;
+  gchar *owner;
+  GstVaapiVideoPool *surface_pool;
+  guint max_width;
+  guint max_height;
+  guint coalesce_slices:1;
 };
 
 /**
@@ -282,6 +290,23 @@ G_GNUC_INTERNAL
 GstVaapiDecoderStatus
 gst_vaapi_decoder_decode_codec_data (GstVaapiDecoder * decoder);
 
+/**
+ * GstVaapiDecoderJobFunc:
+ * @job: the job to process
+ * @user_data: the data passed to gst_vaapi_decoder_run_jobs()
+ *
+ * Processes a single job submitted with gst_vaapi_decoder_run_jobs().
+ * This can be called from any thread, concurrently with other jobs
+ * of the same batch.
+ */
+typedef void (*GstVaapiDecoderJobFunc) (gpointer job, gpointer user_data);
+
+G_GNUC_INTERNAL
+void
+gst_vaapi_decoder_run_jobs (GstVaapiDecoder * decoder,
+    GstVaapiDecoderJobFunc func, gpointer * jobs, guint num_jobs,
+    gpointer user_data);
+
 G_END_DECLS
 
 #endif /* GST_VAAPI_DECODER_PRIV_H */
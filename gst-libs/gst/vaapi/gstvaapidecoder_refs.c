@@ -0,0 +1,119 @@
+/*
+ *  gstvaapidecoder_refs.c - Reference picture index
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation; either version 2.1
+ *  of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free
+ *  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301 USA
+ */
+
+#include "sysdeps.h"
+#include "gstvaapidecoder_refs.h"
+
+/**
+ * gst_vaapi_ref_index_insert:
+ * @index: a #GstVaapiRefIndex
+ * @key: the key of @picture
+ * @picture: the picture to insert
+ *
+ * Inserts @picture after the pictures with a key lower than or equal
+ * to @key.
+ *
+ * Return value: %FALSE if @index is full
+ */
+gboolean
+gst_vaapi_ref_index_insert (GstVaapiRefIndex * index, gint32 key,
+    gpointer picture)
+{
+  guint i;
+
+  g_return_val_if_fail (index != NULL, FALSE);
+  g_return_val_if_fail (index->count < GST_VAAPI_REF_INDEX_MAX_SIZE, FALSE);
+
+  i = gst_vaapi_ref_index_upper_bound (index, key);
+  if (i < index->count)
+    memmove (&index->entries[i + 1], &index->entries[i],
+        (index->count - i) * sizeof (index->entries[0]));
+  index->entries[i].key = key;
+  index->entries[i].picture = picture;
+  index->count++;
+  return TRUE;
+}
+
+guint
+gst_vaapi_ref_index_lower_bound (const GstVaapiRefIndex * index, gint32 key)
+{
+  guint lo = 0, hi = index->count, mid;
+
+  while (lo < hi) {
+    mid = (lo + hi) / 2;
+    if (index->entries[mid].key < key)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+guint
+gst_vaapi_ref_index_upper_bound (const GstVaapiRefIndex * index, gint32 key)
+{
+  guint lo = 0, hi = index->count, mid;
+
+  while (lo < hi) {
+    mid = (lo + hi) / 2;
+    if (index->entries[mid].key <= key)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+/**
+ * gst_vaapi_ref_index_copy:
+ * @index: a #GstVaapiRefIndex
+ * @start: the position of the first picture to copy
+ * @end: the position following the last picture to copy
+ * @reverse: %TRUE to copy the pictures by decreasing key
+ * @pictures: the array to fill in
+ *
+ * Copies the pictures from @start to @end, excluded, into @pictures,
+ * by increasing key, or by decreasing key if @reverse is set.
+ *
+ * Return value: the number of pictures copied
+ */
+guint
+gst_vaapi_ref_index_copy (const GstVaapiRefIndex * index, guint start,
+    guint end, gboolean reverse, gpointer * pictures)
+{
+  guint i, n;
+
+  g_return_val_if_fail (index != NULL, 0);
+  g_return_val_if_fail (end <= index->count, 0);
+
+  if (start >= end)
+    return 0;
+
+  n = end - start;
+  if (reverse) {
+    for (i = 0; i < n; i++)
+      pictures[i] = index->entries[end - 1 - i].picture;
+  } else {
+    for (i = 0; i < n; i++)
+      pictures[i] = index->entries[start + i].picture;
+  }
+  return n;
+}
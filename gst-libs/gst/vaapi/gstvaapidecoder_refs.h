@@ -0,0 +1,87 @@
+/*
+ *  gstvaapidecoder_refs.h - Reference picture index
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation; either version 2.1
+ *  of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free
+ *  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301 USA
+ */
+
+#ifndef GST_VAAPI_DECODER_REFS_H
+#define GST_VAAPI_DECODER_REFS_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* Maximum number of pictures in an index, i.e. the fields of a full
+   H.264 DPB */
+#define GST_VAAPI_REF_INDEX_MAX_SIZE 32
+
+typedef struct _GstVaapiRefIndex GstVaapiRefIndex;
+typedef struct _GstVaapiRefIndexEntry GstVaapiRefIndexEntry;
+
+struct _GstVaapiRefIndexEntry
+{
+  gint32 key;
+  gpointer picture;
+};
+
+/**
+ * GstVaapiRefIndex:
+ * @entries: the pictures, by increasing key
+ * @count: the number of @entries
+ *
+ * A set of reference pictures kept sorted by a key, e.g. their POC or
+ * their PicNum. Reference picture lists are then initialized by
+ * copying ranges of the index instead of sorting, and pictures are
+ * looked up by binary search. Pictures with equal keys stay in
+ * insertion order.
+ */
+struct _GstVaapiRefIndex
+{
+  GstVaapiRefIndexEntry entries[GST_VAAPI_REF_INDEX_MAX_SIZE];
+  guint count;
+};
+
+static inline void
+gst_vaapi_ref_index_clear (GstVaapiRefIndex * index)
+{
+  index->count = 0;
+}
+
+G_GNUC_INTERNAL
+gboolean
+gst_vaapi_ref_index_insert (GstVaapiRefIndex * index, gint32 key,
+    gpointer picture);
+
+/* Returns the position of the first picture with a key >= @key */
+G_GNUC_INTERNAL
+guint
+gst_vaapi_ref_index_lower_bound (const GstVaapiRefIndex * index, gint32 key);
+
+/* Returns the position of the first picture with a key > @key */
+G_GNUC_INTERNAL
+guint
+gst_vaapi_ref_index_upper_bound (const GstVaapiRefIndex * index, gint32 key);
+
+G_GNUC_INTERNAL
+guint
+gst_vaapi_ref_index_copy (const GstVaapiRefIndex * index, guint start,
+    guint end, gboolean reverse, gpointer * pictures);
+
+G_END_DECLS
+
+#endif /* GST_VAAPI_DECODER_REFS_H */
@@ -64,6 +64,15 @@ struct _GstVaapiDecoderVp9Private
   guint had_superframe_hdr:1;   /* indicate the presense of super frame */
 
   guint size_changed:1;
+
+  /* Frame-threaded submission */
+  GThreadPool *submit_pool;
+  GMutex submit_lock;
+  GCond submit_done;
+  GstVaapiPicture *pending_picture;     /* submitted but not output yet */
+  gboolean submit_busy;
+  gboolean submit_failed;
+  GstVaapiDecoderStats submit_stats;    /* accounted by the submit thread */
 };
 
 /**
@@ -115,6 +124,14 @@ gst_vaapi_decoder_vp9_close (GstVaapiDecoderVp9 * decoder)
   GstVaapiDecoderVp9Private *const priv = &decoder->priv;
   guint i;
 
+  if (priv->submit_pool) {
+    g_thread_pool_free (priv->submit_pool, FALSE, TRUE);
+    priv->submit_pool = NULL;
+  }
+  priv->submit_busy = FALSE;
+  memset (&priv->submit_stats, 0, sizeof (priv->submit_stats));
+  gst_vaapi_picture_replace (&priv->pending_picture, NULL);
+
   for (i = 0; i < GST_VP9_REF_FRAMES; i++)
     gst_vaapi_picture_replace (&priv->ref_frames[i], NULL);
 
@@ -136,8 +153,11 @@ static void
 gst_vaapi_decoder_vp9_destroy (GstVaapiDecoder * base_decoder)
 {
   GstVaapiDecoderVp9 *const decoder = GST_VAAPI_DECODER_VP9_CAST (base_decoder);
+  GstVaapiDecoderVp9Private *const priv = &decoder->priv;
 
   gst_vaapi_decoder_vp9_close (decoder);
+  g_cond_clear (&priv->submit_done);
+  g_mutex_clear (&priv->submit_lock);
 }
 
 static gboolean
@@ -146,6 +166,8 @@ gst_vaapi_decoder_vp9_create (GstVaapiDecoder * base_decoder)
   GstVaapiDecoderVp9 *const decoder = GST_VAAPI_DECODER_VP9_CAST (base_decoder);
   GstVaapiDecoderVp9Private *const priv = &decoder->priv;
 
+  g_mutex_init (&priv->submit_lock);
+  g_cond_init (&priv->submit_done);
   if (!gst_vaapi_decoder_vp9_open (decoder))
     return FALSE;
 
@@ -180,6 +202,95 @@ get_profile (guint profile_idc)
   return profile;
 }
 
+static void
+submit_picture (gpointer data, gpointer user_data)
+{
+  GstVaapiDecoderVp9 *const decoder = user_data;
+  GstVaapiDecoderVp9Private *const priv = &decoder->priv;
+  gboolean success;
+
+  success = gst_vaapi_picture_decode_with_stats (GST_VAAPI_PICTURE_CAST (data),
+      &priv->submit_stats);
+
+  g_mutex_lock (&priv->submit_lock);
+  priv->submit_failed = !success;
+  priv->submit_busy = FALSE;
+  g_cond_signal (&priv->submit_done);
+  g_mutex_unlock (&priv->submit_lock);
+}
+
+/* Waits for the pending picture to be submitted, and outputs it */
+static GstVaapiDecoderStatus
+complete_pending_picture (GstVaapiDecoderVp9 * decoder)
+{
+  GstVaapiDecoderVp9Private *const priv = &decoder->priv;
+  GstVaapiDecoderStats *const stats = &GST_VAAPI_DECODER (decoder)->stats;
+  GstVaapiPicture *const picture = priv->pending_picture;
+  gboolean success;
+
+  if (!picture)
+    return GST_VAAPI_DECODER_STATUS_SUCCESS;
+
+  g_mutex_lock (&priv->submit_lock);
+  while (priv->submit_busy)
+    g_cond_wait (&priv->submit_done, &priv->submit_lock);
+  success = !priv->submit_failed;
+  g_mutex_unlock (&priv->submit_lock);
+
+  /* The decoder statistics are only updated from the streaming thread */
+  stats->num_pictures += priv->submit_stats.num_pictures;
+  stats->num_va_calls += priv->submit_stats.num_va_calls;
+  stats->num_render_calls += priv->submit_stats.num_render_calls;
+  memset (&priv->submit_stats, 0, sizeof (priv->submit_stats));
+
+  priv->pending_picture = NULL;
+  if (success)
+    success = gst_vaapi_picture_output (picture);
+  gst_vaapi_picture_unref (picture);
+
+  if (!success)
+    return GST_VAAPI_DECODER_STATUS_ERROR_UNKNOWN;
+  return GST_VAAPI_DECODER_STATUS_SUCCESS;
+}
+
+/* Checks whether the current picture can be submitted by the submit
+   thread, while the next frame is parsed and its buffers are filled.
+   This is only the case if the next frame is part of the same
+   superframe, since it would otherwise wait for more input and delay
+   the output. The frames that adapt the probabilities inherited by the
+   next ones are submitted synchronously, and so is the last free
+   surface, so that a surface is always left for the next frame */
+static gboolean
+can_defer_picture (GstVaapiDecoderVp9 * decoder)
+{
+  GstVaapiDecoderVp9Private *const priv = &decoder->priv;
+  GstVp9FrameHdr *const frame_hdr = &priv->frame_hdr;
+
+  if (gst_vaapi_decoder_get_parse_threads (GST_VAAPI_DECODER (decoder)) < 2)
+    return FALSE;
+
+  /* The superframe parse state is reset once its last frame was split */
+  if (priv->num_frames == 0)
+    return FALSE;
+
+  if (frame_hdr->refresh_frame_context &&
+      !frame_hdr->frame_parallel_decoding_mode &&
+      !frame_hdr->error_resilient_mode)
+    return FALSE;
+
+  if (gst_vaapi_context_get_surface_count (GST_VAAPI_DECODER_CONTEXT
+          (decoder)) < 1)
+    return FALSE;
+
+  if (!priv->submit_pool) {
+    priv->submit_pool = g_thread_pool_new (submit_picture, decoder, 1, FALSE,
+        NULL);
+    if (!priv->submit_pool)
+      return FALSE;
+  }
+  return TRUE;
+}
+
 static GstVaapiDecoderStatus
 ensure_context (GstVaapiDecoderVp9 * decoder)
 {
@@ -208,6 +319,12 @@ ensure_context (GstVaapiDecoderVp9 * decoder)
 
   if (reset_context) {
     GstVaapiContextInfo info;
+    GstVaapiDecoderStatus status;
+
+    /* The pending picture still uses the current surfaces */
+    status = complete_pending_picture (decoder);
+    if (status != GST_VAAPI_DECODER_STATUS_SUCCESS)
+      return status;
 
     info.profile = priv->profile;
     info.entrypoint = entrypoint;
@@ -511,13 +628,29 @@ decode_current_picture (GstVaapiDecoderVp9 * decoder)
   GstVaapiDecoderVp9Private *const priv = &decoder->priv;
   GstVaapiPicture *const picture = priv->current_picture;
   GstVp9FrameHdr *const frame_hdr = &priv->frame_hdr;
+  GstVaapiDecoderStatus status;
 
   if (!picture)
     return GST_VAAPI_DECODER_STATUS_SUCCESS;
 
+  /* Output the frames in decoding order */
+  status = complete_pending_picture (decoder);
+  if (status != GST_VAAPI_DECODER_STATUS_SUCCESS)
+    goto error;
+
   if (frame_hdr->show_existing_frame)
     goto ret;
 
+  if (can_defer_picture (decoder)) {
+    update_ref_frames (decoder);
+
+    priv->pending_picture = priv->current_picture;
+    priv->current_picture = NULL;
+    priv->submit_busy = TRUE;
+    g_thread_pool_push (priv->submit_pool, picture, NULL);
+    return GST_VAAPI_DECODER_STATUS_SUCCESS;
+  }
+
   if (!gst_vaapi_picture_decode (picture))
     goto error;
 
@@ -540,18 +673,31 @@ error:
   }
 }
 
+/* Maximum size of a superframe index: a marker byte on both ends, and
+   the sizes of up to 8 frames, coded on up to 4 bytes each */
+#define MAX_SUPER_FRAME_INDEX_SIZE (2 + 8 * 4)
+
+/* Splits the data available from @adapter into frames, reading only
+   the superframe index that may trail it. The adapter contents are
+   neither mapped nor scanned, since that would merge the input
+   buffers, and the frame sizes are taken as is for the next units */
 static gboolean
-parse_super_frame (const guchar * data, guint data_size,
+parse_super_frame (GstAdapter * adapter, guint data_size,
     guint * frame_sizes, guint * frame_count, guint * total_idx_size)
 {
+  guint8 index[MAX_SUPER_FRAME_INDEX_SIZE];
+  const guint8 *x;
   guint8 marker;
   guint32 num_frames = 1, frame_size_length, total_index_size;
-  guint i, j;
+  guint64 frames_size = 0;
+  guint i, j, index_size;
 
   if (data_size <= 0)
     return FALSE;
 
-  marker = data[data_size - 1];
+  index_size = MIN (data_size, sizeof (index));
+  gst_adapter_copy (adapter, index, data_size - index_size, index_size);
+  marker = index[index_size - 1];
 
   if ((marker & 0xe0) == 0xc0) {
 
@@ -561,9 +707,9 @@ parse_super_frame (const guchar * data, guint data_size,
     frame_size_length = ((marker >> 3) & 0x3) + 1;
     total_index_size = 2 + num_frames * frame_size_length;
 
-    if ((data_size >= total_index_size)
-        && (data[data_size - total_index_size] == marker)) {
-      const guint8 *x = &data[data_size - total_index_size + 1];
+    if ((index_size >= total_index_size)
+        && (index[index_size - total_index_size] == marker)) {
+      x = &index[index_size - total_index_size + 1];
 
       for (i = 0; i < num_frames; i++) {
         guint32 cur_frame_size = 0;
@@ -572,6 +718,12 @@ parse_super_frame (const guchar * data, guint data_size,
           cur_frame_size |= (*x++) << (j * 8);
 
         frame_sizes[i] = cur_frame_size;
+        frames_size += cur_frame_size;
+      }
+
+      if (frames_size > data_size - total_index_size) {
+        GST_ERROR ("Super-frame index exceeds the frame size");
+        return FALSE;
       }
 
       *frame_count = num_frames;
@@ -631,19 +783,15 @@ gst_vaapi_decoder_vp9_parse (GstVaapiDecoder * base_decoder,
 {
   GstVaapiDecoderVp9 *const decoder = GST_VAAPI_DECODER_VP9_CAST (base_decoder);
   GstVaapiDecoderVp9Private *const priv = &decoder->priv;
-  guchar *buf;
   guint buf_size, flags = 0;
 
   buf_size = gst_adapter_available (adapter);
   if (!buf_size)
     return GST_VAAPI_DECODER_STATUS_ERROR_NO_DATA;
-  buf = (guchar *) gst_adapter_map (adapter, buf_size);
-  if (!buf)
-    return GST_VAAPI_DECODER_STATUS_ERROR_NO_DATA;
 
   if (!priv->had_superframe_hdr) {
-    if (!parse_super_frame (buf, buf_size, priv->frame_sizes, &priv->num_frames,
-            &priv->total_idx_size))
+    if (!parse_super_frame (adapter, buf_size, priv->frame_sizes,
+            &priv->num_frames, &priv->total_idx_size))
       return GST_VAAPI_DECODER_STATUS_ERROR_BITSTREAM_PARSER;
 
     if (priv->num_frames > 1)
@@ -729,7 +877,9 @@ gst_vaapi_decoder_vp9_end_frame (GstVaapiDecoder * base_decoder)
 static GstVaapiDecoderStatus
 gst_vaapi_decoder_vp9_flush (GstVaapiDecoder * base_decoder)
 {
-  return GST_VAAPI_DECODER_STATUS_SUCCESS;
+  GstVaapiDecoderVp9 *const decoder = GST_VAAPI_DECODER_VP9_CAST (base_decoder);
+
+  return complete_pending_picture (decoder);
 }
 
 static void
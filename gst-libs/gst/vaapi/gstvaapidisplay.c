@@ -1014,6 +1014,7 @@ gst_vaapi_display_init (GstVaapiDisplay * display)
   priv->display_type = GST_VAAPI_DISPLAY_TYPE_ANY;
   priv->par_n = 1;
   priv->par_d = 1;
+  priv->budget = gst_vaapi_display_budget_new ();
 
   g_rec_mutex_init (&priv->mutex);
 }
@@ -1025,6 +1026,7 @@ gst_vaapi_display_finalize (GObject * object)
   GstVaapiDisplayPrivate *const priv = GST_VAAPI_DISPLAY_GET_PRIVATE (display);
 
   gst_vaapi_display_destroy (display);
+  gst_vaapi_display_budget_free (priv->budget);
   g_rec_mutex_clear (&priv->mutex);
 
   G_OBJECT_CLASS (gst_vaapi_display_parent_class)->finalize (object);
@@ -2168,3 +2170,82 @@ gst_vaapi_display_reset_texture_map (GstVaapiDisplay * display)
   if ((map = klass->get_texture_map (display)))
     gst_vaapi_texture_map_reset (map);
 }
+
+GstVaapiDisplayBudget *
+gst_vaapi_display_get_budget (GstVaapiDisplay * display)
+{
+  GstVaapiDisplayPrivate *priv = GST_VAAPI_DISPLAY_GET_PRIVATE (display);
+
+  if (priv->parent)
+    priv = GST_VAAPI_DISPLAY_GET_PRIVATE (priv->parent);
+  return priv->budget;
+}
+
+/**
+ * gst_vaapi_display_set_surface_budget:
+ * @display: a #GstVaapiDisplay
+ * @max_bytes: the maximum number of bytes, or 0 for no limit
+ *
+ * Limits the memory all the #GstVaapiVideoPool objects created on
+ * @display may hold to @max_bytes. Beyond this limit, allocations
+ * first release the free objects of the other pools, and then wait
+ * for memory to be released, up to a timeout after which they fail.
+ *
+ * The default budget is read from the GST_VAAPI_SURFACE_BUDGET
+ * environment variable, in MiB, and is unlimited otherwise.
+ *
+ * This function is thread safe.
+ */
+void
+gst_vaapi_display_set_surface_budget (GstVaapiDisplay * display,
+    guint64 max_bytes)
+{
+  g_return_if_fail (display != NULL);
+
+  gst_vaapi_display_budget_set_max_bytes (GST_VAAPI_DISPLAY_BUDGET (display),
+      max_bytes);
+}
+
+/**
+ * gst_vaapi_display_get_surface_budget:
+ * @display: a #GstVaapiDisplay
+ *
+ * Returns the maximum number of bytes the #GstVaapiVideoPool objects
+ * created on @display may hold.
+ *
+ * This function is thread safe.
+ *
+ * Return value: the budget in bytes, or 0 if there is no limit
+ */
+guint64
+gst_vaapi_display_get_surface_budget (GstVaapiDisplay * display)
+{
+  g_return_val_if_fail (display != NULL, 0);
+
+  return gst_vaapi_display_budget_get_max_bytes (GST_VAAPI_DISPLAY_BUDGET
+      (display));
+}
+
+/**
+ * gst_vaapi_display_get_surface_usage:
+ * @display: a #GstVaapiDisplay
+ * @owner: (allow-none): the owner of the pools, e.g. an element name
+ *
+ * Returns the number of bytes currently held by the #GstVaapiVideoPool
+ * objects created on @display and labelled with @owner through
+ * gst_vaapi_video_pool_set_owner(), or by all of them if @owner is
+ * %NULL.
+ *
+ * This function is thread safe.
+ *
+ * Return value: the memory usage, in bytes
+ */
+guint64
+gst_vaapi_display_get_surface_usage (GstVaapiDisplay * display,
+    const gchar * owner)
+{
+  g_return_val_if_fail (display != NULL, 0);
+
+  return gst_vaapi_display_budget_get_usage (GST_VAAPI_DISPLAY_BUDGET
+      (display), owner);
+}
@@ -266,6 +266,17 @@ gst_vaapi_display_has_opengl (GstVaapiDisplay * display);
 void
 gst_vaapi_display_reset_texture_map (GstVaapiDisplay * display);
 
+void
+gst_vaapi_display_set_surface_budget (GstVaapiDisplay * display,
+    guint64 max_bytes);
+
+guint64
+gst_vaapi_display_get_surface_budget (GstVaapiDisplay * display);
+
+guint64
+gst_vaapi_display_get_surface_usage (GstVaapiDisplay * display,
+    const gchar * owner);
+
 #ifdef G_DEFINE_AUTOPTR_CLEANUP_FUNC
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstVaapiDisplay, gst_vaapi_display_unref)
 #endif
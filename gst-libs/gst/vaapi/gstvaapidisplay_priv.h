@@ -30,6 +30,7 @@
 #include <gst/vaapi/gstvaapiwindow.h>
 #include <gst/vaapi/gstvaapitexture.h>
 #include <gst/vaapi/gstvaapitexturemap.h>
+#include "gstvaapidisplaybudget.h"
 #include "gstvaapiminiobject.h"
 
 G_BEGIN_DECLS
@@ -119,6 +120,18 @@ typedef enum _GstVaapiDisplayInitType           GstVaapiDisplayInitType;
 #define GST_VAAPI_DISPLAY_CACHE(display) \
   (GST_VAAPI_DISPLAY_GET_PRIVATE (display)->cache)
 
+/**
+ * GST_VAAPI_DISPLAY_BUDGET:
+ * @display: a @GstVaapiDisplay
+ *
+ * Returns the #GstVaapiDisplayBudget shared by the pools of the
+ * supplied @display object, i.e. that of the parent display, if any.
+ * This is an internal macro that does not do any run-time type check.
+ */
+#undef  GST_VAAPI_DISPLAY_BUDGET
+#define GST_VAAPI_DISPLAY_BUDGET(display) \
+  gst_vaapi_display_get_budget (GST_VAAPI_DISPLAY_CAST (display))
+
 struct _GstVaapiDisplayPrivate
 {
   GstVaapiDisplay *parent;
@@ -140,6 +153,7 @@ struct _GstVaapiDisplayPrivate
   GArray *subpicture_formats;
   GArray *properties;
   gchar *vendor_string;
+  GstVaapiDisplayBudget *budget;
   guint use_foreign_display:1;
   guint has_vpp:1;
   guint has_profiles:1;
@@ -217,6 +231,10 @@ GstVaapiDisplay *
 gst_vaapi_display_new (GstVaapiDisplay * display,
     GstVaapiDisplayInitType init_type, gpointer init_value);
 
+G_GNUC_INTERNAL
+GstVaapiDisplayBudget *
+gst_vaapi_display_get_budget (GstVaapiDisplay * display);
+
 /* Inline reference counting for core libgstvaapi library */
 #ifdef IN_LIBGSTVAAPI_CORE
 #define gst_vaapi_display_ref_internal(display) \
@@ -0,0 +1,340 @@
+/*
+ *  gstvaapidisplaybudget.c - VA display memory budget
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation; either version 2.1
+ *  of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free
+ *  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301 USA
+ */
+
+#include "sysdeps.h"
+#include "gstvaapidisplaybudget.h"
+#include "gstvaapivideopool_priv.h"
+#include "gstvaapiobject.h"
+
+#define DEBUG 1
+#include "gstvaapidebug.h"
+
+/* Owner name of the pools no element claimed */
+#define DEFAULT_OWNER "unknown"
+
+/* Maximum time an allocation waits for memory to be released, and
+   interval between two attempts at trimming idle pools meanwhile */
+#define BUDGET_WAIT_TIMEOUT     (2 * G_TIME_SPAN_SECOND)
+#define BUDGET_TRIM_INTERVAL    (50 * G_TIME_SPAN_MILLISECOND)
+
+/* Environment variable holding the default budget, in MiB */
+#define BUDGET_ENV_VAR "GST_VAAPI_SURFACE_BUDGET"
+
+/*
+ * Tracks the bytes held by all the video pools created on a VA
+ * display, per owner, and enforces an upper bound on them. When an
+ * allocation would overflow the budget, the free objects of the other
+ * pools are released first, from the least recently used pool on, and
+ * then the allocation waits for memory to be given back until
+ * BUDGET_WAIT_TIMEOUT expires.
+ *
+ * The budget lock is always taken before the pool locks.
+ */
+struct _GstVaapiDisplayBudget
+{
+  GMutex lock;
+  GCond cond;
+  guint64 max_bytes;
+  guint64 used_bytes;
+  GHashTable *owners;
+  GList *pools;
+};
+
+static inline const gchar *
+get_owner (GstVaapiVideoPool * pool)
+{
+  return pool->owner ? pool->owner : DEFAULT_OWNER;
+}
+
+static void
+account_unlocked (GstVaapiDisplayBudget * budget, GstVaapiVideoPool * pool,
+    gint64 bytes)
+{
+  const gchar *const owner = get_owner (pool);
+  guint64 *owner_bytes;
+
+  owner_bytes = g_hash_table_lookup (budget->owners, owner);
+  if (!owner_bytes) {
+    owner_bytes = g_new0 (guint64, 1);
+    g_hash_table_insert (budget->owners, g_strdup (owner), owner_bytes);
+  }
+
+  *owner_bytes += bytes;
+  pool->num_bytes += bytes;
+  budget->used_bytes += bytes;
+
+  if (*owner_bytes == 0)
+    g_hash_table_remove (budget->owners, owner);
+  if (bytes < 0)
+    g_cond_broadcast (&budget->cond);
+}
+
+static inline gboolean
+is_within_budget_unlocked (GstVaapiDisplayBudget * budget, gsize size)
+{
+  return budget->max_bytes == 0 ||
+      budget->used_bytes + size <= budget->max_bytes;
+}
+
+/* Orders pools from the least to the most recently used one. The
+   times wrap around, but pools are never idle for that long */
+static gint
+compare_last_used (gconstpointer a, gconstpointer b)
+{
+  const guint a_time = gst_vaapi_video_pool_get_last_used ((gpointer) a);
+  const guint b_time = gst_vaapi_video_pool_get_last_used ((gpointer) b);
+
+  return (gint) (a_time - b_time);
+}
+
+/* Releases the free objects of the pools other than @pool, the least
+   recently used pool first, until @size bytes more fit within the
+   budget */
+static void
+trim_pools_unlocked (GstVaapiDisplayBudget * budget, GstVaapiVideoPool * pool,
+    gsize size, GPtrArray * objects)
+{
+  GList *l;
+
+  budget->pools = g_list_sort (budget->pools, compare_last_used);
+  for (l = budget->pools; l != NULL; l = l->next) {
+    GstVaapiVideoPool *const other_pool = l->data;
+    guint64 excess_bytes;
+    guint num_objects;
+
+    if (is_within_budget_unlocked (budget, size))
+      break;
+    if (other_pool == pool || other_pool->object_size == 0)
+      continue;
+
+    excess_bytes = budget->used_bytes + size - budget->max_bytes;
+    num_objects = gst_vaapi_video_pool_steal_free_objects (other_pool,
+        (excess_bytes + other_pool->object_size - 1) /
+        other_pool->object_size, objects);
+    if (num_objects == 0)
+      continue;
+
+    GST_DEBUG ("released %u idle objects from pool %p (%s)", num_objects,
+        other_pool, get_owner (other_pool));
+    account_unlocked (budget, other_pool,
+        -(gint64) num_objects * other_pool->object_size);
+  }
+}
+
+static void
+dump_usage_unlocked (GstVaapiDisplayBudget * budget)
+{
+  GHashTableIter iter;
+  gpointer key, value;
+
+  g_hash_table_iter_init (&iter, budget->owners);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    GST_WARNING ("  %s: %" G_GUINT64_FORMAT " bytes", (const gchar *) key,
+        *(guint64 *) value);
+}
+
+GstVaapiDisplayBudget *
+gst_vaapi_display_budget_new (void)
+{
+  GstVaapiDisplayBudget *budget;
+  const gchar *env;
+
+  budget = g_slice_new0 (GstVaapiDisplayBudget);
+  if (!budget)
+    return NULL;
+
+  g_mutex_init (&budget->lock);
+  g_cond_init (&budget->cond);
+  budget->owners = g_hash_table_new_full (g_str_hash, g_str_equal,
+      g_free, g_free);
+
+  env = g_getenv (BUDGET_ENV_VAR);
+  if (env)
+    budget->max_bytes = g_ascii_strtoull (env, NULL, 10) << 20;
+  return budget;
+}
+
+void
+gst_vaapi_display_budget_free (GstVaapiDisplayBudget * budget)
+{
+  if (!budget)
+    return;
+
+  /* The pools all hold a reference to the display */
+  g_warn_if_fail (budget->pools == NULL);
+  g_list_free (budget->pools);
+  g_hash_table_unref (budget->owners);
+  g_cond_clear (&budget->cond);
+  g_mutex_clear (&budget->lock);
+  g_slice_free (GstVaapiDisplayBudget, budget);
+}
+
+void
+gst_vaapi_display_budget_set_max_bytes (GstVaapiDisplayBudget * budget,
+    guint64 max_bytes)
+{
+  g_mutex_lock (&budget->lock);
+  budget->max_bytes = max_bytes;
+  g_cond_broadcast (&budget->cond);
+  g_mutex_unlock (&budget->lock);
+}
+
+guint64
+gst_vaapi_display_budget_get_max_bytes (GstVaapiDisplayBudget * budget)
+{
+  guint64 max_bytes;
+
+  g_mutex_lock (&budget->lock);
+  max_bytes = budget->max_bytes;
+  g_mutex_unlock (&budget->lock);
+  return max_bytes;
+}
+
+/* Returns the bytes held by the pools of @owner, or by all the pools
+   if @owner is %NULL */
+guint64
+gst_vaapi_display_budget_get_usage (GstVaapiDisplayBudget * budget,
+    const gchar * owner)
+{
+  const guint64 *owner_bytes;
+  guint64 bytes;
+
+  g_mutex_lock (&budget->lock);
+  if (owner) {
+    owner_bytes = g_hash_table_lookup (budget->owners, owner);
+    bytes = owner_bytes ? *owner_bytes : 0;
+  } else
+    bytes = budget->used_bytes;
+  g_mutex_unlock (&budget->lock);
+  return bytes;
+}
+
+void
+gst_vaapi_display_budget_add_pool (GstVaapiDisplayBudget * budget,
+    GstVaapiVideoPool * pool)
+{
+  g_mutex_lock (&budget->lock);
+  budget->pools = g_list_prepend (budget->pools, pool);
+  g_mutex_unlock (&budget->lock);
+}
+
+/* Removes @pool and gives back all the bytes it was charged for */
+void
+gst_vaapi_display_budget_remove_pool (GstVaapiDisplayBudget * budget,
+    GstVaapiVideoPool * pool)
+{
+  g_mutex_lock (&budget->lock);
+  budget->pools = g_list_remove (budget->pools, pool);
+  if (pool->num_bytes > 0)
+    account_unlocked (budget, pool, -(gint64) pool->num_bytes);
+  g_mutex_unlock (&budget->lock);
+}
+
+/* Moves the bytes @pool was charged for to @owner */
+void
+gst_vaapi_display_budget_set_pool_owner (GstVaapiDisplayBudget * budget,
+    GstVaapiVideoPool * pool, const gchar * owner)
+{
+  guint64 num_bytes;
+
+  g_mutex_lock (&budget->lock);
+  num_bytes = pool->num_bytes;
+  if (g_strcmp0 (pool->owner, owner) != 0) {
+    if (num_bytes > 0)
+      account_unlocked (budget, pool, -(gint64) num_bytes);
+    g_free (pool->owner);
+    pool->owner = g_strdup (owner);
+    if (num_bytes > 0)
+      account_unlocked (budget, pool, num_bytes);
+  }
+  g_mutex_unlock (&budget->lock);
+}
+
+/* Charges @pool for @size bytes, once they fit within the budget.
+   Returns %FALSE if they still don't after BUDGET_WAIT_TIMEOUT */
+gboolean
+gst_vaapi_display_budget_acquire (GstVaapiDisplayBudget * budget,
+    GstVaapiVideoPool * pool, gsize size)
+{
+  GPtrArray *objects = NULL;
+  gint64 now, end_time = 0;
+  gboolean success = TRUE;
+
+  g_mutex_lock (&budget->lock);
+  while (!is_within_budget_unlocked (budget, size)) {
+    if (!objects)
+      objects = g_ptr_array_new_with_free_func (gst_vaapi_object_unref);
+    trim_pools_unlocked (budget, pool, size, objects);
+    if (objects->len > 0) {
+      /* Destroy the released objects before allocating anew */
+      g_mutex_unlock (&budget->lock);
+      g_ptr_array_set_size (objects, 0);
+      g_mutex_lock (&budget->lock);
+      continue;
+    }
+
+    now = g_get_monotonic_time ();
+    if (!end_time) {
+      GST_INFO ("pool %p (%s) waits for %" G_GSIZE_FORMAT " bytes", pool,
+          get_owner (pool), size);
+      end_time = now + BUDGET_WAIT_TIMEOUT;
+    } else if (now >= end_time) {
+      success = FALSE;
+      break;
+    }
+    g_cond_wait_until (&budget->cond, &budget->lock,
+        MIN (end_time, now + BUDGET_TRIM_INTERVAL));
+  }
+
+  if (success)
+    account_unlocked (budget, pool, size);
+  else {
+    GST_WARNING ("pool %p (%s) exceeds budget of %" G_GUINT64_FORMAT
+        " bytes, in use:", pool, get_owner (pool), budget->max_bytes);
+    dump_usage_unlocked (budget);
+  }
+  g_mutex_unlock (&budget->lock);
+
+  if (objects)
+    g_ptr_array_unref (objects);
+  return success;
+}
+
+/* Moves @size bytes @pool was charged for to @dst_pool, without
+   waiting since no memory is allocated */
+void
+gst_vaapi_display_budget_transfer (GstVaapiDisplayBudget * budget,
+    GstVaapiVideoPool * pool, GstVaapiVideoPool * dst_pool, gsize size)
+{
+  g_mutex_lock (&budget->lock);
+  account_unlocked (budget, pool, -(gint64) size);
+  account_unlocked (budget, dst_pool, size);
+  g_mutex_unlock (&budget->lock);
+}
+
+void
+gst_vaapi_display_budget_release (GstVaapiDisplayBudget * budget,
+    GstVaapiVideoPool * pool, gsize size)
+{
+  g_mutex_lock (&budget->lock);
+  account_unlocked (budget, pool, -(gint64) size);
+  g_mutex_unlock (&budget->lock);
+}
@@ -0,0 +1,86 @@
+/*
+ *  gstvaapidisplaybudget.h - VA display memory budget
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation; either version 2.1
+ *  of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free
+ *  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301 USA
+ */
+
+#ifndef GST_VAAPI_DISPLAY_BUDGET_H
+#define GST_VAAPI_DISPLAY_BUDGET_H
+
+#include "libgstvaapi_priv_check.h"
+#include <gst/vaapi/gstvaapivideopool.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GstVaapiDisplayBudget GstVaapiDisplayBudget;
+
+G_GNUC_INTERNAL
+GstVaapiDisplayBudget *
+gst_vaapi_display_budget_new (void);
+
+G_GNUC_INTERNAL
+void
+gst_vaapi_display_budget_free (GstVaapiDisplayBudget * budget);
+
+G_GNUC_INTERNAL
+void
+gst_vaapi_display_budget_set_max_bytes (GstVaapiDisplayBudget * budget,
+    guint64 max_bytes);
+
+G_GNUC_INTERNAL
+guint64
+gst_vaapi_display_budget_get_max_bytes (GstVaapiDisplayBudget * budget);
+
+G_GNUC_INTERNAL
+guint64
+gst_vaapi_display_budget_get_usage (GstVaapiDisplayBudget * budget,
+    const gchar * owner);
+
+G_GNUC_INTERNAL
+void
+gst_vaapi_display_budget_add_pool (GstVaapiDisplayBudget * budget,
+    GstVaapiVideoPool * pool);
+
+G_GNUC_INTERNAL
+void
+gst_vaapi_display_budget_remove_pool (GstVaapiDisplayBudget * budget,
+    GstVaapiVideoPool * pool);
+
+G_GNUC_INTERNAL
+void
+gst_vaapi_display_budget_set_pool_owner (GstVaapiDisplayBudget * budget,
+    GstVaapiVideoPool * pool, const gchar * owner);
+
+G_GNUC_INTERNAL
+gboolean
+gst_vaapi_display_budget_acquire (GstVaapiDisplayBudget * budget,
+    GstVaapiVideoPool * pool, gsize size);
+
+G_GNUC_INTERNAL
+void
+gst_vaapi_display_budget_transfer (GstVaapiDisplayBudget * budget,
+    GstVaapiVideoPool * pool, GstVaapiVideoPool * dst_pool, gsize size);
+
+G_GNUC_INTERNAL
+void
+gst_vaapi_display_budget_release (GstVaapiDisplayBudget * budget,
+    GstVaapiVideoPool * pool, gsize size);
+
+G_END_DECLS
+
+#endif /* GST_VAAPI_DISPLAY_BUDGET_H */
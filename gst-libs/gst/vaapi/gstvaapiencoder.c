@@ -169,6 +169,35 @@ gst_vaapi_encoder_properties_get_default (const GstVaapiEncoderClass * klass)
           cdata->encoder_tune_get_type (), cdata->default_encoder_tune,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  if (cdata->rate_control_mask & GST_VAAPI_RATECONTROL_MASK (LOOKAHEAD)) {
+    /**
+     * GstVaapiEncoder:lookahead-depth:
+     *
+     * The number of frames analyzed ahead of the one being encoded,
+     * when the lookahead rate control mode is selected.
+     */
+    GST_VAAPI_ENCODER_PROPERTIES_APPEND (props,
+        GST_VAAPI_ENCODER_PROP_LOOKAHEAD_DEPTH,
+        g_param_spec_uint ("lookahead-depth",
+            "Lookahead Depth",
+            "Number of frames analyzed ahead by the lookahead rate control",
+            1, 60, 10, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  }
+
+  /**
+   * GstVaapiEncoder:async-depth:
+   *
+   * The maximal number of pictures submitted to the hardware whose
+   * coded buffer was not retrieved yet. The coded buffer pool is
+   * sized after it, one coded buffer per picture in flight.
+   */
+  GST_VAAPI_ENCODER_PROPERTIES_APPEND (props,
+      GST_VAAPI_ENCODER_PROP_ASYNC_DEPTH,
+      g_param_spec_uint ("async-depth",
+          "Async Depth",
+          "Maximal number of pictures being encoded at a time",
+          1, 16, 4, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   return props;
 }
 
@@ -285,19 +314,23 @@ gst_vaapi_encoder_create_surface (GstVaapiEncoder * encoder)
   return proxy;
 }
 
-/**
- * gst_vaapi_encoder_put_frame:
- * @encoder: a #GstVaapiEncoder
- * @frame: a #GstVideoCodecFrame
- *
- * Queues a #GstVideoCodedFrame to the HW encoder. The encoder holds
- * an extra reference to the @frame.
- *
- * Return value: a #GstVaapiEncoderStatus
- */
-GstVaapiEncoderStatus
-gst_vaapi_encoder_put_frame (GstVaapiEncoder * encoder,
-    GstVideoCodecFrame * frame)
+/* Waits until fewer than async-depth pictures are in flight, or the
+   encoder is flushing. This is checked before any coded buffer or
+   reconstructed surface is allocated for the next picture, so that
+   the submission thread never blocks while holding VA resources */
+static void
+wait_for_submission_slot (GstVaapiEncoder * encoder)
+{
+  g_mutex_lock (&encoder->mutex);
+  while (encoder->num_codedbuf_queued >= encoder->async_depth &&
+      !encoder->codedbuf_flushing)
+    g_cond_wait (&encoder->picture_done, &encoder->mutex);
+  g_mutex_unlock (&encoder->mutex);
+}
+
+/* Submits a frame, and any pending reordered frame, to the HW encoder */
+static GstVaapiEncoderStatus
+submit_frame (GstVaapiEncoder * encoder, GstVideoCodecFrame * frame)
 {
   GstVaapiEncoderClass *const klass = GST_VAAPI_ENCODER_GET_CLASS (encoder);
   GstVaapiEncoderStatus status;
@@ -312,6 +345,7 @@ gst_vaapi_encoder_put_frame (GstVaapiEncoder * encoder,
     if (status != GST_VAAPI_ENCODER_STATUS_SUCCESS)
       goto error_reorder_frame;
 
+    wait_for_submission_slot (encoder);
     codedbuf_proxy = gst_vaapi_encoder_create_coded_buffer (encoder);
     if (!codedbuf_proxy)
       goto error_create_coded_buffer;
@@ -320,10 +354,16 @@ gst_vaapi_encoder_put_frame (GstVaapiEncoder * encoder,
     if (status != GST_VAAPI_ENCODER_STATUS_SUCCESS)
       goto error_encode;
 
+    picture->submit_time = g_get_monotonic_time ();
     gst_vaapi_coded_buffer_proxy_set_user_data (codedbuf_proxy,
         picture, (GDestroyNotify) gst_vaapi_mini_object_unref);
-    g_async_queue_push (encoder->codedbuf_queue, codedbuf_proxy);
+
+    /* Wake up any thread waiting in get_buffer_with_timeout() */
+    g_mutex_lock (&encoder->mutex);
+    g_queue_push_tail (&encoder->codedbuf_queue, codedbuf_proxy);
     encoder->num_codedbuf_queued++;
+    g_cond_signal (&encoder->codedbuf_ready);
+    g_mutex_unlock (&encoder->mutex);
 
     /* Try again with any pending reordered frame now available for encoding */
     frame = NULL;
@@ -351,6 +391,215 @@ error_encode:
   }
 }
 
+/**
+ * gst_vaapi_encoder_put_frame:
+ * @encoder: a #GstVaapiEncoder
+ * @frame: a #GstVideoCodecFrame
+ *
+ * Queues a #GstVideoCodedFrame to the HW encoder. The encoder holds
+ * an extra reference to the @frame.
+ *
+ * With the lookahead rate control, the @frame is first analyzed and
+ * buffered, and only submitted to the HW encoder once enough frames
+ * were queued after it.
+ *
+ * This function blocks while the maximal number of pictures in flight
+ * is reached (see gst_vaapi_encoder_set_async_depth()), until a coded
+ * buffer is retrieved or the @encoder is set to flushing.
+ *
+ * Return value: a #GstVaapiEncoderStatus
+ */
+GstVaapiEncoderStatus
+gst_vaapi_encoder_put_frame (GstVaapiEncoder * encoder,
+    GstVideoCodecFrame * frame)
+{
+  GstVaapiSurfaceProxy *proxy;
+  GstVaapiEncoderStatus status;
+
+  if (!encoder->lookahead)
+    return submit_frame (encoder, frame);
+
+  proxy = gst_video_codec_frame_get_user_data (frame);
+  if (!gst_vaapi_enc_lookahead_push (encoder->lookahead, frame,
+          proxy ? GST_VAAPI_SURFACE_PROXY_SURFACE (proxy) : NULL))
+    return GST_VAAPI_ENCODER_STATUS_ERROR_ALLOCATION_FAILED;
+
+  frame = gst_vaapi_enc_lookahead_pop (encoder->lookahead, FALSE);
+  if (!frame)
+    return GST_VAAPI_ENCODER_STATUS_SUCCESS;
+
+  status = submit_frame (encoder, frame);
+  gst_video_codec_frame_unref (frame);
+  return status;
+}
+
+/* Checks whether frames are queued, either in the lookahead window or
+   as coded buffers not retrieved yet */
+static gboolean
+has_pending_frames (GstVaapiEncoder * encoder)
+{
+  guint num_codedbuf_queued;
+
+  g_mutex_lock (&encoder->mutex);
+  num_codedbuf_queued = encoder->num_codedbuf_queued;
+  g_mutex_unlock (&encoder->mutex);
+
+  return num_codedbuf_queued > 0 || (encoder->lookahead &&
+      gst_vaapi_enc_lookahead_get_length (encoder->lookahead) > 0);
+}
+
+/* Submits all the frames buffered in the lookahead window */
+static GstVaapiEncoderStatus
+drain_lookahead (GstVaapiEncoder * encoder)
+{
+  GstVaapiEncoderStatus status;
+  GstVideoCodecFrame *frame;
+
+  while (encoder->lookahead &&
+      (frame = gst_vaapi_enc_lookahead_pop (encoder->lookahead, TRUE))) {
+    status = submit_frame (encoder, frame);
+    gst_video_codec_frame_unref (frame);
+    if (status != GST_VAAPI_ENCODER_STATUS_SUCCESS)
+      return status;
+  }
+  return GST_VAAPI_ENCODER_STATUS_SUCCESS;
+}
+
+/* Returns the QP decided by the lookahead rate control for @frame */
+guint
+gst_vaapi_encoder_get_lookahead_qp (GstVaapiEncoder * encoder,
+    GstVideoCodecFrame * frame, gboolean is_intra, guint qp_init,
+    guint qp_min, guint qp_max)
+{
+  if (!encoder->lookahead || !frame)
+    return qp_init;
+  return gst_vaapi_enc_lookahead_get_qp (encoder->lookahead, frame, is_intra,
+      qp_init, qp_min, qp_max);
+}
+
+/* Checks whether @frame starts a new scene. The analysis made by the
+   lookahead rate control is reused if any, so that @surface is only
+   read back once */
+gboolean
+gst_vaapi_encoder_detect_scene_cut (GstVaapiEncoder * encoder,
+    GstVaapiEncSceneCut * scene_cut, GstVideoCodecFrame * frame,
+    GstVaapiSurface * surface)
+{
+  guint64 intra_cost, inter_cost;
+  gdouble histogram_diff;
+
+  if (!encoder->lookahead || !frame)
+    return gst_vaapi_enc_scene_cut_detect (scene_cut, surface);
+
+  if (!gst_vaapi_enc_lookahead_get_costs (encoder->lookahead, frame,
+          &intra_cost, &inter_cost, &histogram_diff)) {
+    /* First frame, or the previous one could not be analyzed */
+    gst_vaapi_enc_scene_cut_reset (scene_cut);
+    return FALSE;
+  }
+  return gst_vaapi_enc_scene_cut_update (scene_cut, intra_cost, inter_cost,
+      histogram_diff);
+}
+
+/* Waits for the coded buffer queue to be non-empty, at most until
+   end_time (monotonic time), or forever if end_time is -1. Returns
+   the oldest queued coded buffer, or NULL */
+static GstVaapiCodedBufferProxy *
+pop_coded_buffer (GstVaapiEncoder * encoder, gint64 end_time)
+{
+  GstVaapiCodedBufferProxy *codedbuf_proxy;
+
+  g_mutex_lock (&encoder->mutex);
+  while (g_queue_is_empty (&encoder->codedbuf_queue)) {
+    if (encoder->codedbuf_flushing)
+      break;
+    if (end_time < 0)
+      g_cond_wait (&encoder->codedbuf_ready, &encoder->mutex);
+    else if (!g_cond_wait_until (&encoder->codedbuf_ready, &encoder->mutex,
+            end_time))
+      break;
+  }
+  codedbuf_proxy = g_queue_pop_head (&encoder->codedbuf_queue);
+  g_mutex_unlock (&encoder->mutex);
+  return codedbuf_proxy;
+}
+
+/* Polling interval bounds for vaQuerySurfaceStatus(), in microseconds */
+#define POLL_DELAY_MIN 50
+#define POLL_DELAY_MAX 2000
+
+/* Releases the submission slot held by a picture, once its coded
+   buffer is complete */
+static void
+release_submission_slot (GstVaapiEncoder * encoder)
+{
+  g_mutex_lock (&encoder->mutex);
+  g_assert (encoder->num_codedbuf_queued > 0);
+  encoder->num_codedbuf_queued--;
+  g_cond_signal (&encoder->picture_done);
+  g_mutex_unlock (&encoder->mutex);
+}
+
+/* Waits for the encoded picture to be ready. In polling mode, the
+   surface status is queried with an exponential backoff, starting
+   from the earliest completion time observed so far. This does not
+   hold the display lock while the hardware is busy, and other threads
+   can submit new pictures in the meantime */
+static gboolean
+wait_for_completion (GstVaapiEncoder * encoder, GstVaapiEncPicture * picture)
+{
+  GstVaapiSurfaceStatus surface_status;
+  gint64 now, expected_time;
+  gulong delay;
+
+  if (!encoder->completion_polling)
+    return gst_vaapi_surface_sync (picture->surface);
+
+  g_mutex_lock (&encoder->mutex);
+  expected_time = picture->submit_time;
+  if (encoder->stats_num_frames > 0)
+    expected_time += encoder->stats_latency_min / GST_USECOND;
+  g_mutex_unlock (&encoder->mutex);
+
+  now = g_get_monotonic_time ();
+  if (expected_time > now)
+    g_usleep (expected_time - now);
+
+  delay = POLL_DELAY_MIN;
+  for (;;) {
+    if (!gst_vaapi_surface_query_status (picture->surface, &surface_status))
+      break;
+    if (!(surface_status & GST_VAAPI_SURFACE_STATUS_RENDERING))
+      break;
+    g_usleep (delay);
+    delay = MIN (delay * 2, POLL_DELAY_MAX);
+  }
+
+  /* Synchronize anyway so that any encoding error gets reported */
+  return gst_vaapi_surface_sync (picture->surface);
+}
+
+static void
+update_stats (GstVaapiEncoder * encoder, GstVaapiEncPicture * picture)
+{
+  const GstClockTime latency =
+      (g_get_monotonic_time () - picture->submit_time) * GST_USECOND;
+
+  g_mutex_lock (&encoder->mutex);
+  if (encoder->stats_num_frames == 0 || latency < encoder->stats_latency_min)
+    encoder->stats_latency_min = latency;
+  if (latency > encoder->stats_latency_max)
+    encoder->stats_latency_max = latency;
+  encoder->stats_latency_last = latency;
+  encoder->stats_latency_total += latency;
+  encoder->stats_num_frames++;
+  g_mutex_unlock (&encoder->mutex);
+
+  GST_LOG ("frame %u encoded in %" GST_TIME_FORMAT,
+      picture->frame ? picture->frame->system_frame_number : 0,
+      GST_TIME_ARGS (latency));
+}
+
 /**
  * gst_vaapi_encoder_get_buffer_with_timeout:
  * @encoder: a #GstVaapiEncoder
@@ -361,7 +610,12 @@ error_encode:
  * coded buffer as a #GstVaapiCodedBufferProxy. The caller owns this
  * object, so gst_vaapi_coded_buffer_proxy_unref() shall be called
  * after usage. Otherwise, @GST_VAAPI_DECODER_STATUS_ERROR_NO_BUFFER
- * is returned if no coded buffer is available so far (timeout).
+ * is returned if no coded buffer is available so far (timeout), or if
+ * the @encoder is flushing (see gst_vaapi_encoder_set_flushing()).
+ *
+ * The calling thread is woken up as soon as a coded buffer is
+ * queued. A @timeout of %G_MAXUINT64 waits until a coded buffer is
+ * available or the @encoder is set to flushing.
  *
  * The parent frame is available as a #GstVideoCodecFrame attached to
  * the user-data anchor of the output coded buffer. Ownership of the
@@ -375,15 +629,29 @@ gst_vaapi_encoder_get_buffer_with_timeout (GstVaapiEncoder * encoder,
 {
   GstVaapiEncPicture *picture;
   GstVaapiCodedBufferProxy *codedbuf_proxy;
+  gint64 end_time;
+  gboolean success;
+
+  if (timeout == G_MAXUINT64)
+    end_time = -1;
+  else
+    end_time = g_get_monotonic_time () + MIN (timeout, G_MAXINT32);
 
-  codedbuf_proxy = g_async_queue_timeout_pop (encoder->codedbuf_queue, timeout);
+  codedbuf_proxy = pop_coded_buffer (encoder, end_time);
   if (!codedbuf_proxy)
     return GST_VAAPI_ENCODER_STATUS_NO_BUFFER;
 
   /* Wait for completion of all operations and report any error that occurred */
   picture = gst_vaapi_coded_buffer_proxy_get_user_data (codedbuf_proxy);
-  if (!gst_vaapi_surface_sync (picture->surface))
+  success = wait_for_completion (encoder, picture);
+  release_submission_slot (encoder);
+  if (!success)
     goto error_invalid_buffer;
+  update_stats (encoder, picture);
+
+  if (encoder->lookahead)
+    gst_vaapi_enc_lookahead_update (encoder->lookahead, picture->frame,
+        gst_vaapi_coded_buffer_proxy_get_buffer_size (codedbuf_proxy) * 8);
 
   gst_vaapi_coded_buffer_proxy_set_user_data (codedbuf_proxy,
       gst_video_codec_frame_ref (picture->frame),
@@ -403,6 +671,94 @@ error_invalid_buffer:
   }
 }
 
+/**
+ * gst_vaapi_encoder_set_flushing:
+ * @encoder: a #GstVaapiEncoder
+ * @flushing: %TRUE to unblock waiters
+ *
+ * When @flushing is %TRUE, any thread waiting in
+ * gst_vaapi_encoder_get_buffer_with_timeout() is woken up, and
+ * subsequent calls return immediately if no coded buffer is queued,
+ * until this function is called again with @flushing set to %FALSE.
+ */
+void
+gst_vaapi_encoder_set_flushing (GstVaapiEncoder * encoder, gboolean flushing)
+{
+  g_return_if_fail (encoder != NULL);
+
+  g_mutex_lock (&encoder->mutex);
+  encoder->codedbuf_flushing = flushing;
+  g_cond_broadcast (&encoder->codedbuf_ready);
+  g_cond_broadcast (&encoder->picture_done);
+  g_mutex_unlock (&encoder->mutex);
+}
+
+/**
+ * gst_vaapi_encoder_set_completion_polling:
+ * @encoder: a #GstVaapiEncoder
+ * @enable: %TRUE to poll for encoded pictures completion
+ *
+ * Selects how gst_vaapi_encoder_get_buffer_with_timeout() waits for
+ * the hardware to complete an encoded picture. By default, the call
+ * blocks in vaSyncSurface(). When @enable is %TRUE, the surface
+ * status is polled with an adaptive backoff instead, so that the
+ * VA display is not locked while the hardware is busy.
+ */
+void
+gst_vaapi_encoder_set_completion_polling (GstVaapiEncoder * encoder,
+    gboolean enable)
+{
+  g_return_if_fail (encoder != NULL);
+
+  encoder->completion_polling = enable;
+}
+
+/**
+ * gst_vaapi_encoder_get_stats:
+ * @encoder: a #GstVaapiEncoder
+ * @stats: return location for the #GstVaapiEncoderStats
+ *
+ * Fills in @stats with the encode latency statistics accumulated
+ * since @encoder was created.
+ */
+void
+gst_vaapi_encoder_get_stats (GstVaapiEncoder * encoder,
+    GstVaapiEncoderStats * stats)
+{
+  g_return_if_fail (encoder != NULL);
+  g_return_if_fail (stats != NULL);
+
+  g_mutex_lock (&encoder->mutex);
+  stats->num_frames = encoder->stats_num_frames;
+  stats->latency_last = encoder->stats_latency_last;
+  stats->latency_min = encoder->stats_latency_min;
+  stats->latency_max = encoder->stats_latency_max;
+  stats->latency_avg = encoder->stats_num_frames > 0 ?
+      encoder->stats_latency_total / encoder->stats_num_frames : 0;
+  g_mutex_unlock (&encoder->mutex);
+}
+
+/**
+ * gst_vaapi_encoder_set_owner:
+ * @encoder: a #GstVaapiEncoder
+ * @owner: (allow-none): the name of the owner, e.g. an element name
+ *
+ * Labels the surfaces allocated for the VA context of the @encoder
+ * with @owner, so that their memory can be monitored through
+ * gst_vaapi_display_get_surface_usage().
+ */
+void
+gst_vaapi_encoder_set_owner (GstVaapiEncoder * encoder, const gchar * owner)
+{
+  g_return_if_fail (encoder != NULL);
+
+  g_free (encoder->owner);
+  encoder->owner = g_strdup (owner);
+
+  if (encoder->context && encoder->context->surfaces_pool)
+    gst_vaapi_video_pool_set_owner (encoder->context->surfaces_pool, owner);
+}
+
 /**
  * gst_vaapi_encoder_flush:
  * @encoder: a #GstVaapiEncoder
@@ -415,6 +771,12 @@ GstVaapiEncoderStatus
 gst_vaapi_encoder_flush (GstVaapiEncoder * encoder)
 {
   GstVaapiEncoderClass *const klass = GST_VAAPI_ENCODER_GET_CLASS (encoder);
+  GstVaapiEncoderStatus status;
+
+  /* Drain the lookahead window first */
+  status = drain_lookahead (encoder);
+  if (status != GST_VAAPI_ENCODER_STATUS_SUCCESS)
+    return status;
 
   return klass->flush (encoder);
 }
@@ -646,6 +1008,10 @@ gst_vaapi_encoder_ensure_context (GstVaapiEncoder * encoder)
       return FALSE;
   }
   encoder->va_context = gst_vaapi_context_get_id (encoder->context);
+
+  if (encoder->owner && encoder->context->surfaces_pool)
+    gst_vaapi_video_pool_set_owner (encoder->context->surfaces_pool,
+        encoder->owner);
   return TRUE;
 }
 
@@ -670,6 +1036,16 @@ gst_vaapi_encoder_reconfigure_internal (GstVaapiEncoder * encoder)
   if (!gst_vaapi_encoder_ensure_context (encoder))
     goto error_reset_context;
 
+  /* The bitrate may have been computed by the subclass at this point */
+  gst_vaapi_enc_lookahead_free (encoder->lookahead);
+  encoder->lookahead = NULL;
+  if (encoder->rate_control == GST_VAAPI_RATECONTROL_LOOKAHEAD) {
+    encoder->lookahead =
+        gst_vaapi_enc_lookahead_new (encoder->lookahead_depth);
+    gst_vaapi_enc_lookahead_set_target (encoder->lookahead,
+        encoder->bitrate * 1000, vip->fps_n, vip->fps_d);
+  }
+
   codedbuf_size = encoder->codedbuf_pool ?
       gst_vaapi_coded_buffer_pool_get_buffer_size (GST_VAAPI_CODED_BUFFER_POOL
       (encoder)) : 0;
@@ -677,10 +1053,14 @@ gst_vaapi_encoder_reconfigure_internal (GstVaapiEncoder * encoder)
     pool = gst_vaapi_coded_buffer_pool_new (encoder, encoder->codedbuf_size);
     if (!pool)
       goto error_alloc_codedbuf_pool;
-    gst_vaapi_video_pool_set_capacity (pool, 5);
     gst_vaapi_video_pool_replace (&encoder->codedbuf_pool, pool);
     gst_vaapi_video_pool_unref (pool);
   }
+
+  /* One coded buffer per picture in flight, plus the one being
+     output downstream */
+  gst_vaapi_video_pool_set_capacity (encoder->codedbuf_pool,
+      encoder->async_depth + 1);
   return GST_VAAPI_ENCODER_STATUS_SUCCESS;
 
   /* ERRORS */
@@ -723,7 +1103,8 @@ gst_vaapi_encoder_set_codec_state (GstVaapiEncoder * encoder,
   g_return_val_if_fail (state != NULL,
       GST_VAAPI_ENCODER_STATUS_ERROR_INVALID_PARAMETER);
 
-  if (encoder->num_codedbuf_queued > 0)
+  /* The lookahead window is rebuilt, so it must not hold any frame */
+  if (has_pending_frames (encoder))
     goto error_operation_failed;
 
   if (!gst_video_info_is_equal (&state->info, &encoder->video_info)) {
@@ -767,7 +1148,7 @@ set_property (GstVaapiEncoder * encoder, gint prop_id, const GValue * value)
     GstVaapiEncoderClass *const klass = GST_VAAPI_ENCODER_GET_CLASS (encoder);
 
     if (klass->set_property) {
-      if (encoder->num_codedbuf_queued > 0)
+      if (has_pending_frames (encoder))
         goto error_operation_failed;
       status = klass->set_property (encoder, prop_id, value);
     }
@@ -791,6 +1172,14 @@ set_property (GstVaapiEncoder * encoder, gint prop_id, const GValue * value)
     case GST_VAAPI_ENCODER_PROP_TUNE:
       status = gst_vaapi_encoder_set_tuning (encoder, g_value_get_enum (value));
       break;
+    case GST_VAAPI_ENCODER_PROP_LOOKAHEAD_DEPTH:
+      status = gst_vaapi_encoder_set_lookahead_depth (encoder,
+          g_value_get_uint (value));
+      break;
+    case GST_VAAPI_ENCODER_PROP_ASYNC_DEPTH:
+      status = gst_vaapi_encoder_set_async_depth (encoder,
+          g_value_get_uint (value));
+      break;
   }
   return status;
 
@@ -854,6 +1243,9 @@ get_rate_control_mask (GstVaapiEncoder * encoder)
       rate_control_mask |= 1 << to_GstVaapiRateControl (1 << i);
     }
   }
+  /* The lookahead rate control only needs constant QP from the driver */
+  if (rate_control_mask & GST_VAAPI_RATECONTROL_MASK (CQP))
+    rate_control_mask |= GST_VAAPI_RATECONTROL_MASK (LOOKAHEAD);
   GST_INFO ("supported rate controls: 0x%08x", rate_control_mask);
 
   encoder->got_rate_control_mask = TRUE;
@@ -872,10 +1264,13 @@ get_rate_control_mask (GstVaapiEncoder * encoder)
  * then @GST_VAAPI_ENCODER_STATUS_ERROR_UNSUPPORTED_RATE_CONTROL is
  * returned.
  *
- * The rate control mode can only be specified before the first frame
- * is to be encoded. Afterwards, any change to this parameter is
- * invalid and @GST_VAAPI_ENCODER_STATUS_ERROR_OPERATION_FAILED is
- * returned.
+ * The rate control mode can only be specified while the @encoder holds
+ * no frame, i.e. before the first frame is encoded, or once all the
+ * coded buffers were retrieved after gst_vaapi_encoder_flush(). The
+ * change takes effect on the next call to
+ * gst_vaapi_encoder_set_codec_state(). Otherwise, any change to this
+ * parameter is invalid and
+ * @GST_VAAPI_ENCODER_STATUS_ERROR_OPERATION_FAILED is returned.
  *
  * Return value: a #GstVaapiEncoderStatus
  */
@@ -888,7 +1283,8 @@ gst_vaapi_encoder_set_rate_control (GstVaapiEncoder * encoder,
   g_return_val_if_fail (encoder != NULL,
       GST_VAAPI_ENCODER_STATUS_ERROR_INVALID_PARAMETER);
 
-  if (encoder->rate_control != rate_control && encoder->num_codedbuf_queued > 0)
+  if (encoder->rate_control != rate_control &&
+      has_pending_frames (encoder))
     goto error_operation_failed;
 
   rate_control_mask = get_rate_control_mask (encoder);
@@ -918,10 +1314,11 @@ error_unsupported_rate_control:
  *
  * Notifies the @encoder to use the supplied @bitrate value.
  *
- * Note: currently, the bitrate can only be specified before the first
- * frame is encoded. Afterwards, any change to this parameter is
- * invalid and @GST_VAAPI_ENCODER_STATUS_ERROR_OPERATION_FAILED is
- * returned.
+ * Note: currently, the bitrate can only be specified while the
+ * @encoder holds no frame, and takes effect on the next call to
+ * gst_vaapi_encoder_set_codec_state(). Otherwise, any change to this
+ * parameter is invalid and
+ * @GST_VAAPI_ENCODER_STATUS_ERROR_OPERATION_FAILED is returned.
  *
  * Return value: a #GstVaapiEncoderStatus
  */
@@ -930,7 +1327,7 @@ gst_vaapi_encoder_set_bitrate (GstVaapiEncoder * encoder, guint bitrate)
 {
   g_return_val_if_fail (encoder != NULL, 0);
 
-  if (encoder->bitrate != bitrate && encoder->num_codedbuf_queued > 0)
+  if (encoder->bitrate != bitrate && has_pending_frames (encoder))
     goto error_operation_failed;
 
   encoder->bitrate = bitrate;
@@ -952,9 +1349,9 @@ error_operation_failed:
  * Notifies the @encoder to use the supplied @keyframe_period value.
  *
  * Note: currently, the keyframe period can only be specified before
- * the last call to gst_vaapi_encoder_set_codec_state(), which shall
- * occur before the first frame is encoded. Afterwards, any change to
- * this parameter causes gst_vaapi_encoder_set_keyframe_period() to
+ * the last call to gst_vaapi_encoder_set_codec_state(), while the
+ * @encoder holds no frame. Otherwise, any change to this parameter
+ * causes gst_vaapi_encoder_set_keyframe_period() to
  * return @GST_VAAPI_ENCODER_STATUS_ERROR_OPERATION_FAILED.
  *
  * Return value: a #GstVaapiEncoderStatus
@@ -966,7 +1363,7 @@ gst_vaapi_encoder_set_keyframe_period (GstVaapiEncoder * encoder,
   g_return_val_if_fail (encoder != NULL, 0);
 
   if (encoder->keyframe_period != keyframe_period
-      && encoder->num_codedbuf_queued > 0)
+      && has_pending_frames (encoder))
     goto error_operation_failed;
 
   encoder->keyframe_period = keyframe_period;
@@ -988,9 +1385,9 @@ error_operation_failed:
  * Notifies the @encoder to use the supplied @tuning option.
  *
  * Note: currently, the tuning option can only be specified before the
- * last call to gst_vaapi_encoder_set_codec_state(), which shall occur
- * before the first frame is encoded. Afterwards, any change to this
- * parameter causes gst_vaapi_encoder_set_tuning() to return
+ * last call to gst_vaapi_encoder_set_codec_state(), while the @encoder
+ * holds no frame. Otherwise, any change to this parameter causes
+ * gst_vaapi_encoder_set_tuning() to return
  * @GST_VAAPI_ENCODER_STATUS_ERROR_OPERATION_FAILED.
  *
  * Return value: a #GstVaapiEncoderStatus
@@ -1001,7 +1398,7 @@ gst_vaapi_encoder_set_tuning (GstVaapiEncoder * encoder,
 {
   g_return_val_if_fail (encoder != NULL, 0);
 
-  if (encoder->tune != tuning && encoder->num_codedbuf_queued > 0)
+  if (encoder->tune != tuning && has_pending_frames (encoder))
     goto error_operation_failed;
 
   encoder->tune = tuning;
@@ -1015,6 +1412,81 @@ error_operation_failed:
   }
 }
 
+/**
+ * gst_vaapi_encoder_set_lookahead_depth:
+ * @encoder: a #GstVaapiEncoder
+ * @depth: the number of frames to analyze ahead
+ *
+ * Notifies the @encoder to buffer and analyze @depth frames ahead of
+ * the frame being encoded, when the lookahead rate control is used.
+ * Larger values give better bit allocation decisions at the expense
+ * of latency and memory, since the input surfaces of the frames in
+ * the lookahead window are held by the @encoder.
+ *
+ * Note: the lookahead depth can only be specified while the @encoder
+ * holds no frame. Otherwise, any change to this parameter causes
+ * gst_vaapi_encoder_set_lookahead_depth() to return
+ * @GST_VAAPI_ENCODER_STATUS_ERROR_OPERATION_FAILED.
+ *
+ * Return value: a #GstVaapiEncoderStatus
+ */
+GstVaapiEncoderStatus
+gst_vaapi_encoder_set_lookahead_depth (GstVaapiEncoder * encoder, guint depth)
+{
+  g_return_val_if_fail (encoder != NULL, 0);
+
+  if (encoder->lookahead_depth != depth && has_pending_frames (encoder))
+    goto error_operation_failed;
+
+  encoder->lookahead_depth = depth;
+  return GST_VAAPI_ENCODER_STATUS_SUCCESS;
+
+  /* ERRORS */
+error_operation_failed:
+  {
+    GST_ERROR ("could not change lookahead depth after encoding started");
+    return GST_VAAPI_ENCODER_STATUS_ERROR_OPERATION_FAILED;
+  }
+}
+
+/**
+ * gst_vaapi_encoder_set_async_depth:
+ * @encoder: a #GstVaapiEncoder
+ * @depth: the maximal number of pictures in flight
+ *
+ * Sets the maximal number of pictures that can be submitted to the
+ * hardware before the oldest one is retrieved with
+ * gst_vaapi_encoder_get_buffer_with_timeout().
+ * gst_vaapi_encoder_put_frame() blocks while that limit is reached.
+ *
+ * This option can only be set while the @encoder holds no frame.
+ * Otherwise, it will cause
+ * gst_vaapi_encoder_set_async_depth() to return
+ * @GST_VAAPI_ENCODER_STATUS_ERROR_OPERATION_FAILED.
+ *
+ * Return value: a #GstVaapiEncoderStatus
+ */
+GstVaapiEncoderStatus
+gst_vaapi_encoder_set_async_depth (GstVaapiEncoder * encoder, guint depth)
+{
+  g_return_val_if_fail (encoder != NULL, 0);
+  g_return_val_if_fail (depth > 0,
+      GST_VAAPI_ENCODER_STATUS_ERROR_INVALID_PARAMETER);
+
+  if (encoder->async_depth != depth && has_pending_frames (encoder))
+    goto error_operation_failed;
+
+  encoder->async_depth = depth;
+  return GST_VAAPI_ENCODER_STATUS_SUCCESS;
+
+  /* ERRORS */
+error_operation_failed:
+  {
+    GST_ERROR ("could not change async depth after encoding started");
+    return GST_VAAPI_ENCODER_STATUS_ERROR_OPERATION_FAILED;
+  }
+}
+
 /* Initialize default values for configurable properties */
 static gboolean
 gst_vaapi_encoder_init_properties (GstVaapiEncoder * encoder)
@@ -1070,11 +1542,9 @@ gst_vaapi_encoder_init (GstVaapiEncoder * encoder, GstVaapiDisplay * display)
   g_mutex_init (&encoder->mutex);
   g_cond_init (&encoder->surface_free);
   g_cond_init (&encoder->codedbuf_free);
-
-  encoder->codedbuf_queue = g_async_queue_new_full ((GDestroyNotify)
-      gst_vaapi_coded_buffer_proxy_unref);
-  if (!encoder->codedbuf_queue)
-    return FALSE;
+  g_cond_init (&encoder->codedbuf_ready);
+  g_cond_init (&encoder->picture_done);
+  g_queue_init (&encoder->codedbuf_queue);
 
   if (!klass->init (encoder))
     return FALSE;
@@ -1107,14 +1577,18 @@ gst_vaapi_encoder_finalize (GstVaapiEncoder * encoder)
     encoder->properties = NULL;
   }
 
+  gst_vaapi_enc_lookahead_free (encoder->lookahead);
+  encoder->lookahead = NULL;
   gst_vaapi_video_pool_replace (&encoder->codedbuf_pool, NULL);
-  if (encoder->codedbuf_queue) {
-    g_async_queue_unref (encoder->codedbuf_queue);
-    encoder->codedbuf_queue = NULL;
-  }
+  g_queue_foreach (&encoder->codedbuf_queue,
+      (GFunc) gst_vaapi_coded_buffer_proxy_unref, NULL);
+  g_queue_clear (&encoder->codedbuf_queue);
   g_cond_clear (&encoder->surface_free);
   g_cond_clear (&encoder->codedbuf_free);
+  g_cond_clear (&encoder->codedbuf_ready);
+  g_cond_clear (&encoder->picture_done);
   g_mutex_clear (&encoder->mutex);
+  g_free (encoder->owner);
 }
 
 /* Helper function to create new GstVaapiEncoder instances (internal) */
@@ -100,6 +100,10 @@ typedef enum {
  * @GST_VAAPI_ENCODER_PROP_KEYFRAME_PERIOD: The maximal distance
  *   between two keyframes (uint).
  * @GST_VAAPI_ENCODER_PROP_TUNE: The tuning options (#GstVaapiEncoderTune).
+ * @GST_VAAPI_ENCODER_PROP_LOOKAHEAD_DEPTH: The number of frames
+ *   analyzed ahead by the lookahead rate control (uint).
+ * @GST_VAAPI_ENCODER_PROP_ASYNC_DEPTH: The maximal number of pictures
+ *   submitted to the hardware and not yet retrieved (uint).
  *
  * The set of configurable properties for the encoder.
  */
@@ -108,6 +112,8 @@ typedef enum {
   GST_VAAPI_ENCODER_PROP_BITRATE,
   GST_VAAPI_ENCODER_PROP_KEYFRAME_PERIOD,
   GST_VAAPI_ENCODER_PROP_TUNE,
+  GST_VAAPI_ENCODER_PROP_LOOKAHEAD_DEPTH,
+  GST_VAAPI_ENCODER_PROP_ASYNC_DEPTH,
 } GstVaapiEncoderProp;
 
 /**
@@ -122,6 +128,26 @@ typedef struct {
   GParamSpec *const pspec;
 } GstVaapiEncoderPropInfo;
 
+/**
+ * GstVaapiEncoderStats:
+ * @num_frames: number of frames that completed encoding
+ * @latency_last: encode latency of the last completed frame
+ * @latency_min: minimal encode latency
+ * @latency_max: maximal encode latency
+ * @latency_avg: average encode latency
+ *
+ * Encode latency statistics. The latency of a frame is the time
+ * elapsed from the submission of its picture to the hardware until
+ * its coded buffer is ready. All times are expressed in nanoseconds.
+ */
+typedef struct {
+  guint64 num_frames;
+  GstClockTime latency_last;
+  GstClockTime latency_min;
+  GstClockTime latency_max;
+  GstClockTime latency_avg;
+} GstVaapiEncoderStats;
+
 GType
 gst_vaapi_encoder_tune_get_type (void) G_GNUC_CONST;
 
@@ -166,6 +192,13 @@ GstVaapiEncoderStatus
 gst_vaapi_encoder_set_tuning (GstVaapiEncoder * encoder,
     GstVaapiEncoderTune tuning);
 
+GstVaapiEncoderStatus
+gst_vaapi_encoder_set_lookahead_depth (GstVaapiEncoder * encoder,
+    guint depth);
+
+GstVaapiEncoderStatus
+gst_vaapi_encoder_set_async_depth (GstVaapiEncoder * encoder, guint depth);
+
 GstVaapiEncoderStatus
 gst_vaapi_encoder_get_buffer_with_timeout (GstVaapiEncoder * encoder,
     GstVaapiCodedBufferProxy ** out_codedbuf_proxy_ptr, guint64 timeout);
@@ -173,6 +206,20 @@ gst_vaapi_encoder_get_buffer_with_timeout (GstVaapiEncoder * encoder,
 GstVaapiEncoderStatus
 gst_vaapi_encoder_flush (GstVaapiEncoder * encoder);
 
+void
+gst_vaapi_encoder_set_flushing (GstVaapiEncoder * encoder, gboolean flushing);
+
+void
+gst_vaapi_encoder_set_completion_polling (GstVaapiEncoder * encoder,
+    gboolean enable);
+
+void
+gst_vaapi_encoder_get_stats (GstVaapiEncoder * encoder,
+    GstVaapiEncoderStats * stats);
+
+void
+gst_vaapi_encoder_set_owner (GstVaapiEncoder * encoder, const gchar * owner);
+
 G_END_DECLS
 
 #endif /* GST_VAAPI_ENCODER_H */
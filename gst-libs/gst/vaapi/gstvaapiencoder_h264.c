@@ -34,6 +34,7 @@
 #include "gstvaapicompat.h"
 #include "gstvaapiencoder_priv.h"
 #include "gstvaapiencoder_h264.h"
+#include "gstvaapiencoder_scenecut.h"
 #include "gstvaapiutils_h264.h"
 #include "gstvaapiutils_h264_priv.h"
 #include "gstvaapicodedbufferproxy_priv.h"
@@ -69,7 +70,8 @@
   (GST_VAAPI_RATECONTROL_MASK (CQP)  |                  \
    GST_VAAPI_RATECONTROL_MASK (CBR)  |                  \
    GST_VAAPI_RATECONTROL_MASK (VBR)  |                  \
-   GST_VAAPI_RATECONTROL_MASK (VBR_CONSTRAINED))
+   GST_VAAPI_RATECONTROL_MASK (VBR_CONSTRAINED) |       \
+   GST_VAAPI_RATECONTROL_MASK (LOOKAHEAD))
 
 /* Supported set of tuning options, within this implementation */
 #define SUPPORTED_TUNE_OPTIONS                          \
@@ -764,6 +766,8 @@ struct _GstVaapiEncoderH264
   gboolean use_dct8x8;
   GstClockTime cts_offset;
   gboolean config_changed;
+  gboolean scene_cut_detection;
+  GstVaapiEncSceneCut *scene_cut;
 
   /* frame, poc */
   guint32 max_frame_num;
@@ -2022,9 +2026,23 @@ add_slice_headers (GstVaapiEncoderH264 * encoder, GstVaapiEncPicture * picture,
   guint mb_size;
   guint last_mb_index;
   guint i_slice, i_ref;
+  gint slice_qp_delta;
 
   g_assert (picture);
 
+  /* The lookahead rate control decides the QP of each picture */
+  if (GST_VAAPI_ENCODER_RATE_CONTROL (encoder) ==
+      GST_VAAPI_RATECONTROL_LOOKAHEAD) {
+    slice_qp_delta = (gint) gst_vaapi_encoder_get_lookahead_qp
+        (GST_VAAPI_ENCODER_CAST (encoder), picture->frame,
+        picture->type == GST_VAAPI_PICTURE_TYPE_I, encoder->init_qp,
+        encoder->min_qp, 51) - (gint) encoder->init_qp;
+  } else {
+    slice_qp_delta = encoder->init_qp - encoder->min_qp;
+    if (slice_qp_delta > 4)
+      slice_qp_delta = 4;
+  }
+
   mb_size = encoder->mb_width * encoder->mb_height;
 
   g_assert (encoder->num_slices && encoder->num_slices < mb_size);
@@ -2120,9 +2138,7 @@ add_slice_headers (GstVaapiEncoderH264 * encoder, GstVaapiEncPicture * picture,
         sizeof (slice_param->chroma_offset_l1));
 
     slice_param->cabac_init_idc = 0;
-    slice_param->slice_qp_delta = encoder->init_qp - encoder->min_qp;
-    if (slice_param->slice_qp_delta > 4)
-      slice_param->slice_qp_delta = 4;
+    slice_param->slice_qp_delta = slice_qp_delta;
     slice_param->disable_deblocking_filter_idc = 0;
     slice_param->slice_alpha_c0_offset_div2 = 2;
     slice_param->slice_beta_offset_div2 = 2;
@@ -2371,6 +2387,7 @@ ensure_bitrate (GstVaapiEncoderH264 * encoder)
     case GST_VAAPI_RATECONTROL_CBR:
     case GST_VAAPI_RATECONTROL_VBR:
     case GST_VAAPI_RATECONTROL_VBR_CONSTRAINED:
+    case GST_VAAPI_RATECONTROL_LOOKAHEAD:
       if (!base_encoder->bitrate) {
         /* According to the literature and testing, CABAC entropy coding
            mode could provide for +10% to +18% improvement in general,
@@ -2546,6 +2563,9 @@ gst_vaapi_encoder_h264_flush (GstVaapiEncoder * base_encoder)
   GstVaapiEncPicture *pic;
   guint i;
 
+  if (encoder->scene_cut)
+    gst_vaapi_enc_scene_cut_reset (encoder->scene_cut);
+
   for (i = 0; i < encoder->num_views; i++) {
     reorder_pool = &encoder->reorder_pools[i];
     reorder_pool->frame_index = 0;
@@ -2663,6 +2683,7 @@ gst_vaapi_encoder_h264_reordering (GstVaapiEncoder * base_encoder,
   GstVaapiH264ViewReorderPool *reorder_pool = NULL;
   GstVaapiEncPicture *picture;
   gboolean is_idr = FALSE;
+  gboolean is_scene_cut = FALSE;
 
   *output = NULL;
 
@@ -2704,12 +2725,24 @@ gst_vaapi_encoder_h264_reordering (GstVaapiEncoder * base_encoder,
   picture->poc = ((reorder_pool->cur_present_index * 2) %
       encoder->max_pic_order_cnt);
 
+  /* scene changes are only handled for single view streams, so that
+     all views keep the same GOP structure */
+  if (encoder->scene_cut && !encoder->is_mvc)
+    is_scene_cut = gst_vaapi_encoder_detect_scene_cut (base_encoder,
+        encoder->scene_cut, frame, picture->surface);
+
   is_idr = (reorder_pool->frame_index == 0 ||
       reorder_pool->frame_index >= encoder->idr_period);
 
+  /* start a new IDR period at scene cuts, unless the current one is
+     still too short to be worth it, in which case an I-frame is used */
+  if (is_scene_cut && reorder_pool->frame_index >=
+      GST_VAAPI_ENCODER_KEYFRAME_PERIOD (encoder) / 2)
+    is_idr = TRUE;
+
   /* check key frames */
-  if (is_idr || GST_VIDEO_CODEC_FRAME_IS_FORCE_KEYFRAME (frame) ||
-      (reorder_pool->frame_index %
+  if (is_idr || is_scene_cut || GST_VIDEO_CODEC_FRAME_IS_FORCE_KEYFRAME (frame)
+      || (reorder_pool->frame_index %
           GST_VAAPI_ENCODER_KEYFRAME_PERIOD (encoder)) == 0) {
     ++reorder_pool->cur_frame_num;
     ++reorder_pool->frame_index;
@@ -2843,6 +2876,13 @@ gst_vaapi_encoder_h264_reconfigure (GstVaapiEncoder * base_encoder)
 
   encoder->is_mvc = encoder->num_views > 1;
 
+  if (encoder->scene_cut_detection && !encoder->scene_cut)
+    encoder->scene_cut = gst_vaapi_enc_scene_cut_new ();
+  else if (!encoder->scene_cut_detection && encoder->scene_cut) {
+    gst_vaapi_enc_scene_cut_free (encoder->scene_cut);
+    encoder->scene_cut = NULL;
+  }
+
   status = ensure_profile_and_level (encoder);
   if (status != GST_VAAPI_ENCODER_STATUS_SUCCESS)
     return status;
@@ -2904,6 +2944,9 @@ gst_vaapi_encoder_h264_finalize (GstVaapiEncoder * base_encoder)
   gst_buffer_replace (&encoder->subset_sps_data, NULL);
   gst_buffer_replace (&encoder->pps_data, NULL);
 
+  gst_vaapi_enc_scene_cut_free (encoder->scene_cut);
+  encoder->scene_cut = NULL;
+
   /* reference list info de-init */
   for (i = 0; i < MAX_NUM_VIEWS; i++) {
     GstVaapiH264ViewRefPool *const ref_pool = &encoder->ref_pools[i];
@@ -2976,6 +3019,9 @@ gst_vaapi_encoder_h264_set_property (GstVaapiEncoder * base_encoder,
       }
       break;
     }
+    case GST_VAAPI_ENCODER_H264_PROP_SCENE_CUT:
+      encoder->scene_cut_detection = g_value_get_boolean (value);
+      break;
     default:
       return GST_VAAPI_ENCODER_STATUS_ERROR_INVALID_PARAMETER;
   }
@@ -3141,6 +3187,20 @@ gst_vaapi_encoder_h264_get_default_properties (void)
               G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS),
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstVaapiEncoderH264:scene-cut:
+   *
+   * Analyze the input frames and code the first frame of each new
+   * scene as an IDR or I-frame, cutting short any pending run of
+   * B-frames. This requires a CPU readback of every input frame.
+   */
+  GST_VAAPI_ENCODER_PROPERTIES_APPEND (props,
+      GST_VAAPI_ENCODER_H264_PROP_SCENE_CUT,
+      g_param_spec_boolean ("scene-cut",
+          "Scene Cut Detection",
+          "Insert key frames at scene changes",
+          FALSE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   return props;
 }
 
@@ -48,6 +48,8 @@ typedef struct _GstVaapiEncoderH264 GstVaapiEncoderH264;
  *   in milliseconds (uint).
  * @GST_VAAPI_ENCODER_H264_PROP_NUM_VIEWS: Number of views per frame.
  * @GST_VAAPI_ENCODER_H264_PROP_VIEW_IDS: View IDs
+ * @GST_VAAPI_ENCODER_H264_PROP_SCENE_CUT: Insert key frames at scene
+ *   changes (bool).
  *
  * The set of H.264 encoder specific configurable properties.
  */
@@ -61,6 +63,7 @@ typedef enum {
   GST_VAAPI_ENCODER_H264_PROP_CPB_LENGTH = -7,
   GST_VAAPI_ENCODER_H264_PROP_NUM_VIEWS = -8,
   GST_VAAPI_ENCODER_H264_PROP_VIEW_IDS = -9,
+  GST_VAAPI_ENCODER_H264_PROP_SCENE_CUT = -10,
 } GstVaapiEncoderH264Prop;
 
 GstVaapiEncoder *
@@ -34,6 +34,7 @@
 #include "gstvaapicompat.h"
 #include "gstvaapiencoder_priv.h"
 #include "gstvaapiencoder_h265.h"
+#include "gstvaapiencoder_scenecut.h"
 #include "gstvaapiutils_h265.h"
 #include "gstvaapiutils_h265_priv.h"
 #include "gstvaapicodedbufferproxy_priv.h"
@@ -60,7 +61,8 @@
 /* Supported set of VA rate controls, within this implementation */
 #define SUPPORTED_RATECONTROLS                          \
   (GST_VAAPI_RATECONTROL_MASK (CQP)) |                  \
-  GST_VAAPI_RATECONTROL_MASK (CBR)
+  GST_VAAPI_RATECONTROL_MASK (CBR) |                    \
+  GST_VAAPI_RATECONTROL_MASK (LOOKAHEAD)
 
 /* Supported set of tuning options, within this implementation */
 #define SUPPORTED_TUNE_OPTIONS                          \
@@ -130,6 +132,8 @@ struct _GstVaapiEncoderH265
   guint32 luma_height;
   GstClockTime cts_offset;
   gboolean config_changed;
+  gboolean scene_cut_detection;
+  GstVaapiEncSceneCut *scene_cut;
 
   /* maximum required size of the decoded picture buffer */
   guint32 max_dec_pic_buffering;
@@ -1664,9 +1668,20 @@ add_slice_headers (GstVaapiEncoderH265 * encoder, GstVaapiEncPicture * picture,
   guint ctu_width_round_factor;
   guint last_ctu_index;
   guint i_slice, i_ref;
+  gint slice_qp_delta;
 
   g_assert (picture);
 
+  /* The lookahead rate control decides the QP of each picture */
+  if (GST_VAAPI_ENCODER_RATE_CONTROL (encoder) ==
+      GST_VAAPI_RATECONTROL_LOOKAHEAD)
+    slice_qp_delta = (gint) gst_vaapi_encoder_get_lookahead_qp
+        (GST_VAAPI_ENCODER_CAST (encoder), picture->frame,
+        picture->type == GST_VAAPI_PICTURE_TYPE_I, encoder->init_qp,
+        encoder->min_qp, 51) - (gint) encoder->init_qp;
+  else
+    slice_qp_delta = encoder->init_qp - encoder->min_qp;
+
   ctu_size = encoder->ctu_width * encoder->ctu_height;
 
   g_assert (encoder->num_slices && encoder->num_slices < ctu_size);
@@ -1746,7 +1761,7 @@ add_slice_headers (GstVaapiEncoderH265 * encoder, GstVaapiEncPicture * picture,
     }
 
     slice_param->max_num_merge_cand = 5;        /* MaxNumMergeCand  */
-    slice_param->slice_qp_delta = encoder->init_qp - encoder->min_qp;
+    slice_param->slice_qp_delta = slice_qp_delta;
 
     slice_param->slice_fields.value = 0;
 
@@ -1943,6 +1958,7 @@ ensure_bitrate (GstVaapiEncoderH265 * encoder)
 
   switch (GST_VAAPI_ENCODER_RATE_CONTROL (encoder)) {
     case GST_VAAPI_RATECONTROL_CBR:
+    case GST_VAAPI_RATECONTROL_LOOKAHEAD:
       if (!base_encoder->bitrate) {
         /* Fixme: Provide better estimation */
         /* Using a 1/6 compression ratio */
@@ -2110,6 +2126,9 @@ gst_vaapi_encoder_h265_flush (GstVaapiEncoder * base_encoder)
   GstVaapiH265ReorderPool *reorder_pool;
   GstVaapiEncPicture *pic;
 
+  if (encoder->scene_cut)
+    gst_vaapi_enc_scene_cut_reset (encoder->scene_cut);
+
   reorder_pool = &encoder->reorder_pool;
   reorder_pool->frame_index = 0;
   reorder_pool->cur_present_index = 0;
@@ -2269,6 +2288,7 @@ gst_vaapi_encoder_h265_reordering (GstVaapiEncoder * base_encoder,
   GstVaapiH265ReorderPool *reorder_pool = NULL;
   GstVaapiEncPicture *picture;
   gboolean is_idr = FALSE;
+  gboolean is_scene_cut = FALSE;
 
   *output = NULL;
 
@@ -2302,12 +2322,22 @@ gst_vaapi_encoder_h265_reordering (GstVaapiEncoder * base_encoder,
   picture->poc = ((reorder_pool->cur_present_index * 1) %
       encoder->max_pic_order_cnt);
 
+  if (encoder->scene_cut)
+    is_scene_cut = gst_vaapi_encoder_detect_scene_cut (base_encoder,
+        encoder->scene_cut, frame, picture->surface);
+
   is_idr = (reorder_pool->frame_index == 0 ||
       reorder_pool->frame_index >= encoder->idr_period);
 
+  /* start a new IDR period at scene cuts, unless the current one is
+     still too short to be worth it, in which case an I-frame is used */
+  if (is_scene_cut && reorder_pool->frame_index >=
+      GST_VAAPI_ENCODER_KEYFRAME_PERIOD (encoder) / 2)
+    is_idr = TRUE;
+
   /* check key frames */
-  if (is_idr || GST_VIDEO_CODEC_FRAME_IS_FORCE_KEYFRAME (frame) ||
-      (reorder_pool->frame_index %
+  if (is_idr || is_scene_cut || GST_VIDEO_CODEC_FRAME_IS_FORCE_KEYFRAME (frame)
+      || (reorder_pool->frame_index %
           GST_VAAPI_ENCODER_KEYFRAME_PERIOD (encoder)) == 0) {
     ++reorder_pool->frame_index;
 
@@ -2421,6 +2451,13 @@ gst_vaapi_encoder_h265_reconfigure (GstVaapiEncoder * base_encoder)
   GstVaapiEncoderStatus status;
   guint luma_width, luma_height;
 
+  if (encoder->scene_cut_detection && !encoder->scene_cut)
+    encoder->scene_cut = gst_vaapi_enc_scene_cut_new ();
+  else if (!encoder->scene_cut_detection && encoder->scene_cut) {
+    gst_vaapi_enc_scene_cut_free (encoder->scene_cut);
+    encoder->scene_cut = NULL;
+  }
+
   luma_width = GST_VAAPI_ENCODER_WIDTH (encoder);
   luma_height = GST_VAAPI_ENCODER_HEIGHT (encoder);
 
@@ -2501,6 +2538,9 @@ gst_vaapi_encoder_h265_finalize (GstVaapiEncoder * base_encoder)
   gst_buffer_replace (&encoder->sps_data, NULL);
   gst_buffer_replace (&encoder->pps_data, NULL);
 
+  gst_vaapi_enc_scene_cut_free (encoder->scene_cut);
+  encoder->scene_cut = NULL;
+
   /* reference list info de-init */
   ref_pool = &encoder->ref_pool;
   while (!g_queue_is_empty (&ref_pool->ref_list)) {
@@ -2542,6 +2582,9 @@ gst_vaapi_encoder_h265_set_property (GstVaapiEncoder * base_encoder,
     case GST_VAAPI_ENCODER_H265_PROP_CPB_LENGTH:
       encoder->cpb_length = g_value_get_uint (value);
       break;
+    case GST_VAAPI_ENCODER_H265_PROP_SCENE_CUT:
+      encoder->scene_cut_detection = g_value_get_boolean (value);
+      break;
     default:
       return GST_VAAPI_ENCODER_STATUS_ERROR_INVALID_PARAMETER;
   }
@@ -2655,6 +2698,20 @@ gst_vaapi_encoder_h265_get_default_properties (void)
           1, 10000, DEFAULT_CPB_LENGTH,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstVaapiEncoderH265:scene-cut:
+   *
+   * Analyze the input frames and code the first frame of each new
+   * scene as an IDR or I-frame, cutting short any pending run of
+   * B-frames. This requires a CPU readback of every input frame.
+   */
+  GST_VAAPI_ENCODER_PROPERTIES_APPEND (props,
+      GST_VAAPI_ENCODER_H265_PROP_SCENE_CUT,
+      g_param_spec_boolean ("scene-cut",
+          "Scene Cut Detection",
+          "Insert key frames at scene changes",
+          FALSE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   return props;
 }
 
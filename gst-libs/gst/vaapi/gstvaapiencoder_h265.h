@@ -42,6 +42,8 @@ typedef struct _GstVaapiEncoderH265 GstVaapiEncoderH265;
  * @GST_VAAPI_ENCODER_H265_PROP_NUM_SLICES: Number of slices per frame (uint).
  * @GST_VAAPI_ENCODER_H265_PROP_CPB_LENGTH: Length of the CPB buffer
  *   in milliseconds (uint).
+ * @GST_VAAPI_ENCODER_H265_PROP_SCENE_CUT: Insert key frames at scene
+ *   changes (bool).
  *
  * The set of H.265 encoder specific configurable properties.
  */
@@ -50,7 +52,8 @@ typedef enum {
   GST_VAAPI_ENCODER_H265_PROP_INIT_QP = -2,
   GST_VAAPI_ENCODER_H265_PROP_MIN_QP = -3,
   GST_VAAPI_ENCODER_H265_PROP_NUM_SLICES = -4,
-  GST_VAAPI_ENCODER_H265_PROP_CPB_LENGTH = -7
+  GST_VAAPI_ENCODER_H265_PROP_CPB_LENGTH = -7,
+  GST_VAAPI_ENCODER_H265_PROP_SCENE_CUT = -8
 } GstVaapiEncoderH265Prop;
 
 GstVaapiEncoder *
@@ -0,0 +1,735 @@
+/*
+ *  gstvaapiencoder_lookahead.c - Lookahead rate control
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation; either version 2.1
+ *  of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free
+ *  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301 USA
+ */
+
+/*
+ * The lookahead stage buffers a configurable number of input frames
+ * before they reach the codec specific reordering logic. For each of
+ * them, a downscaled copy of the luma plane is analyzed on the CPU to
+ * estimate an intra cost (sum of absolute deviations from the block
+ * average) and an inter cost (SAD against the previous frame, without
+ * motion search).
+ *
+ * The rate control model follows the classic "qcomp" approach: the
+ * number of bits produced by a frame is modelled as k * cplx / qscale
+ * and frames are coded with qscale = cplx^(1 - qcomp) / rate_factor.
+ * The rate factor is derived so that the frames currently in the
+ * lookahead window would meet the target bitrate, and is corrected
+ * with the actual bits produced by the hardware (see
+ * gst_vaapi_enc_lookahead_update()). The resulting QP is then used
+ * in constant-QP mode by the driver.
+ */
+
+#include "sysdeps.h"
+#include <math.h>
+#include "gstvaapiencoder_lookahead.h"
+#include "gstvaapiimage.h"
+#include "gstvaapiobject_priv.h"
+
+#define DEBUG 1
+#include "gstvaapidebug.h"
+
+/* Quantizer curve compression factor */
+#define QCOMP 0.6
+
+/* Decay factor of the bits/complexity model */
+#define MODEL_DECAY 0.9
+
+/* Number of bins of the luma histograms */
+#define HISTOGRAM_BINS 64
+
+typedef struct
+{
+  GstVideoCodecFrame *frame;
+  guint64 intra_cost;
+  guint64 inter_cost;
+  gdouble histogram_diff;
+  gboolean has_ref;
+} LookaheadEntry;
+
+/* Rate control data of a frame handed over to the codec */
+typedef struct
+{
+  guint64 intra_cost;
+  guint64 inter_cost;
+  gdouble histogram_diff;
+  gboolean has_ref;
+  gdouble window_cplx;
+  gdouble cplx;
+  gdouble qscale;
+} PendingFrame;
+
+struct _GstVaapiEncLookahead
+{
+  guint depth;
+  GQueue entries;
+  GstVaapiEncLowres lowres[2];
+  guint lowres_index;
+  gboolean has_ref;
+
+  /* Rate control model, protected by lock */
+  GMutex lock;
+  GHashTable *pending;
+  gdouble target_bits;
+  gdouble model_sum;
+  gdouble model_weight;
+  gdouble total_bits;
+  gdouble total_target_bits;
+};
+
+/* ------------------------------------------------------------------------- */
+/* --- Low-resolution luma analysis                                      --- */
+/* ------------------------------------------------------------------------- */
+
+static GstVaapiImage *
+get_surface_image (GstVaapiSurface * surface)
+{
+  GstVaapiImage *image;
+  guint width, height;
+
+  image = gst_vaapi_surface_derive_image (surface);
+  if (image)
+    return image;
+
+  gst_vaapi_surface_get_size (surface, &width, &height);
+  image = gst_vaapi_image_new (GST_VAAPI_OBJECT_DISPLAY (surface),
+      GST_VIDEO_FORMAT_NV12, width, height);
+  if (!image)
+    return NULL;
+  if (!gst_vaapi_surface_get_image (surface, image)) {
+    gst_vaapi_object_unref (image);
+    return NULL;
+  }
+  return image;
+}
+
+static void
+downscale_luma (guint8 * dst, guint dst_width, guint dst_height,
+    const guint8 * src, guint src_stride)
+{
+  const guint scale = GST_VAAPI_ENC_LOWRES_SCALE;
+  guint x, y, i, j, sum;
+
+  for (y = 0; y < dst_height; y++) {
+    const guint8 *const src_row = src + y * scale * src_stride;
+    for (x = 0; x < dst_width; x++) {
+      sum = 0;
+      for (j = 0; j < scale; j++) {
+        const guint8 *const p = src_row + j * src_stride + x * scale;
+        for (i = 0; i < scale; i++)
+          sum += p[i];
+      }
+      dst[y * dst_width + x] = (sum + scale * scale / 2) / (scale * scale);
+    }
+  }
+}
+
+/**
+ * gst_vaapi_enc_lowres_update:
+ * @lowres: a #GstVaapiEncLowres
+ * @surface: the source #GstVaapiSurface
+ *
+ * Reads back the luma plane of @surface and stores a copy of it into
+ * @lowres, downscaled by %GST_VAAPI_ENC_LOWRES_SCALE in each
+ * direction. Only 8-bit planar and semi-planar YUV 4:2:0 surfaces are
+ * supported.
+ *
+ * Return value: %TRUE on success
+ */
+gboolean
+gst_vaapi_enc_lowres_update (GstVaapiEncLowres * lowres,
+    GstVaapiSurface * surface)
+{
+  GstVaapiImage *image;
+  guint width, height;
+  gboolean success = FALSE;
+
+  g_return_val_if_fail (lowres != NULL, FALSE);
+  g_return_val_if_fail (surface != NULL, FALSE);
+
+  image = get_surface_image (surface);
+  if (!image)
+    return FALSE;
+
+  switch (gst_vaapi_image_get_format (image)) {
+    case GST_VIDEO_FORMAT_NV12:
+    case GST_VIDEO_FORMAT_I420:
+    case GST_VIDEO_FORMAT_YV12:
+      break;
+    default:
+      goto cleanup;
+  }
+
+  if (!gst_vaapi_image_map (image))
+    goto cleanup;
+
+  gst_vaapi_surface_get_size (surface, &width, &height);
+  width /= GST_VAAPI_ENC_LOWRES_SCALE;
+  height /= GST_VAAPI_ENC_LOWRES_SCALE;
+  if (width != lowres->width || height != lowres->height) {
+    g_free (lowres->data);
+    lowres->data = g_malloc (width * height);
+    lowres->width = width;
+    lowres->height = height;
+  }
+
+  downscale_luma (lowres->data, width, height,
+      gst_vaapi_image_get_plane (image, 0),
+      gst_vaapi_image_get_pitch (image, 0));
+  gst_vaapi_image_unmap (image);
+  success = TRUE;
+
+cleanup:
+  gst_vaapi_object_unref (image);
+  return success;
+}
+
+/**
+ * gst_vaapi_enc_lowres_clear:
+ * @lowres: a #GstVaapiEncLowres
+ *
+ * Releases the samples held in @lowres.
+ */
+void
+gst_vaapi_enc_lowres_clear (GstVaapiEncLowres * lowres)
+{
+  g_return_if_fail (lowres != NULL);
+
+  g_free (lowres->data);
+  lowres->data = NULL;
+  lowres->width = 0;
+  lowres->height = 0;
+}
+
+static guint
+block_intra_cost (const guint8 * src, guint stride)
+{
+  const guint n = GST_VAAPI_ENC_LOWRES_BLOCK;
+  guint x, y, sum = 0, cost = 0;
+  gint mean;
+
+  for (y = 0; y < n; y++) {
+    for (x = 0; x < n; x++)
+      sum += src[y * stride + x];
+  }
+  mean = (sum + n * n / 2) / (n * n);
+
+  for (y = 0; y < n; y++) {
+    for (x = 0; x < n; x++)
+      cost += ABS ((gint) src[y * stride + x] - mean);
+  }
+  return cost;
+}
+
+static guint
+block_sad (const guint8 * src, const guint8 * ref, guint stride)
+{
+  const guint n = GST_VAAPI_ENC_LOWRES_BLOCK;
+  guint x, y, cost = 0;
+
+  for (y = 0; y < n; y++) {
+    for (x = 0; x < n; x++)
+      cost += ABS ((gint) src[y * stride + x] - (gint) ref[y * stride + x]);
+  }
+  return cost;
+}
+
+/**
+ * gst_vaapi_enc_lowres_intra_cost:
+ * @lowres: a #GstVaapiEncLowres
+ *
+ * Estimates the cost of coding @lowres without any reference. This
+ * is the sum, over all blocks, of the absolute deviation of samples
+ * from the block average.
+ *
+ * Return value: the intra cost
+ */
+guint64
+gst_vaapi_enc_lowres_intra_cost (const GstVaapiEncLowres * lowres)
+{
+  const guint n = GST_VAAPI_ENC_LOWRES_BLOCK;
+  guint64 cost = 0;
+  guint x, y;
+
+  g_return_val_if_fail (lowres != NULL, 0);
+
+  for (y = 0; y + n <= lowres->height; y += n) {
+    for (x = 0; x + n <= lowres->width; x += n)
+      cost += block_intra_cost (lowres->data + y * lowres->width + x,
+          lowres->width);
+  }
+  return cost;
+}
+
+/**
+ * gst_vaapi_enc_lowres_inter_cost:
+ * @lowres: a #GstVaapiEncLowres
+ * @ref: the reference #GstVaapiEncLowres
+ *
+ * Estimates the cost of coding @lowres predicted from @ref. For each
+ * block, the smallest of the intra cost and the SAD against the
+ * co-located block in @ref is accumulated.
+ *
+ * Return value: the inter cost
+ */
+guint64
+gst_vaapi_enc_lowres_inter_cost (const GstVaapiEncLowres * lowres,
+    const GstVaapiEncLowres * ref)
+{
+  const guint n = GST_VAAPI_ENC_LOWRES_BLOCK;
+  guint64 cost = 0;
+  guint x, y, offset;
+
+  g_return_val_if_fail (lowres != NULL, 0);
+  g_return_val_if_fail (ref != NULL, 0);
+
+  if (lowres->width != ref->width || lowres->height != ref->height)
+    return gst_vaapi_enc_lowres_intra_cost (lowres);
+
+  for (y = 0; y + n <= lowres->height; y += n) {
+    for (x = 0; x + n <= lowres->width; x += n) {
+      offset = y * lowres->width + x;
+      cost += MIN (block_intra_cost (lowres->data + offset, lowres->width),
+          block_sad (lowres->data + offset, ref->data + offset, lowres->width));
+    }
+  }
+  return cost;
+}
+
+static void
+compute_histogram (const GstVaapiEncLowres * lowres, guint * histogram)
+{
+  const guint n = lowres->width * lowres->height;
+  guint i;
+
+  memset (histogram, 0, HISTOGRAM_BINS * sizeof (*histogram));
+  for (i = 0; i < n; i++)
+    histogram[lowres->data[i] * HISTOGRAM_BINS / 256]++;
+}
+
+/**
+ * gst_vaapi_enc_lowres_histogram_diff:
+ * @lowres: a #GstVaapiEncLowres
+ * @ref: the #GstVaapiEncLowres of the reference frame
+ *
+ * Compares the luma histograms of @lowres and @ref. Unlike the inter
+ * cost, this is insensitive to motion but catches global changes of
+ * brightness or content.
+ *
+ * Return value: the normalized histogram difference, from 0 (same
+ *   histograms) to 1 (disjoint histograms)
+ */
+gdouble
+gst_vaapi_enc_lowres_histogram_diff (const GstVaapiEncLowres * lowres,
+    const GstVaapiEncLowres * ref)
+{
+  guint histogram[HISTOGRAM_BINS], ref_histogram[HISTOGRAM_BINS];
+  const guint num_samples = lowres->width * lowres->height;
+  guint64 diff = 0;
+  guint i;
+
+  g_return_val_if_fail (lowres != NULL, 0.0);
+  g_return_val_if_fail (ref != NULL, 0.0);
+
+  if (!num_samples || ref->width * ref->height != num_samples)
+    return 0.0;
+
+  compute_histogram (lowres, histogram);
+  compute_histogram (ref, ref_histogram);
+  for (i = 0; i < HISTOGRAM_BINS; i++)
+    diff += ABS ((gint) histogram[i] - (gint) ref_histogram[i]);
+  return (gdouble) diff / (2.0 * num_samples);
+}
+
+/* ------------------------------------------------------------------------- */
+/* --- Lookahead rate control                                            --- */
+/* ------------------------------------------------------------------------- */
+
+static inline gdouble
+qp_to_qscale (gdouble qp)
+{
+  return 0.85 * pow (2.0, (qp - 12.0) / 6.0);
+}
+
+static inline gdouble
+qscale_to_qp (gdouble qscale)
+{
+  return 12.0 + 6.0 * log2 (qscale / 0.85);
+}
+
+static inline gpointer
+frame_key (GstVideoCodecFrame * frame)
+{
+  return GUINT_TO_POINTER (frame->system_frame_number);
+}
+
+static void
+pending_frame_free (PendingFrame * pending)
+{
+  g_slice_free (PendingFrame, pending);
+}
+
+static void
+lookahead_entry_free (LookaheadEntry * entry)
+{
+  if (entry->frame)
+    gst_video_codec_frame_unref (entry->frame);
+  g_slice_free (LookaheadEntry, entry);
+}
+
+/**
+ * gst_vaapi_enc_lookahead_new:
+ * @depth: the number of frames to buffer ahead of the encoder
+ *
+ * Creates a new lookahead rate control stage.
+ *
+ * Return value: the newly allocated #GstVaapiEncLookahead
+ */
+GstVaapiEncLookahead *
+gst_vaapi_enc_lookahead_new (guint depth)
+{
+  GstVaapiEncLookahead *lookahead;
+
+  lookahead = g_slice_new0 (GstVaapiEncLookahead);
+  lookahead->depth = depth;
+  g_queue_init (&lookahead->entries);
+  g_mutex_init (&lookahead->lock);
+  lookahead->pending = g_hash_table_new_full (NULL, NULL, NULL,
+      (GDestroyNotify) pending_frame_free);
+  return lookahead;
+}
+
+/**
+ * gst_vaapi_enc_lookahead_free:
+ * @lookahead: a #GstVaapiEncLookahead
+ *
+ * Releases @lookahead and any frame still buffered.
+ */
+void
+gst_vaapi_enc_lookahead_free (GstVaapiEncLookahead * lookahead)
+{
+  if (!lookahead)
+    return;
+
+  gst_vaapi_enc_lookahead_flush (lookahead);
+  gst_vaapi_enc_lowres_clear (&lookahead->lowres[0]);
+  gst_vaapi_enc_lowres_clear (&lookahead->lowres[1]);
+  g_hash_table_unref (lookahead->pending);
+  g_mutex_clear (&lookahead->lock);
+  g_slice_free (GstVaapiEncLookahead, lookahead);
+}
+
+/**
+ * gst_vaapi_enc_lookahead_set_target:
+ * @lookahead: a #GstVaapiEncLookahead
+ * @bitrate: the target bitrate, in bits per second
+ * @fps_n: the framerate numerator
+ * @fps_d: the framerate denominator
+ *
+ * Sets the target bitrate, from which the per-frame bit budget is
+ * derived.
+ */
+void
+gst_vaapi_enc_lookahead_set_target (GstVaapiEncLookahead * lookahead,
+    guint bitrate, guint fps_n, guint fps_d)
+{
+  g_return_if_fail (lookahead != NULL);
+
+  g_mutex_lock (&lookahead->lock);
+  lookahead->target_bits = fps_n > 0 ? (gdouble) bitrate * fps_d / fps_n : 0;
+  g_mutex_unlock (&lookahead->lock);
+
+  GST_DEBUG ("lookahead target: %.0f bits per frame", lookahead->target_bits);
+}
+
+/**
+ * gst_vaapi_enc_lookahead_push:
+ * @lookahead: a #GstVaapiEncLookahead
+ * @frame: the input #GstVideoCodecFrame
+ * @surface: the #GstVaapiSurface holding the @frame pixels
+ *
+ * Analyzes the @frame and appends it to the lookahead window. The
+ * @lookahead holds an extra reference to @frame until it is returned
+ * by gst_vaapi_enc_lookahead_pop(). If @surface cannot be read back,
+ * the frame is still queued and will be coded with the initial QP.
+ *
+ * Return value: %TRUE on success
+ */
+gboolean
+gst_vaapi_enc_lookahead_push (GstVaapiEncLookahead * lookahead,
+    GstVideoCodecFrame * frame, GstVaapiSurface * surface)
+{
+  GstVaapiEncLowres *const lowres =
+      &lookahead->lowres[lookahead->lowres_index];
+  GstVaapiEncLowres *const ref =
+      &lookahead->lowres[lookahead->lowres_index ^ 1];
+  LookaheadEntry *entry;
+
+  g_return_val_if_fail (frame != NULL, FALSE);
+
+  entry = g_slice_new0 (LookaheadEntry);
+  entry->frame = gst_video_codec_frame_ref (frame);
+
+  if (surface && gst_vaapi_enc_lowres_update (lowres, surface)) {
+    entry->intra_cost = gst_vaapi_enc_lowres_intra_cost (lowres);
+    if (lookahead->has_ref) {
+      entry->inter_cost = gst_vaapi_enc_lowres_inter_cost (lowres, ref);
+      entry->histogram_diff = gst_vaapi_enc_lowres_histogram_diff (lowres,
+          ref);
+      entry->has_ref = TRUE;
+    } else
+      entry->inter_cost = entry->intra_cost;
+    lookahead->lowres_index ^= 1;
+    lookahead->has_ref = TRUE;
+  } else {
+    GST_WARNING ("failed to analyze frame %u", frame->system_frame_number);
+    lookahead->has_ref = FALSE;
+  }
+
+  GST_LOG ("frame %u: intra cost %" G_GUINT64_FORMAT ", inter cost %"
+      G_GUINT64_FORMAT, frame->system_frame_number, entry->intra_cost,
+      entry->inter_cost);
+
+  g_queue_push_tail (&lookahead->entries, entry);
+  return TRUE;
+}
+
+/**
+ * gst_vaapi_enc_lookahead_get_length:
+ * @lookahead: a #GstVaapiEncLookahead
+ *
+ * Return value: the number of frames buffered in the lookahead window
+ */
+guint
+gst_vaapi_enc_lookahead_get_length (GstVaapiEncLookahead * lookahead)
+{
+  g_return_val_if_fail (lookahead != NULL, 0);
+
+  return g_queue_get_length (&lookahead->entries);
+}
+
+/**
+ * gst_vaapi_enc_lookahead_pop:
+ * @lookahead: a #GstVaapiEncLookahead
+ * @drain: %TRUE to return frames even if the window is not full
+ *
+ * Returns the oldest frame of the lookahead window, once enough
+ * frames were queued after it, or whenever @drain is set. The caller
+ * owns the returned reference.
+ *
+ * Return value: the next #GstVideoCodecFrame to encode, or %NULL
+ */
+GstVideoCodecFrame *
+gst_vaapi_enc_lookahead_pop (GstVaapiEncLookahead * lookahead, gboolean drain)
+{
+  LookaheadEntry *entry;
+  PendingFrame *pending;
+  GstVideoCodecFrame *frame;
+  gdouble window_cplx;
+  guint i, n;
+
+  g_return_val_if_fail (lookahead != NULL, NULL);
+
+  n = g_queue_get_length (&lookahead->entries);
+  if (n == 0 || (n <= lookahead->depth && !drain))
+    return NULL;
+
+  /* Average compressed complexity over the lookahead window */
+  window_cplx = 0;
+  for (i = 0; i < n; i++) {
+    entry = g_queue_peek_nth (&lookahead->entries, i);
+    window_cplx += pow (MAX (entry->inter_cost, 1), QCOMP);
+  }
+  window_cplx /= n;
+
+  entry = g_queue_pop_head (&lookahead->entries);
+  frame = entry->frame;
+  entry->frame = NULL;
+
+  pending = g_slice_new0 (PendingFrame);
+  pending->intra_cost = entry->intra_cost;
+  pending->inter_cost = entry->inter_cost;
+  pending->histogram_diff = entry->histogram_diff;
+  pending->has_ref = entry->has_ref;
+  pending->window_cplx = window_cplx;
+  lookahead_entry_free (entry);
+
+  g_mutex_lock (&lookahead->lock);
+  g_hash_table_replace (lookahead->pending, frame_key (frame), pending);
+  g_mutex_unlock (&lookahead->lock);
+  return frame;
+}
+
+/**
+ * gst_vaapi_enc_lookahead_get_costs:
+ * @lookahead: a #GstVaapiEncLookahead
+ * @frame: the #GstVideoCodecFrame about to be encoded
+ * @intra_cost: (out): return location for the intra cost of @frame
+ * @inter_cost: (out): return location for the inter cost of @frame
+ * @histogram_diff: (out): return location for the histogram difference
+ *   between @frame and the previous frame
+ *
+ * Retrieves the analysis of @frame, made against the previous frame
+ * in display order when @frame entered the lookahead window, so that
+ * other analyses need not read back @frame again.
+ *
+ * Return value: %TRUE if @frame was analyzed against the previous
+ *   frame, %FALSE otherwise, e.g. for the first frame
+ */
+gboolean
+gst_vaapi_enc_lookahead_get_costs (GstVaapiEncLookahead * lookahead,
+    GstVideoCodecFrame * frame, guint64 * intra_cost, guint64 * inter_cost,
+    gdouble * histogram_diff)
+{
+  PendingFrame *pending;
+  gboolean success = FALSE;
+
+  g_return_val_if_fail (lookahead != NULL, FALSE);
+  g_return_val_if_fail (frame != NULL, FALSE);
+
+  g_mutex_lock (&lookahead->lock);
+  pending = g_hash_table_lookup (lookahead->pending, frame_key (frame));
+  if (pending && pending->has_ref) {
+    *intra_cost = pending->intra_cost;
+    *inter_cost = pending->inter_cost;
+    *histogram_diff = pending->histogram_diff;
+    success = TRUE;
+  }
+  g_mutex_unlock (&lookahead->lock);
+  return success;
+}
+
+/**
+ * gst_vaapi_enc_lookahead_get_qp:
+ * @lookahead: a #GstVaapiEncLookahead
+ * @frame: the #GstVideoCodecFrame about to be encoded
+ * @is_intra: %TRUE if @frame is coded without reference
+ * @qp_init: the QP to use if no decision could be made
+ * @qp_min: the minimal QP
+ * @qp_max: the maximal QP
+ *
+ * Decides the QP for @frame, from its complexity and the complexity
+ * of the frames that follow it in the lookahead window.
+ *
+ * Return value: the QP to use for @frame
+ */
+guint
+gst_vaapi_enc_lookahead_get_qp (GstVaapiEncLookahead * lookahead,
+    GstVideoCodecFrame * frame, gboolean is_intra, guint qp_init,
+    guint qp_min, guint qp_max)
+{
+  PendingFrame *pending;
+  gdouble k, rate_factor, overflow, qscale, qp;
+
+  g_return_val_if_fail (lookahead != NULL, qp_init);
+  g_return_val_if_fail (frame != NULL, qp_init);
+
+  g_mutex_lock (&lookahead->lock);
+  pending = g_hash_table_lookup (lookahead->pending, frame_key (frame));
+  if (!pending || pending->intra_cost == 0 || lookahead->target_bits <= 0) {
+    qp = qp_init;
+    goto done;
+  }
+
+  pending->cplx = MAX (is_intra ? pending->intra_cost : pending->inter_cost, 1);
+
+  /* Bootstrap the bits/complexity model with the initial QP */
+  if (lookahead->model_weight == 0) {
+    qp = qp_init;
+    goto done;
+  }
+
+  /* Rate factor meeting the target over the lookahead window */
+  k = lookahead->model_sum / lookahead->model_weight;
+  rate_factor = lookahead->target_bits / (k * pending->window_cplx);
+
+  /* Compensate for the past deviation from the target, spread over
+     a few lookahead windows */
+  overflow = (lookahead->total_bits - lookahead->total_target_bits) /
+      (lookahead->target_bits * 4 * MAX (lookahead->depth, 1));
+  rate_factor /= CLAMP (1.0 + overflow, 0.5, 2.0);
+
+  qscale = pow (pending->cplx, 1.0 - QCOMP) / rate_factor;
+  qp = qscale_to_qp (qscale);
+
+done:
+  qp = CLAMP (qp + 0.5, qp_min, qp_max);
+  if (pending && pending->cplx > 0)
+    pending->qscale = qp_to_qscale ((guint) qp);
+  g_mutex_unlock (&lookahead->lock);
+
+  GST_LOG ("frame %u: QP %u", frame->system_frame_number, (guint) qp);
+  return (guint) qp;
+}
+
+/**
+ * gst_vaapi_enc_lookahead_update:
+ * @lookahead: a #GstVaapiEncLookahead
+ * @frame: the #GstVideoCodecFrame that got encoded
+ * @bits: the size of the coded @frame, in bits
+ *
+ * Feeds the actual size of a coded frame back into the rate control
+ * model. This can be called from a different thread than the other
+ * functions.
+ */
+void
+gst_vaapi_enc_lookahead_update (GstVaapiEncLookahead * lookahead,
+    GstVideoCodecFrame * frame, guint bits)
+{
+  PendingFrame *pending;
+
+  g_return_if_fail (lookahead != NULL);
+  g_return_if_fail (frame != NULL);
+
+  g_mutex_lock (&lookahead->lock);
+  pending = g_hash_table_lookup (lookahead->pending, frame_key (frame));
+  if (pending && pending->qscale > 0) {
+    lookahead->model_sum = lookahead->model_sum * MODEL_DECAY +
+        bits * pending->qscale / pending->cplx;
+    lookahead->model_weight = lookahead->model_weight * MODEL_DECAY + 1;
+  }
+  lookahead->total_bits += bits;
+  lookahead->total_target_bits += lookahead->target_bits;
+  g_hash_table_remove (lookahead->pending, frame_key (frame));
+  g_mutex_unlock (&lookahead->lock);
+}
+
+/**
+ * gst_vaapi_enc_lookahead_flush:
+ * @lookahead: a #GstVaapiEncLookahead
+ *
+ * Drops any buffered frame and any pending rate control data. The
+ * bits/complexity model is preserved.
+ */
+void
+gst_vaapi_enc_lookahead_flush (GstVaapiEncLookahead * lookahead)
+{
+  LookaheadEntry *entry;
+
+  g_return_if_fail (lookahead != NULL);
+
+  while ((entry = g_queue_pop_head (&lookahead->entries)))
+    lookahead_entry_free (entry);
+  lookahead->has_ref = FALSE;
+
+  g_mutex_lock (&lookahead->lock);
+  g_hash_table_remove_all (lookahead->pending);
+  g_mutex_unlock (&lookahead->lock);
+}
@@ -0,0 +1,128 @@
+/*
+ *  gstvaapiencoder_lookahead.h - Lookahead rate control (private)
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation; either version 2.1
+ *  of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free
+ *  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301 USA
+ */
+
+#ifndef GST_VAAPI_ENCODER_LOOKAHEAD_H
+#define GST_VAAPI_ENCODER_LOOKAHEAD_H
+
+#include <gst/video/gstvideoutils.h>
+#include <gst/vaapi/gstvaapisurface.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GstVaapiEncLowres GstVaapiEncLowres;
+typedef struct _GstVaapiEncLookahead GstVaapiEncLookahead;
+
+/* Downscaling factor, in each direction, of the analyzed luma plane */
+#define GST_VAAPI_ENC_LOWRES_SCALE 4
+
+/* Size of the blocks the costs are computed on, in low-res pixels */
+#define GST_VAAPI_ENC_LOWRES_BLOCK 8
+
+/**
+ * GstVaapiEncLowres:
+ * @width: the low-resolution plane width, in pixels
+ * @height: the low-resolution plane height, in pixels
+ * @data: the low-resolution luma samples (@width x @height)
+ *
+ * A downscaled copy of the luma plane of a source surface, used for
+ * cheap complexity and similarity analysis of the input frames.
+ */
+struct _GstVaapiEncLowres
+{
+  guint width;
+  guint height;
+  guint8 *data;
+};
+
+G_GNUC_INTERNAL
+gboolean
+gst_vaapi_enc_lowres_update (GstVaapiEncLowres * lowres,
+    GstVaapiSurface * surface);
+
+G_GNUC_INTERNAL
+void
+gst_vaapi_enc_lowres_clear (GstVaapiEncLowres * lowres);
+
+G_GNUC_INTERNAL
+guint64
+gst_vaapi_enc_lowres_intra_cost (const GstVaapiEncLowres * lowres);
+
+G_GNUC_INTERNAL
+guint64
+gst_vaapi_enc_lowres_inter_cost (const GstVaapiEncLowres * lowres,
+    const GstVaapiEncLowres * ref);
+
+G_GNUC_INTERNAL
+gdouble
+gst_vaapi_enc_lowres_histogram_diff (const GstVaapiEncLowres * lowres,
+    const GstVaapiEncLowres * ref);
+
+G_GNUC_INTERNAL
+GstVaapiEncLookahead *
+gst_vaapi_enc_lookahead_new (guint depth);
+
+G_GNUC_INTERNAL
+void
+gst_vaapi_enc_lookahead_free (GstVaapiEncLookahead * lookahead);
+
+G_GNUC_INTERNAL
+void
+gst_vaapi_enc_lookahead_set_target (GstVaapiEncLookahead * lookahead,
+    guint bitrate, guint fps_n, guint fps_d);
+
+G_GNUC_INTERNAL
+gboolean
+gst_vaapi_enc_lookahead_push (GstVaapiEncLookahead * lookahead,
+    GstVideoCodecFrame * frame, GstVaapiSurface * surface);
+
+G_GNUC_INTERNAL
+guint
+gst_vaapi_enc_lookahead_get_length (GstVaapiEncLookahead * lookahead);
+
+G_GNUC_INTERNAL
+GstVideoCodecFrame *
+gst_vaapi_enc_lookahead_pop (GstVaapiEncLookahead * lookahead,
+    gboolean drain);
+
+G_GNUC_INTERNAL
+gboolean
+gst_vaapi_enc_lookahead_get_costs (GstVaapiEncLookahead * lookahead,
+    GstVideoCodecFrame * frame, guint64 * intra_cost, guint64 * inter_cost,
+    gdouble * histogram_diff);
+
+G_GNUC_INTERNAL
+guint
+gst_vaapi_enc_lookahead_get_qp (GstVaapiEncLookahead * lookahead,
+    GstVideoCodecFrame * frame, gboolean is_intra, guint qp_init,
+    guint qp_min, guint qp_max);
+
+G_GNUC_INTERNAL
+void
+gst_vaapi_enc_lookahead_update (GstVaapiEncLookahead * lookahead,
+    GstVideoCodecFrame * frame, guint bits);
+
+G_GNUC_INTERNAL
+void
+gst_vaapi_enc_lookahead_flush (GstVaapiEncLookahead * lookahead);
+
+G_END_DECLS
+
+#endif /* GST_VAAPI_ENCODER_LOOKAHEAD_H */
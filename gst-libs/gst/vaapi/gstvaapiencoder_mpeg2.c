@@ -554,6 +554,11 @@ gst_vaapi_encoder_mpeg2_encode (GstVaapiEncoder * base_encoder,
 
   g_assert (GST_VAAPI_SURFACE_PROXY_SURFACE (reconstruct));
 
+  /* I-frames always start a new GOP. This is tracked here rather
+     than at reordering time since a scene cut may queue an I-frame
+     behind pending B-frames */
+  encoder->new_gop = (picture->type == GST_VAAPI_PICTURE_TYPE_I);
+
   if (!ensure_sequence (encoder, picture))
     goto error;
   if (!ensure_picture (encoder, picture, codedbuf, reconstruct))
@@ -591,6 +596,9 @@ gst_vaapi_encoder_mpeg2_flush (GstVaapiEncoder * base_encoder)
       GST_VAAPI_ENCODER_MPEG2_CAST (base_encoder);
   GstVaapiEncPicture *pic;
 
+  if (encoder->scene_cut)
+    gst_vaapi_enc_scene_cut_reset (encoder->scene_cut);
+
   while (!g_queue_is_empty (&encoder->b_frames)) {
     pic = g_queue_pop_head (&encoder->b_frames);
     gst_vaapi_enc_picture_unref (pic);
@@ -608,6 +616,7 @@ gst_vaapi_encoder_mpeg2_reordering (GstVaapiEncoder * base_encoder,
       GST_VAAPI_ENCODER_MPEG2_CAST (base_encoder);
   GstVaapiEncPicture *picture = NULL;
   GstVaapiEncoderStatus status = GST_VAAPI_ENCODER_STATUS_SUCCESS;
+  gboolean is_scene_cut = FALSE;
 
   if (!frame) {
     if (g_queue_is_empty (&encoder->b_frames) && encoder->dump_frames) {
@@ -629,16 +638,36 @@ gst_vaapi_encoder_mpeg2_reordering (GstVaapiEncoder * base_encoder,
     return GST_VAAPI_ENCODER_STATUS_ERROR_ALLOCATION_FAILED;
   }
 
+  if (encoder->scene_cut)
+    is_scene_cut = gst_vaapi_encoder_detect_scene_cut (base_encoder,
+        encoder->scene_cut, frame, picture->surface);
+
   if (encoder->frame_num >= base_encoder->keyframe_period) {
     encoder->frame_num = 0;
     clear_references (encoder);
+  } else if (is_scene_cut && encoder->frame_num > 0) {
+    encoder->frame_num = 0;
+
+    /* pending B-frames belong to the previous scene: promote the last
+       one to a P-frame, so that none of them is predicted from the new
+       scene, and queue the I-frame behind them */
+    if (!g_queue_is_empty (&encoder->b_frames)) {
+      GstVaapiEncPicture *const p_pic = g_queue_pop_tail (&encoder->b_frames);
+
+      p_pic->type = GST_VAAPI_PICTURE_TYPE_P;
+      picture->type = GST_VAAPI_PICTURE_TYPE_I;
+      GST_VIDEO_CODEC_FRAME_SET_SYNC_POINT (frame);
+      picture->frame_num = encoder->frame_num++;
+      g_queue_push_tail (&encoder->b_frames, picture);
+      encoder->dump_frames = TRUE;
+      picture = p_pic;
+      goto end;
+    }
   }
   if (encoder->frame_num == 0) {
     picture->type = GST_VAAPI_PICTURE_TYPE_I;
     GST_VIDEO_CODEC_FRAME_SET_SYNC_POINT (frame);
-    encoder->new_gop = TRUE;
   } else {
-    encoder->new_gop = FALSE;
     if ((encoder->frame_num % (encoder->ip_period + 1)) == 0 ||
         encoder->frame_num == base_encoder->keyframe_period - 1) {
       picture->type = GST_VAAPI_PICTURE_TYPE_P;
@@ -710,6 +739,13 @@ gst_vaapi_encoder_mpeg2_reconfigure (GstVaapiEncoder * base_encoder)
       GST_VAAPI_ENCODER_MPEG2_CAST (base_encoder);
   GstVaapiEncoderStatus status;
 
+  if (encoder->scene_cut_detection && !encoder->scene_cut)
+    encoder->scene_cut = gst_vaapi_enc_scene_cut_new ();
+  else if (!encoder->scene_cut_detection && encoder->scene_cut) {
+    gst_vaapi_enc_scene_cut_free (encoder->scene_cut);
+    encoder->scene_cut = NULL;
+  }
+
   if (encoder->ip_period > base_encoder->keyframe_period) {
     encoder->ip_period = base_encoder->keyframe_period - 1;
   }
@@ -781,6 +817,9 @@ gst_vaapi_encoder_mpeg2_finalize (GstVaapiEncoder * base_encoder)
 
   clear_references (encoder);
 
+  gst_vaapi_enc_scene_cut_free (encoder->scene_cut);
+  encoder->scene_cut = NULL;
+
   while (!g_queue_is_empty (&encoder->b_frames)) {
     pic = g_queue_pop_head (&encoder->b_frames);
     gst_vaapi_enc_picture_unref (pic);
@@ -802,6 +841,9 @@ gst_vaapi_encoder_mpeg2_set_property (GstVaapiEncoder * base_encoder,
     case GST_VAAPI_ENCODER_MPEG2_PROP_MAX_BFRAMES:
       encoder->ip_period = g_value_get_uint (value);
       break;
+    case GST_VAAPI_ENCODER_MPEG2_PROP_SCENE_CUT:
+      encoder->scene_cut_detection = g_value_get_boolean (value);
+      break;
     default:
       return GST_VAAPI_ENCODER_STATUS_ERROR_INVALID_PARAMETER;
   }
@@ -868,6 +910,20 @@ gst_vaapi_encoder_mpeg2_get_default_properties (void)
           "Number of B-frames between I and P",
           0, 16, 0, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstVaapiEncoderMpeg2:scene-cut:
+   *
+   * Analyze the input frames and start a new GOP at each new scene,
+   * cutting short any pending run of B-frames. This requires a CPU
+   * readback of every input frame.
+   */
+  GST_VAAPI_ENCODER_PROPERTIES_APPEND (props,
+      GST_VAAPI_ENCODER_MPEG2_PROP_SCENE_CUT,
+      g_param_spec_boolean ("scene-cut",
+          "Scene Cut Detection",
+          "Start a new GOP at scene changes",
+          FALSE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   return props;
 }
 
@@ -38,12 +38,15 @@ typedef struct _GstVaapiEncoderMpeg2 GstVaapiEncoderMpeg2;
  * @GST_VAAPI_ENCODER_MPEG2_PROP_QUANTIZER: Constant quantizer value (uint).
  * @GST_VAAPI_ENCODER_MPEG2_PROP_MAX_BFRAMES: Number of B-frames between I
  *   and P (uint).
+ * @GST_VAAPI_ENCODER_MPEG2_PROP_SCENE_CUT: Start a new GOP at scene
+ *   changes (bool).
  *
  * The set of MPEG-2 encoder specific configurable properties.
  */
 typedef enum {
   GST_VAAPI_ENCODER_MPEG2_PROP_QUANTIZER = -1,
   GST_VAAPI_ENCODER_MPEG2_PROP_MAX_BFRAMES = -2,
+  GST_VAAPI_ENCODER_MPEG2_PROP_SCENE_CUT = -3,
 } GstVaapiEncoderMpeg2Prop;
 
 GstVaapiEncoder *
@@ -25,6 +25,7 @@
 #define GST_VAAPI_ENCODER_MPEG2_PRIV_H
 
 #include "gstvaapiencoder_priv.h"
+#include "gstvaapiencoder_scenecut.h"
 #include "gstvaapiutils_mpeg2.h"
 
 G_BEGIN_DECLS
@@ -54,6 +55,8 @@ struct _GstVaapiEncoderMpeg2
   GQueue b_frames;
   gboolean dump_frames;
   gboolean new_gop;
+  gboolean scene_cut_detection;
+  GstVaapiEncSceneCut *scene_cut;
 
   /* reference list */
   GstVaapiSurfaceProxy *forward;
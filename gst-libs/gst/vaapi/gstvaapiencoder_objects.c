@@ -23,6 +23,7 @@
 #include "sysdeps.h"
 #include "gstvaapiencoder_objects.h"
 #include "gstvaapiencoder_priv.h"
+#include "gstvaapicontext_buffers.h"
 #include "gstvaapisurfaceproxy_priv.h"
 #include "gstvaapicompat.h"
 #include "gstvaapiutils.h"
@@ -33,6 +34,7 @@
 #define GET_ENCODER(obj)    GST_VAAPI_ENCODER_CAST((obj)->parent_instance.codec)
 #define GET_VA_DISPLAY(obj) GET_ENCODER(obj)->va_display
 #define GET_VA_CONTEXT(obj) GET_ENCODER(obj)->va_context
+#define GET_CONTEXT(obj)    GET_ENCODER(obj)->context
 
 /* ------------------------------------------------------------------------- */
 /* --- Encoder Packed Header                                             --- */
@@ -44,8 +46,8 @@ GST_VAAPI_CODEC_DEFINE_TYPE (GstVaapiEncPackedHeader,
 void
 gst_vaapi_enc_packed_header_destroy (GstVaapiEncPackedHeader * header)
 {
-  vaapi_destroy_buffer (GET_VA_DISPLAY (header), &header->param_id);
-  vaapi_destroy_buffer (GET_VA_DISPLAY (header), &header->data_id);
+  gst_vaapi_context_destroy_buffer (GET_CONTEXT (header), &header->param_id);
+  gst_vaapi_context_destroy_buffer (GET_CONTEXT (header), &header->data_id);
   header->param = NULL;
   header->data = NULL;
 }
@@ -59,20 +61,18 @@ gst_vaapi_enc_packed_header_create (GstVaapiEncPackedHeader * header,
   header->param_id = VA_INVALID_ID;
   header->data_id = VA_INVALID_ID;
 
-  success = vaapi_create_buffer (GET_VA_DISPLAY (header),
-      GET_VA_CONTEXT (header),
-      VAEncPackedHeaderParameterBufferType,
-      args->param_size, args->param, &header->param_id, &header->param);
+  success = gst_vaapi_context_create_buffer (GET_CONTEXT (header),
+      VAEncPackedHeaderParameterBufferType, args->param_size, args->param,
+      &header->param_id, &header->param);
   if (!success)
     return FALSE;
 
   if (!args->data_size)
     return TRUE;
 
-  success = vaapi_create_buffer (GET_VA_DISPLAY (header),
-      GET_VA_CONTEXT (header),
-      VAEncPackedHeaderDataBufferType,
-      args->data_size, args->data, &header->data_id, &header->data);
+  success = gst_vaapi_context_create_buffer (GET_CONTEXT (header),
+      VAEncPackedHeaderDataBufferType, args->data_size, args->data,
+      &header->data_id, &header->data);
   if (!success)
     return FALSE;
   return TRUE;
@@ -95,13 +95,12 @@ gst_vaapi_enc_packed_header_set_data (GstVaapiEncPackedHeader * header,
 {
   gboolean success;
 
-  vaapi_destroy_buffer (GET_VA_DISPLAY (header), &header->data_id);
+  gst_vaapi_context_destroy_buffer (GET_CONTEXT (header), &header->data_id);
   header->data = NULL;
 
-  success = vaapi_create_buffer (GET_VA_DISPLAY (header),
-      GET_VA_CONTEXT (header),
-      VAEncPackedHeaderDataBufferType,
-      data_size, data, &header->data_id, &header->data);
+  success = gst_vaapi_context_create_buffer (GET_CONTEXT (header),
+      VAEncPackedHeaderDataBufferType, data_size, data, &header->data_id,
+      &header->data);
   if (!success)
     return FALSE;
   return TRUE;
@@ -116,7 +115,8 @@ GST_VAAPI_CODEC_DEFINE_TYPE (GstVaapiEncSequence, gst_vaapi_enc_sequence);
 void
 gst_vaapi_enc_sequence_destroy (GstVaapiEncSequence * sequence)
 {
-  vaapi_destroy_buffer (GET_VA_DISPLAY (sequence), &sequence->param_id);
+  gst_vaapi_context_destroy_buffer (GET_CONTEXT (sequence),
+      &sequence->param_id);
   sequence->param = NULL;
 }
 
@@ -127,10 +127,9 @@ gst_vaapi_enc_sequence_create (GstVaapiEncSequence * sequence,
   gboolean success;
 
   sequence->param_id = VA_INVALID_ID;
-  success = vaapi_create_buffer (GET_VA_DISPLAY (sequence),
-      GET_VA_CONTEXT (sequence),
-      VAEncSequenceParameterBufferType,
-      args->param_size, args->param, &sequence->param_id, &sequence->param);
+  success = gst_vaapi_context_create_buffer (GET_CONTEXT (sequence),
+      VAEncSequenceParameterBufferType, args->param_size, args->param,
+      &sequence->param_id, &sequence->param);
   if (!success)
     return FALSE;
   return TRUE;
@@ -161,7 +160,7 @@ gst_vaapi_enc_slice_destroy (GstVaapiEncSlice * slice)
     slice->packed_headers = NULL;
   }
 
-  vaapi_destroy_buffer (GET_VA_DISPLAY (slice), &slice->param_id);
+  gst_vaapi_context_destroy_buffer (GET_CONTEXT (slice), &slice->param_id);
   slice->param = NULL;
 }
 
@@ -172,10 +171,9 @@ gst_vaapi_enc_slice_create (GstVaapiEncSlice * slice,
   gboolean success;
 
   slice->param_id = VA_INVALID_ID;
-  success = vaapi_create_buffer (GET_VA_DISPLAY (slice),
-      GET_VA_CONTEXT (slice),
-      VAEncSliceParameterBufferType,
-      args->param_size, args->param, &slice->param_id, &slice->param);
+  success = gst_vaapi_context_create_buffer (GET_CONTEXT (slice),
+      VAEncSliceParameterBufferType, args->param_size, args->param,
+      &slice->param_id, &slice->param);
   if (!success)
     return FALSE;
 
@@ -207,7 +205,7 @@ GST_VAAPI_CODEC_DEFINE_TYPE (GstVaapiEncMiscParam, gst_vaapi_enc_misc_param);
 void
 gst_vaapi_enc_misc_param_destroy (GstVaapiEncMiscParam * misc)
 {
-  vaapi_destroy_buffer (GET_VA_DISPLAY (misc), &misc->param_id);
+  gst_vaapi_context_destroy_buffer (GET_CONTEXT (misc), &misc->param_id);
   misc->param = NULL;
   misc->data = NULL;
 }
@@ -219,10 +217,9 @@ gst_vaapi_enc_misc_param_create (GstVaapiEncMiscParam * misc,
   gboolean success;
 
   misc->param_id = VA_INVALID_ID;
-  success = vaapi_create_buffer (GET_VA_DISPLAY (misc),
-      GET_VA_CONTEXT (misc),
-      VAEncMiscParameterBufferType,
-      args->param_size, args->param, &misc->param_id, &misc->param);
+  success = gst_vaapi_context_create_buffer (GET_CONTEXT (misc),
+      VAEncMiscParameterBufferType, args->param_size, args->param,
+      &misc->param_id, &misc->param);
   if (!success)
     return FALSE;
   return TRUE;
@@ -258,7 +255,8 @@ GST_VAAPI_CODEC_DEFINE_TYPE (GstVaapiEncQMatrix, gst_vaapi_enc_q_matrix);
 void
 gst_vaapi_enc_q_matrix_destroy (GstVaapiEncQMatrix * q_matrix)
 {
-  vaapi_destroy_buffer (GET_VA_DISPLAY (q_matrix), &q_matrix->param_id);
+  gst_vaapi_context_destroy_buffer (GET_CONTEXT (q_matrix),
+      &q_matrix->param_id);
   q_matrix->param = NULL;
 }
 
@@ -267,9 +265,9 @@ gst_vaapi_enc_q_matrix_create (GstVaapiEncQMatrix * q_matrix,
     const GstVaapiCodecObjectConstructorArgs * args)
 {
   q_matrix->param_id = VA_INVALID_ID;
-  return vaapi_create_buffer (GET_VA_DISPLAY (q_matrix),
-      GET_VA_CONTEXT (q_matrix), VAQMatrixBufferType,
-      args->param_size, args->param, &q_matrix->param_id, &q_matrix->param);
+  return gst_vaapi_context_create_buffer (GET_CONTEXT (q_matrix),
+      VAQMatrixBufferType, args->param_size, args->param, &q_matrix->param_id,
+      &q_matrix->param);
 }
 
 GstVaapiEncQMatrix *
@@ -296,7 +294,8 @@ GST_VAAPI_CODEC_DEFINE_TYPE (GstVaapiEncHuffmanTable,
 void
 gst_vaapi_enc_huffman_table_destroy (GstVaapiEncHuffmanTable * huf_table)
 {
-  vaapi_destroy_buffer (GET_VA_DISPLAY (huf_table), &huf_table->param_id);
+  gst_vaapi_context_destroy_buffer (GET_CONTEXT (huf_table),
+      &huf_table->param_id);
   huf_table->param = NULL;
 }
 
@@ -305,9 +304,9 @@ gst_vaapi_enc_huffman_table_create (GstVaapiEncHuffmanTable * huf_table,
     const GstVaapiCodecObjectConstructorArgs * args)
 {
   huf_table->param_id = VA_INVALID_ID;
-  return vaapi_create_buffer (GET_VA_DISPLAY (huf_table),
-      GET_VA_CONTEXT (huf_table), VAHuffmanTableBufferType, args->param_size,
-      args->param, &huf_table->param_id, (void **) &huf_table->param);
+  return gst_vaapi_context_create_buffer (GET_CONTEXT (huf_table),
+      VAHuffmanTableBufferType, args->param_size, args->param,
+      &huf_table->param_id, (void **) &huf_table->param);
 }
 
 GstVaapiEncHuffmanTable *
@@ -328,7 +327,11 @@ gst_vaapi_enc_huffman_table_new (GstVaapiEncoder * encoder,
 /* --- Encoder Picture                                                   --- */
 /* ------------------------------------------------------------------------- */
 
-GST_VAAPI_CODEC_DEFINE_TYPE (GstVaapiEncPicture, gst_vaapi_enc_picture);
+static void gst_vaapi_enc_picture_reset (GstVaapiEncPicture * picture);
+static void gst_vaapi_enc_picture_release (GstVaapiEncPicture * picture);
+
+GST_VAAPI_CODEC_DEFINE_TYPE_FULL (GstVaapiEncPicture, gst_vaapi_enc_picture,
+    gst_vaapi_enc_picture_reset, gst_vaapi_enc_picture_release);
 
 void
 gst_vaapi_enc_picture_destroy (GstVaapiEncPicture * picture)
@@ -355,7 +358,7 @@ gst_vaapi_enc_picture_destroy (GstVaapiEncPicture * picture)
   picture->surface_id = VA_INVALID_ID;
   picture->surface = NULL;
 
-  vaapi_destroy_buffer (GET_VA_DISPLAY (picture), &picture->param_id);
+  gst_vaapi_context_destroy_buffer (GET_CONTEXT (picture), &picture->param_id);
   picture->param = NULL;
 
   if (picture->frame) {
@@ -364,6 +367,50 @@ gst_vaapi_enc_picture_destroy (GstVaapiEncPicture * picture)
   }
 }
 
+/* Destroys the picture, but keeps its arrays of packed headers, misc
+   parameters and slices so that the picture is reused with them */
+static void
+gst_vaapi_enc_picture_reset (GstVaapiEncPicture * picture)
+{
+  GPtrArray *const packed_headers = picture->packed_headers;
+  GPtrArray *const misc_params = picture->misc_params;
+  GPtrArray *const slices = picture->slices;
+
+  picture->packed_headers = NULL;
+  picture->misc_params = NULL;
+  picture->slices = NULL;
+  if (packed_headers)
+    g_ptr_array_set_size (packed_headers, 0);
+  if (misc_params)
+    g_ptr_array_set_size (misc_params, 0);
+  if (slices)
+    g_ptr_array_set_size (slices, 0);
+
+  gst_vaapi_enc_picture_destroy (picture);
+  memset ((guchar *) picture + sizeof (GstVaapiMiniObject), 0,
+      sizeof (*picture) - sizeof (GstVaapiMiniObject));
+  picture->packed_headers = packed_headers;
+  picture->misc_params = misc_params;
+  picture->slices = slices;
+}
+
+static void
+gst_vaapi_enc_picture_release (GstVaapiEncPicture * picture)
+{
+  if (picture->packed_headers) {
+    g_ptr_array_unref (picture->packed_headers);
+    picture->packed_headers = NULL;
+  }
+  if (picture->misc_params) {
+    g_ptr_array_unref (picture->misc_params);
+    picture->misc_params = NULL;
+  }
+  if (picture->slices) {
+    g_ptr_array_unref (picture->slices);
+    picture->slices = NULL;
+  }
+}
+
 gboolean
 gst_vaapi_enc_picture_create (GstVaapiEncPicture * picture,
     const GstVaapiCodecObjectConstructorArgs * args)
@@ -390,26 +437,28 @@ gst_vaapi_enc_picture_create (GstVaapiEncPicture * picture,
 
   picture->param_id = VA_INVALID_ID;
   picture->param_size = args->param_size;
-  success = vaapi_create_buffer (GET_VA_DISPLAY (picture),
-      GET_VA_CONTEXT (picture),
-      VAEncPictureParameterBufferType,
-      args->param_size, args->param, &picture->param_id, &picture->param);
+  success = gst_vaapi_context_create_buffer (GET_CONTEXT (picture),
+      VAEncPictureParameterBufferType, args->param_size, args->param,
+      &picture->param_id, &picture->param);
   if (!success)
     return FALSE;
   picture->param_size = args->param_size;
 
-  picture->packed_headers = g_ptr_array_new_with_free_func ((GDestroyNotify)
-      gst_vaapi_mini_object_unref);
+  if (!picture->packed_headers)
+    picture->packed_headers = g_ptr_array_new_with_free_func ((GDestroyNotify)
+        gst_vaapi_mini_object_unref);
   if (!picture->packed_headers)
     return FALSE;
 
-  picture->misc_params = g_ptr_array_new_with_free_func ((GDestroyNotify)
-      gst_vaapi_mini_object_unref);
+  if (!picture->misc_params)
+    picture->misc_params = g_ptr_array_new_with_free_func ((GDestroyNotify)
+        gst_vaapi_mini_object_unref);
   if (!picture->misc_params)
     return FALSE;
 
-  picture->slices = g_ptr_array_new_with_free_func ((GDestroyNotify)
-      gst_vaapi_mini_object_unref);
+  if (!picture->slices)
+    picture->slices = g_ptr_array_new_with_free_func ((GDestroyNotify)
+        gst_vaapi_mini_object_unref);
   if (!picture->slices)
     return FALSE;
 
@@ -481,60 +530,76 @@ gst_vaapi_enc_slice_add_packed_header (GstVaapiEncSlice * slice,
   g_ptr_array_add (slice->packed_headers, gst_vaapi_codec_object_ref (header));
 }
 
+/* Number of VA buffers that can be recycled without extra allocation */
+#define MAX_STATIC_VA_BUFFERS 64
+
+typedef struct
+{
+  VADisplay va_display;
+  VAContextID va_context;
+  VABufferID **buf_id_ptrs;
+  guint num_buffers;
+  VABufferID *static_buf_id_ptrs[MAX_STATIC_VA_BUFFERS];
+} EncodeBatch;
+
+static guint
+get_max_buffers (GstVaapiEncPicture * picture)
+{
+  guint i, max_buffers;
+
+  /* Sequence, quantization matrix, huffman table and picture parameters */
+  max_buffers = 4 + 2 * picture->packed_headers->len +
+      picture->misc_params->len;
+  for (i = 0; i < picture->slices->len; i++) {
+    GstVaapiEncSlice *const slice = g_ptr_array_index (picture->slices, i);
+    max_buffers += 1 + 2 * slice->packed_headers->len;
+  }
+  return max_buffers;
+}
+
 static gboolean
-do_encode (VADisplay dpy, VAContextID ctx, VABufferID * buf_id, void **buf_ptr)
+do_encode (EncodeBatch * batch, VABufferID * buf_id, void **buf_ptr)
 {
   VAStatus status;
 
-  vaapi_unmap_buffer (dpy, *buf_id, buf_ptr);
+  vaapi_unmap_buffer (batch->va_display, *buf_id, buf_ptr);
 
-  status = vaRenderPicture (dpy, ctx, buf_id, 1);
+  status = vaRenderPicture (batch->va_display, batch->va_context, buf_id, 1);
   if (!vaapi_check_status (status, "vaRenderPicture()"))
     return FALSE;
 
-  /* XXX: vaRenderPicture() is meant to destroy the VA buffer implicitly */
-  vaapi_destroy_buffer (dpy, buf_id);
+  /* The VA buffer is recycled once the whole picture was submitted */
+  batch->buf_id_ptrs[batch->num_buffers++] = buf_id;
   return TRUE;
 }
 
-gboolean
-gst_vaapi_enc_picture_encode (GstVaapiEncPicture * picture)
+static gboolean
+encode_picture (GstVaapiEncPicture * picture, EncodeBatch * batch)
 {
   GstVaapiEncSequence *sequence;
   GstVaapiEncQMatrix *q_matrix;
   GstVaapiEncHuffmanTable *huf_table;
-  VADisplay va_display;
-  VAContextID va_context;
   VAStatus status;
   guint i;
 
-  g_return_val_if_fail (picture != NULL, FALSE);
-  g_return_val_if_fail (picture->surface_id != VA_INVALID_SURFACE, FALSE);
-
-  va_display = GET_VA_DISPLAY (picture);
-  va_context = GET_VA_CONTEXT (picture);
-
-  GST_DEBUG ("encode picture 0x%08x", picture->surface_id);
-
-  status = vaBeginPicture (va_display, va_context, picture->surface_id);
+  status = vaBeginPicture (batch->va_display, batch->va_context,
+      picture->surface_id);
   if (!vaapi_check_status (status, "vaBeginPicture()"))
     return FALSE;
 
   /* Submit Sequence parameter */
   sequence = picture->sequence;
-  if (sequence && !do_encode (va_display, va_context,
-          &sequence->param_id, &sequence->param))
+  if (sequence && !do_encode (batch, &sequence->param_id, &sequence->param))
     return FALSE;
 
   /* Submit Quantization matrix */
   q_matrix = picture->q_matrix;
-  if (q_matrix && !do_encode (va_display, va_context,
-          &q_matrix->param_id, &q_matrix->param))
+  if (q_matrix && !do_encode (batch, &q_matrix->param_id, &q_matrix->param))
     return FALSE;
 
   /* Submit huffman table */
   huf_table = picture->huf_table;
-  if (huf_table && !do_encode (va_display, va_context,
+  if (huf_table && !do_encode (batch,
           &huf_table->param_id, (void **) &huf_table->param))
     return FALSE;
 
@@ -542,9 +607,8 @@ gst_vaapi_enc_picture_encode (GstVaapiEncPicture * picture)
   for (i = 0; i < picture->packed_headers->len; i++) {
     GstVaapiEncPackedHeader *const header =
         g_ptr_array_index (picture->packed_headers, i);
-    if (!do_encode (va_display, va_context,
-            &header->param_id, &header->param) ||
-        !do_encode (va_display, va_context, &header->data_id, &header->data))
+    if (!do_encode (batch, &header->param_id, &header->param) ||
+        !do_encode (batch, &header->data_id, &header->data))
       return FALSE;
   }
 
@@ -552,12 +616,12 @@ gst_vaapi_enc_picture_encode (GstVaapiEncPicture * picture)
   for (i = 0; i < picture->misc_params->len; i++) {
     GstVaapiEncMiscParam *const misc =
         g_ptr_array_index (picture->misc_params, i);
-    if (!do_encode (va_display, va_context, &misc->param_id, &misc->param))
+    if (!do_encode (batch, &misc->param_id, &misc->param))
       return FALSE;
   }
 
   /* Submit Picture parameter */
-  if (!do_encode (va_display, va_context, &picture->param_id, &picture->param))
+  if (!do_encode (batch, &picture->param_id, &picture->param))
     return FALSE;
 
   /* Submit Slice parameters */
@@ -569,17 +633,49 @@ gst_vaapi_enc_picture_encode (GstVaapiEncPicture * picture)
     for (j = 0; j < slice->packed_headers->len; j++) {
       GstVaapiEncPackedHeader *const header =
           g_ptr_array_index (slice->packed_headers, j);
-      if (!do_encode (va_display, va_context,
-              &header->param_id, &header->param) ||
-          !do_encode (va_display, va_context, &header->data_id, &header->data))
+      if (!do_encode (batch, &header->param_id, &header->param) ||
+          !do_encode (batch, &header->data_id, &header->data))
         return FALSE;
     }
-    if (!do_encode (va_display, va_context, &slice->param_id, &slice->param))
+    if (!do_encode (batch, &slice->param_id, &slice->param))
       return FALSE;
   }
 
-  status = vaEndPicture (va_display, va_context);
+  status = vaEndPicture (batch->va_display, batch->va_context);
   if (!vaapi_check_status (status, "vaEndPicture()"))
     return FALSE;
   return TRUE;
 }
+
+gboolean
+gst_vaapi_enc_picture_encode (GstVaapiEncPicture * picture)
+{
+  EncodeBatch batch;
+  guint max_buffers;
+  gboolean success;
+
+  g_return_val_if_fail (picture != NULL, FALSE);
+  g_return_val_if_fail (picture->surface_id != VA_INVALID_SURFACE, FALSE);
+
+  GST_DEBUG ("encode picture 0x%08x", picture->surface_id);
+
+  batch.va_display = GET_VA_DISPLAY (picture);
+  batch.va_context = GET_VA_CONTEXT (picture);
+  batch.num_buffers = 0;
+
+  max_buffers = get_max_buffers (picture);
+  if (max_buffers <= MAX_STATIC_VA_BUFFERS)
+    batch.buf_id_ptrs = batch.static_buf_id_ptrs;
+  else
+    batch.buf_id_ptrs = g_new (VABufferID *, max_buffers);
+
+  /* On error, the buffers are destroyed along with the codec objects */
+  success = encode_picture (picture, &batch);
+  if (success)
+    gst_vaapi_context_recycle_buffers (GET_CONTEXT (picture),
+        batch.buf_id_ptrs, batch.num_buffers);
+
+  if (batch.buf_id_ptrs != batch.static_buf_id_ptrs)
+    g_free (batch.buf_id_ptrs);
+  return success;
+}
@@ -30,6 +30,8 @@
 #include <gst/vaapi/gstvaapivideopool.h>
 #include <gst/video/gstvideoutils.h>
 #include <gst/vaapi/gstvaapivalue.h>
+#include "gstvaapiencoder_lookahead.h"
+#include "gstvaapiencoder_scenecut.h"
 
 G_BEGIN_DECLS
 
@@ -195,6 +197,18 @@ G_GNUC_INTERNAL
 GPtrArray *
 gst_vaapi_encoder_properties_get_default (const GstVaapiEncoderClass * klass);
 
+G_GNUC_INTERNAL
+guint
+gst_vaapi_encoder_get_lookahead_qp (GstVaapiEncoder * encoder,
+    GstVideoCodecFrame * frame, gboolean is_intra, guint qp_init,
+    guint qp_min, guint qp_max);
+
+G_GNUC_INTERNAL
+gboolean
+gst_vaapi_encoder_detect_scene_cut (GstVaapiEncoder * encoder,
+    GstVaapiEncSceneCut * scene_cut, GstVideoCodecFrame * frame,
+    GstVaapiSurface * surface);
+
 struct _GstVaapiEncoder
 {
   /*< private >*/
@@ -216,14 +230,30 @@ struct _GstVaapiEncoder
   guint32 rate_control_mask;
   guint bitrate; /* kbps */
   guint keyframe_period;
+  guint lookahead_depth;
+  GstVaapiEncLookahead *lookahead;
 
   GMutex mutex;
   GCond surface_free;
   GCond codedbuf_free;
   guint codedbuf_size;
   GstVaapiVideoPool *codedbuf_pool;
-  GAsyncQueue *codedbuf_queue;
+  GQueue codedbuf_queue;
+  GCond codedbuf_ready;
   guint32 num_codedbuf_queued;
+  gboolean codedbuf_flushing;
+  guint async_depth;
+  GCond picture_done;
+  gboolean completion_polling;
+
+  /* Encode latency statistics, protected by mutex */
+  guint64 stats_num_frames;
+  GstClockTime stats_latency_last;
+  GstClockTime stats_latency_min;
+  GstClockTime stats_latency_max;
+  GstClockTime stats_latency_total;
+
+  gchar *owner;
 
   guint got_packed_headers:1;
   guint got_rate_control_mask:1;
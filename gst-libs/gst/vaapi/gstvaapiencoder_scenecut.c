@@ -0,0 +1,202 @@
+/*
+ *  gstvaapiencoder_scenecut.c - Scene change detection
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation; either version 2.1
+ *  of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free
+ *  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301 USA
+ */
+
+/*
+ * The scene change detector compares each input frame with the
+ * previous one, using the low-resolution luma planes also used by the
+ * lookahead rate control. Two metrics are combined:
+ *
+ * - the ratio between the inter cost (SAD against the co-located
+ *   blocks of the previous frame) and the intra cost of the frame. It
+ *   gets close to 1 when temporal prediction no longer helps;
+ * - the normalized difference between the luma histograms of both
+ *   frames, which is robust to motion but catches global changes of
+ *   brightness or content.
+ *
+ * A scene cut is reported when both metrics are high, or when the
+ * histograms alone are almost disjoint (e.g. cuts between flat
+ * frames, which have no meaningful intra cost). Cuts closer than
+ * MIN_CUT_DISTANCE frames are ignored so that flashes and fast
+ * transitions do not produce a burst of key frames.
+ *
+ * With the lookahead rate control, the metrics it computed when the
+ * frame entered its window are fed through gst_vaapi_enc_scene_cut_update()
+ * instead, so that each frame is only read back once.
+ */
+
+#include "sysdeps.h"
+#include "gstvaapiencoder_scenecut.h"
+#include "gstvaapiencoder_lookahead.h"
+
+#define DEBUG 1
+#include "gstvaapidebug.h"
+
+/* Inter/intra cost ratio above which prediction is deemed useless */
+#define CUT_COST_RATIO 0.75
+
+/* Histogram difference required together with a high cost ratio */
+#define CUT_HISTOGRAM_DIFF 0.35
+
+/* Histogram difference that is a scene cut on its own */
+#define CUT_HISTOGRAM_DIFF_STRONG 0.75
+
+/* Minimal number of frames between two scene cuts */
+#define MIN_CUT_DISTANCE 4
+
+struct _GstVaapiEncSceneCut
+{
+  GstVaapiEncLowres lowres[2];
+  guint index;
+  gboolean has_ref;
+  guint distance;
+};
+
+/**
+ * gst_vaapi_enc_scene_cut_new:
+ *
+ * Creates a new scene change detector.
+ *
+ * Return value: the newly allocated #GstVaapiEncSceneCut
+ */
+GstVaapiEncSceneCut *
+gst_vaapi_enc_scene_cut_new (void)
+{
+  return g_slice_new0 (GstVaapiEncSceneCut);
+}
+
+/**
+ * gst_vaapi_enc_scene_cut_free:
+ * @scene_cut: a #GstVaapiEncSceneCut
+ *
+ * Releases @scene_cut and all associated resources.
+ */
+void
+gst_vaapi_enc_scene_cut_free (GstVaapiEncSceneCut * scene_cut)
+{
+  if (!scene_cut)
+    return;
+
+  gst_vaapi_enc_lowres_clear (&scene_cut->lowres[0]);
+  gst_vaapi_enc_lowres_clear (&scene_cut->lowres[1]);
+  g_slice_free (GstVaapiEncSceneCut, scene_cut);
+}
+
+/**
+ * gst_vaapi_enc_scene_cut_reset:
+ * @scene_cut: a #GstVaapiEncSceneCut
+ *
+ * Forgets about the previous frame, e.g. after a flush or a
+ * discontinuity. The next frame is never reported as a scene cut.
+ */
+void
+gst_vaapi_enc_scene_cut_reset (GstVaapiEncSceneCut * scene_cut)
+{
+  g_return_if_fail (scene_cut != NULL);
+
+  scene_cut->has_ref = FALSE;
+  scene_cut->distance = 0;
+}
+
+/**
+ * gst_vaapi_enc_scene_cut_update:
+ * @scene_cut: a #GstVaapiEncSceneCut
+ * @intra_cost: the intra cost of the next input frame
+ * @inter_cost: the inter cost of the next input frame, predicted from
+ *   the previous one
+ * @histogram_diff: the luma histogram difference between the next
+ *   input frame and the previous one
+ *
+ * Same as gst_vaapi_enc_scene_cut_detect(), but with metrics computed
+ * elsewhere from the low-resolution luma planes, e.g. by the lookahead
+ * rate control, rather than by reading back the frame again.
+ *
+ * Return value: %TRUE if the next input frame starts a new scene
+ */
+gboolean
+gst_vaapi_enc_scene_cut_update (GstVaapiEncSceneCut * scene_cut,
+    guint64 intra_cost, guint64 inter_cost, gdouble histogram_diff)
+{
+  gdouble cost_ratio;
+  gboolean is_cut;
+
+  g_return_val_if_fail (scene_cut != NULL, FALSE);
+
+  scene_cut->distance++;
+  if (scene_cut->distance < MIN_CUT_DISTANCE)
+    return FALSE;
+
+  cost_ratio = intra_cost > 0 ? (gdouble) inter_cost / intra_cost : 0.0;
+  is_cut = (cost_ratio > CUT_COST_RATIO &&
+      histogram_diff > CUT_HISTOGRAM_DIFF) ||
+      histogram_diff > CUT_HISTOGRAM_DIFF_STRONG;
+  if (is_cut) {
+    GST_DEBUG ("scene cut detected (cost ratio %.2f, histogram diff %.2f)",
+        cost_ratio, histogram_diff);
+    scene_cut->distance = 0;
+  }
+  return is_cut;
+}
+
+/**
+ * gst_vaapi_enc_scene_cut_detect:
+ * @scene_cut: a #GstVaapiEncSceneCut
+ * @surface: the #GstVaapiSurface holding the next input frame
+ *
+ * Analyzes the next input frame in display order and determines
+ * whether it starts a new scene, in which case the encoder should
+ * code it as a key frame rather than predict it from the previous
+ * frames.
+ *
+ * Return value: %TRUE if @surface starts a new scene
+ */
+gboolean
+gst_vaapi_enc_scene_cut_detect (GstVaapiEncSceneCut * scene_cut,
+    GstVaapiSurface * surface)
+{
+  GstVaapiEncLowres *cur, *ref;
+  gboolean is_cut;
+
+  g_return_val_if_fail (scene_cut != NULL, FALSE);
+  g_return_val_if_fail (surface != NULL, FALSE);
+
+  cur = &scene_cut->lowres[scene_cut->index];
+  ref = &scene_cut->lowres[scene_cut->index ^ 1];
+
+  if (!gst_vaapi_enc_lowres_update (cur, surface)) {
+    GST_WARNING ("failed to analyze surface, skipping scene cut detection");
+    gst_vaapi_enc_scene_cut_reset (scene_cut);
+    return FALSE;
+  }
+
+  if (scene_cut->has_ref)
+    is_cut = gst_vaapi_enc_scene_cut_update (scene_cut,
+        gst_vaapi_enc_lowres_intra_cost (cur),
+        gst_vaapi_enc_lowres_inter_cost (cur, ref),
+        gst_vaapi_enc_lowres_histogram_diff (cur, ref));
+  else {
+    scene_cut->distance++;
+    is_cut = FALSE;
+  }
+
+  scene_cut->has_ref = TRUE;
+  scene_cut->index ^= 1;
+  return is_cut;
+}
@@ -0,0 +1,55 @@
+/*
+ *  gstvaapiencoder_scenecut.h - Scene change detection (private)
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation; either version 2.1
+ *  of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free
+ *  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301 USA
+ */
+
+#ifndef GST_VAAPI_ENCODER_SCENECUT_H
+#define GST_VAAPI_ENCODER_SCENECUT_H
+
+#include <gst/vaapi/gstvaapisurface.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GstVaapiEncSceneCut GstVaapiEncSceneCut;
+
+G_GNUC_INTERNAL
+GstVaapiEncSceneCut *
+gst_vaapi_enc_scene_cut_new (void);
+
+G_GNUC_INTERNAL
+void
+gst_vaapi_enc_scene_cut_free (GstVaapiEncSceneCut * scene_cut);
+
+G_GNUC_INTERNAL
+void
+gst_vaapi_enc_scene_cut_reset (GstVaapiEncSceneCut * scene_cut);
+
+G_GNUC_INTERNAL
+gboolean
+gst_vaapi_enc_scene_cut_detect (GstVaapiEncSceneCut * scene_cut,
+    GstVaapiSurface * surface);
+
+G_GNUC_INTERNAL
+gboolean
+gst_vaapi_enc_scene_cut_update (GstVaapiEncSceneCut * scene_cut,
+    guint64 intra_cost, guint64 inter_cost, gdouble histogram_diff);
+
+G_END_DECLS
+
+#endif /* GST_VAAPI_ENCODER_SCENECUT_H */
@@ -34,6 +34,8 @@
 #include "gstvaapiimage.h"
 #include "gstvaapiimage_priv.h"
 #include "gstvaapiobject_priv.h"
+#include "gstvaapiutils_convert.h"
+#include "gstvaapiutils_copy.h"
 
 #define DEBUG 1
 #include "gstvaapidebug.h"
@@ -693,130 +695,163 @@ gst_vaapi_image_get_data_size (GstVaapiImage * image)
 #include <gst/video/gstvideometa.h>
 
 static gboolean
-init_image_from_video_meta (GstVaapiImageRaw * raw_image, GstVideoMeta * vmeta)
-{
-  GST_FIXME ("map from GstVideoMeta + add fini_image_from_buffer()");
-  return FALSE;
-}
-
-static gboolean
-init_image_from_buffer (GstVaapiImageRaw * raw_image, GstBuffer * buffer)
+map_image_from_buffer (GstVaapiImageRaw * raw_image, GstVideoFrame * frame,
+    GstBuffer * buffer, GstVaapiImage * image, GstMapFlags flags)
 {
   GstVideoMeta *const vmeta = gst_buffer_get_video_meta (buffer);
+  GstVideoInfo vi;
+  guint i;
+
+  /* gst_video_frame_map() picks the strides and offsets up from the
+     GstVideoMeta, if any. Otherwise, assume the default layout */
+  if (vmeta)
+    gst_video_info_set_format (&vi, vmeta->format, vmeta->width,
+        vmeta->height);
+  else
+    gst_video_info_set_format (&vi, image->format, image->width,
+        image->height);
+
+  if (!gst_video_frame_map (frame, &vi, buffer, flags))
+    return FALSE;
 
-  return vmeta ? init_image_from_video_meta (raw_image, vmeta) : FALSE;
+  raw_image->format = GST_VIDEO_FRAME_FORMAT (frame);
+  raw_image->width = GST_VIDEO_FRAME_WIDTH (frame);
+  raw_image->height = GST_VIDEO_FRAME_HEIGHT (frame);
+  raw_image->num_planes = GST_VIDEO_FRAME_N_PLANES (frame);
+  if (raw_image->num_planes > G_N_ELEMENTS (raw_image->pixels)) {
+    gst_video_frame_unmap (frame);
+    return FALSE;
+  }
+
+  for (i = 0; i < raw_image->num_planes; i++) {
+    raw_image->pixels[i] = GST_VIDEO_FRAME_PLANE_DATA (frame, i);
+    raw_image->stride[i] = GST_VIDEO_FRAME_PLANE_STRIDE (frame, i);
+  }
+  return TRUE;
 }
 
-/* Copy N lines of an image */
 static inline void
-memcpy_pic (guchar * dst,
-    guint dst_stride,
-    const guchar * src, guint src_stride, guint len, guint height)
+init_copy_plane (GstVaapiCopyPlane * plane, GstVaapiImageRaw * dst_image,
+    GstVaapiImageRaw * src_image, guint index, guint x, guint y,
+    guint width, guint height)
 {
-  guint i;
-
-  for (i = 0; i < height; i++) {
-    memcpy (dst, src, len);
-    dst += dst_stride;
-    src += src_stride;
-  }
+  plane->dst_stride = dst_image->stride[index];
+  plane->dst = dst_image->pixels[index] + y * plane->dst_stride + x;
+  plane->src_stride = src_image->stride[index];
+  plane->src = src_image->pixels[index] + y * plane->src_stride + x;
+  plane->width = width;
+  plane->height = height;
 }
 
 /* Copy NV12 images */
-static void
-copy_image_NV12 (GstVaapiImageRaw * dst_image,
+static guint
+copy_image_NV12 (GstVaapiCopyPlane * planes, GstVaapiImageRaw * dst_image,
     GstVaapiImageRaw * src_image, const GstVaapiRectangle * rect)
 {
-  guchar *dst, *src;
-  guint dst_stride, src_stride;
-
   /* Y plane */
-  dst_stride = dst_image->stride[0];
-  dst = dst_image->pixels[0] + rect->y * dst_stride + rect->x;
-  src_stride = src_image->stride[0];
-  src = src_image->pixels[0] + rect->y * src_stride + rect->x;
-  memcpy_pic (dst, dst_stride, src, src_stride, rect->width, rect->height);
+  init_copy_plane (&planes[0], dst_image, src_image, 0, rect->x, rect->y,
+      rect->width, rect->height);
 
   /* UV plane */
-  dst_stride = dst_image->stride[1];
-  dst = dst_image->pixels[1] + (rect->y / 2) * dst_stride + (rect->x & -2);
-  src_stride = src_image->stride[1];
-  src = src_image->pixels[1] + (rect->y / 2) * src_stride + (rect->x & -2);
-  memcpy_pic (dst, dst_stride, src, src_stride, rect->width, rect->height / 2);
+  init_copy_plane (&planes[1], dst_image, src_image, 1, rect->x & -2,
+      rect->y / 2, rect->width, rect->height / 2);
+  return 2;
 }
 
 /* Copy YV12 images */
-static void
-copy_image_YV12 (GstVaapiImageRaw * dst_image,
+static guint
+copy_image_YV12 (GstVaapiCopyPlane * planes, GstVaapiImageRaw * dst_image,
     GstVaapiImageRaw * src_image, const GstVaapiRectangle * rect)
 {
-  guchar *dst, *src;
-  guint dst_stride, src_stride;
-  guint i, x, y, w, h;
+  guint i;
 
   /* Y plane */
-  dst_stride = dst_image->stride[0];
-  dst = dst_image->pixels[0] + rect->y * dst_stride + rect->x;
-  src_stride = src_image->stride[0];
-  src = src_image->pixels[0] + rect->y * src_stride + rect->x;
-  memcpy_pic (dst, dst_stride, src, src_stride, rect->width, rect->height);
+  init_copy_plane (&planes[0], dst_image, src_image, 0, rect->x, rect->y,
+      rect->width, rect->height);
 
   /* U/V planes */
-  x = rect->x / 2;
-  y = rect->y / 2;
-  w = rect->width / 2;
-  h = rect->height / 2;
-  for (i = 1; i < dst_image->num_planes; i++) {
-    dst_stride = dst_image->stride[i];
-    dst = dst_image->pixels[i] + y * dst_stride + x;
-    src_stride = src_image->stride[i];
-    src = src_image->pixels[i] + y * src_stride + x;
-    memcpy_pic (dst, dst_stride, src, src_stride, w, h);
-  }
+  for (i = 1; i < dst_image->num_planes; i++)
+    init_copy_plane (&planes[i], dst_image, src_image, i, rect->x / 2,
+        rect->y / 2, rect->width / 2, rect->height / 2);
+  return dst_image->num_planes;
 }
 
 /* Copy YUY2 images */
-static void
-copy_image_YUY2 (GstVaapiImageRaw * dst_image,
+static guint
+copy_image_YUY2 (GstVaapiCopyPlane * planes, GstVaapiImageRaw * dst_image,
     GstVaapiImageRaw * src_image, const GstVaapiRectangle * rect)
 {
-  guchar *dst, *src;
-  guint dst_stride, src_stride;
-
   /* YUV 4:2:2, full vertical resolution */
-  dst_stride = dst_image->stride[0];
-  dst = dst_image->pixels[0] + rect->y * dst_stride + rect->x * 2;
-  src_stride = src_image->stride[0];
-  src = src_image->pixels[0] + rect->y * src_stride + rect->x * 2;
-  memcpy_pic (dst, dst_stride, src, src_stride, rect->width * 2, rect->height);
+  init_copy_plane (&planes[0], dst_image, src_image, 0, rect->x * 2, rect->y,
+      rect->width * 2, rect->height);
+  return 1;
 }
 
 /* Copy RGBA images */
-static void
-copy_image_RGBA (GstVaapiImageRaw * dst_image,
+static guint
+copy_image_RGBA (GstVaapiCopyPlane * planes, GstVaapiImageRaw * dst_image,
     GstVaapiImageRaw * src_image, const GstVaapiRectangle * rect)
 {
-  guchar *dst, *src;
-  guint dst_stride, src_stride;
-
-  dst_stride = dst_image->stride[0];
-  dst = dst_image->pixels[0] + rect->y * dst_stride + rect->x;
-  src_stride = src_image->stride[0];
-  src = src_image->pixels[0] + rect->y * src_stride + rect->x;
-  memcpy_pic (dst, dst_stride, src, src_stride, 4 * rect->width, rect->height);
+  init_copy_plane (&planes[0], dst_image, src_image, 0, rect->x * 4, rect->y,
+      rect->width * 4, rect->height);
+  return 1;
+}
+
+static void
+init_convert_frame (GstVaapiConvertFrame * frame, GstVaapiImageRaw * image)
+{
+  guint i;
+
+  frame->format = image->format;
+  frame->width = image->width;
+  frame->height = image->height;
+  for (i = 0; i < image->num_planes; i++) {
+    frame->data[i] = image->pixels[i];
+    frame->stride[i] = image->stride[i];
+  }
+}
+
+/* Converts whole images of different formats */
+static gboolean
+convert_image (GstVaapiImageRaw * dst_image, GstVaapiImageRaw * src_image,
+    const GstVaapiRectangle * rect)
+{
+  GstVaapiConvertFrame dst_frame, src_frame;
+
+  if (rect && (rect->x != 0 || rect->y != 0 ||
+          rect->width != src_image->width ||
+          rect->height != src_image->height)) {
+    GST_ERROR ("unsupported sub-rectangle for image conversion");
+    return FALSE;
+  }
+
+  init_convert_frame (&dst_frame, dst_image);
+  init_convert_frame (&src_frame, src_image);
+  if (!gst_vaapi_convert_frame (&dst_frame, &src_frame)) {
+    GST_ERROR ("unsupported image conversion from %s to %s",
+        gst_video_format_to_string (src_image->format),
+        gst_video_format_to_string (dst_image->format));
+    return FALSE;
+  }
+  return TRUE;
 }
 
 static gboolean
 copy_image (GstVaapiImageRaw * dst_image,
-    GstVaapiImageRaw * src_image, const GstVaapiRectangle * rect)
+    GstVaapiImageRaw * src_image, const GstVaapiRectangle * rect, guint flags)
 {
+  GstVaapiCopyPlane planes[3];
   GstVaapiRectangle default_rect;
+  guint num_planes;
 
-  if (dst_image->format != src_image->format ||
-      dst_image->width != src_image->width ||
+  if (dst_image->width != src_image->width ||
       dst_image->height != src_image->height)
     return FALSE;
 
+  /* Convert the pixels while copying them, if needed */
+  if (dst_image->format != src_image->format)
+    return convert_image (dst_image, src_image, rect);
+
   if (rect) {
     if (rect->x >= src_image->width ||
         rect->x + rect->width > src_image->width ||
@@ -833,26 +868,27 @@ copy_image (GstVaapiImageRaw * dst_image,
 
   switch (dst_image->format) {
     case GST_VIDEO_FORMAT_NV12:
-      copy_image_NV12 (dst_image, src_image, rect);
+      num_planes = copy_image_NV12 (planes, dst_image, src_image, rect);
       break;
     case GST_VIDEO_FORMAT_YV12:
     case GST_VIDEO_FORMAT_I420:
-      copy_image_YV12 (dst_image, src_image, rect);
+      num_planes = copy_image_YV12 (planes, dst_image, src_image, rect);
       break;
     case GST_VIDEO_FORMAT_YUY2:
     case GST_VIDEO_FORMAT_UYVY:
-      copy_image_YUY2 (dst_image, src_image, rect);
+      num_planes = copy_image_YUY2 (planes, dst_image, src_image, rect);
       break;
     case GST_VIDEO_FORMAT_ARGB:
     case GST_VIDEO_FORMAT_RGBA:
     case GST_VIDEO_FORMAT_ABGR:
     case GST_VIDEO_FORMAT_BGRA:
-      copy_image_RGBA (dst_image, src_image, rect);
+      num_planes = copy_image_RGBA (planes, dst_image, src_image, rect);
       break;
     default:
       GST_ERROR ("unsupported image format for copy");
       return FALSE;
   }
+  gst_vaapi_copy_planes (planes, num_planes, flags);
   return TRUE;
 }
 
@@ -864,7 +900,9 @@ copy_image (GstVaapiImageRaw * dst_image,
  *   whole image
  *
  * Transfers pixels data contained in the @image into the #GstBuffer.
- * Both image structures shall have the same format.
+ * Both image structures shall have the same size. The pixels of whole
+ * images are converted if the formats differ, between NV12 and one
+ * of I420, YV12, YUY2, UYVY, RGBA, BGRA or P010.
  *
  * Return value: %TRUE on success
  */
@@ -873,27 +911,39 @@ gst_vaapi_image_get_buffer (GstVaapiImage * image,
     GstBuffer * buffer, GstVaapiRectangle * rect)
 {
   GstVaapiImageRaw dst_image, src_image;
+  GstVideoFrame frame;
   gboolean success;
 
   g_return_val_if_fail (image != NULL, FALSE);
   g_return_val_if_fail (GST_IS_BUFFER (buffer), FALSE);
 
-  if (!init_image_from_buffer (&dst_image, buffer))
-    return FALSE;
-  if (dst_image.format != image->format)
+  if (!map_image_from_buffer (&dst_image, &frame, buffer, image,
+          GST_MAP_WRITE))
     return FALSE;
+  if (dst_image.format != image->format &&
+      !gst_vaapi_convert_is_supported (dst_image.format, image->format))
+    goto error_mismatch;
   if (dst_image.width != image->width || dst_image.height != image->height)
-    return FALSE;
+    goto error_mismatch;
 
   if (!_gst_vaapi_image_map (image, &src_image))
-    return FALSE;
+    goto error_mismatch;
 
-  success = copy_image (&dst_image, &src_image, rect);
+  success = copy_image (&dst_image, &src_image, rect,
+      GST_VAAPI_COPY_FLAG_SRC_UNCACHED);
 
   if (!_gst_vaapi_image_unmap (image))
-    return FALSE;
+    success = FALSE;
 
+  gst_video_frame_unmap (&frame);
   return success;
+
+  /* ERRORS */
+error_mismatch:
+  {
+    gst_video_frame_unmap (&frame);
+    return FALSE;
+  }
 }
 
 /**
@@ -904,7 +954,9 @@ gst_vaapi_image_get_buffer (GstVaapiImage * image,
  *   whole image
  *
  * Transfers pixels data contained in the @image into the #GstVaapiImageRaw.
- * Both image structures shall have the same format.
+ * Both image structures shall have the same size. The pixels of whole
+ * images are converted if the formats differ, between NV12 and one
+ * of I420, YV12, YUY2, UYVY, RGBA, BGRA or P010.
  *
  * Return value: %TRUE on success
  */
@@ -920,7 +972,8 @@ gst_vaapi_image_get_raw (GstVaapiImage * image,
   if (!_gst_vaapi_image_map (image, &src_image))
     return FALSE;
 
-  success = copy_image (dst_image, &src_image, rect);
+  success = copy_image (dst_image, &src_image, rect,
+      GST_VAAPI_COPY_FLAG_SRC_UNCACHED);
 
   if (!_gst_vaapi_image_unmap (image))
     return FALSE;
@@ -936,7 +989,10 @@ gst_vaapi_image_get_raw (GstVaapiImage * image,
  *   whole image
  *
  * Transfers pixels data contained in the #GstBuffer into the
- * @image. Both image structures shall have the same format.
+ * @image.
+ * Both image structures shall have the same size. The pixels of whole
+ * images are converted if the formats differ, between NV12 and one
+ * of I420, YV12, YUY2, UYVY, RGBA, BGRA or P010.
  *
  * Return value: %TRUE on success
  */
@@ -945,27 +1001,39 @@ gst_vaapi_image_update_from_buffer (GstVaapiImage * image,
     GstBuffer * buffer, GstVaapiRectangle * rect)
 {
   GstVaapiImageRaw dst_image, src_image;
+  GstVideoFrame frame;
   gboolean success;
 
   g_return_val_if_fail (image != NULL, FALSE);
   g_return_val_if_fail (GST_IS_BUFFER (buffer), FALSE);
 
-  if (!init_image_from_buffer (&src_image, buffer))
-    return FALSE;
-  if (src_image.format != image->format)
+  if (!map_image_from_buffer (&src_image, &frame, buffer, image,
+          GST_MAP_READ))
     return FALSE;
+  if (src_image.format != image->format &&
+      !gst_vaapi_convert_is_supported (image->format, src_image.format))
+    goto error_mismatch;
   if (src_image.width != image->width || src_image.height != image->height)
-    return FALSE;
+    goto error_mismatch;
 
   if (!_gst_vaapi_image_map (image, &dst_image))
-    return FALSE;
+    goto error_mismatch;
 
-  success = copy_image (&dst_image, &src_image, rect);
+  success = copy_image (&dst_image, &src_image, rect,
+      GST_VAAPI_COPY_FLAG_DST_UNCACHED);
 
   if (!_gst_vaapi_image_unmap (image))
-    return FALSE;
+    success = FALSE;
 
+  gst_video_frame_unmap (&frame);
   return success;
+
+  /* ERRORS */
+error_mismatch:
+  {
+    gst_video_frame_unmap (&frame);
+    return FALSE;
+  }
 }
 
 /**
@@ -977,7 +1045,10 @@ gst_vaapi_image_update_from_buffer (GstVaapiImage * image,
  *   whole image
  *
  * Transfers pixels data contained in the #GstVaapiImageRaw into the
- * @image. Both image structures shall have the same format.
+ * @image.
+ * Both image structures shall have the same size. The pixels of whole
+ * images are converted if the formats differ, between NV12 and one
+ * of I420, YV12, YUY2, UYVY, RGBA, BGRA or P010.
  *
  * Return value: %TRUE on success
  */
@@ -993,7 +1064,8 @@ gst_vaapi_image_update_from_raw (GstVaapiImage * image,
   if (!_gst_vaapi_image_map (image, &dst_image))
     return FALSE;
 
-  success = copy_image (&dst_image, src_image, rect);
+  success = copy_image (&dst_image, src_image, rect,
+      GST_VAAPI_COPY_FLAG_DST_UNCACHED);
 
   if (!_gst_vaapi_image_unmap (image))
     return FALSE;
@@ -1025,7 +1097,8 @@ gst_vaapi_image_copy (GstVaapiImage * dst_image, GstVaapiImage * src_image)
   if (!_gst_vaapi_image_map (src_image, &src_image_raw))
     goto end;
 
-  success = copy_image (&dst_image_raw, &src_image_raw, NULL);
+  success = copy_image (&dst_image_raw, &src_image_raw, NULL,
+      GST_VAAPI_COPY_FLAG_SRC_UNCACHED | GST_VAAPI_COPY_FLAG_DST_UNCACHED);
 
 end:
   _gst_vaapi_image_unmap (src_image);
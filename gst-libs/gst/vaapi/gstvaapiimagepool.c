@@ -57,6 +57,7 @@ image_pool_init (GstVaapiVideoPool * base_pool, const GstVideoInfo * vip)
   pool->format = GST_VIDEO_INFO_FORMAT (vip);
   pool->width = GST_VIDEO_INFO_WIDTH (vip);
   pool->height = GST_VIDEO_INFO_HEIGHT (vip);
+  base_pool->object_size = GST_VIDEO_INFO_SIZE (vip);
   return gst_vaapi_display_has_image_format (base_pool->display, pool->format);
 }
 
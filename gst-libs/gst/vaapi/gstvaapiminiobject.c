@@ -28,36 +28,109 @@
 #undef gst_vaapi_mini_object_unref
 #undef gst_vaapi_mini_object_replace
 
+/* Default maximum number of free objects per class */
+#define DEFAULT_MAX_FREE_OBJECTS 64
+
+/* The free objects are chained through their first field, i.e. the
+   object class, which is restored when they are reused */
+#define FREE_OBJECT_NEXT(object) \
+  (*(gpointer *) (object))
+
+static inline guint
+cache_get_max_objects (GstVaapiMiniObjectCache * cache)
+{
+  return cache->max_objects ? cache->max_objects : DEFAULT_MAX_FREE_OBJECTS;
+}
+
+static inline gboolean
+cache_is_full (GstVaapiMiniObjectCache * cache)
+{
+  /* Unlocked read, only used as a hint */
+  return cache->num_free_objects >= cache_get_max_objects (cache);
+}
+
+static gboolean
+cache_push (GstVaapiMiniObjectCache * cache, GstVaapiMiniObject * object)
+{
+  gboolean success = FALSE;
+
+  g_mutex_lock (&cache->lock);
+  if (cache->num_free_objects < cache_get_max_objects (cache)) {
+    FREE_OBJECT_NEXT (object) = cache->free_objects;
+    cache->free_objects = object;
+    cache->num_free_objects++;
+    success = TRUE;
+  }
+  g_mutex_unlock (&cache->lock);
+  return success;
+}
+
+static GstVaapiMiniObject *
+cache_pop (GstVaapiMiniObjectCache * cache)
+{
+  GstVaapiMiniObject *object;
+
+  g_mutex_lock (&cache->lock);
+  object = cache->free_objects;
+  if (object) {
+    cache->free_objects = FREE_OBJECT_NEXT (object);
+    cache->num_free_objects--;
+    cache->num_reuses++;
+  } else
+    cache->num_allocations++;
+  g_mutex_unlock (&cache->lock);
+  return object;
+}
+
 void
 gst_vaapi_mini_object_free (GstVaapiMiniObject * object)
 {
   const GstVaapiMiniObjectClass *const klass = object->object_class;
+  GstVaapiMiniObjectCache *const cache = klass->cache;
+  gboolean is_reset = FALSE;
 
   g_atomic_int_inc (&object->ref_count);
 
-  if (klass->finalize)
+  if (cache && cache->reset && !cache_is_full (cache)) {
+    cache->reset (object);
+    is_reset = TRUE;
+  } else if (klass->finalize)
     klass->finalize (object);
 
-  if (G_LIKELY (g_atomic_int_dec_and_test (&object->ref_count)))
+  if (G_LIKELY (g_atomic_int_dec_and_test (&object->ref_count))) {
+    /* The cache of a class with a reset function only holds objects
+       that were reset */
+    if (cache && (is_reset || !cache->reset) && cache_push (cache, object))
+      return;
+    if (is_reset && cache->release)
+      cache->release (object);
     g_slice_free1 (klass->size, object);
+  }
 }
 
-/**
- * gst_vaapi_mini_object_new:
- * @object_class: (optional): The object class
- *
- * Creates a new #GstVaapiMiniObject. If @object_class is NULL, then the
- * size of the allocated object is the same as sizeof(GstVaapiMiniObject).
- * If @object_class is not NULL, typically when a sub-class is implemented,
- * that pointer shall reference a statically allocated descriptor.
- *
- * This function does *not* zero-initialize the derived object data,
- * use gst_vaapi_mini_object_new0() to fill this purpose.
- *
- * Returns: The newly allocated #GstVaapiMiniObject
- */
-GstVaapiMiniObject *
-gst_vaapi_mini_object_new (const GstVaapiMiniObjectClass * object_class)
+/* Allocates an object, or reuses a free one from the class cache. The
+   object data was reset, instead of finalized, if *is_reset is set */
+static GstVaapiMiniObject *
+mini_object_alloc (const GstVaapiMiniObjectClass * object_class,
+    gboolean * is_reset)
+{
+  GstVaapiMiniObjectCache *const cache = object_class->cache;
+  GstVaapiMiniObject *object = NULL;
+
+  if (cache)
+    object = cache_pop (cache);
+  if (object) {
+    *is_reset = cache->reset != NULL;
+    return object;
+  }
+
+  *is_reset = FALSE;
+  return g_slice_alloc (object_class->size);
+}
+
+static GstVaapiMiniObject *
+mini_object_new (const GstVaapiMiniObjectClass * object_class,
+    gboolean * is_reset)
 {
   GstVaapiMiniObject *object;
 
@@ -70,7 +143,7 @@ gst_vaapi_mini_object_new (const GstVaapiMiniObjectClass * object_class)
 
   g_return_val_if_fail (object_class->size >= sizeof (*object), NULL);
 
-  object = g_slice_alloc (object_class->size);
+  object = mini_object_alloc (object_class, is_reset);
   if (!object)
     return NULL;
 
@@ -80,6 +153,28 @@ gst_vaapi_mini_object_new (const GstVaapiMiniObjectClass * object_class)
   return object;
 }
 
+/**
+ * gst_vaapi_mini_object_new:
+ * @object_class: (optional): The object class
+ *
+ * Creates a new #GstVaapiMiniObject. If @object_class is NULL, then the
+ * size of the allocated object is the same as sizeof(GstVaapiMiniObject).
+ * If @object_class is not NULL, typically when a sub-class is implemented,
+ * that pointer shall reference a statically allocated descriptor.
+ *
+ * This function does *not* zero-initialize the derived object data,
+ * use gst_vaapi_mini_object_new0() to fill this purpose.
+ *
+ * Returns: The newly allocated #GstVaapiMiniObject
+ */
+GstVaapiMiniObject *
+gst_vaapi_mini_object_new (const GstVaapiMiniObjectClass * object_class)
+{
+  gboolean is_reset;
+
+  return mini_object_new (object_class, &is_reset);
+}
+
 /**
  * gst_vaapi_mini_object_new0:
  * @object_class: (optional): The object class
@@ -95,11 +190,16 @@ gst_vaapi_mini_object_new0 (const GstVaapiMiniObjectClass * object_class)
 {
   GstVaapiMiniObject *object;
   guint sub_size;
+  gboolean is_reset;
 
-  object = gst_vaapi_mini_object_new (object_class);
+  object = mini_object_new (object_class, &is_reset);
   if (!object)
     return NULL;
 
+  /* Objects reset for reuse are already initialized */
+  if (is_reset)
+    return object;
+
   object_class = object->object_class;
 
   sub_size = object_class->size - sizeof (*object);
@@ -172,3 +272,60 @@ gst_vaapi_mini_object_replace (GstVaapiMiniObject ** old_object_ptr,
   if (old_object)
     gst_vaapi_mini_object_unref_internal (old_object);
 }
+
+/**
+ * gst_vaapi_mini_object_cache_get_stats:
+ * @cache: a #GstVaapiMiniObjectCache
+ * @stats: (out caller-allocates): the #GstVaapiMiniObjectCacheStats
+ *
+ * Retrieves the statistics of the @cache.
+ */
+void
+gst_vaapi_mini_object_cache_get_stats (GstVaapiMiniObjectCache * cache,
+    GstVaapiMiniObjectCacheStats * stats)
+{
+  g_return_if_fail (cache != NULL);
+  g_return_if_fail (stats != NULL);
+
+  g_mutex_lock (&cache->lock);
+  stats->num_allocations = cache->num_allocations;
+  stats->num_reuses = cache->num_reuses;
+  stats->num_free = cache->num_free_objects;
+  g_mutex_unlock (&cache->lock);
+}
+
+/**
+ * gst_vaapi_mini_object_cache_clear:
+ * @object_class: a #GstVaapiMiniObjectClass
+ *
+ * Destroys the free objects kept in the cache of @object_class, if
+ * any.
+ */
+void
+gst_vaapi_mini_object_cache_clear (const GstVaapiMiniObjectClass *
+    object_class)
+{
+  GstVaapiMiniObjectCache *cache;
+  GstVaapiMiniObject *object, *next_object;
+
+  g_return_if_fail (object_class != NULL);
+
+  cache = object_class->cache;
+  if (!cache)
+    return;
+
+  g_mutex_lock (&cache->lock);
+  object = cache->free_objects;
+  cache->free_objects = NULL;
+  cache->num_free_objects = 0;
+  g_mutex_unlock (&cache->lock);
+
+  for (; object != NULL; object = next_object) {
+    next_object = FREE_OBJECT_NEXT (object);
+    if (cache->reset && cache->release) {
+      object->object_class = object_class;
+      cache->release (object);
+    }
+    g_slice_free1 (object_class->size, object);
+  }
+}
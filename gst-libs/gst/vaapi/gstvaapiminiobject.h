@@ -30,6 +30,8 @@ G_BEGIN_DECLS
 
 typedef struct _GstVaapiMiniObject              GstVaapiMiniObject;
 typedef struct _GstVaapiMiniObjectClass         GstVaapiMiniObjectClass;
+typedef struct _GstVaapiMiniObjectCache         GstVaapiMiniObjectCache;
+typedef struct _GstVaapiMiniObjectCacheStats    GstVaapiMiniObjectCacheStats;
 
 /**
  * GST_VAAPI_MINI_OBJECT:
@@ -125,11 +127,64 @@ struct _GstVaapiMiniObject
   guint flags;
 };
 
+/**
+ * GstVaapiMiniObjectCache:
+ * @max_objects: maximum number of free objects kept for reuse, or 0
+ *   for the default
+ * @reset: (optional): function called instead of the class finalize
+ *   function on the objects kept for reuse
+ * @release: (optional): function called to free the resources kept
+ *   by @reset, when an object that was reset is destroyed
+ *
+ * A #GstVaapiMiniObjectCache holds the free objects of a class, so
+ * that objects created and destroyed at a high rate, e.g. once per
+ * frame or per NAL unit, reuse the same memory instead of going
+ * through the allocator each time. It is statically allocated along
+ * with the class, and only the fields above shall be initialized.
+ *
+ * By default, the objects are finalized before they are kept for
+ * reuse. If @reset is set, it shall instead release the references
+ * the object holds and reset it the way gst_vaapi_mini_object_new0()
+ * initializes it, except for the resources it keeps for reuse, e.g.
+ * empty arrays, that @release frees.
+ */
+struct _GstVaapiMiniObjectCache
+{
+  /*< protected >*/
+  guint max_objects;
+  GDestroyNotify reset;
+  GDestroyNotify release;
+
+  /*< private >*/
+  GMutex lock;
+  gpointer free_objects;
+  guint num_free_objects;
+  guint64 num_allocations;
+  guint64 num_reuses;
+};
+
+/**
+ * GstVaapiMiniObjectCacheStats:
+ * @num_allocations: number of objects allocated
+ * @num_reuses: number of objects reused from the cache
+ * @num_free: current number of free objects in the cache
+ *
+ * Statistics of a #GstVaapiMiniObjectCache.
+ */
+struct _GstVaapiMiniObjectCacheStats
+{
+  guint64 num_allocations;
+  guint64 num_reuses;
+  guint num_free;
+};
+
 /**
  * GstVaapiMiniObjectClass:
  * @size: size in bytes of the #GstVaapiMiniObject, plus any
  *   additional data for derived classes
  * @finalize: function called to destroy data in derived classes
+ * @cache: (optional): the #GstVaapiMiniObjectCache holding the free
+ *   objects of the class
  *
  * A #GstVaapiMiniObjectClass represents the base object class that
  * defines the size of the #GstVaapiMiniObject and utility function to
@@ -140,6 +195,7 @@ struct _GstVaapiMiniObjectClass
   /*< protected >*/
   guint size;
   GDestroyNotify finalize;
+  GstVaapiMiniObjectCache *cache;
 };
 
 GstVaapiMiniObject *
@@ -158,6 +214,16 @@ void
 gst_vaapi_mini_object_replace (GstVaapiMiniObject ** old_object_ptr,
     GstVaapiMiniObject * new_object);
 
+G_GNUC_INTERNAL
+void
+gst_vaapi_mini_object_cache_get_stats (GstVaapiMiniObjectCache * cache,
+    GstVaapiMiniObjectCacheStats * stats);
+
+G_GNUC_INTERNAL
+void
+gst_vaapi_mini_object_cache_clear (const GstVaapiMiniObjectClass *
+    object_class);
+
 #ifdef IN_LIBGSTVAAPI_CORE
 #undef  gst_vaapi_mini_object_ref
 #define gst_vaapi_mini_object_ref(object) \
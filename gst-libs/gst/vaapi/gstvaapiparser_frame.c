@@ -28,12 +28,21 @@
 #include "sysdeps.h"
 #include "gstvaapiparser_frame.h"
 
+static void gst_vaapi_parser_frame_reset (GstVaapiParserFrame * frame);
+
 static inline const GstVaapiMiniObjectClass *
 gst_vaapi_parser_frame_class (void)
 {
+  /* A frame is created for every decoded frame, keep its arrays of
+     units for the next ones */
+  static GstVaapiMiniObjectCache GstVaapiParserFrameCache = {
+    .reset = (GDestroyNotify) gst_vaapi_parser_frame_reset,
+    .release = (GDestroyNotify) gst_vaapi_parser_frame_free,
+  };
   static const GstVaapiMiniObjectClass GstVaapiParserFrameClass = {
     sizeof (GstVaapiParserFrame),
-    (GDestroyNotify) gst_vaapi_parser_frame_free
+    (GDestroyNotify) gst_vaapi_parser_frame_free,
+    &GstVaapiParserFrameCache
   };
   return &GstVaapiParserFrameClass;
 }
@@ -41,30 +50,54 @@ gst_vaapi_parser_frame_class (void)
 static inline gboolean
 alloc_units (GArray ** units_ptr, guint size)
 {
-  GArray *units;
+  GArray *units = *units_ptr;
 
-  units = g_array_sized_new (FALSE, FALSE, sizeof (GstVaapiDecoderUnit), size);
+  /* Frames reused from the cache still have their (empty) arrays */
+  if (!units)
+    units = g_array_sized_new (FALSE, FALSE, sizeof (GstVaapiDecoderUnit),
+        size);
   *units_ptr = units;
   return units != NULL;
 }
 
+static inline void
+clear_units (GArray * units)
+{
+  guint i;
+
+  for (i = 0; i < units->len; i++) {
+    GstVaapiDecoderUnit *const unit =
+        &g_array_index (units, GstVaapiDecoderUnit, i);
+    gst_vaapi_decoder_unit_clear (unit);
+  }
+  g_array_set_size (units, 0);
+}
+
 static inline void
 free_units (GArray ** units_ptr)
 {
   GArray *const units = *units_ptr;
-  guint i;
 
   if (units) {
-    for (i = 0; i < units->len; i++) {
-      GstVaapiDecoderUnit *const unit =
-          &g_array_index (units, GstVaapiDecoderUnit, i);
-      gst_vaapi_decoder_unit_clear (unit);
-    }
+    clear_units (units);
     g_array_free (units, TRUE);
     *units_ptr = NULL;
   }
 }
 
+/* Clears the units of the frame, but keeps the arrays for reuse */
+static void
+gst_vaapi_parser_frame_reset (GstVaapiParserFrame * frame)
+{
+  if (frame->units)
+    clear_units (frame->units);
+  if (frame->pre_units)
+    clear_units (frame->pre_units);
+  if (frame->post_units)
+    clear_units (frame->post_units);
+  frame->output_offset = 0;
+}
+
 /**
  * gst_vaapi_parser_frame_new:
  * @width: frame width in pixels
@@ -81,7 +114,7 @@ gst_vaapi_parser_frame_new (guint width, guint height)
   guint num_slices;
 
   frame = (GstVaapiParserFrame *)
-      gst_vaapi_mini_object_new (gst_vaapi_parser_frame_class ());
+      gst_vaapi_mini_object_new0 (gst_vaapi_parser_frame_class ());
   if (!frame)
     return NULL;
 
@@ -49,6 +49,29 @@ struct _GstVaapiSurfacePool
   guint alloc_flags;
 };
 
+/* Estimates the memory used by a surface of the supplied chroma type */
+static gsize
+get_surface_size (GstVaapiChromaType chroma_type, guint width, guint height)
+{
+  const gsize num_pixels =
+      (gsize) GST_ROUND_UP_16 (width) * GST_ROUND_UP_16 (height);
+
+  switch (chroma_type) {
+    case GST_VAAPI_CHROMA_TYPE_YUV400:
+      return num_pixels;
+    case GST_VAAPI_CHROMA_TYPE_YUV422:
+    case GST_VAAPI_CHROMA_TYPE_RGB16:
+      return num_pixels * 2;
+    case GST_VAAPI_CHROMA_TYPE_YUV444:
+    case GST_VAAPI_CHROMA_TYPE_YUV420_10BPP:
+      return num_pixels * 3;
+    case GST_VAAPI_CHROMA_TYPE_RGB32:
+      return num_pixels * 4;
+    default:
+      return num_pixels * 3 / 2;
+  }
+}
+
 static gboolean
 surface_pool_init (GstVaapiSurfacePool * pool, const GstVideoInfo * vip,
     guint flags)
@@ -67,6 +90,9 @@ surface_pool_init (GstVaapiSurfacePool * pool, const GstVideoInfo * vip,
     pool->chroma_type = gst_vaapi_video_format_get_chroma_type (format);
   if (!pool->chroma_type)
     return FALSE;
+
+  pool->parent_instance.object_size = get_surface_size (pool->chroma_type,
+      GST_VIDEO_INFO_WIDTH (vip), GST_VIDEO_INFO_HEIGHT (vip));
   return TRUE;
 }
 
@@ -204,3 +230,25 @@ gst_vaapi_surface_pool_new_with_chroma_type (GstVaapiDisplay * display,
 
   return pool;
 }
+
+/* Checks whether the surfaces of @pool can be used as decode targets
+   of the supplied chroma type and size. Surfaces with a non-native
+   pixel format, or special allocation flags, are not */
+gboolean
+gst_vaapi_surface_pool_is_decodable (GstVaapiSurfacePool * pool,
+    GstVaapiChromaType chroma_type, guint width, guint height)
+{
+  const GstVideoInfo *const vip = &pool->video_info;
+  const GstVideoFormat format = GST_VIDEO_INFO_FORMAT (vip);
+
+  if (GST_VAAPI_VIDEO_POOL (pool)->object_type !=
+      GST_VAAPI_VIDEO_POOL_OBJECT_TYPE_SURFACE)
+    return FALSE;
+  if (pool->chroma_type != chroma_type || pool->alloc_flags != 0)
+    return FALSE;
+  if (GST_VIDEO_INFO_WIDTH (vip) != width ||
+      GST_VIDEO_INFO_HEIGHT (vip) != height)
+    return FALSE;
+  return format == GST_VIDEO_FORMAT_ENCODED ||
+      format == gst_vaapi_video_format_get_best_native (format);
+}
@@ -48,6 +48,11 @@ GstVaapiVideoPool *
 gst_vaapi_surface_pool_new_with_chroma_type (GstVaapiDisplay * display,
     GstVaapiChromaType chroma_type, guint width, guint height);
 
+G_GNUC_INTERNAL
+gboolean
+gst_vaapi_surface_pool_is_decodable (GstVaapiSurfacePool * pool,
+    GstVaapiChromaType chroma_type, guint width, guint height);
+
 G_END_DECLS
 
 #endif /* GST_VAAPI_SURFACE_POOL_H */
@@ -149,6 +149,8 @@ typedef enum {
  * @GST_VAAPI_RATECONTROL_VBR_CONSTRAINED: Variable bitrate with peak
  *   rate higher than average bitrate
  * @GST_VAAPI_RATECONTROL_MB: Macroblock based rate control
+ * @GST_VAAPI_RATECONTROL_LOOKAHEAD: Software lookahead rate control,
+ *   with per-frame QP applied in constant QP mode
  *
  * The set of allowed rate control values for #GstVaapiRateControl.
  * Note: this is only valid for encoders.
@@ -161,6 +163,7 @@ typedef enum {
     GST_VAAPI_RATECONTROL_VBR,
     GST_VAAPI_RATECONTROL_VBR_CONSTRAINED,
     GST_VAAPI_RATECONTROL_MB,
+    GST_VAAPI_RATECONTROL_LOOKAHEAD,
 } GstVaapiRateControl;
 
 /* Define a mask for GstVaapiRateControl */
@@ -87,12 +87,23 @@ vaapi_unmap_buffer (VADisplay dpy, VABufferID buf_id, gpointer * pbuf)
 gboolean
 vaapi_create_buffer (VADisplay dpy, VAContextID ctx, int type, guint size,
     gconstpointer buf, VABufferID * buf_id_ptr, gpointer * mapped_data)
+{
+  return vaapi_create_n_elements_buffer (dpy, ctx, type, size, 1, buf,
+      buf_id_ptr, mapped_data);
+}
+
+/* Creates and maps VA buffer holding an array of @num_elements
+   elements of @size bytes each */
+gboolean
+vaapi_create_n_elements_buffer (VADisplay dpy, VAContextID ctx, int type,
+    guint size, guint num_elements, gconstpointer buf,
+    VABufferID * buf_id_ptr, gpointer * mapped_data)
 {
   VABufferID buf_id;
   VAStatus status;
   gpointer data = (gpointer) buf;
 
-  status = vaCreateBuffer (dpy, ctx, type, size, 1, data, &buf_id);
+  status = vaCreateBuffer (dpy, ctx, type, size, num_elements, data, &buf_id);
   if (!vaapi_check_status (status, "vaCreateBuffer()"))
     return FALSE;
 
@@ -543,6 +554,8 @@ from_GstVaapiRateControl (guint value)
       return VA_RC_NONE;
 #ifdef VA_RC_CQP
     case GST_VAAPI_RATECONTROL_CQP:
+    case GST_VAAPI_RATECONTROL_LOOKAHEAD:
+      /* The lookahead rate control runs in software on top of CQP */
       return VA_RC_CQP;
 #endif
     case GST_VAAPI_RATECONTROL_CBR:
@@ -51,6 +51,13 @@ gboolean
 vaapi_create_buffer (VADisplay dpy, VAContextID ctx, int type, guint size,
     gconstpointer data, VABufferID * buf_id, gpointer * mapped_data);
 
+/** Creates and maps VA buffer holding an array of elements */
+G_GNUC_INTERNAL
+gboolean
+vaapi_create_n_elements_buffer (VADisplay dpy, VAContextID ctx, int type,
+    guint size, guint num_elements, gconstpointer data, VABufferID * buf_id,
+    gpointer * mapped_data);
+
 /** Destroy VA buffer */
 G_GNUC_INTERNAL
 void
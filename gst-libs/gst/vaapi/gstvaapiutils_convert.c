@@ -0,0 +1,726 @@
+/*
+ *  gstvaapiutils_convert.c - Pixel format conversion utilities
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation; either version 2.1
+ *  of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free
+ *  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Converts between NV12, the format VA surfaces are usually decoded
+ * into, and the formats raw video is most commonly exchanged in:
+ * I420, YV12, YUY2, UYVY, RGBA, BGRA and P010. This lets a VA image
+ * transfer convert the pixels while copying them, instead of leaving
+ * the conversion to another full frame pass downstream.
+ *
+ * Conversions are performed per pair of lines, so that 4:2:0 chroma
+ * lines are processed once, and the pairs of lines are split across
+ * the copy threads. Chroma is upsampled by replication and downsampled
+ * by averaging. YUV <-> RGB conversions use the BT.601 limited range
+ * matrix.
+ */
+
+#include "sysdeps.h"
+#include "gstvaapiutils_convert.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define USE_X86_SIMD 1
+# include <emmintrin.h>
+#else
+# define USE_X86_SIMD 0
+#endif
+
+#define LINE(frame, plane, y) \
+  ((frame)->data[plane] + (gsize) (y) * (frame)->stride[plane])
+
+/* Kernels processing n pixels, or n bytes of interleaved chroma */
+typedef struct
+{
+  void (*split_uv) (guint8 * u, guint8 * v, const guint8 * uv, guint n);
+  void (*merge_uv) (guint8 * uv, const guint8 * u, const guint8 * v,
+      guint n);
+  void (*pack_422) (guint8 * dst, const guint8 * y, const guint8 * uv,
+      guint n, gboolean uyvy);
+  void (*unpack_422) (guint8 * y0, guint8 * y1, guint8 * uv,
+      const guint8 * src0, const guint8 * src1, guint n, gboolean uyvy);
+  void (*pack_16) (guint8 * dst, const guint8 * src, guint n);
+  void (*unpack_16) (guint8 * dst, const guint8 * src, guint n);
+  void (*yuv_to_rgb) (guint8 * dst, const guint8 * y, const guint8 * uv,
+      guint n, gboolean bgra);
+} ConvertRowFuncs;
+
+/* ------------------------------------------------------------------------ */
+/* --- C kernels                                                        --- */
+/* ------------------------------------------------------------------------ */
+
+static void
+split_uv_c (guint8 * u, guint8 * v, const guint8 * uv, guint n)
+{
+  guint i;
+
+  for (i = 0; i < n / 2; i++) {
+    u[i] = uv[2 * i];
+    v[i] = uv[2 * i + 1];
+  }
+}
+
+static void
+merge_uv_c (guint8 * uv, const guint8 * u, const guint8 * v, guint n)
+{
+  guint i;
+
+  for (i = 0; i < n / 2; i++) {
+    uv[2 * i] = u[i];
+    uv[2 * i + 1] = v[i];
+  }
+}
+
+/* Interleaves n luma samples with n chroma samples, as Y0 U0 Y1 V0 */
+static void
+pack_422_c (guint8 * dst, const guint8 * y, const guint8 * uv, guint n,
+    gboolean uyvy)
+{
+  const guint y_ofs = uyvy ? 1 : 0, c_ofs = uyvy ? 0 : 1;
+  guint i;
+
+  for (i = 0; i < n; i++) {
+    dst[2 * i + y_ofs] = y[i];
+    dst[2 * i + c_ofs] = uv[i];
+  }
+}
+
+/* Splits two lines of packed 4:2:2 pixels into luma and 4:2:0 chroma */
+static void
+unpack_422_c (guint8 * y0, guint8 * y1, guint8 * uv, const guint8 * src0,
+    const guint8 * src1, guint n, gboolean uyvy)
+{
+  const guint y_ofs = uyvy ? 1 : 0, c_ofs = uyvy ? 0 : 1;
+  guint i;
+
+  for (i = 0; i < n; i++) {
+    y0[i] = src0[2 * i + y_ofs];
+    y1[i] = src1[2 * i + y_ofs];
+    uv[i] = (src0[2 * i + c_ofs] + src1[2 * i + c_ofs] + 1) >> 1;
+  }
+}
+
+/* Keeps the 8 most significant bits of 16-bit samples */
+static void
+pack_16_c (guint8 * dst, const guint8 * src, guint n)
+{
+  guint i;
+
+  for (i = 0; i < n; i++)
+    dst[i] = GST_READ_UINT16_LE (src + 2 * i) >> 8;
+}
+
+/* Expands 8-bit samples to 10 bits, in the most significant bits */
+static void
+unpack_16_c (guint8 * dst, const guint8 * src, guint n)
+{
+  guint i;
+
+  for (i = 0; i < n; i++)
+    GST_WRITE_UINT16_LE (dst + 2 * i, (src[i] << 8) | (src[i] & 0xc0));
+}
+
+static inline gint
+clamp_s16 (gint x)
+{
+  return CLAMP (x, G_MININT16, G_MAXINT16);
+}
+
+/* The arithmetic matches the SSE2 implementation: 6-bit coefficients,
+   and saturated 16-bit sums */
+static void
+yuv_to_rgb_c (guint8 * dst, const guint8 * y, const guint8 * uv, guint n,
+    gboolean bgra)
+{
+  const guint r_ofs = bgra ? 2 : 0, b_ofs = bgra ? 0 : 2;
+  gint yy, u, v, r, g, b;
+  guint i;
+
+  for (i = 0; i < n; i++) {
+    yy = (y[i] - 16) * 74 + 32;
+    u = uv[i & ~1] - 128;
+    v = uv[i | 1] - 128;
+    r = clamp_s16 (yy + 102 * v) >> 6;
+    g = clamp_s16 (clamp_s16 (yy - 25 * u) - 52 * v) >> 6;
+    b = clamp_s16 (yy + 129 * u) >> 6;
+    dst[4 * i + r_ofs] = CLAMP (r, 0, 255);
+    dst[4 * i + 1] = CLAMP (g, 0, 255);
+    dst[4 * i + b_ofs] = CLAMP (b, 0, 255);
+    dst[4 * i + 3] = 0xff;
+  }
+}
+
+static const ConvertRowFuncs g_convert_row_funcs_c = {
+  split_uv_c,
+  merge_uv_c,
+  pack_422_c,
+  unpack_422_c,
+  pack_16_c,
+  unpack_16_c,
+  yuv_to_rgb_c,
+};
+
+/* ------------------------------------------------------------------------ */
+/* --- SSE2 kernels                                                     --- */
+/* ------------------------------------------------------------------------ */
+
+#if USE_X86_SIMD
+__attribute__ ((target ("sse2")))
+static void
+split_uv_sse2 (guint8 * u, guint8 * v, const guint8 * uv, guint n)
+{
+  const __m128i mask = _mm_set1_epi16 (0x00ff);
+  guint i;
+
+  for (i = 0; i + 32 <= n; i += 32) {
+    const __m128i a = _mm_loadu_si128 ((const __m128i *) (uv + i));
+    const __m128i b = _mm_loadu_si128 ((const __m128i *) (uv + i + 16));
+    _mm_storeu_si128 ((__m128i *) (u + i / 2),
+        _mm_packus_epi16 (_mm_and_si128 (a, mask), _mm_and_si128 (b, mask)));
+    _mm_storeu_si128 ((__m128i *) (v + i / 2),
+        _mm_packus_epi16 (_mm_srli_epi16 (a, 8), _mm_srli_epi16 (b, 8)));
+  }
+  split_uv_c (u + i / 2, v + i / 2, uv + i, n - i);
+}
+
+__attribute__ ((target ("sse2")))
+static void
+merge_uv_sse2 (guint8 * uv, const guint8 * u, const guint8 * v, guint n)
+{
+  guint i;
+
+  for (i = 0; i + 32 <= n; i += 32) {
+    const __m128i a = _mm_loadu_si128 ((const __m128i *) (u + i / 2));
+    const __m128i b = _mm_loadu_si128 ((const __m128i *) (v + i / 2));
+    _mm_storeu_si128 ((__m128i *) (uv + i), _mm_unpacklo_epi8 (a, b));
+    _mm_storeu_si128 ((__m128i *) (uv + i + 16), _mm_unpackhi_epi8 (a, b));
+  }
+  merge_uv_c (uv + i, u + i / 2, v + i / 2, n - i);
+}
+
+__attribute__ ((target ("sse2")))
+static void
+pack_422_sse2 (guint8 * dst, const guint8 * y, const guint8 * uv, guint n,
+    gboolean uyvy)
+{
+  guint i;
+
+  for (i = 0; i + 16 <= n; i += 16) {
+    const __m128i a = _mm_loadu_si128 ((const __m128i *) (y + i));
+    const __m128i c = _mm_loadu_si128 ((const __m128i *) (uv + i));
+    if (uyvy) {
+      _mm_storeu_si128 ((__m128i *) (dst + 2 * i), _mm_unpacklo_epi8 (c, a));
+      _mm_storeu_si128 ((__m128i *) (dst + 2 * i + 16),
+          _mm_unpackhi_epi8 (c, a));
+    } else {
+      _mm_storeu_si128 ((__m128i *) (dst + 2 * i), _mm_unpacklo_epi8 (a, c));
+      _mm_storeu_si128 ((__m128i *) (dst + 2 * i + 16),
+          _mm_unpackhi_epi8 (a, c));
+    }
+  }
+  pack_422_c (dst + 2 * i, y + i, uv + i, n - i, uyvy);
+}
+
+__attribute__ ((target ("sse2")))
+static inline __m128i
+pack_low_bytes (__m128i a, __m128i b)
+{
+  const __m128i mask = _mm_set1_epi16 (0x00ff);
+
+  return _mm_packus_epi16 (_mm_and_si128 (a, mask), _mm_and_si128 (b, mask));
+}
+
+__attribute__ ((target ("sse2")))
+static inline __m128i
+pack_high_bytes (__m128i a, __m128i b)
+{
+  return _mm_packus_epi16 (_mm_srli_epi16 (a, 8), _mm_srli_epi16 (b, 8));
+}
+
+__attribute__ ((target ("sse2")))
+static void
+unpack_422_sse2 (guint8 * y0, guint8 * y1, guint8 * uv, const guint8 * src0,
+    const guint8 * src1, guint n, gboolean uyvy)
+{
+  guint i;
+
+  for (i = 0; i + 16 <= n; i += 16) {
+    const __m128i a0 = _mm_loadu_si128 ((const __m128i *) (src0 + 2 * i));
+    const __m128i b0 =
+        _mm_loadu_si128 ((const __m128i *) (src0 + 2 * i + 16));
+    const __m128i a1 = _mm_loadu_si128 ((const __m128i *) (src1 + 2 * i));
+    const __m128i b1 =
+        _mm_loadu_si128 ((const __m128i *) (src1 + 2 * i + 16));
+    const __m128i ac = _mm_avg_epu8 (a0, a1);
+    const __m128i bc = _mm_avg_epu8 (b0, b1);
+
+    if (uyvy) {
+      _mm_storeu_si128 ((__m128i *) (y0 + i), pack_high_bytes (a0, b0));
+      _mm_storeu_si128 ((__m128i *) (y1 + i), pack_high_bytes (a1, b1));
+      _mm_storeu_si128 ((__m128i *) (uv + i), pack_low_bytes (ac, bc));
+    } else {
+      _mm_storeu_si128 ((__m128i *) (y0 + i), pack_low_bytes (a0, b0));
+      _mm_storeu_si128 ((__m128i *) (y1 + i), pack_low_bytes (a1, b1));
+      _mm_storeu_si128 ((__m128i *) (uv + i), pack_high_bytes (ac, bc));
+    }
+  }
+  unpack_422_c (y0 + i, y1 + i, uv + i, src0 + 2 * i, src1 + 2 * i, n - i,
+      uyvy);
+}
+
+__attribute__ ((target ("sse2")))
+static void
+pack_16_sse2 (guint8 * dst, const guint8 * src, guint n)
+{
+  guint i;
+
+  for (i = 0; i + 16 <= n; i += 16) {
+    const __m128i a = _mm_loadu_si128 ((const __m128i *) (src + 2 * i));
+    const __m128i b = _mm_loadu_si128 ((const __m128i *) (src + 2 * i + 16));
+    _mm_storeu_si128 ((__m128i *) (dst + i), pack_high_bytes (a, b));
+  }
+  pack_16_c (dst + i, src + 2 * i, n - i);
+}
+
+__attribute__ ((target ("sse2")))
+static void
+unpack_16_sse2 (guint8 * dst, const guint8 * src, guint n)
+{
+  const __m128i mask = _mm_set1_epi8 ((gchar) 0xc0);
+  guint i;
+
+  for (i = 0; i + 16 <= n; i += 16) {
+    const __m128i a = _mm_loadu_si128 ((const __m128i *) (src + i));
+    const __m128i lsb = _mm_and_si128 (a, mask);
+    _mm_storeu_si128 ((__m128i *) (dst + 2 * i), _mm_unpacklo_epi8 (lsb, a));
+    _mm_storeu_si128 ((__m128i *) (dst + 2 * i + 16),
+        _mm_unpackhi_epi8 (lsb, a));
+  }
+  unpack_16_c (dst + 2 * i, src + i, n - i);
+}
+
+__attribute__ ((target ("sse2")))
+static void
+yuv_to_rgb_sse2 (guint8 * dst, const guint8 * y, const guint8 * uv, guint n,
+    gboolean bgra)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  const __m128i mask = _mm_set1_epi16 (0x00ff);
+  const __m128i alpha = _mm_set1_epi8 ((gchar) 0xff);
+  guint i;
+
+  for (i = 0; i + 8 <= n; i += 8) {
+    const __m128i c = _mm_loadl_epi64 ((const __m128i *) (uv + i));
+    const __m128i cc = _mm_unpacklo_epi16 (c, c);
+    const __m128i u = _mm_sub_epi16 (_mm_and_si128 (cc, mask),
+        _mm_set1_epi16 (128));
+    const __m128i v = _mm_sub_epi16 (_mm_srli_epi16 (cc, 8),
+        _mm_set1_epi16 (128));
+    __m128i yy, r, g, b, rg, ba;
+
+    yy = _mm_unpacklo_epi8 (_mm_loadl_epi64 ((const __m128i *) (y + i)),
+        zero);
+    yy = _mm_mullo_epi16 (_mm_sub_epi16 (yy, _mm_set1_epi16 (16)),
+        _mm_set1_epi16 (74));
+    yy = _mm_add_epi16 (yy, _mm_set1_epi16 (32));
+
+    r = _mm_adds_epi16 (yy, _mm_mullo_epi16 (v, _mm_set1_epi16 (102)));
+    g = _mm_adds_epi16 (yy, _mm_mullo_epi16 (u, _mm_set1_epi16 (-25)));
+    g = _mm_adds_epi16 (g, _mm_mullo_epi16 (v, _mm_set1_epi16 (-52)));
+    b = _mm_adds_epi16 (yy, _mm_mullo_epi16 (u, _mm_set1_epi16 (129)));
+    r = _mm_packus_epi16 (_mm_srai_epi16 (r, 6), zero);
+    g = _mm_packus_epi16 (_mm_srai_epi16 (g, 6), zero);
+    b = _mm_packus_epi16 (_mm_srai_epi16 (b, 6), zero);
+
+    if (bgra) {
+      rg = _mm_unpacklo_epi8 (b, g);
+      ba = _mm_unpacklo_epi8 (r, alpha);
+    } else {
+      rg = _mm_unpacklo_epi8 (r, g);
+      ba = _mm_unpacklo_epi8 (b, alpha);
+    }
+    _mm_storeu_si128 ((__m128i *) (dst + 4 * i), _mm_unpacklo_epi16 (rg, ba));
+    _mm_storeu_si128 ((__m128i *) (dst + 4 * i + 16),
+        _mm_unpackhi_epi16 (rg, ba));
+  }
+  yuv_to_rgb_c (dst + 4 * i, y + i, uv + i, n - i, bgra);
+}
+
+static const ConvertRowFuncs g_convert_row_funcs_sse2 = {
+  split_uv_sse2,
+  merge_uv_sse2,
+  pack_422_sse2,
+  unpack_422_sse2,
+  pack_16_sse2,
+  unpack_16_sse2,
+  yuv_to_rgb_sse2,
+};
+#endif
+
+static const ConvertRowFuncs *
+get_convert_row_funcs (GstVaapiCopyIsa isa)
+{
+#if USE_X86_SIMD
+  if (isa != GST_VAAPI_COPY_ISA_C &&
+      gst_vaapi_copy_isa_is_supported (GST_VAAPI_COPY_ISA_SSE2))
+    return &g_convert_row_funcs_sse2;
+#endif
+  return &g_convert_row_funcs_c;
+}
+
+/* ------------------------------------------------------------------------ */
+/* --- Frame conversions                                                --- */
+/* ------------------------------------------------------------------------ */
+
+/* Converts lines [y, y + height), where y and height are even */
+typedef void (*ConvertFunc) (const ConvertRowFuncs * funcs,
+    GstVaapiConvertFrame * dst, const GstVaapiConvertFrame * src, guint y,
+    guint height);
+
+static inline void
+get_uv_planes (GstVideoFormat format, guint * u_plane, guint * v_plane)
+{
+  *u_plane = format == GST_VIDEO_FORMAT_YV12 ? 2 : 1;
+  *v_plane = format == GST_VIDEO_FORMAT_YV12 ? 1 : 2;
+}
+
+static void
+copy_luma (GstVaapiConvertFrame * dst, const GstVaapiConvertFrame * src,
+    guint y, guint height)
+{
+  guint l;
+
+  for (l = y; l < y + height; l++)
+    memcpy (LINE (dst, 0, l), LINE (src, 0, l), src->width);
+}
+
+static void
+convert_NV12_to_I420 (const ConvertRowFuncs * funcs,
+    GstVaapiConvertFrame * dst, const GstVaapiConvertFrame * src, guint y,
+    guint height)
+{
+  guint l, u_plane, v_plane;
+
+  get_uv_planes (dst->format, &u_plane, &v_plane);
+  copy_luma (dst, src, y, height);
+  for (l = y / 2; l < (y + height) / 2; l++)
+    funcs->split_uv (LINE (dst, u_plane, l), LINE (dst, v_plane, l),
+        LINE (src, 1, l), src->width);
+}
+
+static void
+convert_I420_to_NV12 (const ConvertRowFuncs * funcs,
+    GstVaapiConvertFrame * dst, const GstVaapiConvertFrame * src, guint y,
+    guint height)
+{
+  guint l, u_plane, v_plane;
+
+  get_uv_planes (src->format, &u_plane, &v_plane);
+  copy_luma (dst, src, y, height);
+  for (l = y / 2; l < (y + height) / 2; l++)
+    funcs->merge_uv (LINE (dst, 1, l), LINE (src, u_plane, l),
+        LINE (src, v_plane, l), src->width);
+}
+
+static void
+convert_NV12_to_YUY2 (const ConvertRowFuncs * funcs,
+    GstVaapiConvertFrame * dst, const GstVaapiConvertFrame * src, guint y,
+    guint height)
+{
+  const gboolean uyvy = dst->format == GST_VIDEO_FORMAT_UYVY;
+  guint l;
+
+  for (l = y; l < y + height; l++)
+    funcs->pack_422 (LINE (dst, 0, l), LINE (src, 0, l), LINE (src, 1, l / 2),
+        src->width, uyvy);
+}
+
+static void
+convert_YUY2_to_NV12 (const ConvertRowFuncs * funcs,
+    GstVaapiConvertFrame * dst, const GstVaapiConvertFrame * src, guint y,
+    guint height)
+{
+  const gboolean uyvy = src->format == GST_VIDEO_FORMAT_UYVY;
+  guint l;
+
+  for (l = y; l < y + height; l += 2)
+    funcs->unpack_422 (LINE (dst, 0, l), LINE (dst, 0, l + 1),
+        LINE (dst, 1, l / 2), LINE (src, 0, l), LINE (src, 0, l + 1),
+        src->width, uyvy);
+}
+
+static void
+convert_NV12_to_RGBA (const ConvertRowFuncs * funcs,
+    GstVaapiConvertFrame * dst, const GstVaapiConvertFrame * src, guint y,
+    guint height)
+{
+  const gboolean bgra = dst->format == GST_VIDEO_FORMAT_BGRA;
+  guint l;
+
+  for (l = y; l < y + height; l++)
+    funcs->yuv_to_rgb (LINE (dst, 0, l), LINE (src, 0, l),
+        LINE (src, 1, l / 2), src->width, bgra);
+}
+
+static inline guint8
+rgb_to_y (gint r, gint g, gint b)
+{
+  return ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+}
+
+static void
+convert_RGBA_to_NV12 (const ConvertRowFuncs * funcs,
+    GstVaapiConvertFrame * dst, const GstVaapiConvertFrame * src, guint y,
+    guint height)
+{
+  const gboolean bgra = src->format == GST_VIDEO_FORMAT_BGRA;
+  const guint r_ofs = bgra ? 2 : 0, b_ofs = bgra ? 0 : 2;
+  guint l, i;
+
+  for (l = y; l < y + height; l += 2) {
+    const guint8 *const src0 = LINE (src, 0, l);
+    const guint8 *const src1 = LINE (src, 0, l + 1);
+    guint8 *const y0 = LINE (dst, 0, l);
+    guint8 *const y1 = LINE (dst, 0, l + 1);
+    guint8 *const uv = LINE (dst, 1, l / 2);
+
+    for (i = 0; i < src->width; i += 2) {
+      const guint8 *const p00 = src0 + 4 * i, *const p01 = p00 + 4;
+      const guint8 *const p10 = src1 + 4 * i, *const p11 = p10 + 4;
+      gint r, g, b;
+
+      y0[i] = rgb_to_y (p00[r_ofs], p00[1], p00[b_ofs]);
+      y0[i + 1] = rgb_to_y (p01[r_ofs], p01[1], p01[b_ofs]);
+      y1[i] = rgb_to_y (p10[r_ofs], p10[1], p10[b_ofs]);
+      y1[i + 1] = rgb_to_y (p11[r_ofs], p11[1], p11[b_ofs]);
+
+      /* Chroma of the average color of the 2x2 block */
+      r = (p00[r_ofs] + p01[r_ofs] + p10[r_ofs] + p11[r_ofs] + 2) >> 2;
+      g = (p00[1] + p01[1] + p10[1] + p11[1] + 2) >> 2;
+      b = (p00[b_ofs] + p01[b_ofs] + p10[b_ofs] + p11[b_ofs] + 2) >> 2;
+      uv[i] = ((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128;
+      uv[i + 1] = ((112 * r - 94 * g - 18 * b + 128) >> 8) + 128;
+    }
+  }
+}
+
+static void
+convert_P010_to_NV12 (const ConvertRowFuncs * funcs,
+    GstVaapiConvertFrame * dst, const GstVaapiConvertFrame * src, guint y,
+    guint height)
+{
+  guint l;
+
+  for (l = y; l < y + height; l++)
+    funcs->pack_16 (LINE (dst, 0, l), LINE (src, 0, l), src->width);
+  for (l = y / 2; l < (y + height) / 2; l++)
+    funcs->pack_16 (LINE (dst, 1, l), LINE (src, 1, l), src->width);
+}
+
+static void
+convert_NV12_to_P010 (const ConvertRowFuncs * funcs,
+    GstVaapiConvertFrame * dst, const GstVaapiConvertFrame * src, guint y,
+    guint height)
+{
+  guint l;
+
+  for (l = y; l < y + height; l++)
+    funcs->unpack_16 (LINE (dst, 0, l), LINE (src, 0, l), src->width);
+  for (l = y / 2; l < (y + height) / 2; l++)
+    funcs->unpack_16 (LINE (dst, 1, l), LINE (src, 1, l), src->width);
+}
+
+typedef struct
+{
+  GstVideoFormat dst_format;
+  GstVideoFormat src_format;
+  ConvertFunc func;
+} ConvertMap;
+
+static const ConvertMap g_convert_map[] = {
+  {GST_VIDEO_FORMAT_I420, GST_VIDEO_FORMAT_NV12, convert_NV12_to_I420},
+  {GST_VIDEO_FORMAT_YV12, GST_VIDEO_FORMAT_NV12, convert_NV12_to_I420},
+  {GST_VIDEO_FORMAT_NV12, GST_VIDEO_FORMAT_I420, convert_I420_to_NV12},
+  {GST_VIDEO_FORMAT_NV12, GST_VIDEO_FORMAT_YV12, convert_I420_to_NV12},
+  {GST_VIDEO_FORMAT_YUY2, GST_VIDEO_FORMAT_NV12, convert_NV12_to_YUY2},
+  {GST_VIDEO_FORMAT_UYVY, GST_VIDEO_FORMAT_NV12, convert_NV12_to_YUY2},
+  {GST_VIDEO_FORMAT_NV12, GST_VIDEO_FORMAT_YUY2, convert_YUY2_to_NV12},
+  {GST_VIDEO_FORMAT_NV12, GST_VIDEO_FORMAT_UYVY, convert_YUY2_to_NV12},
+  {GST_VIDEO_FORMAT_RGBA, GST_VIDEO_FORMAT_NV12, convert_NV12_to_RGBA},
+  {GST_VIDEO_FORMAT_BGRA, GST_VIDEO_FORMAT_NV12, convert_NV12_to_RGBA},
+  {GST_VIDEO_FORMAT_NV12, GST_VIDEO_FORMAT_RGBA, convert_RGBA_to_NV12},
+  {GST_VIDEO_FORMAT_NV12, GST_VIDEO_FORMAT_BGRA, convert_RGBA_to_NV12},
+  {GST_VIDEO_FORMAT_NV12, GST_VIDEO_FORMAT_P010_10LE, convert_P010_to_NV12},
+  {GST_VIDEO_FORMAT_P010_10LE, GST_VIDEO_FORMAT_NV12, convert_NV12_to_P010},
+};
+
+static ConvertFunc
+get_convert_func (GstVideoFormat dst_format, GstVideoFormat src_format)
+{
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (g_convert_map); i++) {
+    const ConvertMap *const m = &g_convert_map[i];
+    if (m->dst_format == dst_format && m->src_format == src_format)
+      return m->func;
+  }
+  return NULL;
+}
+
+typedef struct
+{
+  ConvertFunc func;
+  const ConvertRowFuncs *funcs;
+  GstVaapiConvertFrame *dst;
+  const GstVaapiConvertFrame *src;
+} ConvertJob;
+
+static void
+convert_band (ConvertJob * job, guint index, guint y, guint height)
+{
+  job->func (job->funcs, job->dst, job->src, y, height);
+}
+
+/* ------------------------------------------------------------------------ */
+/* --- Interface                                                        --- */
+/* ------------------------------------------------------------------------ */
+
+/**
+ * gst_vaapi_convert_is_supported:
+ * @dst_format: the destination #GstVideoFormat
+ * @src_format: the source #GstVideoFormat
+ *
+ * Checks whether frames can be converted from @src_format to
+ * @dst_format. Frames of the same format are not converted, but
+ * copied.
+ *
+ * Return value: %TRUE if the conversion is supported
+ */
+gboolean
+gst_vaapi_convert_is_supported (GstVideoFormat dst_format,
+    GstVideoFormat src_format)
+{
+  return get_convert_func (dst_format, src_format) != NULL;
+}
+
+/**
+ * gst_vaapi_convert_frame_full:
+ * @isa: the #GstVaapiCopyIsa to use
+ * @dst_frame: the destination #GstVaapiConvertFrame
+ * @src_frame: the source #GstVaapiConvertFrame
+ * @num_threads: the maximal number of threads to use, or 0 for the
+ *   default
+ *
+ * Same as gst_vaapi_convert_frame(), only using the C implementation
+ * if @isa is %GST_VAAPI_COPY_ISA_C, and up to @num_threads threads.
+ * This is mostly useful for testing and benchmarking purposes.
+ *
+ * Return value: %TRUE on success
+ */
+gboolean
+gst_vaapi_convert_frame_full (GstVaapiCopyIsa isa,
+    GstVaapiConvertFrame * dst_frame, const GstVaapiConvertFrame * src_frame,
+    guint num_threads)
+{
+  ConvertJob job;
+
+  g_return_val_if_fail (dst_frame != NULL, FALSE);
+  g_return_val_if_fail (src_frame != NULL, FALSE);
+
+  job.func = get_convert_func (dst_frame->format, src_frame->format);
+  if (!job.func)
+    return FALSE;
+
+  /* All the supported conversions involve 4:2:0 frames */
+  if (dst_frame->width != src_frame->width ||
+      dst_frame->height != src_frame->height ||
+      (src_frame->width | src_frame->height) & 1)
+    return FALSE;
+
+  job.funcs = get_convert_row_funcs (isa);
+  job.dst = dst_frame;
+  job.src = src_frame;
+  gst_vaapi_copy_run_bands ((GstVaapiCopyBandFunc) convert_band, &job,
+      src_frame->height, 2, (gsize) src_frame->width * src_frame->height * 4,
+      num_threads);
+  return TRUE;
+}
+
+/**
+ * gst_vaapi_convert_frame:
+ * @dst_frame: the destination #GstVaapiConvertFrame
+ * @src_frame: the source #GstVaapiConvertFrame
+ *
+ * Converts @src_frame into @dst_frame, which shall have the same size.
+ * Large frames are converted by several threads. Only frames with even
+ * dimensions are supported.
+ *
+ * Return value: %TRUE on success
+ */
+gboolean
+gst_vaapi_convert_frame (GstVaapiConvertFrame * dst_frame,
+    const GstVaapiConvertFrame * src_frame)
+{
+  return gst_vaapi_convert_frame_full (GST_VAAPI_COPY_ISA_AUTO, dst_frame,
+      src_frame, 0);
+}
+
+static gboolean
+init_convert_frame (GstVaapiConvertFrame * frame,
+    const GstVideoFrame * video_frame)
+{
+  guint i;
+
+  if (GST_VIDEO_FRAME_N_PLANES (video_frame) > G_N_ELEMENTS (frame->data))
+    return FALSE;
+
+  frame->format = GST_VIDEO_FRAME_FORMAT (video_frame);
+  frame->width = GST_VIDEO_FRAME_WIDTH (video_frame);
+  frame->height = GST_VIDEO_FRAME_HEIGHT (video_frame);
+  for (i = 0; i < GST_VIDEO_FRAME_N_PLANES (video_frame); i++) {
+    frame->data[i] = GST_VIDEO_FRAME_PLANE_DATA (video_frame, i);
+    frame->stride[i] = GST_VIDEO_FRAME_PLANE_STRIDE (video_frame, i);
+  }
+  return TRUE;
+}
+
+/**
+ * gst_vaapi_convert_video_frame:
+ * @dst_frame: the destination #GstVideoFrame
+ * @src_frame: the source #GstVideoFrame
+ *
+ * Same as gst_vaapi_convert_frame(), for #GstVideoFrame objects.
+ *
+ * Return value: %TRUE on success
+ */
+gboolean
+gst_vaapi_convert_video_frame (GstVideoFrame * dst_frame,
+    const GstVideoFrame * src_frame)
+{
+  GstVaapiConvertFrame dst, src;
+
+  g_return_val_if_fail (dst_frame != NULL, FALSE);
+  g_return_val_if_fail (src_frame != NULL, FALSE);
+
+  if (!init_convert_frame (&dst, dst_frame) ||
+      !init_convert_frame (&src, src_frame))
+    return FALSE;
+  return gst_vaapi_convert_frame (&dst, &src);
+}
@@ -0,0 +1,72 @@
+/*
+ *  gstvaapiutils_convert.h - Pixel format conversion utilities
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation; either version 2.1
+ *  of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free
+ *  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301 USA
+ */
+
+#ifndef GST_VAAPI_UTILS_CONVERT_H
+#define GST_VAAPI_UTILS_CONVERT_H
+
+#include "gstvaapiutils_copy.h"
+
+G_BEGIN_DECLS
+
+/**
+ * GstVaapiConvertFrame:
+ * @format: the #GstVideoFormat of the pixels
+ * @width: the width of the frame, in pixels
+ * @height: the height of the frame, in pixels
+ * @data: the first line of each plane, in memory order
+ * @stride: the stride of each plane, in bytes
+ *
+ * A frame to convert from or to.
+ */
+typedef struct
+{
+  GstVideoFormat format;
+  guint width;
+  guint height;
+  guint8 *data[3];
+  guint stride[3];
+} GstVaapiConvertFrame;
+
+G_GNUC_INTERNAL
+gboolean
+gst_vaapi_convert_is_supported (GstVideoFormat dst_format,
+    GstVideoFormat src_format);
+
+G_GNUC_INTERNAL
+gboolean
+gst_vaapi_convert_frame (GstVaapiConvertFrame * dst_frame,
+    const GstVaapiConvertFrame * src_frame);
+
+/* Same as above, restricted to the supplied ISA and number of threads */
+G_GNUC_INTERNAL
+gboolean
+gst_vaapi_convert_frame_full (GstVaapiCopyIsa isa,
+    GstVaapiConvertFrame * dst_frame, const GstVaapiConvertFrame * src_frame,
+    guint num_threads);
+
+G_GNUC_INTERNAL
+gboolean
+gst_vaapi_convert_video_frame (GstVideoFrame * dst_frame,
+    const GstVideoFrame * src_frame);
+
+G_END_DECLS
+
+#endif /* GST_VAAPI_UTILS_CONVERT_H */
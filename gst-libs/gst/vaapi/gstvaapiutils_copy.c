@@ -0,0 +1,648 @@
+/*
+ *  gstvaapiutils_copy.c - Plane copy utilities
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation; either version 2.1
+ *  of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free
+ *  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301 USA
+ */
+
+/*
+ * VA image mappings are usually write-combined, or even uncached
+ * speculative write-combined (USWC) memory. Regular loads from such
+ * memory are not cached, and thus run at a fraction of the memory
+ * bandwidth, whereas streaming loads (MOVNTDQA) fetch a whole line
+ * into a fill buffer at once. Likewise, non-temporal stores avoid
+ * reading back the destination lines into the cache, only to evict
+ * them shortly after.
+ *
+ * The vector implementations align the source lines on the register
+ * size, copy whole cache lines with streaming loads where available,
+ * and use non-temporal stores whenever the destination is aligned
+ * too. Large images are further split into bands of lines that are
+ * copied by a pool of threads, since a single core can rarely
+ * saturate the memory bandwidth.
+ *
+ * The implementation is selected at runtime from the CPU features and
+ * the kind of memory involved: plain memcpy() is best for cached
+ * memory.
+ */
+
+#include "sysdeps.h"
+#include "gstvaapiutils_copy.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define USE_X86_SIMD 1
+# include <immintrin.h>
+#else
+# define USE_X86_SIMD 0
+#endif
+
+/* Maximal number of threads used to copy a single image */
+#define MAX_COPY_THREADS 8
+
+/* Default number of threads, copies are limited by memory bandwidth */
+#define DEFAULT_COPY_THREADS 4
+
+/* Minimal number of bytes per thread, below which threads don't pay off */
+#define MIN_BYTES_PER_THREAD (512 * 1024)
+
+#define MAX_COPY_PLANES 4
+
+typedef void (*CopyRowFunc) (guint8 * dst, const guint8 * src, guint size,
+    gboolean nt_store);
+
+static void
+copy_row_c (guint8 * dst, const guint8 * src, guint size, gboolean nt_store)
+{
+  memcpy (dst, src, size);
+}
+
+#if USE_X86_SIMD
+__attribute__ ((target ("sse2")))
+static void
+copy_row_sse2 (guint8 * dst, const guint8 * src, guint size,
+    gboolean nt_store)
+{
+  guint head;
+
+  /* Align on the destination for non-temporal stores, without
+     streaming loads there is nothing to gain from aligned loads */
+  head = (nt_store ? -(guintptr) dst : -(guintptr) src) & 15;
+  if (size < head + 64) {
+    memcpy (dst, src, size);
+    return;
+  }
+  memcpy (dst, src, head);
+  dst += head;
+  src += head;
+  size -= head;
+
+  if (nt_store) {
+    for (; size >= 64; size -= 64, dst += 64, src += 64) {
+      const __m128i x0 = _mm_loadu_si128 ((const __m128i *) src + 0);
+      const __m128i x1 = _mm_loadu_si128 ((const __m128i *) src + 1);
+      const __m128i x2 = _mm_loadu_si128 ((const __m128i *) src + 2);
+      const __m128i x3 = _mm_loadu_si128 ((const __m128i *) src + 3);
+      _mm_stream_si128 ((__m128i *) dst + 0, x0);
+      _mm_stream_si128 ((__m128i *) dst + 1, x1);
+      _mm_stream_si128 ((__m128i *) dst + 2, x2);
+      _mm_stream_si128 ((__m128i *) dst + 3, x3);
+    }
+  } else {
+    for (; size >= 64; size -= 64, dst += 64, src += 64) {
+      const __m128i x0 = _mm_load_si128 ((const __m128i *) src + 0);
+      const __m128i x1 = _mm_load_si128 ((const __m128i *) src + 1);
+      const __m128i x2 = _mm_load_si128 ((const __m128i *) src + 2);
+      const __m128i x3 = _mm_load_si128 ((const __m128i *) src + 3);
+      _mm_storeu_si128 ((__m128i *) dst + 0, x0);
+      _mm_storeu_si128 ((__m128i *) dst + 1, x1);
+      _mm_storeu_si128 ((__m128i *) dst + 2, x2);
+      _mm_storeu_si128 ((__m128i *) dst + 3, x3);
+    }
+  }
+  memcpy (dst, src, size);
+}
+
+__attribute__ ((target ("sse4.1")))
+static void
+copy_row_sse4_1 (guint8 * dst, const guint8 * src, guint size,
+    gboolean nt_store)
+{
+  guint head;
+
+  /* Streaming loads require aligned source addresses */
+  head = -(guintptr) src & 15;
+  if (size < head + 64) {
+    memcpy (dst, src, size);
+    return;
+  }
+  memcpy (dst, src, head);
+  dst += head;
+  src += head;
+  size -= head;
+
+  if (nt_store && !((guintptr) dst & 15)) {
+    for (; size >= 64; size -= 64, dst += 64, src += 64) {
+      const __m128i x0 = _mm_stream_load_si128 ((__m128i *) src + 0);
+      const __m128i x1 = _mm_stream_load_si128 ((__m128i *) src + 1);
+      const __m128i x2 = _mm_stream_load_si128 ((__m128i *) src + 2);
+      const __m128i x3 = _mm_stream_load_si128 ((__m128i *) src + 3);
+      _mm_stream_si128 ((__m128i *) dst + 0, x0);
+      _mm_stream_si128 ((__m128i *) dst + 1, x1);
+      _mm_stream_si128 ((__m128i *) dst + 2, x2);
+      _mm_stream_si128 ((__m128i *) dst + 3, x3);
+    }
+  } else {
+    for (; size >= 64; size -= 64, dst += 64, src += 64) {
+      const __m128i x0 = _mm_stream_load_si128 ((__m128i *) src + 0);
+      const __m128i x1 = _mm_stream_load_si128 ((__m128i *) src + 1);
+      const __m128i x2 = _mm_stream_load_si128 ((__m128i *) src + 2);
+      const __m128i x3 = _mm_stream_load_si128 ((__m128i *) src + 3);
+      _mm_storeu_si128 ((__m128i *) dst + 0, x0);
+      _mm_storeu_si128 ((__m128i *) dst + 1, x1);
+      _mm_storeu_si128 ((__m128i *) dst + 2, x2);
+      _mm_storeu_si128 ((__m128i *) dst + 3, x3);
+    }
+  }
+  memcpy (dst, src, size);
+}
+
+__attribute__ ((target ("avx2")))
+static void
+copy_row_avx2 (guint8 * dst, const guint8 * src, guint size,
+    gboolean nt_store)
+{
+  guint head;
+
+  /* Streaming loads require aligned source addresses */
+  head = -(guintptr) src & 31;
+  if (size < head + 128) {
+    memcpy (dst, src, size);
+    return;
+  }
+  memcpy (dst, src, head);
+  dst += head;
+  src += head;
+  size -= head;
+
+  if (nt_store && !((guintptr) dst & 31)) {
+    for (; size >= 128; size -= 128, dst += 128, src += 128) {
+      const __m256i y0 = _mm256_stream_load_si256 ((__m256i *) src + 0);
+      const __m256i y1 = _mm256_stream_load_si256 ((__m256i *) src + 1);
+      const __m256i y2 = _mm256_stream_load_si256 ((__m256i *) src + 2);
+      const __m256i y3 = _mm256_stream_load_si256 ((__m256i *) src + 3);
+      _mm256_stream_si256 ((__m256i *) dst + 0, y0);
+      _mm256_stream_si256 ((__m256i *) dst + 1, y1);
+      _mm256_stream_si256 ((__m256i *) dst + 2, y2);
+      _mm256_stream_si256 ((__m256i *) dst + 3, y3);
+    }
+  } else {
+    for (; size >= 128; size -= 128, dst += 128, src += 128) {
+      const __m256i y0 = _mm256_stream_load_si256 ((__m256i *) src + 0);
+      const __m256i y1 = _mm256_stream_load_si256 ((__m256i *) src + 1);
+      const __m256i y2 = _mm256_stream_load_si256 ((__m256i *) src + 2);
+      const __m256i y3 = _mm256_stream_load_si256 ((__m256i *) src + 3);
+      _mm256_storeu_si256 ((__m256i *) dst + 0, y0);
+      _mm256_storeu_si256 ((__m256i *) dst + 1, y1);
+      _mm256_storeu_si256 ((__m256i *) dst + 2, y2);
+      _mm256_storeu_si256 ((__m256i *) dst + 3, y3);
+    }
+  }
+  memcpy (dst, src, size);
+}
+#endif
+
+static CopyRowFunc
+get_copy_row_func (GstVaapiCopyIsa isa)
+{
+  switch (isa) {
+    case GST_VAAPI_COPY_ISA_C:
+      return copy_row_c;
+#if USE_X86_SIMD
+    case GST_VAAPI_COPY_ISA_SSE2:
+      return __builtin_cpu_supports ("sse2") ? copy_row_sse2 : NULL;
+    case GST_VAAPI_COPY_ISA_SSE4_1:
+      return __builtin_cpu_supports ("sse4.1") ? copy_row_sse4_1 : NULL;
+    case GST_VAAPI_COPY_ISA_AVX2:
+      return __builtin_cpu_supports ("avx2") ? copy_row_avx2 : NULL;
+#endif
+    default:
+      break;
+  }
+  return NULL;
+}
+
+/* Returns the best vector implementation, or the C one if none */
+static CopyRowFunc
+get_vector_copy_row_func (void)
+{
+  static gsize g_copy_row_func = 0;
+
+  if (g_once_init_enter (&g_copy_row_func)) {
+    static const GstVaapiCopyIsa isas[] = {
+      GST_VAAPI_COPY_ISA_AVX2,
+      GST_VAAPI_COPY_ISA_SSE4_1,
+      GST_VAAPI_COPY_ISA_SSE2,
+      GST_VAAPI_COPY_ISA_C,
+    };
+    CopyRowFunc func = NULL;
+    guint i;
+
+#if USE_X86_SIMD
+    __builtin_cpu_init ();
+#endif
+    for (i = 0; i < G_N_ELEMENTS (isas) && !func; i++)
+      func = get_copy_row_func (isas[i]);
+    g_once_init_leave (&g_copy_row_func, (gsize) func);
+  }
+  return (CopyRowFunc) g_copy_row_func;
+}
+
+/* ------------------------------------------------------------------------ */
+/* --- Bands                                                            --- */
+/* ------------------------------------------------------------------------ */
+
+typedef struct
+{
+  guint index;
+  guint y;
+  guint height;
+} Band;
+
+typedef struct
+{
+  GstVaapiCopyBandFunc func;
+  gpointer user_data;
+  Band bands[MAX_COPY_PLANES * MAX_COPY_THREADS];
+  guint num_bands;
+  gint next_band;
+  guint num_done_bands;
+  gint ref_count;
+  GMutex lock;
+  GCond done;
+} BandJob;
+
+/* Processes bands until there is none left */
+static void
+band_job_run (BandJob * job)
+{
+  guint n = 0;
+  gint i;
+
+  while ((i = g_atomic_int_add (&job->next_band, 1)) < (gint) job->num_bands) {
+    const Band *const band = &job->bands[i];
+    job->func (job->user_data, band->index, band->y, band->height);
+    n++;
+  }
+
+  if (n > 0) {
+    g_mutex_lock (&job->lock);
+    job->num_done_bands += n;
+    if (job->num_done_bands == job->num_bands)
+      g_cond_signal (&job->done);
+    g_mutex_unlock (&job->lock);
+  }
+}
+
+static void
+band_job_unref (BandJob * job)
+{
+  if (!g_atomic_int_dec_and_test (&job->ref_count))
+    return;
+  g_mutex_clear (&job->lock);
+  g_cond_clear (&job->done);
+  g_slice_free (BandJob, job);
+}
+
+static void
+band_job_thread (BandJob * job, gpointer user_data)
+{
+  band_job_run (job);
+  band_job_unref (job);
+}
+
+static GThreadPool *
+get_thread_pool (void)
+{
+  static gsize g_thread_pool = 0;
+
+  if (g_once_init_enter (&g_thread_pool)) {
+    GThreadPool *const pool =
+        g_thread_pool_new ((GFunc) band_job_thread, NULL,
+        MAX_COPY_THREADS - 1, FALSE, NULL);
+    g_once_init_leave (&g_thread_pool, (gsize) pool);
+  }
+  return (GThreadPool *) g_thread_pool;
+}
+
+static guint
+get_num_threads (gsize size, guint num_threads)
+{
+  if (num_threads == 0)
+    num_threads = MIN (g_get_num_processors (), DEFAULT_COPY_THREADS);
+  num_threads = CLAMP (num_threads, 1, MAX_COPY_THREADS);
+
+  return MAX (MIN (num_threads, size / MIN_BYTES_PER_THREAD), 1);
+}
+
+static BandJob *
+band_job_new (GstVaapiCopyBandFunc func, gpointer user_data)
+{
+  BandJob *const job = g_slice_new (BandJob);
+
+  job->func = func;
+  job->user_data = user_data;
+  job->num_bands = 0;
+  job->next_band = 0;
+  job->num_done_bands = 0;
+  job->ref_count = 1;
+  g_mutex_init (&job->lock);
+  g_cond_init (&job->done);
+  return job;
+}
+
+/* Splits lines [0, height) of index into num_threads bands, whose
+   heights are multiples of align */
+static void
+band_job_add_bands (BandJob * job, guint index, guint height, guint align,
+    guint num_threads)
+{
+  guint j, y, band_height;
+
+  band_height = (height + num_threads - 1) / num_threads;
+  band_height = (band_height + align - 1) / align * align;
+  for (j = 0, y = 0; j < num_threads && y < height; j++) {
+    Band *const band = &job->bands[job->num_bands++];
+    band->index = index;
+    band->y = y;
+    band->height = MIN (band_height, height - y);
+    y += band->height;
+  }
+}
+
+/* Processes the bands from num_threads, including the calling one */
+static void
+band_job_run_threaded (BandJob * job, guint num_threads)
+{
+  GThreadPool *const pool = get_thread_pool ();
+  guint i;
+
+  /* The job is freed by whoever runs last, since worker threads may
+     only get scheduled once all the bands were processed */
+  for (i = 1; i < num_threads && pool; i++) {
+    g_atomic_int_inc (&job->ref_count);
+    if (!g_thread_pool_push (pool, job, NULL))
+      g_atomic_int_add (&job->ref_count, -1);
+  }
+  band_job_run (job);
+
+  g_mutex_lock (&job->lock);
+  while (job->num_done_bands < job->num_bands)
+    g_cond_wait (&job->done, &job->lock);
+  g_mutex_unlock (&job->lock);
+  band_job_unref (job);
+}
+
+typedef struct
+{
+  CopyRowFunc copy_row;
+  gboolean nt_store;
+  const GstVaapiCopyPlane *planes;
+} CopyParams;
+
+static void
+copy_band (CopyParams * params, guint index, guint y, guint height)
+{
+  const GstVaapiCopyPlane *const plane = &params->planes[index];
+  guint8 *dst = plane->dst + (gsize) y * plane->dst_stride;
+  const guint8 *src = plane->src + (gsize) y * plane->src_stride;
+  guint i;
+
+  for (i = 0; i < height; i++) {
+    params->copy_row (dst, src, plane->width, params->nt_store);
+    dst += plane->dst_stride;
+    src += plane->src_stride;
+  }
+
+#if USE_X86_SIMD
+  /* Make non-temporal stores globally visible */
+  if (params->nt_store && params->copy_row != copy_row_c)
+    _mm_sfence ();
+#endif
+}
+
+/* Splits the planes into bands and copies them from num_threads */
+static void
+copy_planes_threaded (CopyParams * params, guint num_planes,
+    guint num_threads)
+{
+  BandJob *const job =
+      band_job_new ((GstVaapiCopyBandFunc) copy_band, params);
+  guint i;
+
+  for (i = 0; i < num_planes; i++)
+    band_job_add_bands (job, i, params->planes[i].height, 1, num_threads);
+  band_job_run_threaded (job, num_threads);
+}
+
+/* ------------------------------------------------------------------------ */
+/* --- Interface                                                        --- */
+/* ------------------------------------------------------------------------ */
+
+/**
+ * gst_vaapi_copy_planes_full:
+ * @isa: the #GstVaapiCopyIsa to use
+ * @planes: the regions of planes to copy
+ * @num_planes: the number of @planes
+ * @flags: a combination of #GstVaapiCopyFlags
+ * @num_threads: the maximal number of threads to use, or 0 for the
+ *   default
+ *
+ * Same as gst_vaapi_copy_planes(), only using the implementation for
+ * @isa and up to @num_threads threads. This is mostly useful for
+ * testing and benchmarking purposes. Nothing is copied if @isa is not
+ * supported.
+ */
+void
+gst_vaapi_copy_planes_full (GstVaapiCopyIsa isa,
+    const GstVaapiCopyPlane * planes, guint num_planes, guint flags,
+    guint num_threads)
+{
+  const gboolean nt_store = (flags & GST_VAAPI_COPY_FLAG_DST_UNCACHED) != 0;
+  CopyParams params;
+  CopyRowFunc copy_row;
+  gsize size = 0;
+  guint i;
+
+  g_return_if_fail (planes != NULL || num_planes == 0);
+  g_return_if_fail (num_planes <= MAX_COPY_PLANES);
+
+  if (isa != GST_VAAPI_COPY_ISA_AUTO)
+    copy_row = get_copy_row_func (isa);
+  else if (flags & (GST_VAAPI_COPY_FLAG_SRC_UNCACHED |
+          GST_VAAPI_COPY_FLAG_DST_UNCACHED))
+    copy_row = get_vector_copy_row_func ();
+  else
+    copy_row = copy_row_c;
+  if (!copy_row)
+    return;
+
+  for (i = 0; i < num_planes; i++)
+    size += (gsize) planes[i].width * planes[i].height;
+
+  params.copy_row = copy_row;
+  params.nt_store = nt_store;
+  params.planes = planes;
+
+  num_threads = get_num_threads (size, num_threads);
+  if (num_threads > 1) {
+    copy_planes_threaded (&params, num_planes, num_threads);
+    return;
+  }
+
+  for (i = 0; i < num_planes; i++)
+    copy_band (&params, i, 0, planes[i].height);
+}
+
+/**
+ * gst_vaapi_copy_run_bands:
+ * @func: the function processing a band of lines
+ * @user_data: the data to pass to @func
+ * @height: the number of lines to process
+ * @align: the alignment of the bands, in lines
+ * @size: the number of bytes to process
+ * @num_threads: the maximal number of threads to use, or 0 for the
+ *   default
+ *
+ * Splits lines [0, @height) into bands whose heights are multiples
+ * of @align, and calls @func on each of them from the copy threads.
+ * Like copies, the actual number of threads depends on the @size of
+ * the data. The @index argument of @func is always zero.
+ */
+void
+gst_vaapi_copy_run_bands (GstVaapiCopyBandFunc func, gpointer user_data,
+    guint height, guint align, gsize size, guint num_threads)
+{
+  BandJob *job;
+
+  g_return_if_fail (func != NULL);
+  g_return_if_fail (align > 0);
+
+  num_threads = get_num_threads (size, num_threads);
+  if (num_threads == 1 || height <= align) {
+    func (user_data, 0, 0, height);
+    return;
+  }
+
+  job = band_job_new (func, user_data);
+  band_job_add_bands (job, 0, height, align, num_threads);
+  band_job_run_threaded (job, num_threads);
+}
+
+/**
+ * gst_vaapi_copy_planes:
+ * @planes: the regions of planes to copy
+ * @num_planes: the number of @planes
+ * @flags: a combination of #GstVaapiCopyFlags
+ *
+ * Copies the supplied regions of planes, using the fastest method for
+ * the kind of memory described by @flags. Large regions are copied by
+ * several threads.
+ */
+void
+gst_vaapi_copy_planes (const GstVaapiCopyPlane * planes, guint num_planes,
+    guint flags)
+{
+  gst_vaapi_copy_planes_full (GST_VAAPI_COPY_ISA_AUTO, planes, num_planes,
+      flags, 0);
+}
+
+/**
+ * gst_vaapi_copy_video_frame:
+ * @dst_frame: the destination #GstVideoFrame
+ * @src_frame: the source #GstVideoFrame
+ * @flags: a combination of #GstVaapiCopyFlags
+ *
+ * Same as gst_video_frame_copy(), using gst_vaapi_copy_planes() for
+ * the formats it can handle.
+ *
+ * Return value: %TRUE on success
+ */
+gboolean
+gst_vaapi_copy_video_frame (GstVideoFrame * dst_frame,
+    const GstVideoFrame * src_frame, guint flags)
+{
+  const GstVideoFormatInfo *const finfo = dst_frame->info.finfo;
+  GstVaapiCopyPlane planes[MAX_COPY_PLANES];
+  guint i, num_planes;
+
+  g_return_val_if_fail (dst_frame != NULL, FALSE);
+  g_return_val_if_fail (src_frame != NULL, FALSE);
+
+  if (GST_VIDEO_FRAME_FORMAT (dst_frame) != GST_VIDEO_FRAME_FORMAT (src_frame)
+      || GST_VIDEO_FRAME_WIDTH (dst_frame) != GST_VIDEO_FRAME_WIDTH (src_frame)
+      || GST_VIDEO_FRAME_HEIGHT (dst_frame) !=
+      GST_VIDEO_FRAME_HEIGHT (src_frame))
+    return FALSE;
+
+  num_planes = GST_VIDEO_FRAME_N_PLANES (dst_frame);
+  if (GST_VIDEO_FORMAT_INFO_HAS_PALETTE (finfo) ||
+      GST_VIDEO_FORMAT_INFO_IS_TILED (finfo) || num_planes > MAX_COPY_PLANES)
+    return gst_video_frame_copy (dst_frame, src_frame);
+
+  /* Like gst_video_frame_copy_plane(), this assumes that component i
+     has the same subsampling as plane i */
+  for (i = 0; i < num_planes; i++) {
+    GstVaapiCopyPlane *const plane = &planes[i];
+
+    if (GST_VIDEO_FRAME_COMP_PSTRIDE (dst_frame, i) == 0)
+      return gst_video_frame_copy (dst_frame, src_frame);
+
+    plane->dst = GST_VIDEO_FRAME_PLANE_DATA (dst_frame, i);
+    plane->dst_stride = GST_VIDEO_FRAME_PLANE_STRIDE (dst_frame, i);
+    plane->src = GST_VIDEO_FRAME_PLANE_DATA (src_frame, i);
+    plane->src_stride = GST_VIDEO_FRAME_PLANE_STRIDE (src_frame, i);
+    plane->width = GST_VIDEO_FRAME_COMP_WIDTH (dst_frame, i) *
+        GST_VIDEO_FRAME_COMP_PSTRIDE (dst_frame, i);
+    plane->height = GST_VIDEO_FRAME_COMP_HEIGHT (dst_frame, i);
+  }
+  gst_vaapi_copy_planes (planes, num_planes, flags);
+  return TRUE;
+}
+
+/**
+ * gst_vaapi_copy_isa_is_supported:
+ * @isa: a #GstVaapiCopyIsa
+ *
+ * Checks whether the plane copy engine for @isa was built in and is
+ * supported by the CPU.
+ *
+ * Return value: %TRUE if @isa can be used
+ */
+gboolean
+gst_vaapi_copy_isa_is_supported (GstVaapiCopyIsa isa)
+{
+  if (isa == GST_VAAPI_COPY_ISA_AUTO)
+    return TRUE;
+
+  /* Make sure the CPU features are initialized */
+  get_vector_copy_row_func ();
+  return get_copy_row_func (isa) != NULL;
+}
+
+/**
+ * gst_vaapi_copy_isa_get_name:
+ * @isa: a #GstVaapiCopyIsa
+ *
+ * Return value: the name of @isa
+ */
+const gchar *
+gst_vaapi_copy_isa_get_name (GstVaapiCopyIsa isa)
+{
+  switch (isa) {
+    case GST_VAAPI_COPY_ISA_AUTO:
+      return "auto";
+    case GST_VAAPI_COPY_ISA_C:
+      return "c";
+    case GST_VAAPI_COPY_ISA_SSE2:
+      return "sse2";
+    case GST_VAAPI_COPY_ISA_SSE4_1:
+      return "sse4.1";
+    case GST_VAAPI_COPY_ISA_AVX2:
+      return "avx2";
+  }
+  return "<unknown>";
+}
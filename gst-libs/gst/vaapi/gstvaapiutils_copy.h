@@ -0,0 +1,122 @@
+/*
+ *  gstvaapiutils_copy.h - Plane copy utilities
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation; either version 2.1
+ *  of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free
+ *  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301 USA
+ */
+
+#ifndef GST_VAAPI_UTILS_COPY_H
+#define GST_VAAPI_UTILS_COPY_H
+
+#include <gst/video/video.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GstVaapiCopyIsa:
+ * @GST_VAAPI_COPY_ISA_AUTO: the fastest implementation available
+ * @GST_VAAPI_COPY_ISA_C: the portable C implementation
+ * @GST_VAAPI_COPY_ISA_SSE2: the x86 SSE2 implementation
+ * @GST_VAAPI_COPY_ISA_SSE4_1: the x86 SSE4.1 implementation, with
+ *   streaming loads
+ * @GST_VAAPI_COPY_ISA_AVX2: the x86 AVX2 implementation, with
+ *   streaming loads
+ *
+ * The instruction sets the plane copy engine can use.
+ */
+typedef enum
+{
+  GST_VAAPI_COPY_ISA_AUTO = 0,
+  GST_VAAPI_COPY_ISA_C,
+  GST_VAAPI_COPY_ISA_SSE2,
+  GST_VAAPI_COPY_ISA_SSE4_1,
+  GST_VAAPI_COPY_ISA_AVX2,
+} GstVaapiCopyIsa;
+
+/**
+ * GstVaapiCopyFlags:
+ * @GST_VAAPI_COPY_FLAG_SRC_UNCACHED: the source is uncached memory,
+ *   e.g. a write-combined VA image mapping
+ * @GST_VAAPI_COPY_FLAG_DST_UNCACHED: the destination is uncached
+ *   memory, or is not read back soon
+ *
+ * Hints about the memory the planes live in.
+ */
+typedef enum
+{
+  GST_VAAPI_COPY_FLAG_SRC_UNCACHED = 1 << 0,
+  GST_VAAPI_COPY_FLAG_DST_UNCACHED = 1 << 1,
+} GstVaapiCopyFlags;
+
+/**
+ * GstVaapiCopyPlane:
+ * @dst: the first destination line
+ * @dst_stride: the destination stride, in bytes
+ * @src: the first source line
+ * @src_stride: the source stride, in bytes
+ * @width: the number of bytes to copy per line
+ * @height: the number of lines to copy
+ *
+ * A region of a plane to copy.
+ */
+typedef struct
+{
+  guint8 *dst;
+  guint dst_stride;
+  const guint8 *src;
+  guint src_stride;
+  guint width;
+  guint height;
+} GstVaapiCopyPlane;
+
+/* Processes lines [y, y + height) of the image or plane index */
+typedef void (*GstVaapiCopyBandFunc) (gpointer user_data, guint index,
+    guint y, guint height);
+
+G_GNUC_INTERNAL
+void
+gst_vaapi_copy_planes (const GstVaapiCopyPlane * planes, guint num_planes,
+    guint flags);
+
+/* Same as above, restricted to the supplied ISA and number of threads */
+G_GNUC_INTERNAL
+void
+gst_vaapi_copy_planes_full (GstVaapiCopyIsa isa,
+    const GstVaapiCopyPlane * planes, guint num_planes, guint flags,
+    guint num_threads);
+
+G_GNUC_INTERNAL
+void
+gst_vaapi_copy_run_bands (GstVaapiCopyBandFunc func, gpointer user_data,
+    guint height, guint align, gsize size, guint num_threads);
+
+G_GNUC_INTERNAL
+gboolean
+gst_vaapi_copy_video_frame (GstVideoFrame * dst_frame,
+    const GstVideoFrame * src_frame, guint flags);
+
+G_GNUC_INTERNAL
+gboolean
+gst_vaapi_copy_isa_is_supported (GstVaapiCopyIsa isa);
+
+G_GNUC_INTERNAL
+const gchar *
+gst_vaapi_copy_isa_get_name (GstVaapiCopyIsa isa);
+
+G_END_DECLS
+
+#endif /* GST_VAAPI_UTILS_COPY_H */
@@ -0,0 +1,367 @@
+/*
+ *  gstvaapiutils_startcode.c - Start code scanning utilities
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation; either version 2.1
+ *  of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free
+ *  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301 USA
+ */
+
+/*
+ * MPEG-2, MPEG-4 Part 2, VC-1, H.264 and H.265 elementary streams
+ * delimit their syntax units with a 0x000001 start code prefix,
+ * followed by a byte holding the unit type. The vector scanners
+ * compare three overlapping loads of the input against 0x00, 0x00
+ * and 0x01, which tests a whole register worth of candidate positions
+ * at once. The C scanner skips up to three bytes at a time based on
+ * the value of the third byte of each candidate.
+ *
+ * The implementation is selected at runtime from the CPU features.
+ */
+
+#include "sysdeps.h"
+#include "gstvaapiutils_startcode.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define USE_X86_SIMD 1
+# include <immintrin.h>
+#else
+# define USE_X86_SIMD 0
+#endif
+
+#if (defined(__ARM_NEON) || defined(__ARM_NEON__)) && \
+    G_BYTE_ORDER == G_LITTLE_ENDIAN
+# define USE_ARM_NEON 1
+# include <arm_neon.h>
+#else
+# define USE_ARM_NEON 0
+#endif
+
+/* Size of the chunks copied out of the adapter when a scan range
+   spans several buffers. Chunks grow from the minimal size, so that
+   nearby start codes don't require large copies */
+#define SCAN_CHUNK_SIZE_MIN 256
+#define SCAN_CHUNK_SIZE_MAX 4096
+
+typedef gint (*ScanFunc) (const guint8 * data, guint size, guint ofs);
+
+/* Scans data[ofs..size-1] for a start code with a type byte */
+static gint
+scan_c (const guint8 * data, guint size, guint ofs)
+{
+  guint i = ofs;
+
+  if (size < 4)
+    return -1;
+
+  while (i <= size - 4) {
+    if (data[i + 2] > 1)
+      i += 3;
+    else if (data[i + 1])
+      i += 2;
+    else if (data[i] || data[i + 2] != 1)
+      i++;
+    else
+      return i;
+  }
+  return -1;
+}
+
+#if USE_X86_SIMD
+__attribute__ ((target ("sse2")))
+static gint
+scan_sse2 (const guint8 * data, guint size, guint ofs)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  const __m128i one = _mm_set1_epi8 (1);
+  guint i, mask;
+
+  /* The type byte of the last candidate is at i + 18 */
+  for (i = ofs; i + 19 <= size; i += 16) {
+    const __m128i b0 = _mm_loadu_si128 ((const __m128i *) (data + i));
+    const __m128i b1 = _mm_loadu_si128 ((const __m128i *) (data + i + 1));
+    const __m128i b2 = _mm_loadu_si128 ((const __m128i *) (data + i + 2));
+
+    mask = _mm_movemask_epi8 (_mm_and_si128 (_mm_and_si128 (
+                _mm_cmpeq_epi8 (b0, zero), _mm_cmpeq_epi8 (b1, zero)),
+            _mm_cmpeq_epi8 (b2, one)));
+    if (mask)
+      return i + __builtin_ctz (mask);
+  }
+  return scan_c (data, size, i);
+}
+
+__attribute__ ((target ("avx2")))
+static gint
+scan_avx2 (const guint8 * data, guint size, guint ofs)
+{
+  const __m256i zero = _mm256_setzero_si256 ();
+  const __m256i one = _mm256_set1_epi8 (1);
+  guint i, mask;
+
+  /* The type byte of the last candidate is at i + 34 */
+  for (i = ofs; i + 35 <= size; i += 32) {
+    const __m256i b0 = _mm256_loadu_si256 ((const __m256i *) (data + i));
+    const __m256i b1 = _mm256_loadu_si256 ((const __m256i *) (data + i + 1));
+    const __m256i b2 = _mm256_loadu_si256 ((const __m256i *) (data + i + 2));
+
+    mask = (guint) _mm256_movemask_epi8 (_mm256_and_si256 (_mm256_and_si256
+            (_mm256_cmpeq_epi8 (b0, zero), _mm256_cmpeq_epi8 (b1, zero)),
+            _mm256_cmpeq_epi8 (b2, one)));
+    if (mask)
+      return i + __builtin_ctz (mask);
+  }
+  return scan_sse2 (data, size, i);
+}
+#endif
+
+#if USE_ARM_NEON
+static gint
+scan_neon (const guint8 * data, guint size, guint ofs)
+{
+  const uint8x16_t zero = vdupq_n_u8 (0);
+  const uint8x16_t one = vdupq_n_u8 (1);
+  guint64 lo, hi;
+  guint i;
+
+  /* The type byte of the last candidate is at i + 18 */
+  for (i = ofs; i + 19 <= size; i += 16) {
+    const uint8x16_t b0 = vld1q_u8 (data + i);
+    const uint8x16_t b1 = vld1q_u8 (data + i + 1);
+    const uint8x16_t b2 = vld1q_u8 (data + i + 2);
+    const uint64x2_t m = vreinterpretq_u64_u8 (vandq_u8 (vandq_u8 (
+                vceqq_u8 (b0, zero), vceqq_u8 (b1, zero)),
+            vceqq_u8 (b2, one)));
+
+    lo = vgetq_lane_u64 (m, 0);
+    hi = vgetq_lane_u64 (m, 1);
+    if (lo)
+      return i + __builtin_ctzll (lo) / 8;
+    if (hi)
+      return i + 8 + __builtin_ctzll (hi) / 8;
+  }
+  return scan_c (data, size, i);
+}
+#endif
+
+static ScanFunc
+get_scan_func (GstVaapiStartCodeIsa isa)
+{
+  switch (isa) {
+    case GST_VAAPI_START_CODE_ISA_C:
+      return scan_c;
+#if USE_X86_SIMD
+    case GST_VAAPI_START_CODE_ISA_SSE2:
+      return __builtin_cpu_supports ("sse2") ? scan_sse2 : NULL;
+    case GST_VAAPI_START_CODE_ISA_AVX2:
+      return __builtin_cpu_supports ("avx2") ? scan_avx2 : NULL;
+#endif
+#if USE_ARM_NEON
+    case GST_VAAPI_START_CODE_ISA_NEON:
+      return scan_neon;
+#endif
+    default:
+      break;
+  }
+  return NULL;
+}
+
+static ScanFunc
+get_default_scan_func (void)
+{
+  static gsize g_scan_func = 0;
+
+  if (g_once_init_enter (&g_scan_func)) {
+    static const GstVaapiStartCodeIsa isas[] = {
+      GST_VAAPI_START_CODE_ISA_AVX2,
+      GST_VAAPI_START_CODE_ISA_SSE2,
+      GST_VAAPI_START_CODE_ISA_NEON,
+      GST_VAAPI_START_CODE_ISA_C,
+    };
+    ScanFunc func = NULL;
+    guint i;
+
+#if USE_X86_SIMD
+    __builtin_cpu_init ();
+#endif
+    for (i = 0; i < G_N_ELEMENTS (isas) && !func; i++)
+      func = get_scan_func (isas[i]);
+    g_once_init_leave (&g_scan_func, (gsize) func);
+  }
+  return (ScanFunc) g_scan_func;
+}
+
+/**
+ * gst_vaapi_scan_for_start_code:
+ * @data: the data to scan
+ * @size: the size of @data, in bytes
+ *
+ * Looks for the first 0x000001 start code prefix in @data that is
+ * followed by at least one byte, i.e. the start code type.
+ *
+ * Return value: the offset of the start code in @data, or -1 if none
+ *   was found
+ */
+gint
+gst_vaapi_scan_for_start_code (const guint8 * data, guint size)
+{
+  g_return_val_if_fail (data != NULL || size == 0, -1);
+
+  return get_default_scan_func () (data, size, 0);
+}
+
+/**
+ * gst_vaapi_scan_for_start_code_isa:
+ * @isa: the #GstVaapiStartCodeIsa to use
+ * @data: the data to scan
+ * @size: the size of @data, in bytes
+ *
+ * Same as gst_vaapi_scan_for_start_code(), only using the
+ * implementation for @isa. This is mostly useful for testing and
+ * benchmarking purposes.
+ *
+ * Return value: the offset of the start code in @data, or -1 if none
+ *   was found or if @isa is not supported
+ */
+gint
+gst_vaapi_scan_for_start_code_isa (GstVaapiStartCodeIsa isa,
+    const guint8 * data, guint size)
+{
+  ScanFunc func;
+
+  g_return_val_if_fail (data != NULL || size == 0, -1);
+
+  if (isa == GST_VAAPI_START_CODE_ISA_AUTO)
+    func = get_default_scan_func ();
+  else
+    func = get_scan_func (isa);
+  return func ? func (data, size, 0) : -1;
+}
+
+/**
+ * gst_vaapi_adapter_scan_for_start_code:
+ * @adapter: a #GstAdapter
+ * @ofs: the offset into @adapter to start scanning from
+ * @size: the number of bytes to scan
+ * @scp: (out) (allow-none): return location for the start code value
+ *
+ * Same as gst_adapter_masked_scan_uint32_peek() with a 0xffffff00
+ * mask and a 0x00000100 pattern, only faster. The data is scanned in
+ * place if it lives in the first buffer of @adapter, or in copied
+ * chunks otherwise. Like gst_adapter_masked_scan_uint32_peek(), this
+ * leaves any mapping obtained through gst_adapter_map() valid.
+ *
+ * Return value: the offset of the start code from the start of
+ *   @adapter, or -1 if none was found
+ */
+gint
+gst_vaapi_adapter_scan_for_start_code (GstAdapter * adapter, guint ofs,
+    guint size, guint32 * scp)
+{
+  const ScanFunc scan = get_default_scan_func ();
+  guint8 chunk[SCAN_CHUNK_SIZE_MAX];
+  guint n, chunk_size = SCAN_CHUNK_SIZE_MIN;
+  gint pos;
+
+  g_return_val_if_fail (adapter != NULL, -1);
+  g_return_val_if_fail (ofs + size <= gst_adapter_available (adapter), -1);
+
+  if (size < 4)
+    return -1;
+
+  /* Peek at the first buffer through a reference of our own rather
+     than gst_adapter_map(), which would invalidate any mapping the
+     caller holds on @adapter */
+  if (ofs + size <= gst_adapter_available_fast (adapter)) {
+    GstBuffer *const buffer = gst_adapter_get_buffer (adapter, ofs + size);
+    GstMapInfo map;
+
+    if (!buffer)
+      return -1;
+    if (!gst_buffer_map (buffer, &map, GST_MAP_READ)) {
+      gst_buffer_unref (buffer);
+      return -1;
+    }
+    pos = scan (map.data, ofs + size, ofs);
+    if (pos >= 0 && scp)
+      *scp = GST_READ_UINT32_BE (map.data + pos);
+    gst_buffer_unmap (buffer, &map);
+    gst_buffer_unref (buffer);
+    return pos;
+  }
+
+  /* Consecutive chunks overlap by 3 bytes, so that start codes
+     crossing chunk boundaries are found */
+  for (;;) {
+    n = MIN (size, chunk_size);
+    gst_adapter_copy (adapter, chunk, ofs, n);
+    pos = scan (chunk, n, 0);
+    if (pos >= 0) {
+      if (scp)
+        *scp = GST_READ_UINT32_BE (chunk + pos);
+      return ofs + pos;
+    }
+    if (n == size)
+      break;
+    ofs += n - 3;
+    size -= n - 3;
+    chunk_size = MIN (2 * chunk_size, SCAN_CHUNK_SIZE_MAX);
+  }
+  return -1;
+}
+
+/**
+ * gst_vaapi_start_code_isa_is_supported:
+ * @isa: a #GstVaapiStartCodeIsa
+ *
+ * Checks whether the start code scanner for @isa was built in and is
+ * supported by the CPU.
+ *
+ * Return value: %TRUE if @isa can be used
+ */
+gboolean
+gst_vaapi_start_code_isa_is_supported (GstVaapiStartCodeIsa isa)
+{
+  if (isa == GST_VAAPI_START_CODE_ISA_AUTO)
+    return TRUE;
+
+  /* Make sure the CPU features are initialized */
+  get_default_scan_func ();
+  return get_scan_func (isa) != NULL;
+}
+
+/**
+ * gst_vaapi_start_code_isa_get_name:
+ * @isa: a #GstVaapiStartCodeIsa
+ *
+ * Return value: the name of @isa
+ */
+const gchar *
+gst_vaapi_start_code_isa_get_name (GstVaapiStartCodeIsa isa)
+{
+  switch (isa) {
+    case GST_VAAPI_START_CODE_ISA_AUTO:
+      return "auto";
+    case GST_VAAPI_START_CODE_ISA_C:
+      return "c";
+    case GST_VAAPI_START_CODE_ISA_SSE2:
+      return "sse2";
+    case GST_VAAPI_START_CODE_ISA_AVX2:
+      return "avx2";
+    case GST_VAAPI_START_CODE_ISA_NEON:
+      return "neon";
+  }
+  return "<unknown>";
+}
@@ -0,0 +1,75 @@
+/*
+ *  gstvaapiutils_startcode.h - Start code scanning utilities
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation; either version 2.1
+ *  of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free
+ *  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301 USA
+ */
+
+#ifndef GST_VAAPI_UTILS_STARTCODE_H
+#define GST_VAAPI_UTILS_STARTCODE_H
+
+#include <gst/base/gstadapter.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GstVaapiStartCodeIsa:
+ * @GST_VAAPI_START_CODE_ISA_AUTO: the fastest implementation available
+ * @GST_VAAPI_START_CODE_ISA_C: the portable C implementation
+ * @GST_VAAPI_START_CODE_ISA_SSE2: the x86 SSE2 implementation
+ * @GST_VAAPI_START_CODE_ISA_AVX2: the x86 AVX2 implementation
+ * @GST_VAAPI_START_CODE_ISA_NEON: the ARM NEON implementation
+ *
+ * The instruction sets the start code scanner can use.
+ */
+typedef enum
+{
+  GST_VAAPI_START_CODE_ISA_AUTO = 0,
+  GST_VAAPI_START_CODE_ISA_C,
+  GST_VAAPI_START_CODE_ISA_SSE2,
+  GST_VAAPI_START_CODE_ISA_AVX2,
+  GST_VAAPI_START_CODE_ISA_NEON,
+} GstVaapiStartCodeIsa;
+
+/* Finds the first 0x000001 start code prefix followed by one byte */
+G_GNUC_INTERNAL
+gint
+gst_vaapi_scan_for_start_code (const guint8 * data, guint size);
+
+/* Same as above, restricted to the supplied instruction set */
+G_GNUC_INTERNAL
+gint
+gst_vaapi_scan_for_start_code_isa (GstVaapiStartCodeIsa isa,
+    const guint8 * data, guint size);
+
+/* Same as gst_adapter_masked_scan_uint32_peek() for start codes */
+G_GNUC_INTERNAL
+gint
+gst_vaapi_adapter_scan_for_start_code (GstAdapter * adapter, guint ofs,
+    guint size, guint32 * scp);
+
+G_GNUC_INTERNAL
+gboolean
+gst_vaapi_start_code_isa_is_supported (GstVaapiStartCodeIsa isa);
+
+G_GNUC_INTERNAL
+const gchar *
+gst_vaapi_start_code_isa_get_name (GstVaapiStartCodeIsa isa);
+
+G_END_DECLS
+
+#endif /* GST_VAAPI_UTILS_STARTCODE_H */
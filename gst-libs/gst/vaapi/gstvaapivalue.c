@@ -147,6 +147,8 @@ gst_vaapi_rate_control_get_type (void)
         "Variable bitrate - Constrained", "vbr_constrained"},
     {GST_VAAPI_RATECONTROL_MB,
         "Macroblock based rate control", "mb"},
+    {GST_VAAPI_RATECONTROL_LOOKAHEAD,
+        "Lookahead (constant QP per frame)", "lookahead"},
     {0, NULL, NULL},
   };
 
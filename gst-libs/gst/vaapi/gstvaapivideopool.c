@@ -30,6 +30,7 @@
 #include "sysdeps.h"
 #include "gstvaapivideopool.h"
 #include "gstvaapivideopool_priv.h"
+#include "gstvaapidisplay_priv.h"
 #include "gstvaapiobject.h"
 
 #define DEBUG 1
@@ -40,6 +41,48 @@
 #undef gst_vaapi_video_pool_unref
 #undef gst_vaapi_video_pool_replace
 
+/* Current time in milliseconds, for the least recently used order of
+   pools, which wraps around every 49 days */
+#define NOW_MS() \
+  ((gint) (guint) (g_get_monotonic_time () / G_TIME_SPAN_MILLISECOND))
+
+/* Default time after which idle free objects are destroyed */
+#define DEFAULT_IDLE_TIMEOUT (5 * G_TIME_SPAN_SECOND)
+
+/* Statistics counters are 64-bit wide. They are updated without any
+   lock where pointers are that wide too, and under the stats lock
+   otherwise */
+#if GLIB_SIZEOF_VOID_P == 8
+#define STATS_INC(pool, counter, n) \
+  g_atomic_pointer_add (&(pool)->counter, (n))
+#define STATS_GET(pool, counter) \
+  ((guint64) (gsize) g_atomic_pointer_get (&(pool)->counter))
+#else
+static inline void
+stats_inc (GstVaapiVideoPool * pool, guint64 * counter, guint n)
+{
+  g_mutex_lock (&pool->stats_lock);
+  *counter += n;
+  g_mutex_unlock (&pool->stats_lock);
+}
+
+static inline guint64
+stats_get (GstVaapiVideoPool * pool, const guint64 * counter)
+{
+  guint64 value;
+
+  g_mutex_lock (&pool->stats_lock);
+  value = *counter;
+  g_mutex_unlock (&pool->stats_lock);
+  return value;
+}
+
+#define STATS_INC(pool, counter, n) \
+  stats_inc ((pool), &(pool)->counter, (n))
+#define STATS_GET(pool, counter) \
+  stats_get ((pool), &(pool)->counter)
+#endif
+
 #define GST_VAAPI_VIDEO_POOL_GET_CLASS(obj) \
   gst_vaapi_video_pool_get_class (GST_VAAPI_VIDEO_POOL (obj))
 
@@ -49,10 +92,115 @@ gst_vaapi_video_pool_get_class (GstVaapiVideoPool * pool)
   return GST_VAAPI_VIDEO_POOL_CLASS (GST_VAAPI_MINI_OBJECT_GET_CLASS (pool));
 }
 
+/* Charges the pool for a new object, the pool lock must not be held */
+static gboolean
+gst_vaapi_video_pool_acquire_budget (GstVaapiVideoPool * pool, guint n)
+{
+  if (!pool->object_size || !n)
+    return TRUE;
+  return gst_vaapi_display_budget_acquire (GST_VAAPI_DISPLAY_BUDGET
+      (pool->display), pool, n * pool->object_size);
+}
+
+static void
+gst_vaapi_video_pool_release_budget (GstVaapiVideoPool * pool, guint n)
+{
+  if (!pool->object_size || !n)
+    return;
+  gst_vaapi_display_budget_release (GST_VAAPI_DISPLAY_BUDGET (pool->display),
+      pool, n * pool->object_size);
+}
+
 static inline gpointer
 gst_vaapi_video_pool_alloc_object (GstVaapiVideoPool * pool)
 {
-  return GST_VAAPI_VIDEO_POOL_GET_CLASS (pool)->alloc_object (pool);
+  gpointer object;
+
+  if (!gst_vaapi_video_pool_acquire_budget (pool, 1))
+    return NULL;
+
+  object = GST_VAAPI_VIDEO_POOL_GET_CLASS (pool)->alloc_object (pool);
+  if (!object) {
+    gst_vaapi_video_pool_release_budget (pool, 1);
+    return NULL;
+  }
+  STATS_INC (pool, num_allocations, 1);
+  return object;
+}
+
+/* Lowers the minimum number of free objects seen since the last trim */
+static inline void
+gst_vaapi_video_pool_update_min_free (GstVaapiVideoPool * pool,
+    guint num_free)
+{
+  guint min_free;
+
+  do {
+    min_free = g_atomic_int_get (&pool->min_free);
+    if (num_free >= min_free)
+      break;
+  } while (!g_atomic_int_compare_and_exchange (&pool->min_free, min_free,
+          num_free));
+}
+
+/* Pops up to @n free objects, the least recently used first */
+static guint
+gst_vaapi_video_pool_pop_free_objects (GstVaapiVideoPool * pool, guint n,
+    GPtrArray * objects)
+{
+  gpointer object;
+  guint i;
+
+  for (i = 0; i < n; i++) {
+    object = gst_atomic_queue_pop (pool->free_objects);
+    if (!object)
+      break;
+    g_ptr_array_add (objects, object);
+  }
+  if (i > 0) {
+    STATS_INC (pool, num_destructions, i);
+    gst_vaapi_video_pool_update_min_free (pool,
+        gst_atomic_queue_length (pool->free_objects));
+  }
+  return i;
+}
+
+/* Destroys the free objects the pool does not need anymore */
+static void
+gst_vaapi_video_pool_trim (GstVaapiVideoPool * pool)
+{
+  const guint num_free = gst_atomic_queue_length (pool->free_objects);
+  GPtrArray *objects;
+  guint n = 0;
+  gint64 now;
+
+  if (pool->has_foreign_objects)
+    return;
+
+  if (pool->high_watermark && num_free > pool->high_watermark)
+    n = num_free - pool->high_watermark;
+
+  /* Checking the idle timeout is serialized, but never waited for */
+  if (pool->idle_timeout > 0 && g_mutex_trylock (&pool->mutex)) {
+    now = g_get_monotonic_time ();
+    if (now >= pool->trim_time) {
+      const guint min_free = g_atomic_int_get (&pool->min_free);
+
+      if (pool->trim_time > 0 && num_free > pool->low_watermark)
+        n = MAX (n, MIN (min_free, num_free - pool->low_watermark));
+      pool->trim_time = now + pool->idle_timeout;
+      g_atomic_int_set (&pool->min_free, num_free - n);
+    }
+    g_mutex_unlock (&pool->mutex);
+  }
+  if (!n)
+    return;
+
+  objects = g_ptr_array_new_with_free_func (gst_vaapi_object_unref);
+  n = gst_vaapi_video_pool_pop_free_objects (pool, n, objects);
+  GST_DEBUG ("pool %p destroys %u of %u free objects", pool, n, num_free);
+  g_ptr_array_unref (objects);
+  gst_vaapi_video_pool_release_budget (pool, n);
 }
 
 void
@@ -61,22 +209,39 @@ gst_vaapi_video_pool_init (GstVaapiVideoPool * pool, GstVaapiDisplay * display,
 {
   pool->object_type = object_type;
   pool->display = gst_vaapi_display_ref (display);
-  pool->used_objects = NULL;
+  pool->free_objects = gst_atomic_queue_new (16);
   pool->used_count = 0;
   pool->capacity = 0;
+  pool->idle_timeout = DEFAULT_IDLE_TIMEOUT;
+  pool->last_used = NOW_MS ();
 
-  g_queue_init (&pool->free_objects);
   g_mutex_init (&pool->mutex);
+  g_mutex_init (&pool->stats_lock);
+
+  gst_vaapi_display_budget_add_pool (GST_VAAPI_DISPLAY_BUDGET (display), pool);
 }
 
 void
 gst_vaapi_video_pool_finalize (GstVaapiVideoPool * pool)
 {
-  g_list_free_full (pool->used_objects, gst_vaapi_object_unref);
-  g_queue_foreach (&pool->free_objects, (GFunc) gst_vaapi_object_unref, NULL);
-  g_queue_clear (&pool->free_objects);
+  gpointer object;
+
+  gst_vaapi_display_budget_remove_pool (GST_VAAPI_DISPLAY_BUDGET
+      (pool->display), pool);
+  g_free (pool->owner);
+
+  GST_DEBUG ("pool %p: %" G_GUINT64_FORMAT " hits, %" G_GUINT64_FORMAT
+      " misses, %" G_GUINT64_FORMAT " allocations, %" G_GUINT64_FORMAT
+      " destructions", pool, pool->num_hits, pool->num_misses,
+      pool->num_allocations, pool->num_destructions);
+
+  /* Objects still in use are owned by their users */
+  while ((object = gst_atomic_queue_pop (pool->free_objects)))
+    gst_vaapi_object_unref (object);
+  gst_atomic_queue_unref (pool->free_objects);
   gst_vaapi_display_replace (&pool->display, NULL);
   g_mutex_clear (&pool->mutex);
+  g_mutex_clear (&pool->stats_lock);
 }
 
 /**
@@ -161,45 +326,50 @@ gst_vaapi_video_pool_get_object_type (GstVaapiVideoPool * pool)
  * @pool: a #GstVaapiVideoPool
  *
  * Retrieves a new object from the @pool, or allocates a new one if
- * none was found. The @pool holds a reference on the returned object
- * and thus shall be released through gst_vaapi_video_pool_put_object()
- * when it's no longer needed.
+ * none was found. The returned object shall be released through
+ * gst_vaapi_video_pool_put_object() when it's no longer needed.
+ *
+ * This function is lock-free, unless a new object is allocated or the
+ * pool needs to be trimmed.
  *
  * Return value: a possibly newly allocated object, or %NULL on error
  */
-static gpointer
-gst_vaapi_video_pool_get_object_unlocked (GstVaapiVideoPool * pool)
-{
-  gpointer object;
-
-  if (pool->capacity && pool->used_count >= pool->capacity)
-    return NULL;
-
-  object = g_queue_pop_head (&pool->free_objects);
-  if (!object) {
-    g_mutex_unlock (&pool->mutex);
-    object = gst_vaapi_video_pool_alloc_object (pool);
-    g_mutex_lock (&pool->mutex);
-    if (!object)
-      return NULL;
-  }
-
-  ++pool->used_count;
-  pool->used_objects = g_list_prepend (pool->used_objects, object);
-  return gst_vaapi_object_ref (object);
-}
-
 gpointer
 gst_vaapi_video_pool_get_object (GstVaapiVideoPool * pool)
 {
   gpointer object;
+  guint capacity;
 
   g_return_val_if_fail (pool != NULL, NULL);
 
-  g_mutex_lock (&pool->mutex);
-  object = gst_vaapi_video_pool_get_object_unlocked (pool);
-  g_mutex_unlock (&pool->mutex);
+  /* Reserve a slot first, so that the capacity is never exceeded */
+  capacity = g_atomic_int_get (&pool->capacity);
+  if (g_atomic_int_add (&pool->used_count, 1) >= capacity && capacity)
+    goto error_no_slot;
+  g_atomic_int_set (&pool->last_used, NOW_MS ());
+
+  object = gst_atomic_queue_pop (pool->free_objects);
+  if (object) {
+    STATS_INC (pool, num_hits, 1);
+    gst_vaapi_video_pool_update_min_free (pool,
+        gst_atomic_queue_length (pool->free_objects));
+    gst_vaapi_video_pool_trim (pool);
+    return object;
+  }
+
+  STATS_INC (pool, num_misses, 1);
+  g_atomic_int_set (&pool->min_free, 0);
+  object = gst_vaapi_video_pool_alloc_object (pool);
+  if (!object)
+    goto error_no_slot;
   return object;
+
+  /* ERRORS */
+error_no_slot:
+  {
+    g_atomic_int_add (&pool->used_count, -1);
+    return NULL;
+  }
 }
 
 /**
@@ -209,34 +379,30 @@ gst_vaapi_video_pool_get_object (GstVaapiVideoPool * pool)
  *
  * Pushes the @object back into the pool. The @object shall be
  * obtained from the @pool through gst_vaapi_video_pool_get_object().
- * Calling this function with an arbitrary object yields undefined
- * behaviour.
+ * Objects put back while the @pool has none in use are rejected, but
+ * calling this function with an arbitrary object otherwise yields
+ * undefined behaviour.
+ *
+ * This function is lock-free, unless the pool needs to be trimmed.
  */
-static void
-gst_vaapi_video_pool_put_object_unlocked (GstVaapiVideoPool * pool,
-    gpointer object)
-{
-  GList *elem;
-
-  elem = g_list_find (pool->used_objects, object);
-  if (!elem)
-    return;
-
-  gst_vaapi_object_unref (object);
-  --pool->used_count;
-  pool->used_objects = g_list_delete_link (pool->used_objects, elem);
-  g_queue_push_tail (&pool->free_objects, object);
-}
-
 void
 gst_vaapi_video_pool_put_object (GstVaapiVideoPool * pool, gpointer object)
 {
+  gint used_count;
+
   g_return_if_fail (pool != NULL);
   g_return_if_fail (object != NULL);
 
-  g_mutex_lock (&pool->mutex);
-  gst_vaapi_video_pool_put_object_unlocked (pool, object);
-  g_mutex_unlock (&pool->mutex);
+  /* Release the slot first, so that foreign or double puts never
+     make the pool exceed its capacity */
+  do {
+    used_count = g_atomic_int_get (&pool->used_count);
+    g_return_if_fail (used_count > 0);
+  } while (!g_atomic_int_compare_and_exchange (&pool->used_count,
+          used_count, used_count - 1));
+
+  gst_atomic_queue_push (pool->free_objects, object);
+  gst_vaapi_video_pool_trim (pool);
 }
 
 /**
@@ -250,26 +416,18 @@ gst_vaapi_video_pool_put_object (GstVaapiVideoPool * pool, gpointer object)
  *
  * Return value: %TRUE on success.
  */
-static inline gboolean
-gst_vaapi_video_pool_add_object_unlocked (GstVaapiVideoPool * pool,
-    gpointer object)
-{
-  g_queue_push_tail (&pool->free_objects, gst_vaapi_object_ref (object));
-  return TRUE;
-}
-
 gboolean
 gst_vaapi_video_pool_add_object (GstVaapiVideoPool * pool, gpointer object)
 {
-  gboolean success;
-
   g_return_val_if_fail (pool != NULL, FALSE);
   g_return_val_if_fail (object != NULL, FALSE);
 
-  g_mutex_lock (&pool->mutex);
-  success = gst_vaapi_video_pool_add_object_unlocked (pool, object);
-  g_mutex_unlock (&pool->mutex);
-  return success;
+  if (!gst_vaapi_video_pool_acquire_budget (pool, 1))
+    return FALSE;
+
+  pool->has_foreign_objects = TRUE;
+  gst_atomic_queue_push (pool->free_objects, gst_vaapi_object_ref (object));
+  return TRUE;
 }
 
 /**
@@ -283,33 +441,24 @@ gst_vaapi_video_pool_add_object (GstVaapiVideoPool * pool, gpointer object)
  *
  * Return value: %TRUE on success.
  */
-static gboolean
-gst_vaapi_video_pool_add_objects_unlocked (GstVaapiVideoPool * pool,
-    GPtrArray * objects)
+gboolean
+gst_vaapi_video_pool_add_objects (GstVaapiVideoPool * pool, GPtrArray * objects)
 {
   guint i;
 
+  g_return_val_if_fail (pool != NULL, FALSE);
+
+  if (!gst_vaapi_video_pool_acquire_budget (pool, objects->len))
+    return FALSE;
+
+  pool->has_foreign_objects = TRUE;
   for (i = 0; i < objects->len; i++) {
     gpointer const object = g_ptr_array_index (objects, i);
-    if (!gst_vaapi_video_pool_add_object_unlocked (pool, object))
-      return FALSE;
+    gst_atomic_queue_push (pool->free_objects, gst_vaapi_object_ref (object));
   }
   return TRUE;
 }
 
-gboolean
-gst_vaapi_video_pool_add_objects (GstVaapiVideoPool * pool, GPtrArray * objects)
-{
-  gboolean success;
-
-  g_return_val_if_fail (pool != NULL, FALSE);
-
-  g_mutex_lock (&pool->mutex);
-  success = gst_vaapi_video_pool_add_objects_unlocked (pool, objects);
-  g_mutex_unlock (&pool->mutex);
-  return success;
-}
-
 /**
  * gst_vaapi_video_pool_get_size:
  * @pool: a #GstVaapiVideoPool
@@ -321,14 +470,9 @@ gst_vaapi_video_pool_add_objects (GstVaapiVideoPool * pool, GPtrArray * objects)
 guint
 gst_vaapi_video_pool_get_size (GstVaapiVideoPool * pool)
 {
-  guint size;
-
   g_return_val_if_fail (pool != NULL, 0);
 
-  g_mutex_lock (&pool->mutex);
-  size = g_queue_get_length (&pool->free_objects);
-  g_mutex_unlock (&pool->mutex);
-  return size;
+  return gst_atomic_queue_length (pool->free_objects);
 }
 
 /**
@@ -343,44 +487,31 @@ gst_vaapi_video_pool_get_size (GstVaapiVideoPool * pool)
  *
  * Return value: %TRUE on success
  */
-static gboolean
-gst_vaapi_video_pool_reserve_unlocked (GstVaapiVideoPool * pool, guint n)
+gboolean
+gst_vaapi_video_pool_reserve (GstVaapiVideoPool * pool, guint n)
 {
-  guint i, num_allocated;
+  guint i, num_allocated, capacity;
 
-  num_allocated = gst_vaapi_video_pool_get_size (pool) + pool->used_count;
+  g_return_val_if_fail (pool != NULL, 0);
+
+  capacity = g_atomic_int_get (&pool->capacity);
+  num_allocated = gst_atomic_queue_length (pool->free_objects) +
+      g_atomic_int_get (&pool->used_count);
   if (n < num_allocated)
     return TRUE;
 
-  if ((n -= num_allocated) > pool->capacity)
-    n = pool->capacity;
+  if ((n -= num_allocated) > capacity)
+    n = capacity;
 
   for (i = num_allocated; i < n; i++) {
-    gpointer object;
-
-    g_mutex_unlock (&pool->mutex);
-    object = gst_vaapi_video_pool_alloc_object (pool);
-    g_mutex_lock (&pool->mutex);
+    gpointer const object = gst_vaapi_video_pool_alloc_object (pool);
     if (!object)
       return FALSE;
-    g_queue_push_tail (&pool->free_objects, object);
+    gst_atomic_queue_push (pool->free_objects, object);
   }
   return TRUE;
 }
 
-gboolean
-gst_vaapi_video_pool_reserve (GstVaapiVideoPool * pool, guint n)
-{
-  gboolean success;
-
-  g_return_val_if_fail (pool != NULL, 0);
-
-  g_mutex_lock (&pool->mutex);
-  success = gst_vaapi_video_pool_reserve_unlocked (pool, n);
-  g_mutex_unlock (&pool->mutex);
-  return success;
-}
-
 /**
  * gst_vaapi_video_pool_get_capacity:
  * @pool: a #GstVaapiVideoPool
@@ -393,15 +524,9 @@ gst_vaapi_video_pool_reserve (GstVaapiVideoPool * pool, guint n)
 guint
 gst_vaapi_video_pool_get_capacity (GstVaapiVideoPool * pool)
 {
-  guint capacity;
-
   g_return_val_if_fail (pool != NULL, 0);
 
-  g_mutex_lock (&pool->mutex);
-  capacity = pool->capacity;
-  g_mutex_unlock (&pool->mutex);
-
-  return capacity;
+  return g_atomic_int_get (&pool->capacity);
 }
 
 /**
@@ -416,7 +541,145 @@ gst_vaapi_video_pool_set_capacity (GstVaapiVideoPool * pool, guint capacity)
 {
   g_return_if_fail (pool != NULL);
 
+  g_atomic_int_set (&pool->capacity, capacity);
+}
+
+/**
+ * gst_vaapi_video_pool_set_owner:
+ * @pool: a #GstVaapiVideoPool
+ * @owner: (allow-none): the name of the owner, e.g. an element name
+ *
+ * Labels the memory held by the @pool with @owner, so that it can be
+ * monitored through gst_vaapi_display_get_surface_usage().
+ */
+void
+gst_vaapi_video_pool_set_owner (GstVaapiVideoPool * pool, const gchar * owner)
+{
+  g_return_if_fail (pool != NULL);
+
+  gst_vaapi_display_budget_set_pool_owner (GST_VAAPI_DISPLAY_BUDGET
+      (pool->display), pool, owner);
+}
+
+/**
+ * gst_vaapi_video_pool_set_watermarks:
+ * @pool: a #GstVaapiVideoPool
+ * @low_watermark: the number of free objects never destroyed for
+ *   being idle
+ * @high_watermark: the maximum number of free objects, or 0 for no
+ *   limit
+ *
+ * Sets the number of free objects the @pool keeps around. Objects
+ * released to the @pool beyond @high_watermark are destroyed at once,
+ * and those beyond @low_watermark once they stayed idle for the
+ * timeout set with gst_vaapi_video_pool_set_idle_timeout(). New objects
+ * are allocated on demand afterwards. By default, there is no high
+ * watermark and the low watermark is 0.
+ */
+void
+gst_vaapi_video_pool_set_watermarks (GstVaapiVideoPool * pool,
+    guint low_watermark, guint high_watermark)
+{
+  g_return_if_fail (pool != NULL);
+  g_return_if_fail (!high_watermark || low_watermark <= high_watermark);
+
+  g_mutex_lock (&pool->mutex);
+  pool->low_watermark = low_watermark;
+  pool->high_watermark = high_watermark;
+  g_mutex_unlock (&pool->mutex);
+
+  gst_vaapi_video_pool_trim (pool);
+}
+
+/**
+ * gst_vaapi_video_pool_set_idle_timeout:
+ * @pool: a #GstVaapiVideoPool
+ * @timeout: the timeout, in microseconds, or 0 to disable it
+ *
+ * Sets the time after which free objects the @pool did not need are
+ * destroyed, down to the low watermark set with
+ * gst_vaapi_video_pool_set_watermarks(). The default timeout is 5
+ * seconds.
+ *
+ * The timeout is only checked as objects are acquired from or
+ * released to the @pool: there is no timer. A pool that is not used
+ * at all anymore, e.g. in a paused or stalled pipeline, keeps its free
+ * objects until it is used again, unless the display budget set with
+ * gst_vaapi_display_set_surface_budget() reclaims them for another
+ * allocation.
+ */
+void
+gst_vaapi_video_pool_set_idle_timeout (GstVaapiVideoPool * pool,
+    guint64 timeout)
+{
+  g_return_if_fail (pool != NULL);
+
   g_mutex_lock (&pool->mutex);
-  pool->capacity = capacity;
+  pool->idle_timeout = MIN (timeout, G_MAXINT64);
+  pool->trim_time = 0;
   g_mutex_unlock (&pool->mutex);
 }
+
+/**
+ * gst_vaapi_video_pool_get_stats:
+ * @pool: a #GstVaapiVideoPool
+ * @stats: (out caller-allocates): the #GstVaapiVideoPoolStats
+ *
+ * Retrieves statistics about the objects recycled by the @pool since
+ * it was created.
+ */
+void
+gst_vaapi_video_pool_get_stats (GstVaapiVideoPool * pool,
+    GstVaapiVideoPoolStats * stats)
+{
+  g_return_if_fail (pool != NULL);
+  g_return_if_fail (stats != NULL);
+
+  stats->num_hits = STATS_GET (pool, num_hits);
+  stats->num_misses = STATS_GET (pool, num_misses);
+  stats->num_allocations = STATS_GET (pool, num_allocations);
+  stats->num_destructions = STATS_GET (pool, num_destructions);
+  stats->num_free = gst_atomic_queue_length (pool->free_objects);
+  stats->num_used = g_atomic_int_get (&pool->used_count);
+}
+
+/* Moves up to @max_objects of the free objects, the least recently
+   used first, to @objects. Objects added to the pool from outside are
+   not released, since their allocator may rely on them */
+guint
+gst_vaapi_video_pool_steal_free_objects (GstVaapiVideoPool * pool,
+    guint max_objects, GPtrArray * objects)
+{
+  if (pool->has_foreign_objects)
+    return 0;
+  return gst_vaapi_video_pool_pop_free_objects (pool, max_objects, objects);
+}
+
+/* Returns the last time, in milliseconds, an object was handed out */
+guint
+gst_vaapi_video_pool_get_last_used (GstVaapiVideoPool * pool)
+{
+  return g_atomic_int_get (&pool->last_used);
+}
+
+/* Moves a free object to @dst_pool, along with the memory it is
+   charged for. Both pools shall hold objects of the same size, and
+   share the same display budget. The object was allocated for the
+   display of @dst_pool, so it is not foreign to it and may still be
+   trimmed like the objects @dst_pool allocates itself */
+gboolean
+gst_vaapi_video_pool_transfer_free_object (GstVaapiVideoPool * pool,
+    GstVaapiVideoPool * dst_pool)
+{
+  gpointer object;
+
+  object = gst_atomic_queue_pop (pool->free_objects);
+  if (!object)
+    return FALSE;
+
+  if (pool->object_size)
+    gst_vaapi_display_budget_transfer (GST_VAAPI_DISPLAY_BUDGET
+        (pool->display), pool, dst_pool, pool->object_size);
+  gst_atomic_queue_push (dst_pool->free_objects, object);
+  return TRUE;
+}
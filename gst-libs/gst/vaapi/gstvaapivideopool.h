@@ -50,6 +50,29 @@ typedef enum
   GST_VAAPI_VIDEO_POOL_OBJECT_TYPE_CODED_BUFFER
 } GstVaapiVideoPoolObjectType;
 
+/**
+ * GstVaapiVideoPoolStats:
+ * @num_hits: number of objects reused from the free objects
+ * @num_misses: number of objects that had to be allocated on demand
+ * @num_allocations: number of objects allocated, including those
+ *   pre-allocated with gst_vaapi_video_pool_reserve()
+ * @num_destructions: number of free objects destroyed because of the
+ *   watermarks, the idle timeout or the display memory budget
+ * @num_free: current number of free objects
+ * @num_used: current number of objects in use
+ *
+ * Statistics about the recycling of objects by a #GstVaapiVideoPool,
+ * see gst_vaapi_video_pool_get_stats().
+ */
+typedef struct {
+  guint64 num_hits;
+  guint64 num_misses;
+  guint64 num_allocations;
+  guint64 num_destructions;
+  guint num_free;
+  guint num_used;
+} GstVaapiVideoPoolStats;
+
 GstVaapiVideoPool *
 gst_vaapi_video_pool_ref (GstVaapiVideoPool * pool);
 
@@ -91,6 +114,21 @@ gst_vaapi_video_pool_get_capacity (GstVaapiVideoPool * pool);
 void
 gst_vaapi_video_pool_set_capacity (GstVaapiVideoPool * pool, guint capacity);
 
+void
+gst_vaapi_video_pool_set_owner (GstVaapiVideoPool * pool, const gchar * owner);
+
+void
+gst_vaapi_video_pool_set_watermarks (GstVaapiVideoPool * pool,
+    guint low_watermark, guint high_watermark);
+
+void
+gst_vaapi_video_pool_set_idle_timeout (GstVaapiVideoPool * pool,
+    guint64 timeout);
+
+void
+gst_vaapi_video_pool_get_stats (GstVaapiVideoPool * pool,
+    GstVaapiVideoPoolStats * stats);
+
 G_END_DECLS
 
 #endif /* GST_VAAPI_VIDEO_POOL_H */
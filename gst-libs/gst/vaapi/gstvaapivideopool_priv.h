@@ -40,6 +40,25 @@ typedef struct _GstVaapiVideoPoolClass GstVaapiVideoPoolClass;
  * GstVaapiVideoPool:
  *
  * A pool of lazily allocated video objects. e.g. surfaces, images.
+ *
+ * Pools with a non-zero @object_size are charged for each object they
+ * hold in the budget of the @display, under their @owner name. The
+ * @owner and @num_bytes fields are protected by the budget lock.
+ *
+ * Free objects beyond the @high_watermark are destroyed as soon as
+ * they are released, and those beyond the @low_watermark once they
+ * were not needed during a whole @idle_timeout period, i.e. if the
+ * number of free objects did not go below @min_free since @trim_time.
+ *
+ * The @last_used time, in milliseconds, is updated as objects are
+ * handed out, so that the budget trims the least recently used pools
+ * first.
+ *
+ * Objects are recycled through the lock-free @free_objects queue, and
+ * @used_count only tracks how many were handed out against @capacity.
+ * The @mutex merely serializes the watermark and idle timeout settings
+ * with the trimming of idle objects. The @stats_lock only protects the
+ * statistics counters on systems without 64-bit atomic operations.
  */
 struct _GstVaapiVideoPool
 {
@@ -48,11 +67,25 @@ struct _GstVaapiVideoPool
 
   guint object_type;
   GstVaapiDisplay *display;
-  GQueue free_objects;
-  GList *used_objects;
-  guint used_count;
-  guint capacity;
+  GstAtomicQueue *free_objects;
+  gint used_count;
+  gint capacity;
   GMutex mutex;
+  gchar *owner;
+  gsize object_size;
+  guint64 num_bytes;
+  guint low_watermark;
+  guint high_watermark;
+  gint64 idle_timeout;
+  gint64 trim_time;
+  gint min_free;
+  gint last_used;
+  GMutex stats_lock;
+  guint64 num_hits;
+  guint64 num_misses;
+  guint64 num_allocations;
+  guint64 num_destructions;
+  gboolean has_foreign_objects;
 };
 
 /**
@@ -79,6 +112,20 @@ G_GNUC_INTERNAL
 void
 gst_vaapi_video_pool_finalize (GstVaapiVideoPool * pool);
 
+G_GNUC_INTERNAL
+guint
+gst_vaapi_video_pool_steal_free_objects (GstVaapiVideoPool * pool,
+    guint max_objects, GPtrArray * objects);
+
+G_GNUC_INTERNAL
+guint
+gst_vaapi_video_pool_get_last_used (GstVaapiVideoPool * pool);
+
+G_GNUC_INTERNAL
+gboolean
+gst_vaapi_video_pool_transfer_free_object (GstVaapiVideoPool * pool,
+    GstVaapiVideoPool * dst_pool);
+
 /* Internal aliases */
 
 #define gst_vaapi_video_pool_ref_internal(pool) \
@@ -126,6 +126,19 @@ static const GstVaapiDecoderMap vaapi_decode_map[] = {
       gst_vaapidecode_sink_caps_str},
 };
 
+enum
+{
+  PROP_0,
+
+  PROP_PARSE_THREADS,
+  PROP_MAX_WIDTH,
+  PROP_MAX_HEIGHT,
+  PROP_LOW_LATENCY,
+  PROP_COALESCE_SLICES,
+};
+
+#define DEFAULT_PARSE_THREADS 1
+
 static GstElementClass *parent_class = NULL;
 GST_VAAPI_PLUGIN_BASE_DEFINE_SET_CONTEXT (parent_class);
 
@@ -250,6 +263,43 @@ gst_vaapidecode_get_allowed_srcpad_caps (GstVaapiDecode * decode)
   return gst_pad_get_pad_template_caps (srcpad);
 }
 
+/* Checks whether frames are output one frame after their input. Only
+   the H.264 decoder outputs frames early in low-latency mode, and only
+   input with known frame boundaries lets it do so without waiting for
+   the next frame */
+static gboolean
+gst_vaapidecode_is_low_latency (GstVaapiDecode * decode)
+{
+  return decode->low_latency && decode->has_frame_boundaries &&
+      decode->decoder &&
+      gst_vaapi_decoder_get_codec (decode->decoder) == GST_VAAPI_CODEC_H264;
+}
+
+static void
+gst_vaapidecode_update_latency (GstVaapiDecode * decode,
+    const GstVideoInfo * vi)
+{
+  GstClockTime latency;
+  gint fps_d, fps_n;
+
+  fps_n = GST_VIDEO_INFO_FPS_N (vi);
+  fps_d = GST_VIDEO_INFO_FPS_D (vi);
+  if (fps_n <= 0 || fps_d <= 0) {
+    GST_DEBUG_OBJECT (decode, "forcing 25/1 framerate for latency calculation");
+    fps_n = 25;
+    fps_d = 1;
+  }
+
+  /* For parsing/preparation purposes we'd need at least 1 frame
+   * latency in general, with perfectly known unit boundaries (NALU,
+   * AU), and up to 2 frames when we need to wait for the second frame
+   * start to determine the first frame is complete. In low-latency
+   * mode, this is only shortened when the input has these boundaries */
+  latency = gst_util_uint64_scale (gst_vaapidecode_is_low_latency (decode) ?
+      GST_SECOND : 2 * GST_SECOND, fps_d, fps_n);
+  gst_video_decoder_set_latency (GST_VIDEO_DECODER (decode), latency, latency);
+}
+
 static gboolean
 gst_vaapidecode_update_src_caps (GstVaapiDecode * decode)
 {
@@ -262,8 +312,6 @@ gst_vaapidecode_update_src_caps (GstVaapiDecode * decode)
   GstCaps *allocation_caps;
   GstVideoInfo *vi;
   GstVideoFormat format;
-  GstClockTime latency;
-  gint fps_d, fps_n;
   guint width, height;
   const gchar *format_str, *feature_str;
 
@@ -357,21 +405,7 @@ gst_vaapidecode_update_src_caps (GstVaapiDecode * decode)
   gst_caps_replace (&decode->srcpad_caps, state->caps);
   gst_video_codec_state_unref (state);
 
-  fps_n = GST_VIDEO_INFO_FPS_N (vi);
-  fps_d = GST_VIDEO_INFO_FPS_D (vi);
-  if (fps_n <= 0 || fps_d <= 0) {
-    GST_DEBUG_OBJECT (decode, "forcing 25/1 framerate for latency calculation");
-    fps_n = 25;
-    fps_d = 1;
-  }
-
-  /* For parsing/preparation purposes we'd need at least 1 frame
-   * latency in general, with perfectly known unit boundaries (NALU,
-   * AU), and up to 2 frames when we need to wait for the second frame
-   * start to determine the first frame is complete */
-  latency = gst_util_uint64_scale (2 * GST_SECOND, fps_d, fps_n);
-  gst_video_decoder_set_latency (vdec, latency, latency);
-
+  gst_vaapidecode_update_latency (decode, vi);
   return TRUE;
 }
 
@@ -475,6 +509,15 @@ gst_vaapidecode_negotiate (GstVideoDecoder * vdec)
   return TRUE;
 }
 
+static void
+prefetch_output_buffer (GstBuffer * buffer)
+{
+  GstMemory *const mem = gst_buffer_peek_memory (buffer, 0);
+
+  if (GST_VAAPI_IS_VIDEO_MEMORY (mem))
+    gst_vaapi_video_memory_prefetch_image (GST_VAAPI_VIDEO_MEMORY_CAST (mem));
+}
+
 static GstFlowReturn
 gst_vaapidecode_push_decoded_frame (GstVideoDecoder * vdec,
     GstVideoCodecFrame * out_frame)
@@ -546,6 +589,10 @@ gst_vaapidecode_push_decoded_frame (GstVideoDecoder * vdec,
     if (decode->has_texture_upload_meta)
       gst_buffer_ensure_texture_upload_meta (out_frame->output_buffer);
 #endif
+
+    /* Download the frame while the next ones are decoded */
+    if (decode->has_raw_output)
+      prefetch_output_buffer (out_frame->output_buffer);
   }
 
   if (decode->in_segment.rate < 0.0
@@ -740,6 +787,39 @@ error_decoder_flush:
   }
 }
 
+/* Decodes into the surfaces the buffers sent downstream are allocated
+   from, e.g. those of the pool vaapipostproc or vaapisink proposed,
+   so that they are recycled together rather than allocated twice. An
+   unbounded surface pool is first limited to the buffers downstream
+   requires, at least one, and the decoder adds its own surfaces to
+   that capacity, so that it still waits for downstream to release
+   surfaces */
+static void
+gst_vaapidecode_share_surface_pool (GstVaapiDecode * decode)
+{
+  GstBufferPool *const pool =
+      GST_VAAPI_PLUGIN_BASE (decode)->srcpad_buffer_pool;
+  GstVaapiVideoPool *surface_pool = NULL;
+  GstStructure *config;
+  guint min_buffers;
+
+  if (!decode->decoder)
+    return;
+
+  if (pool && GST_VAAPI_IS_VIDEO_BUFFER_POOL (pool))
+    surface_pool = gst_vaapi_video_buffer_pool_get_surface_pool (pool);
+
+  if (surface_pool && !gst_vaapi_video_pool_get_capacity (surface_pool)) {
+    config = gst_buffer_pool_get_config (pool);
+    if (!gst_buffer_pool_config_get_params (config, NULL, NULL,
+            &min_buffers, NULL))
+      min_buffers = 0;
+    gst_structure_free (config);
+    gst_vaapi_video_pool_set_capacity (surface_pool, MAX (min_buffers, 1));
+  }
+  gst_vaapi_decoder_set_surface_pool (decode->decoder, surface_pool);
+}
+
 static gboolean
 gst_vaapidecode_decide_allocation (GstVideoDecoder * vdec, GstQuery * query)
 {
@@ -751,6 +831,7 @@ gst_vaapidecode_decide_allocation (GstVideoDecoder * vdec, GstQuery * query)
     goto error_no_caps;
 
   decode->has_texture_upload_meta = FALSE;
+  decode->has_raw_output = gst_caps_is_video_raw (caps);
 
 #if (USE_GLX || USE_EGL)
   decode->has_texture_upload_meta =
@@ -760,8 +841,12 @@ gst_vaapidecode_decide_allocation (GstVideoDecoder * vdec, GstQuery * query)
       GST_VAAPI_CAPS_FEATURE_GL_TEXTURE_UPLOAD_META);
 #endif
 
-  return gst_vaapi_plugin_base_decide_allocation (GST_VAAPI_PLUGIN_BASE (vdec),
-      query);
+  if (!gst_vaapi_plugin_base_decide_allocation (GST_VAAPI_PLUGIN_BASE (vdec),
+          query))
+    return FALSE;
+
+  gst_vaapidecode_share_surface_pool (decode);
+  return TRUE;
 
   /* ERRORS */
 error_no_caps:
@@ -792,6 +877,7 @@ gst_vaapidecode_create (GstVaapiDecode * decode, GstCaps * caps)
     return FALSE;
   dpy = GST_VAAPI_PLUGIN_BASE_DISPLAY (decode);
 
+  decode->has_frame_boundaries = FALSE;
   switch (gst_vaapi_codec_from_caps (caps)) {
     case GST_VAAPI_CODEC_MPEG2:
       decode->decoder = gst_vaapi_decoder_mpeg2_new (dpy, caps);
@@ -810,16 +896,25 @@ gst_vaapidecode_create (GstVaapiDecode * decode, GstCaps * caps)
 
         if ((str = gst_structure_get_string (structure, "alignment"))) {
           GstVaapiStreamAlignH264 alignment;
-          if (g_strcmp0 (str, "au") == 0)
+          if (g_strcmp0 (str, "au") == 0) {
             alignment = GST_VAAPI_STREAM_ALIGN_H264_AU;
-          else if (g_strcmp0 (str, "nal") == 0)
+            decode->has_frame_boundaries = TRUE;
+          } else if (g_strcmp0 (str, "nal") == 0)
             alignment = GST_VAAPI_STREAM_ALIGN_H264_NALU;
           else
             alignment = GST_VAAPI_STREAM_ALIGN_H264_NONE;
           gst_vaapi_decoder_h264_set_alignment (GST_VAAPI_DECODER_H264
               (decode->decoder), alignment);
         }
+
+        /* Packetized (avcC) streams are split into frames upstream */
+        str = gst_structure_get_string (structure, "stream-format");
+        if (g_strcmp0 (str, "avc") == 0 || g_strcmp0 (str, "avc3") == 0)
+          decode->has_frame_boundaries = TRUE;
       }
+      if (decode->decoder)
+        gst_vaapi_decoder_h264_set_low_latency (GST_VAAPI_DECODER_H264
+            (decode->decoder), decode->low_latency);
       break;
 #if USE_HEVC_DECODER
     case GST_VAAPI_CODEC_H265:
@@ -872,6 +967,13 @@ gst_vaapidecode_create (GstVaapiDecode * decode, GstCaps * caps)
 
   gst_vaapi_decoder_set_codec_state_changed_func (decode->decoder,
       gst_vaapi_decoder_state_changed, decode);
+  gst_vaapi_decoder_set_parse_threads (decode->decoder, decode->parse_threads);
+  gst_vaapi_decoder_set_max_resolution (decode->decoder, decode->max_width,
+      decode->max_height);
+  gst_vaapi_decoder_set_coalesce_slices (decode->decoder,
+      decode->coalesce_slices);
+  gst_vaapi_decoder_set_owner (decode->decoder, GST_OBJECT_NAME (decode));
+  gst_vaapidecode_share_surface_pool (decode);
 
   decode->decoder_caps = gst_caps_ref (caps);
   return TRUE;
@@ -948,6 +1050,80 @@ gst_vaapidecode_finalize (GObject * object)
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
+static void
+gst_vaapidecode_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstVaapiDecode *const decode = GST_VAAPIDECODE (object);
+
+  switch (prop_id) {
+    case PROP_PARSE_THREADS:
+      decode->parse_threads = g_value_get_uint (value);
+      break;
+    case PROP_MAX_WIDTH:
+      decode->max_width = g_value_get_uint (value);
+      break;
+    case PROP_MAX_HEIGHT:
+      decode->max_height = g_value_get_uint (value);
+      break;
+    case PROP_LOW_LATENCY:{
+      GstVideoDecoder *const vdec = GST_VIDEO_DECODER (decode);
+      GstVideoCodecState *state;
+
+      /* Apply the change to the stream being decoded, if any */
+      GST_VIDEO_DECODER_STREAM_LOCK (vdec);
+      decode->low_latency = g_value_get_boolean (value);
+      if (decode->decoder &&
+          gst_vaapi_decoder_get_codec (decode->decoder) ==
+          GST_VAAPI_CODEC_H264)
+        gst_vaapi_decoder_h264_set_low_latency (GST_VAAPI_DECODER_H264
+            (decode->decoder), decode->low_latency);
+      state = gst_video_decoder_get_output_state (vdec);
+      GST_VIDEO_DECODER_STREAM_UNLOCK (vdec);
+
+      if (state) {
+        gst_vaapidecode_update_latency (decode, &state->info);
+        gst_video_codec_state_unref (state);
+      }
+      break;
+    }
+    case PROP_COALESCE_SLICES:
+      decode->coalesce_slices = g_value_get_boolean (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_vaapidecode_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstVaapiDecode *const decode = GST_VAAPIDECODE (object);
+
+  switch (prop_id) {
+    case PROP_PARSE_THREADS:
+      g_value_set_uint (value, decode->parse_threads);
+      break;
+    case PROP_MAX_WIDTH:
+      g_value_set_uint (value, decode->max_width);
+      break;
+    case PROP_MAX_HEIGHT:
+      g_value_set_uint (value, decode->max_height);
+      break;
+    case PROP_LOW_LATENCY:
+      g_value_set_boolean (value, decode->low_latency);
+      break;
+    case PROP_COALESCE_SLICES:
+      g_value_set_boolean (value, decode->coalesce_slices);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
 static gboolean
 gst_vaapidecode_open (GstVideoDecoder * vdec)
 {
@@ -1291,6 +1467,8 @@ gst_vaapidecode_class_init (GstVaapiDecodeClass * klass)
   gst_vaapi_plugin_base_class_init (GST_VAAPI_PLUGIN_BASE_CLASS (klass));
 
   object_class->finalize = gst_vaapidecode_finalize;
+  object_class->set_property = gst_vaapidecode_set_property;
+  object_class->get_property = gst_vaapidecode_get_property;
 
   vdec_class->open = GST_DEBUG_FUNCPTR (gst_vaapidecode_open);
   vdec_class->close = GST_DEBUG_FUNCPTR (gst_vaapidecode_close);
@@ -1344,6 +1522,95 @@ gst_vaapidecode_class_init (GstVaapiDecodeClass * klass)
   /* src pad */
   gst_element_class_add_static_pad_template (element_class,
       &gst_vaapidecode_src_factory);
+
+  /**
+   * GstVaapiDecode:parse-threads:
+   *
+   * The number of threads used to parse the slice headers of H.264
+   * and H.265 streams, including the streaming thread. Slices are
+   * still submitted in bitstream order. For VP9 streams, any value
+   * other than 1 submits frames from another thread, so that the next
+   * frame of the same superframe is parsed meanwhile, unless the frame
+   * adapts probabilities (frame_parallel_decoding_mode unset). 1
+   * disables parallel parsing, and 0 uses as many threads as there
+   * are processors.
+   */
+  g_object_class_install_property
+      (object_class,
+      PROP_PARSE_THREADS,
+      g_param_spec_uint ("parse-threads",
+          "Parse threads",
+          "Number of threads used to parse slice headers (0 = automatic)",
+          0, 64, DEFAULT_PARSE_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstVaapiDecode:max-width:
+   *
+   * The maximum width of the decoded pictures. If both this and
+   * #GstVaapiDecode:max-height are set, surfaces are allocated at the
+   * maximum resolution, and resolution changes within these bounds,
+   * e.g. rendition switches of adaptive streams, no longer re-create
+   * the VA context and its surfaces. 0 disables this mode.
+   */
+  g_object_class_install_property
+      (object_class,
+      PROP_MAX_WIDTH,
+      g_param_spec_uint ("max-width",
+          "Maximum width",
+          "Width of the surfaces allocated up front (0 = picture width)",
+          0, G_MAXINT, 0, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstVaapiDecode:max-height:
+   *
+   * The maximum height of the decoded pictures. See
+   * #GstVaapiDecode:max-width.
+   */
+  g_object_class_install_property
+      (object_class,
+      PROP_MAX_HEIGHT,
+      g_param_spec_uint ("max-height",
+          "Maximum height",
+          "Height of the surfaces allocated up front (0 = picture height)",
+          0, G_MAXINT, 0, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstVaapiDecode:low-latency:
+   *
+   * Outputs the frames of H.264 Baseline profile streams as soon as
+   * they are decoded, assuming that they are not reordered. If the
+   * input buffers hold whole access units (alignment=au) or are
+   * packetized (stream-format=avc), a latency of one frame instead of
+   * two is also reported. Other codecs are not affected. This suits
+   * live sources, such as cameras, that provide complete frames.
+   * Changes apply from the next decoded picture on.
+   */
+  g_object_class_install_property
+      (object_class,
+      PROP_LOW_LATENCY,
+      g_param_spec_boolean ("low-latency",
+          "Low latency",
+          "Output frames as early as possible, assuming live sources",
+          FALSE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstVaapiDecode:coalesce-slices:
+   *
+   * Submits all the slices of MPEG-2 and H.264 pictures with a single
+   * VA slice data buffer and a single VA slice parameter buffer,
+   * instead of a pair of VA buffers per slice. This suits streams
+   * with many slices per picture, e.g. MPEG-2 broadcast streams with
+   * one slice per macroblock row, provided the VA driver supports
+   * arrays of slice parameters.
+   */
+  g_object_class_install_property
+      (object_class,
+      PROP_COALESCE_SLICES,
+      g_param_spec_boolean ("coalesce-slices",
+          "Coalesce slices",
+          "Submit all the slices of a picture with a single pair of buffers",
+          FALSE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -1356,6 +1623,8 @@ gst_vaapidecode_init (GstVaapiDecode * decode)
   g_mutex_init (&decode->surface_ready_mutex);
   g_cond_init (&decode->surface_ready);
 
+  decode->parse_threads = DEFAULT_PARSE_THREADS;
+
   gst_video_decoder_set_packetized (vdec, FALSE);
 }
 
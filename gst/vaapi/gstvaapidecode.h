@@ -50,12 +50,20 @@ struct _GstVaapiDecode {
     GstCaps            *allowed_srcpad_caps;
     guint               current_frame_size;
     guint               has_texture_upload_meta : 1;
+    guint               has_raw_output : 1;
 
     guint               display_width;
     guint               display_height;
 
     GstVideoCodecState *input_state;
     GstSegment          in_segment;
+
+    guint               parse_threads;
+    guint               max_width;
+    guint               max_height;
+    gboolean            low_latency;
+    gboolean            has_frame_boundaries;
+    gboolean            coalesce_slices;
 };
 
 struct _GstVaapiDecodeClass {
@@ -50,9 +50,15 @@ enum
 {
   PROP_0,
 
+  PROP_ZERO_COPY_OUTPUT,
+  PROP_COMPLETION_POLLING,
+
   PROP_BASE,
 };
 
+#define DEFAULT_ZERO_COPY_OUTPUT FALSE
+#define DEFAULT_COMPLETION_POLLING FALSE
+
 static inline gboolean
 ensure_display (GstVaapiEncode * encode)
 {
@@ -181,7 +187,7 @@ gst_vaapiencode_default_set_property (GstVaapiEncode * encode, guint prop_id,
 
 static GstFlowReturn
 gst_vaapiencode_default_alloc_buffer (GstVaapiEncode * encode,
-    GstVaapiCodedBuffer * coded_buf, GstBuffer ** outbuf_ptr)
+    GstVaapiCodedBufferProxy * coded_buf, GstBuffer ** outbuf_ptr)
 {
   GstBuffer *buf;
   gint32 buf_size;
@@ -189,16 +195,27 @@ gst_vaapiencode_default_alloc_buffer (GstVaapiEncode * encode,
   g_return_val_if_fail (coded_buf != NULL, GST_FLOW_ERROR);
   g_return_val_if_fail (outbuf_ptr != NULL, GST_FLOW_ERROR);
 
-  buf_size = gst_vaapi_coded_buffer_get_size (coded_buf);
+  buf_size = gst_vaapi_coded_buffer_proxy_get_buffer_size (coded_buf);
   if (buf_size <= 0)
     goto error_invalid_buffer;
 
+  /* Wrap the VA coded buffer segments, the proxy is released (and the
+     VA coded buffer returned to the pool) once downstream is done */
+  if (encode->zero_copy_output) {
+    buf = gst_buffer_new ();
+    if (!gst_vaapi_coded_buffer_proxy_wrap_into (buf, coded_buf))
+      goto error_copy_buffer;
+    *outbuf_ptr = buf;
+    return GST_FLOW_OK;
+  }
+
   buf =
       gst_video_encoder_allocate_output_buffer (GST_VIDEO_ENCODER_CAST (encode),
       buf_size);
   if (!buf)
     goto error_create_buffer;
-  if (!gst_vaapi_coded_buffer_copy_into (buf, coded_buf))
+  if (!gst_vaapi_coded_buffer_copy_into (buf,
+          GST_VAAPI_CODED_BUFFER_PROXY_BUFFER (coded_buf)))
     goto error_copy_buffer;
 
   *outbuf_ptr = buf;
@@ -258,7 +275,7 @@ ensure_output_state (GstVaapiEncode * encode)
 }
 
 static GstFlowReturn
-gst_vaapiencode_push_frame (GstVaapiEncode * encode, gint64 timeout)
+gst_vaapiencode_push_frame (GstVaapiEncode * encode, guint64 timeout)
 {
   GstVideoEncoder *const venc = GST_VIDEO_ENCODER_CAST (encode);
   GstVaapiEncodeClass *const klass = GST_VAAPIENCODE_GET_CLASS (encode);
@@ -281,16 +298,19 @@ gst_vaapiencode_push_frame (GstVaapiEncode * encode, gint64 timeout)
   gst_video_codec_frame_ref (out_frame);
   gst_video_codec_frame_set_user_data (out_frame, NULL, NULL);
 
+  /* The proxy may outlive this function if its data is wrapped into
+     the output buffer, so break the frame <-> buffer <-> proxy cycle */
+  gst_vaapi_coded_buffer_proxy_set_user_data (codedbuf_proxy, NULL, NULL);
+
   /* Update output state */
   GST_VIDEO_ENCODER_STREAM_LOCK (encode);
   if (!ensure_output_state (encode))
     goto error_output_state;
   GST_VIDEO_ENCODER_STREAM_UNLOCK (encode);
 
-  /* Allocate and copy buffer into system memory */
+  /* Allocate and copy (or wrap) buffer into system memory */
   out_buffer = NULL;
-  ret = klass->alloc_buffer (encode,
-      GST_VAAPI_CODED_BUFFER_PROXY_BUFFER (codedbuf_proxy), &out_buffer);
+  ret = klass->alloc_buffer (encode, codedbuf_proxy, &out_buffer);
   gst_vaapi_coded_buffer_proxy_replace (&codedbuf_proxy, NULL);
   if (ret != GST_FLOW_OK)
     goto error_allocate_buffer;
@@ -332,16 +352,76 @@ static void
 gst_vaapiencode_buffer_loop (GstVaapiEncode * encode)
 {
   GstFlowReturn ret;
-  const gint64 timeout = 50000; /* microseconds */
 
-  ret = gst_vaapiencode_push_frame (encode, timeout);
-  if (ret == GST_FLOW_OK || ret == GST_VAAPI_ENCODE_FLOW_TIMEOUT)
+  /* Block until the next coded buffer is ready, or until the encoder
+     is set to flushing (see unblock_output_task()) */
+  ret = gst_vaapiencode_push_frame (encode, G_MAXUINT64);
+  if (ret == GST_FLOW_OK)
     return;
 
-  GST_LOG_OBJECT (encode, "pausing task, reason %s", gst_flow_get_name (ret));
+  if (ret == GST_VAAPI_ENCODE_FLOW_TIMEOUT)
+    GST_LOG_OBJECT (encode, "pausing task, reason flushing");
+  else
+    GST_LOG_OBJECT (encode, "pausing task, reason %s",
+        gst_flow_get_name (ret));
   gst_pad_pause_task (GST_VAAPI_PLUGIN_BASE_SRC_PAD (encode));
 }
 
+static gboolean
+start_output_task (GstVaapiEncode * encode)
+{
+  if (encode->encoder)
+    gst_vaapi_encoder_set_flushing (encode->encoder, FALSE);
+  return gst_pad_start_task (GST_VAAPI_PLUGIN_BASE_SRC_PAD (encode),
+      (GstTaskFunction) gst_vaapiencode_buffer_loop, encode, NULL);
+}
+
+/* Wakes up the output task, if it is waiting for a coded buffer, so
+   that it can be paused or stopped */
+static void
+unblock_output_task (GstVaapiEncode * encode)
+{
+  if (encode->encoder)
+    gst_vaapi_encoder_set_flushing (encode->encoder, TRUE);
+}
+
+static void
+log_encoder_stats (GstVaapiEncode * encode)
+{
+  GstVaapiEncoderStats stats;
+
+  if (!encode->encoder)
+    return;
+
+  gst_vaapi_encoder_get_stats (encode->encoder, &stats);
+  GST_INFO_OBJECT (encode, "encoded %" G_GUINT64_FORMAT " frames, latency "
+      "min %" GST_TIME_FORMAT ", max %" GST_TIME_FORMAT ", avg %"
+      GST_TIME_FORMAT, stats.num_frames, GST_TIME_ARGS (stats.latency_min),
+      GST_TIME_ARGS (stats.latency_max), GST_TIME_ARGS (stats.latency_avg));
+}
+
+/* Submits the frames still held by the encoder, e.g. in the lookahead
+   window, and pushes all the resulting coded buffers downstream. The
+   output task is stopped on return. The stream lock is released while
+   flushing, since submitting frames may wait for the output task to
+   retrieve coded buffers, and that task takes the stream lock */
+static GstFlowReturn
+gst_vaapiencode_drain (GstVaapiEncode * encode)
+{
+  GstVaapiEncoderStatus status;
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  GST_VIDEO_ENCODER_STREAM_UNLOCK (encode);
+  status = gst_vaapi_encoder_flush (encode->encoder);
+  unblock_output_task (encode);
+  gst_pad_stop_task (GST_VAAPI_PLUGIN_BASE_SRC_PAD (encode));
+  GST_VIDEO_ENCODER_STREAM_LOCK (encode);
+
+  while (status == GST_VAAPI_ENCODER_STATUS_SUCCESS && ret == GST_FLOW_OK)
+    ret = gst_vaapiencode_push_frame (encode, 0);
+  return ret;
+}
+
 static GstCaps *
 gst_vaapiencode_get_caps (GstVideoEncoder * venc, GstCaps * filter)
 {
@@ -409,6 +489,10 @@ ensure_encoder (GstVaapiEncode * encode)
   if (!encode->encoder)
     return FALSE;
 
+  gst_vaapi_encoder_set_completion_polling (encode->encoder,
+      encode->completion_polling);
+  gst_vaapi_encoder_set_owner (encode->encoder, GST_OBJECT_NAME (encode));
+
   if (prop_values) {
     for (i = 0; i < prop_values->len; i++) {
       PropValue *const prop_value = g_ptr_array_index (prop_values, i);
@@ -479,6 +563,14 @@ gst_vaapiencode_set_format (GstVideoEncoder * venc, GstVideoCodecState * state)
 
   g_return_val_if_fail (state->caps != NULL, FALSE);
 
+  /* Renegotiation: the encoder refuses a new codec state while it still
+     holds frames, so get them out with the previous configuration */
+  if (encode->encoder && encode->input_state) {
+    GstFlowReturn ret = gst_vaapiencode_drain (encode);
+    if (ret != GST_FLOW_OK && ret != GST_VAAPI_ENCODE_FLOW_TIMEOUT)
+      return FALSE;
+  }
+
   if (!set_codec_state (encode, state))
     return FALSE;
 
@@ -491,8 +583,7 @@ gst_vaapiencode_set_format (GstVideoEncoder * venc, GstVideoCodecState * state)
   encode->input_state = gst_video_codec_state_ref (state);
   encode->input_state_changed = TRUE;
 
-  return gst_pad_start_task (GST_VAAPI_PLUGIN_BASE_SRC_PAD (encode),
-      (GstTaskFunction) gst_vaapiencode_buffer_loop, encode, NULL);
+  return start_output_task (encode);
 }
 
 static GstFlowReturn
@@ -569,8 +660,7 @@ static GstFlowReturn
 gst_vaapiencode_finish (GstVideoEncoder * venc)
 {
   GstVaapiEncode *const encode = GST_VAAPIENCODE_CAST (venc);
-  GstVaapiEncoderStatus status;
-  GstFlowReturn ret = GST_FLOW_OK;
+  GstFlowReturn ret;
 
   /* Don't try to destroy encoder if none was created in the first place.
      Return "not-negotiated" error since this means we did not even reach
@@ -579,14 +669,9 @@ gst_vaapiencode_finish (GstVideoEncoder * venc)
   if (!encode->encoder)
     return GST_FLOW_NOT_NEGOTIATED;
 
-  status = gst_vaapi_encoder_flush (encode->encoder);
-
-  GST_VIDEO_ENCODER_STREAM_UNLOCK (encode);
-  gst_pad_stop_task (GST_VAAPI_PLUGIN_BASE_SRC_PAD (encode));
-  GST_VIDEO_ENCODER_STREAM_LOCK (encode);
+  ret = gst_vaapiencode_drain (encode);
 
-  while (status == GST_VAAPI_ENCODER_STATUS_SUCCESS && ret == GST_FLOW_OK)
-    ret = gst_vaapiencode_push_frame (encode, 0);
+  log_encoder_stats (encode);
 
   if (ret == GST_VAAPI_ENCODE_FLOW_TIMEOUT)
     ret = GST_FLOW_OK;
@@ -600,6 +685,7 @@ gst_vaapiencode_change_state (GstElement * element, GstStateChange transition)
 
   switch (transition) {
     case GST_STATE_CHANGE_PAUSED_TO_READY:
+      unblock_output_task (encode);
       gst_pad_stop_task (GST_VAAPI_PLUGIN_BASE_SRC_PAD (encode));
       break;
     default:
@@ -634,11 +720,11 @@ gst_vaapiencode_sink_event (GstVideoEncoder * venc, GstEvent * event)
 
   switch (GST_EVENT_TYPE (event)) {
     case GST_EVENT_FLUSH_START:
+      unblock_output_task (encode);
       gst_pad_pause_task (srcpad);
       break;
     case GST_EVENT_FLUSH_STOP:
-      ret = gst_pad_start_task (srcpad,
-          (GstTaskFunction) gst_vaapiencode_buffer_loop, encode, NULL);
+      ret = start_output_task (encode);
       break;
     default:
       break;
@@ -688,6 +774,47 @@ gst_vaapiencode_finalize (GObject * object)
   G_OBJECT_CLASS (gst_vaapiencode_parent_class)->finalize (object);
 }
 
+static void
+gst_vaapiencode_set_property (GObject * object,
+    guint prop_id, const GValue * value, GParamSpec * pspec)
+{
+  GstVaapiEncode *const encode = GST_VAAPIENCODE_CAST (object);
+
+  switch (prop_id) {
+    case PROP_ZERO_COPY_OUTPUT:
+      encode->zero_copy_output = g_value_get_boolean (value);
+      break;
+    case PROP_COMPLETION_POLLING:
+      encode->completion_polling = g_value_get_boolean (value);
+      if (encode->encoder)
+        gst_vaapi_encoder_set_completion_polling (encode->encoder,
+            encode->completion_polling);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_vaapiencode_get_property (GObject * object,
+    guint prop_id, GValue * value, GParamSpec * pspec)
+{
+  GstVaapiEncode *const encode = GST_VAAPIENCODE_CAST (object);
+
+  switch (prop_id) {
+    case PROP_ZERO_COPY_OUTPUT:
+      g_value_set_boolean (value, encode->zero_copy_output);
+      break;
+    case PROP_COMPLETION_POLLING:
+      g_value_set_boolean (value, encode->completion_polling);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
 static void
 gst_vaapiencode_init (GstVaapiEncode * encode)
 {
@@ -695,6 +822,9 @@ gst_vaapiencode_init (GstVaapiEncode * encode)
 
   gst_vaapi_plugin_base_init (GST_VAAPI_PLUGIN_BASE (encode), GST_CAT_DEFAULT);
   gst_pad_use_fixed_caps (plugin->srcpad);
+
+  encode->zero_copy_output = DEFAULT_ZERO_COPY_OUTPUT;
+  encode->completion_polling = DEFAULT_COMPLETION_POLLING;
 }
 
 static void
@@ -710,6 +840,8 @@ gst_vaapiencode_class_init (GstVaapiEncodeClass * klass)
   gst_vaapi_plugin_base_class_init (GST_VAAPI_PLUGIN_BASE_CLASS (klass));
 
   object_class->finalize = gst_vaapiencode_finalize;
+  object_class->set_property = gst_vaapiencode_set_property;
+  object_class->get_property = gst_vaapiencode_get_property;
 
   element_class->set_context = gst_vaapi_base_set_context;
   element_class->change_state =
@@ -733,6 +865,38 @@ gst_vaapiencode_class_init (GstVaapiEncodeClass * klass)
 
   venc_class->src_query = GST_DEBUG_FUNCPTR (gst_vaapiencode_src_query);
   venc_class->sink_query = GST_DEBUG_FUNCPTR (gst_vaapiencode_sink_query);
+
+  /**
+   * GstVaapiEncode:zero-copy-output:
+   *
+   * Push the VA coded buffer segments downstream without copying
+   * them into system memory. The VA coded buffer is only recycled
+   * once downstream releases the output buffer, so elements holding
+   * on to many buffers could stall the encoder.
+   */
+  g_object_class_install_property
+      (object_class,
+      PROP_ZERO_COPY_OUTPUT,
+      g_param_spec_boolean ("zero-copy-output",
+          "Zero-copy output",
+          "Wrap the encoded data instead of copying it",
+          DEFAULT_ZERO_COPY_OUTPUT, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstVaapiEncode:completion-polling:
+   *
+   * Poll the VA surface status to detect when an encoded picture is
+   * ready, instead of blocking in vaSyncSurface(). The display is
+   * then not locked while the hardware is busy.
+   */
+  g_object_class_install_property
+      (object_class,
+      PROP_COMPLETION_POLLING,
+      g_param_spec_boolean ("completion-polling",
+          "Completion polling",
+          "Poll for encoded pictures completion instead of blocking",
+          DEFAULT_COMPLETION_POLLING,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static inline GPtrArray *
@@ -59,6 +59,8 @@ struct _GstVaapiEncode
   gboolean need_codec_data;
   GstVideoCodecState *output_state;
   GPtrArray *prop_values;
+  gboolean zero_copy_output;
+  gboolean completion_polling;
 };
 
 struct _GstVaapiEncodeClass
@@ -77,7 +79,7 @@ struct _GstVaapiEncodeClass
   GstVaapiEncoder *   (*alloc_encoder)  (GstVaapiEncode * encode,
                                          GstVaapiDisplay * display);
   GstFlowReturn       (*alloc_buffer)   (GstVaapiEncode * encode,
-                                         GstVaapiCodedBuffer * coded_buf,
+                                         GstVaapiCodedBufferProxy * coded_buf,
                                          GstBuffer ** outbuf_ptr);
 };
 
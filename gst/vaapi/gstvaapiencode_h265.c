@@ -349,7 +349,7 @@ error:
 
 static GstFlowReturn
 gst_vaapiencode_h265_alloc_buffer (GstVaapiEncode * base_encode,
-    GstVaapiCodedBuffer * coded_buf, GstBuffer ** out_buffer_ptr)
+    GstVaapiCodedBufferProxy * coded_buf, GstBuffer ** out_buffer_ptr)
 {
   GstVaapiEncodeH265 *const encode = GST_VAAPIENCODE_H265_CAST (base_encode);
   GstVaapiEncoderH265 *const encoder =
@@ -24,6 +24,7 @@
 
 #include "gstcompat.h"
 #include <gst/vaapi/gstvaapisurface_drm.h>
+#include <gst/vaapi/gstvaapiutils_copy.h>
 #include <gst/base/gstpushsrc.h>
 #include "gstvaapipluginbase.h"
 #include "gstvaapipluginutil.h"
@@ -522,6 +523,9 @@ ensure_sinkpad_allocator (GstVaapiPluginBase * plugin, GstCaps * caps,
   }
   plugin->sinkpad_allocator =
       gst_vaapi_video_allocator_new (plugin->display, &vinfo, 0, usage_flag);
+  if (plugin->sinkpad_allocator)
+    gst_vaapi_video_allocator_set_owner (plugin->sinkpad_allocator,
+        GST_OBJECT_NAME (plugin));
 
 bail:
   if (!plugin->sinkpad_allocator)
@@ -576,6 +580,8 @@ ensure_srcpad_allocator (GstVaapiPluginBase * plugin, GstVideoInfo * vinfo,
       gst_vaapi_video_allocator_new (plugin->display, vinfo, 0, usage_flag);
   if (!plugin->srcpad_allocator)
     goto error_create_allocator;
+  gst_vaapi_video_allocator_set_owner (plugin->srcpad_allocator,
+      GST_OBJECT_NAME (plugin));
 
   if (different_caps) {
     guint i, flags = 0;
@@ -1007,7 +1013,9 @@ gst_vaapi_plugin_base_get_input_buffer (GstVaapiPluginBase * plugin,
           GST_MAP_WRITE))
     goto error_map_dst_buffer;
 
-  success = gst_video_frame_copy (&out_frame, &src_frame);
+  /* The pool buffers are VA images or surfaces mapped for upload */
+  success = gst_vaapi_copy_video_frame (&out_frame, &src_frame,
+      GST_VAAPI_COPY_FLAG_DST_UNCACHED);
   gst_video_frame_unmap (&out_frame);
   gst_video_frame_unmap (&src_frame);
   if (!success)
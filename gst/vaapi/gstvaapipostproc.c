@@ -1252,6 +1252,7 @@ ensure_srcpad_buffer_pool (GstVaapiPostproc * postproc, GstCaps * caps)
       &postproc->filter_pool_info, 0);
   if (!pool)
     return FALSE;
+  gst_vaapi_video_pool_set_owner (pool, GST_OBJECT_NAME (postproc));
 
   gst_vaapi_video_pool_replace (&postproc->filter_pool, pool);
   gst_vaapi_video_pool_unref (pool);
@@ -412,3 +412,29 @@ gst_vaapi_video_buffer_pool_new (GstVaapiDisplay * display)
   return g_object_new (GST_VAAPI_TYPE_VIDEO_BUFFER_POOL,
       "display", display, NULL);
 }
+
+/**
+ * gst_vaapi_video_buffer_pool_get_surface_pool:
+ * @pool: a #GstVaapiVideoBufferPool
+ *
+ * Retrieves the pool of VA surfaces the memory of the buffers in @pool
+ * is allocated from, e.g. for a decoder to decode into the same
+ * surfaces. This is only possible once @pool is configured, and if it
+ * does not allocate DMA-BUF memory.
+ *
+ * Return value: (transfer none): the #GstVaapiVideoPool of surfaces,
+ *   or %NULL if there is none
+ */
+GstVaapiVideoPool *
+gst_vaapi_video_buffer_pool_get_surface_pool (GstBufferPool * pool)
+{
+  GstVaapiVideoBufferPoolPrivate *priv;
+
+  g_return_val_if_fail (GST_VAAPI_IS_VIDEO_BUFFER_POOL (pool), NULL);
+
+  priv = GST_VAAPI_VIDEO_BUFFER_POOL (pool)->priv;
+  if (!priv->allocator || priv->use_dmabuf_memory ||
+      !GST_VAAPI_IS_VIDEO_ALLOCATOR (priv->allocator))
+    return NULL;
+  return GST_VAAPI_VIDEO_ALLOCATOR_CAST (priv->allocator)->surface_pool;
+}
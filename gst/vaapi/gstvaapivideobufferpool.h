@@ -114,6 +114,10 @@ G_GNUC_INTERNAL
 GstBufferPool *
 gst_vaapi_video_buffer_pool_new (GstVaapiDisplay * display) G_GNUC_CONST;
 
+G_GNUC_INTERNAL
+GstVaapiVideoPool *
+gst_vaapi_video_buffer_pool_get_surface_pool (GstBufferPool * pool);
+
 G_END_DECLS
 
 #endif /* GST_VAAPI_VIDEO_BUFFER_POOL_H */
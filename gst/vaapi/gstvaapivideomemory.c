@@ -25,6 +25,7 @@
 #include <gst/vaapi/gstvaapisurface_drm.h>
 #include <gst/vaapi/gstvaapisurfacepool.h>
 #include <gst/vaapi/gstvaapiimagepool.h>
+#include <gst/vaapi/gstvaapiutils_convert.h>
 #include "gstvaapivideomemory.h"
 #include "gstvaapipluginutil.h"
 
@@ -32,6 +33,9 @@ GST_DEBUG_CATEGORY_STATIC (CAT_PERFORMANCE);
 GST_DEBUG_CATEGORY_STATIC (gst_debug_vaapivideomemory);
 #define GST_CAT_DEFAULT gst_debug_vaapivideomemory
 
+/* Maximal number of pending image downloads per allocator */
+#define MAX_PREFETCH_IMAGES 4
+
 #ifndef GST_VIDEO_INFO_FORMAT_STRING
 #define GST_VIDEO_INFO_FORMAT_STRING(vip) \
   gst_video_format_to_string (GST_VIDEO_INFO_FORMAT (vip))
@@ -126,11 +130,92 @@ ensure_image (GstVaapiVideoMemory * mem)
     mem->image = gst_vaapi_video_pool_get_object (allocator->image_pool);
     if (!mem->image)
       return FALSE;
+    GST_VAAPI_VIDEO_MEMORY_FLAG_SET (mem,
+        GST_VAAPI_VIDEO_MEMORY_FLAG_IMAGE_IS_POOLED);
   }
   gst_vaapi_video_meta_set_image (mem->meta, mem->image);
   return TRUE;
 }
 
+/* Returns the image the surface pixels are stored in, if they can be
+   converted from or to the requested format in software */
+static GstVaapiImage *
+derive_convert_image (GstVaapiVideoMemory * mem, gboolean download)
+{
+  GstVaapiVideoAllocator *const allocator =
+      GST_VAAPI_VIDEO_ALLOCATOR_CAST (GST_MEMORY_CAST (mem)->allocator);
+  const GstVideoFormat surface_format =
+      GST_VIDEO_INFO_FORMAT (&allocator->surface_info);
+  const GstVideoFormat image_format = GST_VIDEO_INFO_FORMAT (mem->image_info);
+
+  if (download && !gst_vaapi_convert_is_supported (image_format,
+          surface_format))
+    return NULL;
+  if (!download && !gst_vaapi_convert_is_supported (surface_format,
+          image_format))
+    return NULL;
+  return gst_vaapi_surface_derive_image (mem->surface);
+}
+
+static gboolean
+get_image (GstVaapiVideoMemory * mem)
+{
+  GstVaapiVideoAllocator *const allocator =
+      GST_VAAPI_VIDEO_ALLOCATOR_CAST (GST_MEMORY_CAST (mem)->allocator);
+  GstVaapiImage *image;
+  gboolean success;
+
+  if (!allocator->convert_on_download) {
+    if (gst_vaapi_surface_get_image (mem->surface, mem->image))
+      return TRUE;
+  }
+
+  /* The driver cannot convert the surface: convert the pixels straight
+     from the surface memory while copying them */
+  image = derive_convert_image (mem, TRUE);
+  if (!image)
+    return FALSE;
+  success = gst_vaapi_surface_sync (mem->surface) &&
+      gst_vaapi_image_copy (mem->image, image);
+  gst_vaapi_object_unref (image);
+
+  if (success && !allocator->convert_on_download) {
+    _init_performance_debug ();
+    GST_CAT_INFO (CAT_PERFORMANCE, "converting images to %s in software",
+        GST_VIDEO_INFO_FORMAT_STRING (mem->image_info));
+    allocator->convert_on_download = TRUE;
+  }
+  return success;
+}
+
+static gboolean
+put_image (GstVaapiVideoMemory * mem)
+{
+  GstVaapiVideoAllocator *const allocator =
+      GST_VAAPI_VIDEO_ALLOCATOR_CAST (GST_MEMORY_CAST (mem)->allocator);
+  GstVaapiImage *image;
+  gboolean success;
+
+  if (!allocator->convert_on_upload) {
+    if (gst_vaapi_surface_put_image (mem->surface, mem->image))
+      return TRUE;
+  }
+
+  image = derive_convert_image (mem, FALSE);
+  if (!image)
+    return FALSE;
+  success = gst_vaapi_image_copy (image, mem->image);
+  gst_vaapi_object_unref (image);
+
+  if (success && !allocator->convert_on_upload) {
+    _init_performance_debug ();
+    GST_CAT_INFO (CAT_PERFORMANCE, "converting images from %s in software",
+        GST_VIDEO_INFO_FORMAT_STRING (mem->image_info));
+    allocator->convert_on_upload = TRUE;
+  }
+  return success;
+}
+
 static gboolean
 ensure_image_is_current (GstVaapiVideoMemory * mem)
 {
@@ -139,7 +224,7 @@ ensure_image_is_current (GstVaapiVideoMemory * mem)
 
   if (!GST_VAAPI_VIDEO_MEMORY_FLAG_IS_SET (mem,
           GST_VAAPI_VIDEO_MEMORY_FLAG_IMAGE_IS_CURRENT)) {
-    if (!gst_vaapi_surface_get_image (mem->surface, mem->image))
+    if (!get_image (mem))
       return FALSE;
 
     GST_VAAPI_VIDEO_MEMORY_FLAG_SET (mem,
@@ -213,7 +298,7 @@ ensure_surface_is_current (GstVaapiVideoMemory * mem)
           GST_VAAPI_VIDEO_MEMORY_FLAG_SURFACE_IS_CURRENT)) {
     if (GST_VAAPI_VIDEO_MEMORY_FLAG_IS_SET (mem,
             GST_VAAPI_VIDEO_MEMORY_FLAG_IMAGE_IS_CURRENT)
-        && !gst_vaapi_surface_put_image (mem->surface, mem->image))
+        && !put_image (mem))
       return FALSE;
 
     GST_VAAPI_VIDEO_MEMORY_FLAG_SET (mem,
@@ -404,12 +489,17 @@ gst_vaapi_video_memory_reset_image (GstVaapiVideoMemory * mem)
   GstVaapiVideoAllocator *const allocator =
       GST_VAAPI_VIDEO_ALLOCATOR_CAST (GST_MEMORY_CAST (mem)->allocator);
 
-  if (!use_native_formats (mem->usage_flag))
-    gst_vaapi_object_replace (&mem->image, NULL);
-  else if (mem->image) {
+  /* Pooled images are given back, so that the pool releases the slot
+     and the budget they were charged for, whatever the usage flags
+     became since they were acquired */
+  if (GST_VAAPI_VIDEO_MEMORY_FLAG_IS_SET (mem,
+          GST_VAAPI_VIDEO_MEMORY_FLAG_IMAGE_IS_POOLED)) {
     gst_vaapi_video_pool_put_object (allocator->image_pool, mem->image);
     mem->image = NULL;
-  }
+    GST_VAAPI_VIDEO_MEMORY_FLAG_UNSET (mem,
+        GST_VAAPI_VIDEO_MEMORY_FLAG_IMAGE_IS_POOLED);
+  } else
+    gst_vaapi_object_replace (&mem->image, NULL);
 
   /* Don't synchronize to surface, this shall have happened during
    * unmaps */
@@ -420,6 +510,8 @@ gst_vaapi_video_memory_reset_image (GstVaapiVideoMemory * mem)
 void
 gst_vaapi_video_memory_reset_surface (GstVaapiVideoMemory * mem)
 {
+  /* Serialize with pending downloads */
+  g_mutex_lock (&mem->lock);
   mem->surface = NULL;
   gst_vaapi_video_memory_reset_image (mem);
   gst_vaapi_surface_proxy_replace (&mem->proxy, NULL);
@@ -428,6 +520,7 @@ gst_vaapi_video_memory_reset_surface (GstVaapiVideoMemory * mem)
 
   GST_VAAPI_VIDEO_MEMORY_FLAG_UNSET (mem,
       GST_VAAPI_VIDEO_MEMORY_FLAG_SURFACE_IS_CURRENT);
+  g_mutex_unlock (&mem->lock);
 }
 
 gboolean
@@ -438,6 +531,105 @@ gst_vaapi_video_memory_sync (GstVaapiVideoMemory * mem)
   return ensure_surface_is_current (mem);
 }
 
+/* Downloads the surface contents, while the memory is not mapped */
+static void
+prefetch_image (GstVaapiVideoMemory * mem)
+{
+  /* The buffer was already released to the pool */
+  if (!gst_vaapi_video_meta_get_surface_proxy (mem->meta))
+    return;
+  if (!ensure_surface (mem))
+    return;
+
+  /* Derived images are mapped on demand, so only wait for the
+     surface to be decoded. Otherwise, get the image now */
+  if (!use_native_formats (mem->usage_flag)) {
+    gst_vaapi_surface_sync (mem->surface);
+    return;
+  }
+  if (!ensure_image (mem) || !ensure_image_is_current (mem))
+    GST_WARNING ("failed to prefetch image");
+}
+
+static void
+prefetch_image_thread (GstVaapiVideoMemory * mem, gpointer user_data)
+{
+  GstVaapiVideoAllocator *const allocator =
+      GST_VAAPI_VIDEO_ALLOCATOR_CAST (GST_MEMORY_CAST (mem)->allocator);
+
+  g_mutex_lock (&mem->lock);
+  if (mem->map_count == 0)
+    prefetch_image (mem);
+  g_mutex_unlock (&mem->lock);
+
+  g_atomic_int_add (&allocator->prefetch_count, -1);
+  gst_memory_unref (GST_MEMORY_CAST (mem));
+}
+
+static gpointer
+create_prefetch_pool (gpointer data)
+{
+  /* A single thread keeps the downloads in presentation order */
+  return g_thread_pool_new ((GFunc) prefetch_image_thread, NULL, 1, FALSE,
+      NULL);
+}
+
+static GThreadPool *
+get_prefetch_pool (void)
+{
+  static GOnce once = G_ONCE_INIT;
+
+  g_once (&once, create_prefetch_pool, NULL);
+  return once.retval;
+}
+
+/**
+ * gst_vaapi_video_memory_prefetch_image:
+ * @mem: a #GstVaapiVideoMemory
+ *
+ * Starts downloading the VA surface contents into the VA image, in
+ * the background, so that the next read-only map of @mem usually
+ * finds the image up-to-date. This is meant for buffers that are
+ * going to be mapped to system memory downstream. Only a few
+ * downloads can be pending per allocator: beyond that, the image is
+ * retrieved on map, as usual.
+ *
+ * Return value: %TRUE if the download was queued
+ */
+gboolean
+gst_vaapi_video_memory_prefetch_image (GstVaapiVideoMemory * mem)
+{
+  GstVaapiVideoAllocator *allocator;
+  GThreadPool *pool;
+
+  g_return_val_if_fail (mem, FALSE);
+  g_return_val_if_fail (mem->meta, FALSE);
+
+  allocator =
+      GST_VAAPI_VIDEO_ALLOCATOR_CAST (GST_MEMORY_CAST (mem)->allocator);
+
+  pool = get_prefetch_pool ();
+  if (!pool)
+    return FALSE;
+
+  if (g_atomic_int_add (&allocator->prefetch_count, 1) >=
+      MAX_PREFETCH_IMAGES) {
+    g_atomic_int_add (&allocator->prefetch_count, -1);
+    _init_performance_debug ();
+    GST_CAT_DEBUG (CAT_PERFORMANCE, "too many pending image downloads");
+    return FALSE;
+  }
+
+  /* The thread holds a reference until the download completes */
+  gst_memory_ref (GST_MEMORY_CAST (mem));
+  if (!g_thread_pool_push (pool, mem, NULL)) {
+    g_atomic_int_add (&allocator->prefetch_count, -1);
+    gst_memory_unref (GST_MEMORY_CAST (mem));
+    return FALSE;
+  }
+  return TRUE;
+}
+
 static gpointer
 gst_vaapi_video_memory_map (GstMemory * base_mem, gsize maxsize, guint flags)
 {
@@ -641,6 +833,7 @@ gst_vaapi_video_allocator_finalize (GObject * object)
 
   gst_vaapi_video_pool_replace (&allocator->surface_pool, NULL);
   gst_vaapi_video_pool_replace (&allocator->image_pool, NULL);
+  g_free (allocator->owner);
 
   G_OBJECT_CLASS (gst_vaapi_video_allocator_parent_class)->finalize (object);
 }
@@ -787,6 +980,10 @@ allocator_configure_image_info (GstVaapiDisplay * display,
   GstVaapiImage *image = NULL;
   const GstVideoInfo *vinfo;
 
+  /* Try the driver conversions again for the new format */
+  allocator->convert_on_download = FALSE;
+  allocator->convert_on_upload = FALSE;
+
   if (!use_native_formats (allocator->usage_flag)) {
     allocator->image_info = allocator->surface_info;
     return;
@@ -857,6 +1054,33 @@ error_create_image_pool:
   }
 }
 
+/**
+ * gst_vaapi_video_allocator_set_owner:
+ * @allocator: a #GstAllocator created with gst_vaapi_video_allocator_new()
+ * @owner: (allow-none): the name of the owner, e.g. an element name
+ *
+ * Labels the surfaces and images allocated by @allocator with @owner,
+ * so that their memory can be monitored through
+ * gst_vaapi_display_get_surface_usage().
+ */
+void
+gst_vaapi_video_allocator_set_owner (GstAllocator * allocator,
+    const gchar * owner)
+{
+  GstVaapiVideoAllocator *vaapi_allocator;
+
+  g_return_if_fail (GST_VAAPI_IS_VIDEO_ALLOCATOR (allocator));
+
+  vaapi_allocator = GST_VAAPI_VIDEO_ALLOCATOR_CAST (allocator);
+
+  GST_OBJECT_LOCK (allocator);
+  g_free (vaapi_allocator->owner);
+  vaapi_allocator->owner = g_strdup (owner);
+  gst_vaapi_video_pool_set_owner (vaapi_allocator->surface_pool, owner);
+  gst_vaapi_video_pool_set_owner (vaapi_allocator->image_pool, owner);
+  GST_OBJECT_UNLOCK (allocator);
+}
+
 /* ------------------------------------------------------------------------ */
 /* --- GstVaapiDmaBufMemory                                             --- */
 /* ------------------------------------------------------------------------ */
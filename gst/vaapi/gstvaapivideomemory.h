@@ -81,6 +81,8 @@ typedef enum
  *   #GstVaapiSurface has the up-to-date video frame contents.
  * @GST_VAAPI_VIDEO_MEMORY_FLAG_IMAGE_IS_CURRENT: The embedded
  *   #GstVaapiImage has the up-to-date video frame contents.
+ * @GST_VAAPI_VIDEO_MEMORY_FLAG_IMAGE_IS_POOLED: The embedded
+ *   #GstVaapiImage was acquired from the allocator image pool.
  *
  * The set of extended #GstMemory flags.
  */
@@ -88,6 +90,7 @@ typedef enum
 {
   GST_VAAPI_VIDEO_MEMORY_FLAG_SURFACE_IS_CURRENT = GST_MEMORY_FLAG_LAST << 0,
   GST_VAAPI_VIDEO_MEMORY_FLAG_IMAGE_IS_CURRENT = GST_MEMORY_FLAG_LAST << 1,
+  GST_VAAPI_VIDEO_MEMORY_FLAG_IMAGE_IS_POOLED = GST_MEMORY_FLAG_LAST << 2,
 } GstVaapiVideoMemoryFlags;
 
 /**
@@ -152,6 +155,10 @@ G_GNUC_INTERNAL
 gboolean
 gst_vaapi_video_memory_sync (GstVaapiVideoMemory * mem);
 
+G_GNUC_INTERNAL
+gboolean
+gst_vaapi_video_memory_prefetch_image (GstVaapiVideoMemory * mem);
+
 /* ------------------------------------------------------------------------ */
 /* --- GstVaapiVideoAllocator                                           --- */
 /* ------------------------------------------------------------------------ */
@@ -185,6 +192,10 @@ struct _GstVaapiVideoAllocator
   GstVideoInfo image_info;
   GstVaapiVideoPool *image_pool;
   GstVaapiImageUsageFlags usage_flag;
+  gint prefetch_count;
+  gboolean convert_on_download;
+  gboolean convert_on_upload;
+  gchar *owner;
 };
 
 /**
@@ -207,6 +218,11 @@ gst_vaapi_video_allocator_new (GstVaapiDisplay * display,
     const GstVideoInfo * vip, guint surface_alloc_flags,
     GstVaapiImageUsageFlags req_usage_flag);
 
+G_GNUC_INTERNAL
+void
+gst_vaapi_video_allocator_set_owner (GstAllocator * allocator,
+    const gchar * owner);
+
 /* ------------------------------------------------------------------------ */
 /* --- GstVaapiDmaBufMemory                                             --- */
 /* ------------------------------------------------------------------------ */
@@ -0,0 +1,629 @@
+/*
+ *  bench-codecs.c - Hardware-free benchmark of the decoder/encoder cores
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation; either version 2.1
+ *  of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free
+ *  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Measures frames per second, heap allocations per frame and VA
+ * driver calls per frame for the libgstvaapi decoders (on the canned
+ * bitstreams from test-*.c) and encoders (on y4m inputs, or synthetic
+ * frames). By default, the mock VA driver (mock-drv-video.c) is
+ * loaded so that only the CPU side of the codecs (parsing, DPB
+ * management, reference lists, packed headers) is measured. Use
+ * --hardware to run against the real VA driver instead.
+ */
+
+#include "gst/vaapi/sysdeps.h"
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <va/va_drm.h>
+#include <gst/vaapi/gstvaapisurfacepool.h>
+#include <gst/vaapi/gstvaapisurfaceproxy.h>
+#if USE_ENCODERS
+# include <gst/vaapi/gstvaapiencoder_h264.h>
+# include <gst/vaapi/gstvaapiencoder_mpeg2.h>
+#endif
+#if USE_JPEG_ENCODER
+# include <gst/vaapi/gstvaapiencoder_jpeg.h>
+#endif
+#if USE_VP8_ENCODER
+# include <gst/vaapi/gstvaapiencoder_vp8.h>
+#endif
+#if USE_H265_ENCODER
+# include <gst/vaapi/gstvaapiencoder_h265.h>
+#endif
+#if USE_VP9_ENCODER
+# include <gst/vaapi/gstvaapiencoder_vp9.h>
+#endif
+#include "decoder.h"
+#include "output.h"
+#include "mock-drv-video.h"
+#include "y4mreader.h"
+
+static gboolean g_use_hardware;
+static gint g_iterations = 100;
+static gint g_num_frames = 300;
+static gint g_width = 1280;
+static gint g_height = 720;
+static gchar **g_input_files;
+
+static GOptionEntry g_options[] = {
+  {"hardware", 0, 0, G_OPTION_ARG_NONE, &g_use_hardware,
+      "use the real VA driver instead of the mock driver", NULL},
+  {"iterations", 'n', 0, G_OPTION_ARG_INT, &g_iterations,
+      "number of times each canned bitstream is decoded", NULL},
+  {"frames", 0, 0, G_OPTION_ARG_INT, &g_num_frames,
+      "number of frames to encode per codec and input", NULL},
+  {"width", 0, 0, G_OPTION_ARG_INT, &g_width,
+      "width of synthetic encoder input", NULL},
+  {"height", 0, 0, G_OPTION_ARG_INT, &g_height,
+      "height of synthetic encoder input", NULL},
+  {G_OPTION_REMAINING, ' ', 0, G_OPTION_ARG_FILENAME_ARRAY, &g_input_files,
+      "y4m input files for the encoders", NULL},
+  {NULL,}
+};
+
+/* ------------------------------------------------------------------------ */
+/* --- Allocation counters                                              --- */
+/* ------------------------------------------------------------------------ */
+
+static gint g_num_allocs;
+
+#ifdef __GLIBC__
+/* Interpose the glibc allocator so that every heap allocation made by
+   libgstvaapi, GLib and GStreamer is accounted for */
+extern void *__libc_malloc (size_t size);
+extern void *__libc_calloc (size_t nmemb, size_t size);
+extern void *__libc_realloc (void *ptr, size_t size);
+extern void *__libc_memalign (size_t alignment, size_t size);
+extern void *__libc_valloc (size_t size);
+
+void *
+malloc (size_t size)
+{
+  g_atomic_int_inc (&g_num_allocs);
+  return __libc_malloc (size);
+}
+
+void *
+calloc (size_t nmemb, size_t size)
+{
+  g_atomic_int_inc (&g_num_allocs);
+  return __libc_calloc (nmemb, size);
+}
+
+void *
+realloc (void *ptr, size_t size)
+{
+  if (!ptr)
+    g_atomic_int_inc (&g_num_allocs);
+  return __libc_realloc (ptr, size);
+}
+
+/* GLib may hand out aligned blocks (g_aligned_alloc(), GstMemory with
+   an alignment), so the aligned entry points are counted as well */
+void *
+memalign (size_t alignment, size_t size)
+{
+  g_atomic_int_inc (&g_num_allocs);
+  return __libc_memalign (alignment, size);
+}
+
+void *
+aligned_alloc (size_t alignment, size_t size)
+{
+  g_atomic_int_inc (&g_num_allocs);
+  return __libc_memalign (alignment, size);
+}
+
+int
+posix_memalign (void **memptr, size_t alignment, size_t size)
+{
+  void *ptr;
+
+  if (alignment % sizeof (void *) != 0
+      || (alignment & (alignment - 1)) != 0 || alignment == 0)
+    return EINVAL;
+
+  g_atomic_int_inc (&g_num_allocs);
+  ptr = __libc_memalign (alignment, size);
+  if (!ptr)
+    return ENOMEM;
+  *memptr = ptr;
+  return 0;
+}
+
+void *
+valloc (size_t size)
+{
+  g_atomic_int_inc (&g_num_allocs);
+  return __libc_valloc (size);
+}
+#endif
+
+/* ------------------------------------------------------------------------ */
+/* --- Reports                                                          --- */
+/* ------------------------------------------------------------------------ */
+
+typedef struct
+{
+  const gchar *codec_name;
+  const gchar *mode;
+  guint num_frames;
+  gint64 start_time;
+  gint64 elapsed_time;
+  gint start_allocs;
+  gint num_allocs;
+  MockVaStats va_stats;
+  gboolean has_decoder_stats;
+  GstVaapiDecoderStats decoder_stats;
+} BenchResult;
+
+static MockVaGetStatsFunc g_get_va_stats;
+
+static void
+bench_result_start (BenchResult * result, const gchar * codec_name,
+    const gchar * mode)
+{
+  memset (result, 0, sizeof (*result));
+  result->codec_name = codec_name;
+  result->mode = mode;
+  if (g_get_va_stats)
+    g_get_va_stats (NULL, TRUE);
+  result->start_allocs = g_atomic_int_get (&g_num_allocs);
+  result->start_time = g_get_monotonic_time ();
+}
+
+static void
+bench_result_stop (BenchResult * result)
+{
+  result->elapsed_time = g_get_monotonic_time () - result->start_time;
+  result->num_allocs = g_atomic_int_get (&g_num_allocs) -
+      result->start_allocs;
+  if (g_get_va_stats)
+    g_get_va_stats (&result->va_stats, FALSE);
+}
+
+static void
+print_header (void)
+{
+  g_print ("%-8s %-6s %8s %10s %13s %14s %14s %16s\n", "codec", "mode",
+      "frames", "fps", "allocs/frame", "render/frame", "buffers/frame",
+      "va-calls/frame");
+}
+
+static void
+print_result (const BenchResult * result)
+{
+  const gdouble n = MAX (result->num_frames, 1);
+  const gdouble secs = MAX (result->elapsed_time, 1) / (gdouble) G_USEC_PER_SEC;
+
+  g_print ("%-8s %-6s %8u %10.1f %13.1f", result->codec_name, result->mode,
+      result->num_frames, result->num_frames / secs, result->num_allocs / n);
+  if (g_get_va_stats)
+    g_print (" %14.1f %14.1f", result->va_stats.render_picture / n,
+        result->va_stats.create_buffer / n);
+  else
+    g_print (" %14s %14s", "-", "-");
+  if (result->has_decoder_stats)
+    g_print (" %16.1f\n", result->decoder_stats.num_va_calls / n);
+  else
+    g_print (" %16s\n", "-");
+}
+
+/* ------------------------------------------------------------------------ */
+/* --- Display                                                          --- */
+/* ------------------------------------------------------------------------ */
+
+static gint g_mock_fd = -1;
+static VADisplay g_mock_va_display;
+
+static GstVaapiDisplay *
+create_mock_display (void)
+{
+  GstVaapiDisplay *display;
+  const gchar *drivers_path;
+  gchar *driver_file;
+  void *handle;
+
+  g_setenv ("LIBVA_DRIVER_NAME", MOCK_VA_DRIVER_NAME, TRUE);
+  g_setenv ("LIBVA_DRIVERS_PATH", MOCK_DRIVER_DIR, FALSE);
+  drivers_path = g_getenv ("LIBVA_DRIVERS_PATH");
+
+  /* Any character device will do, the mock driver never touches it */
+  g_mock_fd = open ("/dev/null", O_RDWR | O_CLOEXEC);
+  if (g_mock_fd < 0)
+    return NULL;
+
+  g_mock_va_display = vaGetDisplayDRM (g_mock_fd);
+  if (!g_mock_va_display)
+    return NULL;
+
+  display = gst_vaapi_display_new_with_display (g_mock_va_display);
+  if (!display)
+    return NULL;
+
+  driver_file = g_build_filename (drivers_path, "mock_drv_video.so", NULL);
+  handle = dlopen (driver_file, RTLD_NOW | RTLD_NOLOAD);
+  g_free (driver_file);
+  if (handle) {
+    g_get_va_stats = (MockVaGetStatsFunc) dlsym (handle,
+        MOCK_VA_GET_STATS_SYMBOL);
+    dlclose (handle);
+  }
+  return display;
+}
+
+static void
+destroy_mock_display (void)
+{
+  if (g_mock_va_display) {
+    vaTerminate (g_mock_va_display);
+    g_mock_va_display = NULL;
+  }
+  if (g_mock_fd >= 0) {
+    close (g_mock_fd);
+    g_mock_fd = -1;
+  }
+}
+
+/* ------------------------------------------------------------------------ */
+/* --- Decoders                                                         --- */
+/* ------------------------------------------------------------------------ */
+
+static guint
+drain_decoder (GstVaapiDecoder * decoder)
+{
+  GstVaapiSurfaceProxy *proxy;
+  guint num_frames = 0;
+
+  while (gst_vaapi_decoder_get_surface (decoder, &proxy) ==
+      GST_VAAPI_DECODER_STATUS_SUCCESS) {
+    gst_vaapi_surface_proxy_unref (proxy);
+    num_frames++;
+  }
+  return num_frames;
+}
+
+static gboolean
+bench_decoder (GstVaapiDisplay * display, const gchar * codec_name)
+{
+  GstVaapiDecoder *decoder;
+  VideoDecodeInfo info;
+  GstBuffer *buffer;
+  BenchResult result;
+  gint i;
+
+  decoder = decoder_new (display, codec_name);
+  if (!decoder)
+    return FALSE;
+
+  decoder_get_video_info (decoder, &info);
+  buffer = gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
+      (guchar *) info.data, info.data_size, 0, info.data_size, NULL, NULL);
+
+  /* Warm up: create the VA context and surface pools */
+  gst_vaapi_decoder_put_buffer (decoder, buffer);
+  drain_decoder (decoder);
+
+  bench_result_start (&result, codec_name, "decode");
+  gst_vaapi_decoder_reset_stats (decoder);
+  for (i = 0; i < g_iterations; i++) {
+    if (!gst_vaapi_decoder_put_buffer (decoder, buffer))
+      break;
+    result.num_frames += drain_decoder (decoder);
+  }
+  gst_vaapi_decoder_put_buffer (decoder, NULL);
+  result.num_frames += drain_decoder (decoder);
+  bench_result_stop (&result);
+  gst_vaapi_decoder_get_stats (decoder, &result.decoder_stats);
+  result.has_decoder_stats = TRUE;
+  print_result (&result);
+
+  gst_buffer_unref (buffer);
+  gst_vaapi_decoder_unref (decoder);
+  return TRUE;
+}
+
+/* ------------------------------------------------------------------------ */
+/* --- Encoders                                                         --- */
+/* ------------------------------------------------------------------------ */
+
+#if USE_ENCODERS
+typedef GstVaapiEncoder *(*EncoderNewFunc) (GstVaapiDisplay * display);
+
+typedef struct
+{
+  const gchar *codec_name;
+  EncoderNewFunc new_func;
+} EncoderDefs;
+
+static const EncoderDefs g_encoder_defs[] = {
+  {"h264", gst_vaapi_encoder_h264_new},
+  {"mpeg2", gst_vaapi_encoder_mpeg2_new},
+#if USE_JPEG_ENCODER
+  {"jpeg", gst_vaapi_encoder_jpeg_new},
+#endif
+#if USE_VP8_ENCODER
+  {"vp8", gst_vaapi_encoder_vp8_new},
+#endif
+#if USE_H265_ENCODER
+  {"h265", gst_vaapi_encoder_h265_new},
+#endif
+#if USE_VP9_ENCODER
+  {"vp9", gst_vaapi_encoder_vp9_new},
+#endif
+  {NULL,}
+};
+
+/* Input frames are uploaded once, before the timed loop, and then
+   cycled through so that file I/O does not bias the results */
+#define MAX_INPUT_SURFACES 8
+
+typedef struct
+{
+  guint width;
+  guint height;
+  gint fps_n;
+  gint fps_d;
+  GstVaapiVideoPool *pool;
+  GstVaapiSurfaceProxy *proxies[MAX_INPUT_SURFACES];
+  guint num_proxies;
+} EncoderInput;
+
+static void
+encoder_input_clear (EncoderInput * input)
+{
+  guint i;
+
+  for (i = 0; i < input->num_proxies; i++)
+    gst_vaapi_surface_proxy_unref (input->proxies[i]);
+  input->num_proxies = 0;
+  gst_vaapi_video_pool_replace (&input->pool, NULL);
+}
+
+static gboolean
+encoder_input_init (EncoderInput * input, GstVaapiDisplay * display,
+    const gchar * filename)
+{
+  Y4MReader *reader = NULL;
+  GstVaapiImage *image;
+  GstVideoInfo vi;
+  guint i;
+
+  memset (input, 0, sizeof (*input));
+  if (filename) {
+    reader = y4m_reader_open (filename);
+    if (!reader)
+      return FALSE;
+    input->width = reader->width;
+    input->height = reader->height;
+    input->fps_n = reader->fps_n;
+    input->fps_d = reader->fps_d;
+  } else {
+    input->width = g_width;
+    input->height = g_height;
+    input->fps_n = 30;
+    input->fps_d = 1;
+  }
+
+  gst_video_info_set_format (&vi, GST_VIDEO_FORMAT_ENCODED, input->width,
+      input->height);
+  input->pool = gst_vaapi_surface_pool_new_full (display, &vi, 0);
+  image = gst_vaapi_image_new (display, GST_VIDEO_FORMAT_I420, input->width,
+      input->height);
+  if (!input->pool || !image)
+    goto error;
+
+  for (i = 0; i < MAX_INPUT_SURFACES; i++) {
+    GstVaapiSurfaceProxy *proxy;
+    gboolean loaded = TRUE;
+
+    if (!gst_vaapi_image_map (image))
+      break;
+    if (reader)
+      loaded = y4m_reader_load_image (reader, image);
+    gst_vaapi_image_unmap (image);
+    if (!loaded)
+      break;
+
+    proxy = gst_vaapi_surface_proxy_new_from_pool (GST_VAAPI_SURFACE_POOL
+        (input->pool));
+    if (!proxy)
+      break;
+    input->proxies[input->num_proxies++] = proxy;
+    if (!gst_vaapi_surface_put_image (gst_vaapi_surface_proxy_get_surface
+            (proxy), image))
+      break;
+  }
+  gst_vaapi_object_unref (image);
+  if (reader)
+    y4m_reader_close (reader);
+  return input->num_proxies > 0;
+
+error:
+  if (image)
+    gst_vaapi_object_unref (image);
+  if (reader)
+    y4m_reader_close (reader);
+  encoder_input_clear (input);
+  return FALSE;
+}
+
+static gboolean
+set_encoder_format (GstVaapiEncoder * encoder, const EncoderInput * input)
+{
+  GstVideoCodecState *state;
+  GstVaapiEncoderStatus status;
+
+  state = g_slice_new0 (GstVideoCodecState);
+  state->ref_count = 1;
+  gst_video_info_set_format (&state->info, GST_VIDEO_FORMAT_ENCODED,
+      input->width, input->height);
+  state->info.fps_n = input->fps_n;
+  state->info.fps_d = input->fps_d;
+
+  status = gst_vaapi_encoder_set_codec_state (encoder, state);
+  g_slice_free (GstVideoCodecState, state);
+  return status == GST_VAAPI_ENCODER_STATUS_SUCCESS;
+}
+
+static guint
+drain_encoder (GstVaapiEncoder * encoder)
+{
+  GstVaapiCodedBufferProxy *proxy;
+  GstVaapiCodedBuffer *buf;
+  GstBuffer *outbuf;
+  guint num_frames = 0;
+
+  while (gst_vaapi_encoder_get_buffer_with_timeout (encoder, &proxy, 0) ==
+      GST_VAAPI_ENCODER_STATUS_SUCCESS) {
+    /* Mirror what vaapiencode does with the coded data */
+    buf = GST_VAAPI_CODED_BUFFER_PROXY_BUFFER (proxy);
+    outbuf = gst_buffer_new_and_alloc (gst_vaapi_coded_buffer_get_size (buf));
+    gst_vaapi_coded_buffer_copy_into (outbuf, buf);
+    gst_buffer_unref (outbuf);
+    gst_vaapi_coded_buffer_proxy_unref (proxy);
+    num_frames++;
+  }
+  return num_frames;
+}
+
+static gboolean
+put_encoder_frame (GstVaapiEncoder * encoder, GstVaapiSurfaceProxy * proxy,
+    guint frame_num, const EncoderInput * input)
+{
+  GstVideoCodecFrame *frame;
+  GstVaapiEncoderStatus status;
+
+  frame = g_slice_new0 (GstVideoCodecFrame);
+  frame->ref_count = 1;
+  frame->system_frame_number = frame_num;
+  frame->duration = gst_util_uint64_scale (GST_SECOND, input->fps_d,
+      input->fps_n);
+  frame->pts = frame_num * frame->duration;
+  gst_video_codec_frame_set_user_data (frame,
+      gst_vaapi_surface_proxy_ref (proxy),
+      (GDestroyNotify) gst_vaapi_surface_proxy_unref);
+
+  status = gst_vaapi_encoder_put_frame (encoder, frame);
+  gst_video_codec_frame_unref (frame);
+  return status == GST_VAAPI_ENCODER_STATUS_SUCCESS;
+}
+
+static gboolean
+bench_encoder (GstVaapiDisplay * display, const EncoderDefs * defs,
+    const EncoderInput * input)
+{
+  GstVaapiEncoder *encoder;
+  BenchResult result;
+  gint i;
+
+  encoder = defs->new_func (display);
+  if (!encoder)
+    return FALSE;
+
+  if (!set_encoder_format (encoder, input)) {
+    gst_vaapi_encoder_unref (encoder);
+    return FALSE;
+  }
+
+  bench_result_start (&result, defs->codec_name, "encode");
+  for (i = 0; i < g_num_frames; i++) {
+    if (!put_encoder_frame (encoder, input->proxies[i % input->num_proxies],
+            i, input))
+      break;
+    result.num_frames += drain_encoder (encoder);
+  }
+  gst_vaapi_encoder_flush (encoder);
+  result.num_frames += drain_encoder (encoder);
+  bench_result_stop (&result);
+  print_result (&result);
+
+  gst_vaapi_encoder_unref (encoder);
+  return TRUE;
+}
+
+static void
+bench_encoders (GstVaapiDisplay * display, const gchar * filename)
+{
+  const EncoderDefs *defs;
+  EncoderInput input;
+
+  if (!encoder_input_init (&input, display, filename)) {
+    g_warning ("could not load encoder input %s", filename ? filename :
+        "(synthetic)");
+    return;
+  }
+
+  g_print ("# encoder input: %s (%ux%u)\n", filename ? filename :
+      "synthetic", input.width, input.height);
+  for (defs = g_encoder_defs; defs->codec_name; defs++) {
+    if (!bench_encoder (display, defs, &input))
+      g_print ("%-8s %-6s %8s\n", defs->codec_name, "encode", "n/a");
+  }
+  encoder_input_clear (&input);
+}
+#endif
+
+int
+main (int argc, char *argv[])
+{
+  static const gchar *decoders[] = {
+    "h264", "jpeg", "mpeg2", "mpeg4", "vc1", NULL
+  };
+  GstVaapiDisplay *display;
+  guint i;
+
+  /* Make GSlice allocations visible to the allocation counters */
+  g_setenv ("G_SLICE", "always-malloc", TRUE);
+
+  if (!video_output_init (&argc, argv, g_options))
+    g_error ("failed to initialize video output subsystem");
+
+  if (g_use_hardware)
+    display = video_output_create_display (NULL);
+  else
+    display = create_mock_display ();
+  if (!display)
+    g_error ("could not create VA display");
+
+  g_print ("# %s VA driver\n", g_use_hardware ? "hardware" : "mock");
+  print_header ();
+  for (i = 0; decoders[i] != NULL; i++) {
+    if (!bench_decoder (display, decoders[i]))
+      g_print ("%-8s %-6s %8s\n", decoders[i], "decode", "n/a");
+  }
+
+#if USE_ENCODERS
+  if (g_input_files) {
+    for (i = 0; g_input_files[i] != NULL; i++)
+      bench_encoders (display, g_input_files[i]);
+  } else
+    bench_encoders (display, NULL);
+#endif
+
+  gst_vaapi_display_unref (display);
+  destroy_mock_display ();
+  g_strfreev (g_input_files);
+  video_output_exit ();
+  return 0;
+}
@@ -0,0 +1,241 @@
+/*
+ *  bench-copy.c - Benchmark of the plane copy engine
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation; either version 2.1
+ *  of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free
+ *  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Measures the throughput, in GB/s, of each plane copy implementation
+ * built into libgstvaapi and supported by the CPU, for the formats
+ * GstVaapiImage transfers, along with gst_video_frame_copy(). The
+ * "download" direction hints an uncached source, as when reading back
+ * a VA image, and the "upload" direction an uncached destination.
+ *
+ * Plain system memory is used on both sides, so this does not measure
+ * the benefit of streaming loads from write-combined mappings: run
+ * against real VA images for that.
+ */
+
+#include "gst/vaapi/sysdeps.h"
+#include "gst/vaapi/gstvaapiutils_copy.h"
+#include "check.h"
+
+static gint g_iterations = 50;
+static gint g_width = 1920;
+static gint g_height = 1080;
+static gint g_threads = 0;
+
+static GOptionEntry g_options[] = {
+  {"iterations", 'n', 0, G_OPTION_ARG_INT, &g_iterations,
+      "number of times each image is copied", NULL},
+  {"width", 'w', 0, G_OPTION_ARG_INT, &g_width,
+      "width of the images", NULL},
+  {"height", 'h', 0, G_OPTION_ARG_INT, &g_height,
+      "height of the images", NULL},
+  {"threads", 't', 0, G_OPTION_ARG_INT, &g_threads,
+      "number of copy threads (0: default)", NULL},
+  {NULL,}
+};
+
+typedef struct
+{
+  const gchar *name;
+  guint flags;
+} Direction;
+
+static const Direction g_directions[] = {
+  {"download", GST_VAAPI_COPY_FLAG_SRC_UNCACHED},
+  {"upload", GST_VAAPI_COPY_FLAG_DST_UNCACHED},
+};
+
+static void
+fill_frame (GstVideoFrame * frame, guint seed)
+{
+  guint i, x, y;
+
+  for (i = 0; i < GST_VIDEO_FRAME_N_PLANES (frame); i++) {
+    guint8 *const data = GST_VIDEO_FRAME_PLANE_DATA (frame, i);
+    const guint stride = GST_VIDEO_FRAME_PLANE_STRIDE (frame, i);
+
+    for (y = 0; y < GST_VIDEO_FRAME_COMP_HEIGHT (frame, i); y++) {
+      for (x = 0; x < stride; x++)
+        data[y * stride + x] = (x * 7 + y * 13 + i + seed) & 0xff;
+    }
+  }
+}
+
+static gboolean
+check_frame (const GstVideoFrame * dst_frame, const GstVideoFrame * src_frame)
+{
+  guint i, y, size;
+
+  for (i = 0; i < GST_VIDEO_FRAME_N_PLANES (src_frame); i++) {
+    const guint8 *const dst = GST_VIDEO_FRAME_PLANE_DATA (dst_frame, i);
+    const guint8 *const src = GST_VIDEO_FRAME_PLANE_DATA (src_frame, i);
+    const guint dst_stride = GST_VIDEO_FRAME_PLANE_STRIDE (dst_frame, i);
+    const guint src_stride = GST_VIDEO_FRAME_PLANE_STRIDE (src_frame, i);
+
+    size = GST_VIDEO_FRAME_COMP_WIDTH (src_frame, i) *
+        GST_VIDEO_FRAME_COMP_PSTRIDE (src_frame, i);
+    for (y = 0; y < GST_VIDEO_FRAME_COMP_HEIGHT (src_frame, i); y++) {
+      if (memcmp (dst + y * dst_stride, src + y * src_stride, size) != 0)
+        return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+static guint
+init_planes (GstVaapiCopyPlane * planes, GstVideoFrame * dst_frame,
+    const GstVideoFrame * src_frame)
+{
+  guint i;
+
+  for (i = 0; i < GST_VIDEO_FRAME_N_PLANES (src_frame); i++) {
+    planes[i].dst = GST_VIDEO_FRAME_PLANE_DATA (dst_frame, i);
+    planes[i].dst_stride = GST_VIDEO_FRAME_PLANE_STRIDE (dst_frame, i);
+    planes[i].src = GST_VIDEO_FRAME_PLANE_DATA (src_frame, i);
+    planes[i].src_stride = GST_VIDEO_FRAME_PLANE_STRIDE (src_frame, i);
+    planes[i].width = GST_VIDEO_FRAME_COMP_WIDTH (src_frame, i) *
+        GST_VIDEO_FRAME_COMP_PSTRIDE (src_frame, i);
+    planes[i].height = GST_VIDEO_FRAME_COMP_HEIGHT (src_frame, i);
+  }
+  return i;
+}
+
+static gsize
+get_frame_size (const GstVideoFrame * frame)
+{
+  gsize size = 0;
+  guint i;
+
+  for (i = 0; i < GST_VIDEO_FRAME_N_PLANES (frame); i++)
+    size += (gsize) GST_VIDEO_FRAME_COMP_WIDTH (frame, i) *
+        GST_VIDEO_FRAME_COMP_PSTRIDE (frame, i) *
+        GST_VIDEO_FRAME_COMP_HEIGHT (frame, i);
+  return size;
+}
+
+static void
+print_result (GstVideoFormat format, const gchar * direction,
+    const gchar * isa, guint num_threads, gsize size, gint64 elapsed_time,
+    gboolean ok)
+{
+  const gdouble gb = (gdouble) size * g_iterations / (1024 * 1024 * 1024);
+
+  g_print ("%-8s %-10s %-12s %8u %10.2f%s\n",
+      gst_video_format_to_string (format), direction, isa, num_threads,
+      elapsed_time > 0 ? gb * G_USEC_PER_SEC / elapsed_time : 0.0,
+      check_result_string (ok));
+}
+
+static void
+bench_format (GstVideoFormat format)
+{
+  static const GstVaapiCopyIsa isas[] = {
+    GST_VAAPI_COPY_ISA_C,
+    GST_VAAPI_COPY_ISA_SSE2,
+    GST_VAAPI_COPY_ISA_SSE4_1,
+    GST_VAAPI_COPY_ISA_AVX2,
+  };
+  const guint max_threads = g_threads > 0 ? g_threads : 4;
+  GstVaapiCopyPlane planes[GST_VIDEO_MAX_PLANES];
+  GstVideoFrame src_frame, dst_frame;
+  GstBuffer *src_buffer, *dst_buffer;
+  GstVideoInfo vi;
+  guint d, i, n, t, num_planes;
+  gint64 start_time;
+  gsize size;
+
+  gst_video_info_set_format (&vi, format, g_width, g_height);
+  src_buffer = gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (&vi), NULL);
+  dst_buffer = gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (&vi), NULL);
+  if (!gst_video_frame_map (&src_frame, &vi, src_buffer, GST_MAP_WRITE) ||
+      !gst_video_frame_map (&dst_frame, &vi, dst_buffer, GST_MAP_WRITE))
+    g_error ("failed to map %s frames", gst_video_format_to_string (format));
+
+  fill_frame (&src_frame, 0);
+  num_planes = init_planes (planes, &dst_frame, &src_frame);
+  size = get_frame_size (&src_frame);
+
+  for (d = 0; d < G_N_ELEMENTS (g_directions); d++) {
+    const Direction *const dir = &g_directions[d];
+
+    for (i = 0; i < G_N_ELEMENTS (isas); i++) {
+      if (!gst_vaapi_copy_isa_is_supported (isas[i]))
+        continue;
+
+      for (t = 1; t <= max_threads; t *= 2) {
+        fill_frame (&dst_frame, 1);
+        start_time = g_get_monotonic_time ();
+        for (n = 0; n < (guint) g_iterations; n++)
+          gst_vaapi_copy_planes_full (isas[i], planes, num_planes,
+              dir->flags, t);
+        print_result (format, dir->name,
+            gst_vaapi_copy_isa_get_name (isas[i]), t, size,
+            g_get_monotonic_time () - start_time,
+            check_frame (&dst_frame, &src_frame));
+      }
+    }
+
+    fill_frame (&dst_frame, 1);
+    start_time = g_get_monotonic_time ();
+    for (n = 0; n < (guint) g_iterations; n++)
+      gst_vaapi_copy_video_frame (&dst_frame, &src_frame, dir->flags);
+    print_result (format, dir->name, "auto", g_threads, size,
+        g_get_monotonic_time () - start_time,
+        check_frame (&dst_frame, &src_frame));
+  }
+
+  fill_frame (&dst_frame, 1);
+  start_time = g_get_monotonic_time ();
+  for (n = 0; n < (guint) g_iterations; n++)
+    gst_video_frame_copy (&dst_frame, &src_frame);
+  print_result (format, "-", "video-frame", 1, size,
+      g_get_monotonic_time () - start_time,
+      check_frame (&dst_frame, &src_frame));
+
+  gst_video_frame_unmap (&dst_frame);
+  gst_video_frame_unmap (&src_frame);
+  gst_buffer_unref (dst_buffer);
+  gst_buffer_unref (src_buffer);
+}
+
+int
+main (int argc, char *argv[])
+{
+  static const GstVideoFormat formats[] = {
+    GST_VIDEO_FORMAT_NV12,
+    GST_VIDEO_FORMAT_I420,
+    GST_VIDEO_FORMAT_YUY2,
+    GST_VIDEO_FORMAT_RGBA,
+  };
+  guint i;
+
+  if (!check_init (&argc, &argv, "- plane copy engine benchmark", g_options))
+    return 1;
+
+  if (g_width <= 0 || g_height <= 0)
+    g_error ("invalid image size %dx%d", g_width, g_height);
+
+  g_print ("%-8s %-10s %-12s %8s %10s\n", "format", "direction", "isa",
+      "threads", "GB/s");
+  for (i = 0; i < G_N_ELEMENTS (formats); i++)
+    bench_format (formats[i]);
+  return 0;
+}
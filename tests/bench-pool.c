@@ -0,0 +1,232 @@
+/*
+ *  bench-pool.c - Contention benchmark of the video pools
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation; either version 2.1
+ *  of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free
+ *  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Measures the number of gst_vaapi_video_pool_get_object() and
+ * gst_vaapi_video_pool_put_object() pairs per second on a single
+ * surface pool, shared by an increasing number of threads. Each
+ * thread holds a few surfaces at a time, the way a decoder and its
+ * downstream elements do. By default, the mock VA driver
+ * (mock-drv-video.c) is loaded so that only the pool itself is
+ * measured. Use --hardware to run against the real VA driver instead.
+ */
+
+#include "gst/vaapi/sysdeps.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <va/va_drm.h>
+#include <gst/vaapi/gstvaapisurfacepool.h>
+#include "output.h"
+#include "mock-drv-video.h"
+
+static gboolean g_use_hardware;
+static gint g_iterations = 1000000;
+static gint g_threads = 0;
+static gint g_depth = 4;
+static gboolean g_bounded;
+
+static GOptionEntry g_options[] = {
+  {"hardware", 0, 0, G_OPTION_ARG_NONE, &g_use_hardware,
+      "use the real VA driver instead of the mock driver", NULL},
+  {"iterations", 'n', 0, G_OPTION_ARG_INT, &g_iterations,
+      "number of objects each thread gets and puts back", NULL},
+  {"threads", 't', 0, G_OPTION_ARG_INT, &g_threads,
+      "maximum number of threads (0: number of processors)", NULL},
+  {"depth", 'd', 0, G_OPTION_ARG_INT, &g_depth,
+      "number of objects each thread holds at a time", NULL},
+  {"bounded", 'b', 0, G_OPTION_ARG_NONE, &g_bounded,
+      "limit the pool capacity to the objects held by all threads", NULL},
+  {NULL,}
+};
+
+/* ------------------------------------------------------------------------ */
+/* --- Display                                                          --- */
+/* ------------------------------------------------------------------------ */
+
+static gint g_mock_fd = -1;
+static VADisplay g_mock_va_display;
+
+static GstVaapiDisplay *
+create_mock_display (void)
+{
+  g_setenv ("LIBVA_DRIVER_NAME", MOCK_VA_DRIVER_NAME, TRUE);
+  g_setenv ("LIBVA_DRIVERS_PATH", MOCK_DRIVER_DIR, FALSE);
+
+  /* Any character device will do, the mock driver never touches it */
+  g_mock_fd = open ("/dev/null", O_RDWR | O_CLOEXEC);
+  if (g_mock_fd < 0)
+    return NULL;
+
+  g_mock_va_display = vaGetDisplayDRM (g_mock_fd);
+  if (!g_mock_va_display)
+    return NULL;
+  return gst_vaapi_display_new_with_display (g_mock_va_display);
+}
+
+static void
+destroy_mock_display (void)
+{
+  if (g_mock_va_display) {
+    vaTerminate (g_mock_va_display);
+    g_mock_va_display = NULL;
+  }
+  if (g_mock_fd >= 0) {
+    close (g_mock_fd);
+    g_mock_fd = -1;
+  }
+}
+
+/* ------------------------------------------------------------------------ */
+/* --- Benchmark                                                        --- */
+/* ------------------------------------------------------------------------ */
+
+typedef struct
+{
+  GstVaapiVideoPool *pool;
+  guint num_threads;
+  gint num_ready;
+  gint go;
+} BenchContext;
+
+typedef struct
+{
+  BenchContext *context;
+  guint num_ops;
+  guint num_failures;
+} BenchThread;
+
+static gpointer
+bench_thread (gpointer data)
+{
+  BenchThread *const thread = data;
+  BenchContext *const context = thread->context;
+  gpointer *objects;
+  guint i, n, num_objects;
+
+  objects = g_new (gpointer, g_depth);
+
+  /* Start all the threads at once */
+  g_atomic_int_inc (&context->num_ready);
+  while (!g_atomic_int_get (&context->go))
+    g_thread_yield ();
+
+  for (n = 0; n < (guint) g_iterations; n += num_objects) {
+    num_objects = 0;
+    for (i = 0; i < (guint) g_depth; i++) {
+      objects[num_objects] = gst_vaapi_video_pool_get_object (context->pool);
+      if (objects[num_objects])
+        num_objects++;
+      else
+        thread->num_failures++;
+    }
+    for (i = 0; i < num_objects; i++)
+      gst_vaapi_video_pool_put_object (context->pool, objects[i]);
+    if (!num_objects)
+      g_thread_yield ();
+  }
+  thread->num_ops = n;
+
+  g_free (objects);
+  return NULL;
+}
+
+static void
+bench_pool (GstVaapiDisplay * display, guint num_threads)
+{
+  BenchContext context = { NULL, };
+  BenchThread *threads;
+  GThread **thread_ids;
+  GstVaapiVideoPoolStats stats;
+  gint64 elapsed_time;
+  guint i, num_ops = 0, num_failures = 0;
+
+  context.pool = gst_vaapi_surface_pool_new (display, GST_VIDEO_FORMAT_NV12,
+      64, 64);
+  if (!context.pool)
+    g_error ("could not create surface pool");
+  if (g_bounded)
+    gst_vaapi_video_pool_set_capacity (context.pool, num_threads * g_depth);
+  context.num_threads = num_threads;
+
+  threads = g_new0 (BenchThread, num_threads);
+  thread_ids = g_new (GThread *, num_threads);
+  for (i = 0; i < num_threads; i++) {
+    threads[i].context = &context;
+    thread_ids[i] = g_thread_new ("bench", bench_thread, &threads[i]);
+  }
+  while (g_atomic_int_get (&context.num_ready) < (gint) num_threads)
+    g_thread_yield ();
+
+  elapsed_time = g_get_monotonic_time ();
+  g_atomic_int_set (&context.go, 1);
+  for (i = 0; i < num_threads; i++) {
+    g_thread_join (thread_ids[i]);
+    num_ops += threads[i].num_ops;
+    num_failures += threads[i].num_failures;
+  }
+  elapsed_time = g_get_monotonic_time () - elapsed_time;
+
+  gst_vaapi_video_pool_get_stats (context.pool, &stats);
+  g_print ("%7u %12.0f %10" G_GUINT64_FORMAT " %10" G_GUINT64_FORMAT
+      " %8" G_GUINT64_FORMAT " %8u\n", num_threads,
+      (gdouble) num_ops * G_USEC_PER_SEC / MAX (elapsed_time, 1),
+      stats.num_hits, stats.num_misses, stats.num_allocations, num_failures);
+
+  g_free (thread_ids);
+  g_free (threads);
+  gst_vaapi_video_pool_unref (context.pool);
+}
+
+int
+main (int argc, char *argv[])
+{
+  GstVaapiDisplay *display;
+  guint num_threads;
+
+  if (!video_output_init (&argc, argv, g_options))
+    g_error ("failed to initialize video output subsystem");
+
+  if (g_depth < 1)
+    g_depth = 1;
+  if (g_threads < 1)
+    g_threads = g_get_num_processors ();
+
+  if (g_use_hardware)
+    display = video_output_create_display (NULL);
+  else
+    display = create_mock_display ();
+  if (!display)
+    g_error ("could not create VA display");
+
+  g_print ("# %s VA driver, %d objects per thread, %s pool\n",
+      g_use_hardware ? "hardware" : "mock", g_depth,
+      g_bounded ? "bounded" : "unbounded");
+  g_print ("%7s %12s %10s %10s %8s %8s\n", "threads", "ops/s", "hits",
+      "misses", "allocs", "failures");
+  for (num_threads = 1; num_threads < (guint) g_threads; num_threads *= 2)
+    bench_pool (display, num_threads);
+  bench_pool (display, g_threads);
+
+  gst_vaapi_display_unref (display);
+  destroy_mock_display ();
+  video_output_exit ();
+  return 0;
+}
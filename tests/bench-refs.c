@@ -0,0 +1,277 @@
+/*
+ *  bench-refs.c - Benchmark of the reference picture list construction
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation; either version 2.1
+ *  of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free
+ *  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Measures the time, in ns per slice, taken to initialize the
+ * RefPicList0 and RefPicList1 lists of B slices in frames (8.2.4.2.3),
+ * for an increasing number of short-term reference frames. The lists
+ * are built either the way the H.264 decoder used to, by filtering and
+ * sorting the reference frames with qsort() for every slice, or from
+ * the reference index sorted once per picture and copied for every
+ * slice. The DPB states are synthetic, with random POCs.
+ */
+
+#include "gst/vaapi/sysdeps.h"
+#include "gst/vaapi/gstvaapidecoder_refs.h"
+#include "check.h"
+
+static gint g_iterations = 20000;
+static gint g_slices = 8;
+static gint g_pictures = 64;
+
+static GOptionEntry g_options[] = {
+  {"iterations", 'n', 0, G_OPTION_ARG_INT, &g_iterations,
+      "number of pictures decoded per measure", NULL},
+  {"slices", 's', 0, G_OPTION_ARG_INT, &g_slices,
+      "number of slices per picture", NULL},
+  {"pictures", 'p', 0, G_OPTION_ARG_INT, &g_pictures,
+      "number of distinct DPB states", NULL},
+  {NULL,}
+};
+
+typedef struct
+{
+  gint32 poc;
+} BenchPicture;
+
+typedef struct
+{
+  BenchPicture current;
+  BenchPicture refs[GST_VAAPI_REF_INDEX_MAX_SIZE];
+  BenchPicture *ref_list[GST_VAAPI_REF_INDEX_MAX_SIZE];
+  guint num_refs;
+} BenchState;
+
+typedef struct
+{
+  BenchPicture *RefPicList0[GST_VAAPI_REF_INDEX_MAX_SIZE];
+  guint RefPicList0_count;
+  BenchPicture *RefPicList1[GST_VAAPI_REF_INDEX_MAX_SIZE];
+  guint RefPicList1_count;
+} BenchLists;
+
+static BenchState *
+generate_states (guint num_states, guint num_refs)
+{
+  GRand *const rand = g_rand_new_with_seed (0x000001);
+  BenchState *const states = g_new0 (BenchState, num_states);
+  guint i, j, k;
+
+  for (i = 0; i < num_states; i++) {
+    BenchState *const state = &states[i];
+
+    /* Distinct POCs around the current picture, in random DPB order */
+    state->current.poc = 2 * g_rand_int_range (rand, 0, 64) + 1;
+    for (j = 0; j < num_refs; j++) {
+      state->refs[j].poc = 2 * j;
+      state->ref_list[j] = &state->refs[j];
+    }
+    for (j = num_refs; j > 1; j--) {
+      BenchPicture *const tmp = state->ref_list[j - 1];
+      k = g_rand_int_range (rand, 0, j);
+      state->ref_list[j - 1] = state->ref_list[k];
+      state->ref_list[k] = tmp;
+    }
+    for (j = 0; j < num_refs; j++)
+      state->ref_list[j]->poc += state->current.poc - num_refs;
+    state->num_refs = num_refs;
+  }
+  g_rand_free (rand);
+  return states;
+}
+
+static int
+compare_picture_poc_dec (const void *a, const void *b)
+{
+  const BenchPicture *const picA = *(BenchPicture **) a;
+  const BenchPicture *const picB = *(BenchPicture **) b;
+
+  return picB->poc - picA->poc;
+}
+
+static int
+compare_picture_poc_inc (const void *a, const void *b)
+{
+  const BenchPicture *const picA = *(BenchPicture **) a;
+  const BenchPicture *const picB = *(BenchPicture **) b;
+
+  return picA->poc - picB->poc;
+}
+
+#define SORT_REF_LIST(list, n, compare_func) \
+    qsort(list, n, sizeof(*(list)), compare_picture_##compare_func)
+
+static void
+init_lists_sort (BenchState * state, BenchLists * lists)
+{
+  BenchPicture **ref_list;
+  guint i, n;
+
+  ref_list = lists->RefPicList0;
+  for (n = 0, i = 0; i < state->num_refs; i++) {
+    if (state->ref_list[i]->poc < state->current.poc)
+      ref_list[n++] = state->ref_list[i];
+  }
+  SORT_REF_LIST (ref_list, n, poc_dec);
+  lists->RefPicList0_count = n;
+
+  ref_list = &lists->RefPicList0[lists->RefPicList0_count];
+  for (n = 0, i = 0; i < state->num_refs; i++) {
+    if (state->ref_list[i]->poc >= state->current.poc)
+      ref_list[n++] = state->ref_list[i];
+  }
+  SORT_REF_LIST (ref_list, n, poc_inc);
+  lists->RefPicList0_count += n;
+
+  ref_list = lists->RefPicList1;
+  for (n = 0, i = 0; i < state->num_refs; i++) {
+    if (state->ref_list[i]->poc > state->current.poc)
+      ref_list[n++] = state->ref_list[i];
+  }
+  SORT_REF_LIST (ref_list, n, poc_inc);
+  lists->RefPicList1_count = n;
+
+  ref_list = &lists->RefPicList1[lists->RefPicList1_count];
+  for (n = 0, i = 0; i < state->num_refs; i++) {
+    if (state->ref_list[i]->poc <= state->current.poc)
+      ref_list[n++] = state->ref_list[i];
+  }
+  SORT_REF_LIST (ref_list, n, poc_dec);
+  lists->RefPicList1_count += n;
+}
+
+#undef SORT_REF_LIST
+
+static void
+init_index (BenchState * state, GstVaapiRefIndex * index)
+{
+  guint i;
+
+  gst_vaapi_ref_index_clear (index);
+  for (i = 0; i < state->num_refs; i++)
+    gst_vaapi_ref_index_insert (index, state->ref_list[i]->poc,
+        state->ref_list[i]);
+}
+
+static void
+init_lists_index (BenchState * state, GstVaapiRefIndex * index,
+    BenchLists * lists)
+{
+  const gint32 poc = state->current.poc;
+  guint lb, ub, n;
+
+  lb = gst_vaapi_ref_index_lower_bound (index, poc);
+  ub = gst_vaapi_ref_index_upper_bound (index, poc);
+
+  n = gst_vaapi_ref_index_copy (index, 0, lb, TRUE,
+      (gpointer *) lists->RefPicList0);
+  n += gst_vaapi_ref_index_copy (index, lb, index->count, FALSE,
+      (gpointer *) & lists->RefPicList0[n]);
+  lists->RefPicList0_count = n;
+
+  n = gst_vaapi_ref_index_copy (index, ub, index->count, FALSE,
+      (gpointer *) lists->RefPicList1);
+  n += gst_vaapi_ref_index_copy (index, 0, ub, TRUE,
+      (gpointer *) & lists->RefPicList1[n]);
+  lists->RefPicList1_count = n;
+}
+
+static gboolean
+compare_lists (const BenchLists * a, const BenchLists * b)
+{
+  return a->RefPicList0_count == b->RefPicList0_count &&
+      a->RefPicList1_count == b->RefPicList1_count &&
+      memcmp (a->RefPicList0, b->RefPicList0,
+      a->RefPicList0_count * sizeof (a->RefPicList0[0])) == 0 &&
+      memcmp (a->RefPicList1, b->RefPicList1,
+      a->RefPicList1_count * sizeof (a->RefPicList1[0])) == 0;
+}
+
+static gdouble
+get_ns_per_slice (gint64 elapsed_time)
+{
+  return (gdouble) elapsed_time * 1000 / ((gdouble) g_iterations * g_slices);
+}
+
+static void
+bench_refs (guint num_refs)
+{
+  BenchState *const states = generate_states (g_pictures, num_refs);
+  GstVaapiRefIndex index;
+  BenchLists lists, ref_lists;
+  guint i, j, num_mismatches = 0;
+  gint64 start_time, sort_time, index_time;
+
+  for (i = 0; i < (guint) g_pictures; i++) {
+    init_lists_sort (&states[i], &ref_lists);
+    init_index (&states[i], &index);
+    init_lists_index (&states[i], &index, &lists);
+    if (!compare_lists (&lists, &ref_lists))
+      num_mismatches++;
+  }
+
+  start_time = g_get_monotonic_time ();
+  for (i = 0; i < (guint) g_iterations; i++) {
+    BenchState *const state = &states[i % g_pictures];
+    for (j = 0; j < (guint) g_slices; j++)
+      init_lists_sort (state, &lists);
+  }
+  sort_time = g_get_monotonic_time () - start_time;
+
+  start_time = g_get_monotonic_time ();
+  for (i = 0; i < (guint) g_iterations; i++) {
+    BenchState *const state = &states[i % g_pictures];
+    init_index (state, &index);
+    for (j = 0; j < (guint) g_slices; j++)
+      init_lists_index (state, &index, &lists);
+  }
+  index_time = g_get_monotonic_time () - start_time;
+
+  g_print ("%4u %12.1f %12.1f %8.2f%s\n", num_refs,
+      get_ns_per_slice (sort_time), get_ns_per_slice (index_time),
+      index_time > 0 ? (gdouble) sort_time / index_time : 0.0,
+      check_result_string (num_mismatches == 0));
+  g_free (states);
+}
+
+int
+main (int argc, char *argv[])
+{
+  guint num_refs;
+
+  if (!check_init (&argc, &argv, "- reference picture list benchmark",
+          g_options))
+    return 1;
+
+  if (g_iterations < 1)
+    g_iterations = 1;
+  if (g_slices < 1)
+    g_slices = 1;
+  if (g_pictures < 1)
+    g_pictures = 1;
+
+  g_print ("# %d slices per picture\n", g_slices);
+  g_print ("%4s %12s %12s %8s\n", "refs", "qsort ns", "index ns", "speedup");
+  for (num_refs = 1; num_refs <= 16; num_refs *= 2)
+    bench_refs (num_refs);
+  bench_refs (GST_VAAPI_REF_INDEX_MAX_SIZE);
+  return 0;
+}
@@ -0,0 +1,228 @@
+/*
+ *  bench-startcode.c - Benchmark of the start code scanners
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation; either version 2.1
+ *  of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free
+ *  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Measures the throughput, in MB/s, of each start code scanner built
+ * into libgstvaapi and supported by the CPU, along with the original
+ * gst_adapter_masked_scan_uint32_peek() based search. The input is
+ * either a set of elementary stream files, or a synthetic stream with
+ * the statistics of a typical H.264 stream (start codes every 1.5 KB
+ * on average, emulation prevention applied to the payloads).
+ */
+
+#include "gst/vaapi/sysdeps.h"
+#include <gst/base/gstadapter.h>
+#include "gst/vaapi/gstvaapiutils_startcode.h"
+#include "check.h"
+
+static gint g_iterations = 20;
+static gint g_stream_size = 64;
+static gchar **g_input_files;
+
+static GOptionEntry g_options[] = {
+  {"iterations", 'n', 0, G_OPTION_ARG_INT, &g_iterations,
+      "number of times each stream is scanned", NULL},
+  {"size", 's', 0, G_OPTION_ARG_INT, &g_stream_size,
+      "size of the synthetic stream, in MB", NULL},
+  {G_OPTION_REMAINING, ' ', 0, G_OPTION_ARG_FILENAME_ARRAY, &g_input_files,
+      "elementary stream files", NULL},
+  {NULL,}
+};
+
+static GBytes *
+generate_stream (gsize size)
+{
+  GRand *const rand = g_rand_new_with_seed (0x000001);
+  guint8 *const data = g_malloc (size);
+  gsize i = 0, unit_end;
+  guint32 zeros = 0;
+
+  while (i < size) {
+    /* Start code, with a random NAL unit header */
+    unit_end = MIN (size, i + g_rand_int_range (rand, 16, 3000));
+    if (i + 4 <= unit_end) {
+      data[i++] = 0;
+      data[i++] = 0;
+      data[i++] = 1;
+      data[i++] = g_rand_int_range (rand, 1, 256);
+    }
+    zeros = 0;
+
+    /* Payload: random bytes, with runs of zeros as in residual data */
+    while (i < unit_end) {
+      guint8 b = g_rand_int_range (rand, 0, 8) ? g_rand_int (rand) : 0;
+      if (zeros >= 2 && b <= 3)
+        b = 3;                  /* emulation_prevention_three_byte */
+      zeros = b ? 0 : zeros + 1;
+      data[i++] = b;
+    }
+  }
+  g_rand_free (rand);
+  return g_bytes_new_take (data, size);
+}
+
+static guint
+count_start_codes (GstVaapiStartCodeIsa isa, const guint8 * data, gsize size)
+{
+  guint count = 0;
+  gsize ofs = 0;
+  gint pos;
+
+  while (ofs < size) {
+    pos = gst_vaapi_scan_for_start_code_isa (isa, data + ofs,
+        MIN (size - ofs, G_MAXINT));
+    if (pos < 0)
+      break;
+    count++;
+    ofs += pos + 3;
+  }
+  return count;
+}
+
+static guint
+count_start_codes_adapter (GstAdapter * adapter, gboolean use_vaapi)
+{
+  const guint size = gst_adapter_available (adapter);
+  guint count = 0, ofs = 0;
+  gint pos;
+
+  while (ofs + 4 <= size) {
+    if (use_vaapi)
+      pos = gst_vaapi_adapter_scan_for_start_code (adapter, ofs, size - ofs,
+          NULL);
+    else
+      pos = gst_adapter_masked_scan_uint32_peek (adapter, 0xffffff00,
+          0x00000100, ofs, size - ofs, NULL);
+    if (pos < 0)
+      break;
+    count++;
+    ofs = pos + 3;
+  }
+  return count;
+}
+
+static void
+print_result (const gchar * name, const gchar * isa, gsize size,
+    gint64 elapsed_time, guint count, guint ref_count)
+{
+  const gdouble mb = (gdouble) size * g_iterations / (1024 * 1024);
+
+  g_print ("%-24s %-12s %10.1f %10u%s\n", name, isa,
+      elapsed_time > 0 ? mb * G_USEC_PER_SEC / elapsed_time : 0.0, count,
+      check_result_string (count == ref_count));
+}
+
+/* Splits the stream into 188 bytes buffers, as from an MPEG-TS demuxer */
+static GstAdapter *
+create_adapter (GBytes * bytes)
+{
+  GstAdapter *const adapter = gst_adapter_new ();
+  gsize ofs, size;
+  gpointer data = (gpointer) g_bytes_get_data (bytes, &size);
+
+  for (ofs = 0; ofs < size; ofs += 188)
+    gst_adapter_push (adapter,
+        gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY, data, size,
+            ofs, MIN (188, size - ofs), g_bytes_ref (bytes),
+            (GDestroyNotify) g_bytes_unref));
+  return adapter;
+}
+
+static void
+bench_stream (const gchar * name, GBytes * bytes)
+{
+  static const GstVaapiStartCodeIsa isas[] = {
+    GST_VAAPI_START_CODE_ISA_C,
+    GST_VAAPI_START_CODE_ISA_SSE2,
+    GST_VAAPI_START_CODE_ISA_AVX2,
+    GST_VAAPI_START_CODE_ISA_NEON,
+  };
+  gsize size;
+  const guint8 *const data = g_bytes_get_data (bytes, &size);
+  GstAdapter *adapter;
+  guint i, n, count = 0, ref_count;
+  gint64 start_time;
+
+  ref_count = count_start_codes (GST_VAAPI_START_CODE_ISA_C, data, size);
+
+  for (i = 0; i < G_N_ELEMENTS (isas); i++) {
+    if (!gst_vaapi_start_code_isa_is_supported (isas[i]))
+      continue;
+
+    start_time = g_get_monotonic_time ();
+    for (n = 0; n < (guint) g_iterations; n++)
+      count = count_start_codes (isas[i], data, size);
+    print_result (name, gst_vaapi_start_code_isa_get_name (isas[i]), size,
+        g_get_monotonic_time () - start_time, count, ref_count);
+  }
+
+  adapter = create_adapter (bytes);
+  start_time = g_get_monotonic_time ();
+  for (n = 0; n < (guint) g_iterations; n++)
+    count = count_start_codes_adapter (adapter, FALSE);
+  print_result (name, "adapter", size, g_get_monotonic_time () - start_time,
+      count, ref_count);
+
+  start_time = g_get_monotonic_time ();
+  for (n = 0; n < (guint) g_iterations; n++)
+    count = count_start_codes_adapter (adapter, TRUE);
+  print_result (name, "adapter-auto", size,
+      g_get_monotonic_time () - start_time, count, ref_count);
+  g_object_unref (adapter);
+}
+
+int
+main (int argc, char *argv[])
+{
+  GError *error = NULL;
+  GBytes *bytes;
+  gchar *contents, *name;
+  gsize length;
+  guint i;
+
+  if (!check_init (&argc, &argv, "- start code scanner benchmark", g_options))
+    return 1;
+
+  g_print ("%-24s %-12s %10s %10s\n", "stream", "isa", "MB/s", "codes");
+  if (g_input_files) {
+    for (i = 0; g_input_files[i] != NULL; i++) {
+      if (!g_file_get_contents (g_input_files[i], &contents, &length,
+              &error)) {
+        g_printerr ("failed to read %s: %s\n", g_input_files[i],
+            error->message);
+        g_clear_error (&error);
+        continue;
+      }
+      bytes = g_bytes_new_take (contents, length);
+      name = g_path_get_basename (g_input_files[i]);
+      bench_stream (name, bytes);
+      g_free (name);
+      g_bytes_unref (bytes);
+    }
+  } else {
+    bytes = generate_stream ((gsize) g_stream_size * 1024 * 1024);
+    bench_stream ("synthetic", bytes);
+    g_bytes_unref (bytes);
+  }
+
+  g_strfreev (g_input_files);
+  return 0;
+}
@@ -0,0 +1,77 @@
+/*
+ * check.c - Helpers for standalone tests and benchmarks
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+
+#include "check.h"
+
+/* Parses the command line @options, along with the GStreamer ones.
+   Returns %FALSE and prints the error on failure */
+gboolean
+check_init (int *argc, char **argv[], const gchar * description,
+    GOptionEntry * options)
+{
+  GOptionContext *ctx;
+  GError *error = NULL;
+  gboolean success;
+
+  ctx = g_option_context_new (description);
+  if (!ctx)
+    return FALSE;
+
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+  if (options)
+    g_option_context_add_main_entries (ctx, options, NULL);
+  success = g_option_context_parse (ctx, argc, argv, &error);
+  g_option_context_free (ctx);
+
+  if (!success) {
+    g_printerr ("option parsing failed: %s\n", error->message);
+    g_error_free (error);
+  }
+  return success;
+}
+
+/* Prints the @value of the counter @name, and aborts if it is not the
+   @expected one */
+void
+check_count (const gchar * name, guint64 value, guint64 expected)
+{
+  g_print ("%-24s %8" G_GUINT64_FORMAT "\n", name, value);
+  if (value != expected)
+    g_error ("%s: %" G_GUINT64_FORMAT ", expected %" G_GUINT64_FORMAT,
+        name, value, expected);
+}
+
+/* Aborts if the @value of the counter @name exceeds @max_value */
+void
+check_at_most (const gchar * name, guint64 value, guint64 max_value)
+{
+  if (value > max_value)
+    g_error ("%s: %" G_GUINT64_FORMAT ", expected at most %"
+        G_GUINT64_FORMAT, name, value, max_value);
+}
+
+/* Returns the suffix of a benchmark result line, depending on whether
+   the result matched the reference implementation */
+const gchar *
+check_result_string (gboolean ok)
+{
+  return ok ? "" : " (MISMATCH)";
+}
@@ -0,0 +1,36 @@
+/*
+ * check.h - Helpers for standalone tests and benchmarks
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+
+#ifndef CHECK_H
+#define CHECK_H
+
+#include "gst/vaapi/sysdeps.h"
+
+gboolean check_init (int *argc, char **argv[], const gchar * description,
+    GOptionEntry * options);
+
+void check_count (const gchar * name, guint64 value, guint64 expected);
+
+void check_at_most (const gchar * name, guint64 value, guint64 max_value);
+
+const gchar *check_result_string (gboolean ok);
+
+#endif /* CHECK_H */
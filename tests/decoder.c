@@ -188,6 +188,21 @@ decoder_get_surface (GstVaapiDecoder * decoder)
   return proxy;
 }
 
+gboolean
+decoder_get_video_info (GstVaapiDecoder * decoder, VideoDecodeInfo * info)
+{
+  const CodecDefs *codec;
+
+  g_return_val_if_fail (decoder != NULL, FALSE);
+  g_return_val_if_fail (info != NULL, FALSE);
+
+  codec = get_codec_defs (decoder);
+  g_return_val_if_fail (codec != NULL, FALSE);
+
+  codec->get_video_info (info);
+  return TRUE;
+}
+
 const gchar *
 decoder_get_codec_name (GstVaapiDecoder * decoder)
 {
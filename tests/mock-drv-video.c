@@ -0,0 +1,891 @@
+/*
+ *  mock-drv-video.c - Mock VA driver for hardware-free benchmarks
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation; either version 2.1
+ *  of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free
+ *  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301 USA
+ */
+
+/*
+ * This is a loadable VA driver (mock_drv_video.so) that implements
+ * just enough of the VA driver interface for the libgstvaapi decoders
+ * and encoders to run without a GPU. Every call returns immediately:
+ * surfaces have no storage, images and buffers are plain system
+ * memory, and coded buffers always hold a small blank payload. The
+ * vaBeginPicture(), vaRenderPicture() and vaEndPicture() calls are
+ * only recorded so that benchmarks can report the number of driver
+ * round-trips per frame.
+ *
+ * Load it with LIBVA_DRIVER_NAME=mock LIBVA_DRIVERS_PATH=<dir>.
+ */
+
+#include <string.h>
+#include <va/va.h>
+#include <va/va_backend.h>
+#include "mock-drv-video.h"
+
+#define MOCK_VENDOR_STRING      "GStreamer VA-API mock driver"
+#define MOCK_MAX_PROFILES       32
+#define MOCK_MAX_ENTRYPOINTS    4
+#define MOCK_MAX_ATTRIBUTES     16
+#define MOCK_MAX_IMAGE_FORMATS  16
+#define MOCK_MAX_SUBPIC_FORMATS 4
+#define MOCK_MAX_DISPLAY_ATTRIBUTES 4
+#define MOCK_CODED_PAYLOAD_SIZE 1024
+
+#ifdef VA_DRIVER_INIT_FUNC
+# define MOCK_DRIVER_INIT_FUNC VA_DRIVER_INIT_FUNC
+#else
+# define MOCK_DRIVER_INIT_FUNC_2(major, minor) __vaDriverInit_##major##_##minor
+# define MOCK_DRIVER_INIT_FUNC_1(major, minor) \
+  MOCK_DRIVER_INIT_FUNC_2 (major, minor)
+# define MOCK_DRIVER_INIT_FUNC \
+  MOCK_DRIVER_INIT_FUNC_1 (VA_MAJOR_VERSION, VA_MINOR_VERSION)
+#endif
+
+typedef struct
+{
+  VAProfile profile;
+  VAEntrypoint entrypoint;
+} MockConfig;
+
+typedef struct
+{
+  VABufferType type;
+  guint size;
+  guint num_elements;
+  guint8 *data;
+} MockBuffer;
+
+typedef struct
+{
+  GMutex lock;
+  guint next_id;
+  GHashTable *configs;
+  GHashTable *buffers;
+  GHashTable *images;
+} MockDriverData;
+
+static GMutex g_stats_lock;
+static MockVaStats g_stats;
+
+#define MOCK_STATS_INC(field, n) G_STMT_START {    \
+    g_mutex_lock (&g_stats_lock);                   \
+    g_stats.field += (n);                           \
+    g_mutex_unlock (&g_stats_lock);                 \
+  } G_STMT_END
+
+/* *INDENT-OFF* */
+static const VAProfile g_decode_profiles[] = {
+  VAProfileMPEG2Simple,
+  VAProfileMPEG2Main,
+  VAProfileMPEG4Simple,
+  VAProfileMPEG4AdvancedSimple,
+  VAProfileMPEG4Main,
+  VAProfileH264ConstrainedBaseline,
+  VAProfileH264Main,
+  VAProfileH264High,
+  VAProfileVC1Simple,
+  VAProfileVC1Main,
+  VAProfileVC1Advanced,
+#if VA_CHECK_VERSION(0,32,0)
+  VAProfileJPEGBaseline,
+#endif
+#if VA_CHECK_VERSION(0,35,0)
+  VAProfileVP8Version0_3,
+#endif
+#if VA_CHECK_VERSION(0,37,0)
+  VAProfileHEVCMain,
+#endif
+#if VA_CHECK_VERSION(0,38,0)
+  VAProfileVP9Profile0,
+#endif
+};
+
+static const VAProfile g_encode_profiles[] = {
+  VAProfileMPEG2Simple,
+  VAProfileMPEG2Main,
+  VAProfileH264ConstrainedBaseline,
+  VAProfileH264Main,
+  VAProfileH264High,
+#if VA_CHECK_VERSION(0,35,0)
+  VAProfileVP8Version0_3,
+#endif
+#if VA_CHECK_VERSION(0,37,0)
+  VAProfileHEVCMain,
+#endif
+#if VA_CHECK_VERSION(0,38,0)
+  VAProfileVP9Profile0,
+#endif
+};
+
+#define DEF_YUV(FOURCC, BPP) \
+  { VA_FOURCC FOURCC, VA_LSB_FIRST, BPP, }
+#define DEF_RGB(FOURCC, R, G, B, A) \
+  { VA_FOURCC FOURCC, VA_LSB_FIRST, 32, 32, R, G, B, A }
+
+static const VAImageFormat g_image_formats[] = {
+  DEF_YUV (('N', 'V', '1', '2'), 12),
+  DEF_YUV (('Y', 'V', '1', '2'), 12),
+  DEF_YUV (('I', '4', '2', '0'), 12),
+  DEF_YUV (('Y', 'U', 'Y', '2'), 16),
+  DEF_YUV (('U', 'Y', 'V', 'Y'), 16),
+  DEF_RGB (('B', 'G', 'R', 'A'),
+      0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000),
+  DEF_RGB (('R', 'G', 'B', 'A'),
+      0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000),
+};
+
+#undef DEF_RGB
+#undef DEF_YUV
+/* *INDENT-ON* */
+
+static inline MockDriverData *
+get_driver_data (VADriverContextP ctx)
+{
+  return ctx->pDriverData;
+}
+
+static VAGenericID
+mock_new_id (MockDriverData * drv)
+{
+  VAGenericID id;
+
+  g_mutex_lock (&drv->lock);
+  id = ++drv->next_id;
+  g_mutex_unlock (&drv->lock);
+  return id;
+}
+
+static gboolean
+has_profile (const VAProfile * profiles, guint num_profiles, VAProfile profile)
+{
+  guint i;
+
+  for (i = 0; i < num_profiles; i++) {
+    if (profiles[i] == profile)
+      return TRUE;
+  }
+  return FALSE;
+}
+
+static void
+mock_buffer_free (MockBuffer * buf)
+{
+  g_free (buf->data);
+  g_slice_free (MockBuffer, buf);
+}
+
+static void
+mock_image_free (VAImage * image)
+{
+  g_slice_free (VAImage, image);
+}
+
+/* ------------------------------------------------------------------------ */
+/* --- Configurations                                                   --- */
+/* ------------------------------------------------------------------------ */
+
+static VAStatus
+mock_QueryConfigProfiles (VADriverContextP ctx, VAProfile * profile_list,
+    int *num_profiles)
+{
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (g_decode_profiles); i++)
+    profile_list[i] = g_decode_profiles[i];
+  profile_list[i++] = VAProfileNone;
+  *num_profiles = i;
+  return VA_STATUS_SUCCESS;
+}
+
+static VAStatus
+mock_QueryConfigEntrypoints (VADriverContextP ctx, VAProfile profile,
+    VAEntrypoint * entrypoint_list, int *num_entrypoints)
+{
+  gint n = 0;
+
+  if (profile == VAProfileNone) {
+#if VA_CHECK_VERSION(0,34,0)
+    entrypoint_list[n++] = VAEntrypointVideoProc;
+#endif
+    *num_entrypoints = n;
+    return VA_STATUS_SUCCESS;
+  }
+
+  if (!has_profile (g_decode_profiles, G_N_ELEMENTS (g_decode_profiles),
+          profile))
+    return VA_STATUS_ERROR_UNSUPPORTED_PROFILE;
+
+  entrypoint_list[n++] = VAEntrypointVLD;
+  if (has_profile (g_encode_profiles, G_N_ELEMENTS (g_encode_profiles),
+          profile))
+    entrypoint_list[n++] = VAEntrypointEncSlice;
+#if VA_CHECK_VERSION(0,32,0)
+  if (profile == VAProfileJPEGBaseline)
+    entrypoint_list[n++] = VAEntrypointEncPicture;
+#endif
+  *num_entrypoints = n;
+  return VA_STATUS_SUCCESS;
+}
+
+static guint
+get_attribute_value (VAProfile profile, VAEntrypoint entrypoint,
+    VAConfigAttribType type)
+{
+  switch (type) {
+    case VAConfigAttribRTFormat:
+      return VA_RT_FORMAT_YUV420 | VA_RT_FORMAT_YUV422 | VA_RT_FORMAT_YUV444;
+    case VAConfigAttribRateControl:
+      return VA_RC_CQP | VA_RC_CBR | VA_RC_VBR;
+#if VA_CHECK_VERSION(0,34,0)
+    case VAConfigAttribEncPackedHeaders:
+      return VA_ENC_PACKED_HEADER_SEQUENCE | VA_ENC_PACKED_HEADER_PICTURE |
+          VA_ENC_PACKED_HEADER_SLICE | VA_ENC_PACKED_HEADER_MISC;
+    case VAConfigAttribEncMaxRefFrames:
+      return 4 | (1 << 16);
+    case VAConfigAttribEncMaxSlices:
+      return 32;
+#endif
+    default:
+      break;
+  }
+  return VA_ATTRIB_NOT_SUPPORTED;
+}
+
+static VAStatus
+mock_GetConfigAttributes (VADriverContextP ctx, VAProfile profile,
+    VAEntrypoint entrypoint, VAConfigAttrib * attrib_list, int num_attribs)
+{
+  gint i;
+
+  for (i = 0; i < num_attribs; i++)
+    attrib_list[i].value = get_attribute_value (profile, entrypoint,
+        attrib_list[i].type);
+  return VA_STATUS_SUCCESS;
+}
+
+static VAStatus
+mock_CreateConfig (VADriverContextP ctx, VAProfile profile,
+    VAEntrypoint entrypoint, VAConfigAttrib * attrib_list, int num_attribs,
+    VAConfigID * config_id)
+{
+  MockDriverData *const drv = get_driver_data (ctx);
+  MockConfig *config;
+
+  config = g_new (MockConfig, 1);
+  config->profile = profile;
+  config->entrypoint = entrypoint;
+
+  *config_id = mock_new_id (drv);
+  g_mutex_lock (&drv->lock);
+  g_hash_table_insert (drv->configs, GUINT_TO_POINTER (*config_id), config);
+  g_mutex_unlock (&drv->lock);
+  return VA_STATUS_SUCCESS;
+}
+
+static VAStatus
+mock_DestroyConfig (VADriverContextP ctx, VAConfigID config_id)
+{
+  MockDriverData *const drv = get_driver_data (ctx);
+  gboolean found;
+
+  g_mutex_lock (&drv->lock);
+  found = g_hash_table_remove (drv->configs, GUINT_TO_POINTER (config_id));
+  g_mutex_unlock (&drv->lock);
+  return found ? VA_STATUS_SUCCESS : VA_STATUS_ERROR_INVALID_CONFIG;
+}
+
+static VAStatus
+mock_QueryConfigAttributes (VADriverContextP ctx, VAConfigID config_id,
+    VAProfile * profile, VAEntrypoint * entrypoint,
+    VAConfigAttrib * attrib_list, int *num_attribs)
+{
+  MockDriverData *const drv = get_driver_data (ctx);
+  MockConfig *config;
+
+  g_mutex_lock (&drv->lock);
+  config = g_hash_table_lookup (drv->configs, GUINT_TO_POINTER (config_id));
+  g_mutex_unlock (&drv->lock);
+  if (!config)
+    return VA_STATUS_ERROR_INVALID_CONFIG;
+
+  *profile = config->profile;
+  *entrypoint = config->entrypoint;
+  attrib_list[0].type = VAConfigAttribRTFormat;
+  attrib_list[0].value = get_attribute_value (config->profile,
+      config->entrypoint, VAConfigAttribRTFormat);
+  *num_attribs = 1;
+  return VA_STATUS_SUCCESS;
+}
+
+/* ------------------------------------------------------------------------ */
+/* --- Surfaces and contexts                                            --- */
+/* ------------------------------------------------------------------------ */
+
+static VAStatus
+mock_CreateSurfaces (VADriverContextP ctx, int width, int height, int format,
+    int num_surfaces, VASurfaceID * surfaces)
+{
+  MockDriverData *const drv = get_driver_data (ctx);
+  gint i;
+
+  for (i = 0; i < num_surfaces; i++)
+    surfaces[i] = mock_new_id (drv);
+  MOCK_STATS_INC (create_surface, num_surfaces);
+  return VA_STATUS_SUCCESS;
+}
+
+#if VA_CHECK_VERSION(0,34,0)
+static VAStatus
+mock_CreateSurfaces2 (VADriverContextP ctx, unsigned int format,
+    unsigned int width, unsigned int height, VASurfaceID * surfaces,
+    unsigned int num_surfaces, VASurfaceAttrib * attrib_list,
+    unsigned int num_attribs)
+{
+  return mock_CreateSurfaces (ctx, width, height, format, num_surfaces,
+      surfaces);
+}
+
+static VAStatus
+mock_QuerySurfaceAttributes (VADriverContextP ctx, VAConfigID config,
+    VASurfaceAttrib * attrib_list, unsigned int *num_attribs)
+{
+  static const guint32 fourccs[] = {
+    VA_FOURCC ('N', 'V', '1', '2'), VA_FOURCC ('I', '4', '2', '0'),
+    VA_FOURCC ('Y', 'V', '1', '2'),
+  };
+  guint i;
+
+  if (!attrib_list) {
+    *num_attribs = G_N_ELEMENTS (fourccs);
+    return VA_STATUS_SUCCESS;
+  }
+  if (*num_attribs < G_N_ELEMENTS (fourccs))
+    return VA_STATUS_ERROR_MAX_NUM_EXCEEDED;
+
+  for (i = 0; i < G_N_ELEMENTS (fourccs); i++) {
+    VASurfaceAttrib *const attrib = &attrib_list[i];
+    attrib->type = VASurfaceAttribPixelFormat;
+    attrib->flags = VA_SURFACE_ATTRIB_GETTABLE | VA_SURFACE_ATTRIB_SETTABLE;
+    attrib->value.type = VAGenericValueTypeInteger;
+    attrib->value.value.i = fourccs[i];
+  }
+  *num_attribs = i;
+  return VA_STATUS_SUCCESS;
+}
+#endif
+
+static VAStatus
+mock_DestroySurfaces (VADriverContextP ctx, VASurfaceID * surface_list,
+    int num_surfaces)
+{
+  return VA_STATUS_SUCCESS;
+}
+
+static VAStatus
+mock_CreateContext (VADriverContextP ctx, VAConfigID config_id,
+    int picture_width, int picture_height, int flag,
+    VASurfaceID * render_targets, int num_render_targets, VAContextID * context)
+{
+  *context = mock_new_id (get_driver_data (ctx));
+  return VA_STATUS_SUCCESS;
+}
+
+static VAStatus
+mock_DestroyContext (VADriverContextP ctx, VAContextID context)
+{
+  return VA_STATUS_SUCCESS;
+}
+
+static VAStatus
+mock_SyncSurface (VADriverContextP ctx, VASurfaceID render_target)
+{
+  MOCK_STATS_INC (sync_surface, 1);
+  return VA_STATUS_SUCCESS;
+}
+
+static VAStatus
+mock_QuerySurfaceStatus (VADriverContextP ctx, VASurfaceID render_target,
+    VASurfaceStatus * status)
+{
+  *status = VASurfaceReady;
+  return VA_STATUS_SUCCESS;
+}
+
+static VAStatus
+mock_PutSurface (VADriverContextP ctx, VASurfaceID surface, void *draw,
+    short srcx, short srcy, unsigned short srcw, unsigned short srch,
+    short destx, short desty, unsigned short destw, unsigned short desth,
+    VARectangle * cliprects, unsigned int number_cliprects, unsigned int flags)
+{
+  return VA_STATUS_SUCCESS;
+}
+
+/* ------------------------------------------------------------------------ */
+/* --- Buffers and pictures                                             --- */
+/* ------------------------------------------------------------------------ */
+
+static VAStatus
+mock_buffer_create (MockDriverData * drv, VABufferType type, guint size,
+    guint num_elements, const void *data, VABufferID * buf_id)
+{
+  MockBuffer *buf;
+  gsize alloc_size;
+
+  buf = g_slice_new (MockBuffer);
+  buf->type = type;
+  buf->size = size;
+  buf->num_elements = num_elements;
+
+  alloc_size = (gsize) size * num_elements;
+  if (type == VAEncCodedBufferType)
+    alloc_size += sizeof (VACodedBufferSegment);
+  buf->data = g_malloc0 (MAX (alloc_size, 1));
+  if (data)
+    memcpy (buf->data, data, (gsize) size * num_elements);
+
+  *buf_id = mock_new_id (drv);
+  g_mutex_lock (&drv->lock);
+  g_hash_table_insert (drv->buffers, GUINT_TO_POINTER (*buf_id), buf);
+  g_mutex_unlock (&drv->lock);
+  MOCK_STATS_INC (create_buffer, 1);
+  return VA_STATUS_SUCCESS;
+}
+
+static MockBuffer *
+mock_buffer_lookup (MockDriverData * drv, VABufferID buf_id)
+{
+  MockBuffer *buf;
+
+  g_mutex_lock (&drv->lock);
+  buf = g_hash_table_lookup (drv->buffers, GUINT_TO_POINTER (buf_id));
+  g_mutex_unlock (&drv->lock);
+  return buf;
+}
+
+static VAStatus
+mock_CreateBuffer (VADriverContextP ctx, VAContextID context,
+    VABufferType type, unsigned int size, unsigned int num_elements,
+    void *data, VABufferID * buf_id)
+{
+  return mock_buffer_create (get_driver_data (ctx), type, size, num_elements,
+      data, buf_id);
+}
+
+static VAStatus
+mock_BufferSetNumElements (VADriverContextP ctx, VABufferID buf_id,
+    unsigned int num_elements)
+{
+  MockBuffer *const buf = mock_buffer_lookup (get_driver_data (ctx), buf_id);
+
+  if (!buf)
+    return VA_STATUS_ERROR_INVALID_BUFFER;
+  if (num_elements > buf->num_elements)
+    return VA_STATUS_ERROR_INVALID_PARAMETER;
+  buf->num_elements = num_elements;
+  return VA_STATUS_SUCCESS;
+}
+
+static VAStatus
+mock_MapBuffer (VADriverContextP ctx, VABufferID buf_id, void **pbuf)
+{
+  MockBuffer *const buf = mock_buffer_lookup (get_driver_data (ctx), buf_id);
+
+  if (!buf)
+    return VA_STATUS_ERROR_INVALID_BUFFER;
+
+  if (buf->type == VAEncCodedBufferType) {
+    VACodedBufferSegment *const segment = (VACodedBufferSegment *) buf->data;
+
+    memset (segment, 0, sizeof (*segment));
+    segment->size = MIN (buf->size, MOCK_CODED_PAYLOAD_SIZE);
+    segment->buf = buf->data + sizeof (*segment);
+  }
+  *pbuf = buf->data;
+  MOCK_STATS_INC (map_buffer, 1);
+  return VA_STATUS_SUCCESS;
+}
+
+static VAStatus
+mock_UnmapBuffer (VADriverContextP ctx, VABufferID buf_id)
+{
+  MockBuffer *const buf = mock_buffer_lookup (get_driver_data (ctx), buf_id);
+
+  return buf ? VA_STATUS_SUCCESS : VA_STATUS_ERROR_INVALID_BUFFER;
+}
+
+static VAStatus
+mock_DestroyBuffer (VADriverContextP ctx, VABufferID buffer_id)
+{
+  MockDriverData *const drv = get_driver_data (ctx);
+  gboolean found;
+
+  g_mutex_lock (&drv->lock);
+  found = g_hash_table_remove (drv->buffers, GUINT_TO_POINTER (buffer_id));
+  g_mutex_unlock (&drv->lock);
+  if (!found)
+    return VA_STATUS_ERROR_INVALID_BUFFER;
+  MOCK_STATS_INC (destroy_buffer, 1);
+  return VA_STATUS_SUCCESS;
+}
+
+static VAStatus
+mock_BeginPicture (VADriverContextP ctx, VAContextID context,
+    VASurfaceID render_target)
+{
+  MOCK_STATS_INC (begin_picture, 1);
+  return VA_STATUS_SUCCESS;
+}
+
+static VAStatus
+mock_RenderPicture (VADriverContextP ctx, VAContextID context,
+    VABufferID * buffers, int num_buffers)
+{
+  g_mutex_lock (&g_stats_lock);
+  g_stats.render_picture++;
+  g_stats.render_buffers += num_buffers;
+  g_mutex_unlock (&g_stats_lock);
+  return VA_STATUS_SUCCESS;
+}
+
+static VAStatus
+mock_EndPicture (VADriverContextP ctx, VAContextID context)
+{
+  MOCK_STATS_INC (end_picture, 1);
+  return VA_STATUS_SUCCESS;
+}
+
+/* ------------------------------------------------------------------------ */
+/* --- Images                                                           --- */
+/* ------------------------------------------------------------------------ */
+
+static VAStatus
+mock_QueryImageFormats (VADriverContextP ctx, VAImageFormat * format_list,
+    int *num_formats)
+{
+  memcpy (format_list, g_image_formats, sizeof (g_image_formats));
+  *num_formats = G_N_ELEMENTS (g_image_formats);
+  return VA_STATUS_SUCCESS;
+}
+
+static gboolean
+mock_image_init (VAImage * image, const VAImageFormat * format, guint width,
+    guint height)
+{
+  const guint width2 = (width + 1) / 2;
+  const guint height2 = (height + 1) / 2;
+
+  memset (image, 0, sizeof (*image));
+  image->format = *format;
+  image->width = width;
+  image->height = height;
+
+  switch (format->fourcc) {
+    case VA_FOURCC ('N', 'V', '1', '2'):
+      image->num_planes = 2;
+      image->pitches[0] = width;
+      image->pitches[1] = width2 * 2;
+      image->offsets[1] = width * height;
+      image->data_size = image->offsets[1] + image->pitches[1] * height2;
+      break;
+    case VA_FOURCC ('Y', 'V', '1', '2'):
+    case VA_FOURCC ('I', '4', '2', '0'):
+      image->num_planes = 3;
+      image->pitches[0] = width;
+      image->pitches[1] = width2;
+      image->pitches[2] = width2;
+      image->offsets[1] = width * height;
+      image->offsets[2] = image->offsets[1] + width2 * height2;
+      image->data_size = image->offsets[2] + width2 * height2;
+      break;
+    case VA_FOURCC ('Y', 'U', 'Y', '2'):
+    case VA_FOURCC ('U', 'Y', 'V', 'Y'):
+      image->num_planes = 1;
+      image->pitches[0] = width2 * 4;
+      image->data_size = image->pitches[0] * height;
+      break;
+    case VA_FOURCC ('B', 'G', 'R', 'A'):
+    case VA_FOURCC ('R', 'G', 'B', 'A'):
+      image->num_planes = 1;
+      image->pitches[0] = width * 4;
+      image->data_size = image->pitches[0] * height;
+      break;
+    default:
+      return FALSE;
+  }
+  return TRUE;
+}
+
+static VAStatus
+mock_CreateImage (VADriverContextP ctx, VAImageFormat * format, int width,
+    int height, VAImage * out_image)
+{
+  MockDriverData *const drv = get_driver_data (ctx);
+  VAImage *image;
+  VAStatus status;
+
+  if (!mock_image_init (out_image, format, width, height))
+    return VA_STATUS_ERROR_INVALID_IMAGE_FORMAT;
+
+  status = mock_buffer_create (drv, VAImageBufferType, out_image->data_size,
+      1, NULL, &out_image->buf);
+  if (status != VA_STATUS_SUCCESS)
+    return status;
+
+  out_image->image_id = mock_new_id (drv);
+  image = g_slice_dup (VAImage, out_image);
+  g_mutex_lock (&drv->lock);
+  g_hash_table_insert (drv->images, GUINT_TO_POINTER (image->image_id), image);
+  g_mutex_unlock (&drv->lock);
+  return VA_STATUS_SUCCESS;
+}
+
+static VAStatus
+mock_DeriveImage (VADriverContextP ctx, VASurfaceID surface, VAImage * image)
+{
+  /* Surfaces have no storage, force the vaGetImage()/vaPutImage() path */
+  return VA_STATUS_ERROR_OPERATION_FAILED;
+}
+
+static VAStatus
+mock_DestroyImage (VADriverContextP ctx, VAImageID image_id)
+{
+  MockDriverData *const drv = get_driver_data (ctx);
+  VAImage *image;
+
+  g_mutex_lock (&drv->lock);
+  image = g_hash_table_lookup (drv->images, GUINT_TO_POINTER (image_id));
+  if (image) {
+    g_hash_table_remove (drv->buffers, GUINT_TO_POINTER (image->buf));
+    g_hash_table_remove (drv->images, GUINT_TO_POINTER (image_id));
+  }
+  g_mutex_unlock (&drv->lock);
+  return image ? VA_STATUS_SUCCESS : VA_STATUS_ERROR_INVALID_IMAGE;
+}
+
+static VAStatus
+mock_SetImagePalette (VADriverContextP ctx, VAImageID image,
+    unsigned char *palette)
+{
+  return VA_STATUS_ERROR_UNIMPLEMENTED;
+}
+
+static VAStatus
+mock_GetImage (VADriverContextP ctx, VASurfaceID surface, int x, int y,
+    unsigned int width, unsigned int height, VAImageID image)
+{
+  return VA_STATUS_SUCCESS;
+}
+
+static VAStatus
+mock_PutImage (VADriverContextP ctx, VASurfaceID surface, VAImageID image,
+    int src_x, int src_y, unsigned int src_width, unsigned int src_height,
+    int dest_x, int dest_y, unsigned int dest_width, unsigned int dest_height)
+{
+  return VA_STATUS_SUCCESS;
+}
+
+/* ------------------------------------------------------------------------ */
+/* --- Subpictures and display attributes (unsupported)                 --- */
+/* ------------------------------------------------------------------------ */
+
+static VAStatus
+mock_QuerySubpictureFormats (VADriverContextP ctx,
+    VAImageFormat * format_list, unsigned int *flags,
+    unsigned int *num_formats)
+{
+  *num_formats = 0;
+  return VA_STATUS_SUCCESS;
+}
+
+static VAStatus
+mock_CreateSubpicture (VADriverContextP ctx, VAImageID image,
+    VASubpictureID * subpicture)
+{
+  return VA_STATUS_ERROR_UNIMPLEMENTED;
+}
+
+static VAStatus
+mock_DestroySubpicture (VADriverContextP ctx, VASubpictureID subpicture)
+{
+  return VA_STATUS_ERROR_UNIMPLEMENTED;
+}
+
+static VAStatus
+mock_SetSubpictureImage (VADriverContextP ctx, VASubpictureID subpicture,
+    VAImageID image)
+{
+  return VA_STATUS_ERROR_UNIMPLEMENTED;
+}
+
+static VAStatus
+mock_SetSubpictureChromakey (VADriverContextP ctx, VASubpictureID subpicture,
+    unsigned int chromakey_min, unsigned int chromakey_max,
+    unsigned int chromakey_mask)
+{
+  return VA_STATUS_ERROR_UNIMPLEMENTED;
+}
+
+static VAStatus
+mock_SetSubpictureGlobalAlpha (VADriverContextP ctx,
+    VASubpictureID subpicture, float global_alpha)
+{
+  return VA_STATUS_ERROR_UNIMPLEMENTED;
+}
+
+static VAStatus
+mock_AssociateSubpicture (VADriverContextP ctx, VASubpictureID subpicture,
+    VASurfaceID * target_surfaces, int num_surfaces, short src_x, short src_y,
+    unsigned short src_width, unsigned short src_height, short dest_x,
+    short dest_y, unsigned short dest_width, unsigned short dest_height,
+    unsigned int flags)
+{
+  return VA_STATUS_ERROR_UNIMPLEMENTED;
+}
+
+static VAStatus
+mock_DeassociateSubpicture (VADriverContextP ctx, VASubpictureID subpicture,
+    VASurfaceID * target_surfaces, int num_surfaces)
+{
+  return VA_STATUS_ERROR_UNIMPLEMENTED;
+}
+
+static VAStatus
+mock_QueryDisplayAttributes (VADriverContextP ctx,
+    VADisplayAttribute * attr_list, int *num_attributes)
+{
+  *num_attributes = 0;
+  return VA_STATUS_SUCCESS;
+}
+
+static VAStatus
+mock_GetDisplayAttributes (VADriverContextP ctx,
+    VADisplayAttribute * attr_list, int num_attributes)
+{
+  return VA_STATUS_ERROR_UNIMPLEMENTED;
+}
+
+static VAStatus
+mock_SetDisplayAttributes (VADriverContextP ctx,
+    VADisplayAttribute * attr_list, int num_attributes)
+{
+  return VA_STATUS_ERROR_UNIMPLEMENTED;
+}
+
+/* ------------------------------------------------------------------------ */
+/* --- Driver entry points                                              --- */
+/* ------------------------------------------------------------------------ */
+
+static VAStatus
+mock_Terminate (VADriverContextP ctx)
+{
+  MockDriverData *const drv = get_driver_data (ctx);
+
+  g_hash_table_unref (drv->images);
+  g_hash_table_unref (drv->buffers);
+  g_hash_table_unref (drv->configs);
+  g_mutex_clear (&drv->lock);
+  g_slice_free (MockDriverData, drv);
+  ctx->pDriverData = NULL;
+  return VA_STATUS_SUCCESS;
+}
+
+void
+mock_va_driver_get_stats (MockVaStats * stats, gboolean reset)
+{
+  g_mutex_lock (&g_stats_lock);
+  if (stats)
+    *stats = g_stats;
+  if (reset)
+    memset (&g_stats, 0, sizeof (g_stats));
+  g_mutex_unlock (&g_stats_lock);
+}
+
+VAStatus MOCK_DRIVER_INIT_FUNC (VADriverContextP ctx);
+
+VAStatus
+MOCK_DRIVER_INIT_FUNC (VADriverContextP ctx)
+{
+  struct VADriverVTable *const vtable = ctx->vtable;
+  MockDriverData *drv;
+
+  drv = g_slice_new0 (MockDriverData);
+  g_mutex_init (&drv->lock);
+  drv->configs = g_hash_table_new_full (NULL, NULL, NULL,
+      (GDestroyNotify) g_free);
+  drv->buffers = g_hash_table_new_full (NULL, NULL, NULL,
+      (GDestroyNotify) mock_buffer_free);
+  drv->images = g_hash_table_new_full (NULL, NULL, NULL,
+      (GDestroyNotify) mock_image_free);
+  ctx->pDriverData = drv;
+
+  ctx->version_major = VA_MAJOR_VERSION;
+  ctx->version_minor = VA_MINOR_VERSION;
+  ctx->max_profiles = MOCK_MAX_PROFILES;
+  ctx->max_entrypoints = MOCK_MAX_ENTRYPOINTS;
+  ctx->max_attributes = MOCK_MAX_ATTRIBUTES;
+  ctx->max_image_formats = MOCK_MAX_IMAGE_FORMATS;
+  ctx->max_subpic_formats = MOCK_MAX_SUBPIC_FORMATS;
+  ctx->max_display_attributes = MOCK_MAX_DISPLAY_ATTRIBUTES;
+  ctx->str_vendor = MOCK_VENDOR_STRING;
+
+  vtable->vaTerminate = mock_Terminate;
+  vtable->vaQueryConfigProfiles = mock_QueryConfigProfiles;
+  vtable->vaQueryConfigEntrypoints = mock_QueryConfigEntrypoints;
+  vtable->vaGetConfigAttributes = mock_GetConfigAttributes;
+  vtable->vaCreateConfig = mock_CreateConfig;
+  vtable->vaDestroyConfig = mock_DestroyConfig;
+  vtable->vaQueryConfigAttributes = mock_QueryConfigAttributes;
+  vtable->vaCreateSurfaces = mock_CreateSurfaces;
+  vtable->vaDestroySurfaces = mock_DestroySurfaces;
+  vtable->vaCreateContext = mock_CreateContext;
+  vtable->vaDestroyContext = mock_DestroyContext;
+  vtable->vaCreateBuffer = mock_CreateBuffer;
+  vtable->vaBufferSetNumElements = mock_BufferSetNumElements;
+  vtable->vaMapBuffer = mock_MapBuffer;
+  vtable->vaUnmapBuffer = mock_UnmapBuffer;
+  vtable->vaDestroyBuffer = mock_DestroyBuffer;
+  vtable->vaBeginPicture = mock_BeginPicture;
+  vtable->vaRenderPicture = mock_RenderPicture;
+  vtable->vaEndPicture = mock_EndPicture;
+  vtable->vaSyncSurface = mock_SyncSurface;
+  vtable->vaQuerySurfaceStatus = mock_QuerySurfaceStatus;
+  vtable->vaPutSurface = mock_PutSurface;
+  vtable->vaQueryImageFormats = mock_QueryImageFormats;
+  vtable->vaCreateImage = mock_CreateImage;
+  vtable->vaDeriveImage = mock_DeriveImage;
+  vtable->vaDestroyImage = mock_DestroyImage;
+  vtable->vaSetImagePalette = mock_SetImagePalette;
+  vtable->vaGetImage = mock_GetImage;
+  vtable->vaPutImage = mock_PutImage;
+  vtable->vaQuerySubpictureFormats = mock_QuerySubpictureFormats;
+  vtable->vaCreateSubpicture = mock_CreateSubpicture;
+  vtable->vaDestroySubpicture = mock_DestroySubpicture;
+  vtable->vaSetSubpictureImage = mock_SetSubpictureImage;
+  vtable->vaSetSubpictureChromakey = mock_SetSubpictureChromakey;
+  vtable->vaSetSubpictureGlobalAlpha = mock_SetSubpictureGlobalAlpha;
+  vtable->vaAssociateSubpicture = mock_AssociateSubpicture;
+  vtable->vaDeassociateSubpicture = mock_DeassociateSubpicture;
+  vtable->vaQueryDisplayAttributes = mock_QueryDisplayAttributes;
+  vtable->vaGetDisplayAttributes = mock_GetDisplayAttributes;
+  vtable->vaSetDisplayAttributes = mock_SetDisplayAttributes;
+#if VA_CHECK_VERSION(0,34,0)
+  vtable->vaCreateSurfaces2 = mock_CreateSurfaces2;
+  vtable->vaQuerySurfaceAttributes = mock_QuerySurfaceAttributes;
+#endif
+  return VA_STATUS_SUCCESS;
+}
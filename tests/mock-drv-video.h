@@ -0,0 +1,60 @@
+/*
+ *  mock-drv-video.h - Mock VA driver for hardware-free benchmarks
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation; either version 2.1
+ *  of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free
+ *  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301 USA
+ */
+
+#ifndef MOCK_DRV_VIDEO_H
+#define MOCK_DRV_VIDEO_H
+
+#include <glib.h>
+
+/* Name to set in LIBVA_DRIVER_NAME so that libva loads mock_drv_video.so */
+#define MOCK_VA_DRIVER_NAME "mock"
+
+/* Symbol exported by the driver module, looked up with dlsym() */
+#define MOCK_VA_GET_STATS_SYMBOL "mock_va_driver_get_stats"
+
+typedef struct _MockVaStats MockVaStats;
+
+/**
+ * MockVaStats:
+ *
+ * Counters of the VA driver entry points recorded by the mock
+ * driver. All calls return immediately, so the counters only reflect
+ * the work performed by the libgstvaapi core.
+ */
+struct _MockVaStats
+{
+  guint begin_picture;
+  guint render_picture;
+  guint render_buffers;
+  guint end_picture;
+  guint create_buffer;
+  guint destroy_buffer;
+  guint map_buffer;
+  guint create_surface;
+  guint sync_surface;
+};
+
+typedef void (*MockVaGetStatsFunc) (MockVaStats * stats, gboolean reset);
+
+void
+mock_va_driver_get_stats (MockVaStats * stats, gboolean reset);
+
+#endif /* MOCK_DRV_VIDEO_H */
@@ -0,0 +1,253 @@
+/*
+ *  test-miniobject.c - Test the recycling of mini objects
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation; either version 2.1
+ *  of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free
+ *  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Decodes synthetic "frames", each creating a few objects of two mini
+ * object classes and keeping some of them alive for a few frames like
+ * a DPB does, and checks that the number of allocations stays bounded
+ * by the peak number of live objects, i.e. that steady-state decoding
+ * allocates nothing. The second class keeps an embedded array across
+ * reuses, whose allocations are counted too. The same is then checked
+ * with several threads creating and destroying objects concurrently.
+ */
+
+#include "gst/vaapi/sysdeps.h"
+#include "gst/vaapi/gstvaapiminiobject.h"
+#include "check.h"
+
+static gint g_frames = 10000;
+static gint g_objects = 8;
+static gint g_depth = 4;
+static gint g_threads = 4;
+
+static GOptionEntry g_options[] = {
+  {"frames", 'n', 0, G_OPTION_ARG_INT, &g_frames,
+      "number of frames to decode", NULL},
+  {"objects", 'o', 0, G_OPTION_ARG_INT, &g_objects,
+      "number of objects created per frame", NULL},
+  {"depth", 'd', 0, G_OPTION_ARG_INT, &g_depth,
+      "number of frames the objects live for", NULL},
+  {"threads", 't', 0, G_OPTION_ARG_INT, &g_threads,
+      "number of threads", NULL},
+  {NULL,}
+};
+
+/* ------------------------------------------------------------------------ */
+/* --- Test objects                                                     --- */
+/* ------------------------------------------------------------------------ */
+
+typedef struct
+{
+  GstVaapiMiniObject parent_instance;
+  guint8 data[200];
+} TestObject;
+
+typedef struct
+{
+  GstVaapiMiniObject parent_instance;
+  gint value;
+  GArray *items;
+} TestArrayObject;
+
+static gint g_num_arrays;
+static gint g_num_finalized;
+
+static void
+test_object_finalize (TestObject * object)
+{
+  g_atomic_int_inc (&g_num_finalized);
+}
+
+static void
+test_array_object_release (TestArrayObject * object)
+{
+  if (object->items) {
+    g_array_free (object->items, TRUE);
+    object->items = NULL;
+    g_atomic_int_add (&g_num_arrays, -1);
+  }
+}
+
+static void
+test_array_object_reset (TestArrayObject * object)
+{
+  if (object->items)
+    g_array_set_size (object->items, 0);
+  object->value = 0;
+}
+
+static void
+test_array_object_finalize (TestArrayObject * object)
+{
+  test_array_object_release (object);
+}
+
+static GstVaapiMiniObjectCache g_test_object_cache;
+
+static const GstVaapiMiniObjectClass g_test_object_class = {
+  .size = sizeof (TestObject),
+  .finalize = (GDestroyNotify) test_object_finalize,
+  .cache = &g_test_object_cache
+};
+
+static GstVaapiMiniObjectCache g_test_array_object_cache = {
+  .reset = (GDestroyNotify) test_array_object_reset,
+  .release = (GDestroyNotify) test_array_object_release,
+};
+
+static const GstVaapiMiniObjectClass g_test_array_object_class = {
+  .size = sizeof (TestArrayObject),
+  .finalize = (GDestroyNotify) test_array_object_finalize,
+  .cache = &g_test_array_object_cache
+};
+
+static GstVaapiMiniObject *
+test_array_object_new (gint value)
+{
+  TestArrayObject *object;
+
+  object = (TestArrayObject *)
+      gst_vaapi_mini_object_new0 (&g_test_array_object_class);
+  if (!object)
+    return NULL;
+
+  /* Objects reused from the cache are reset, with an empty array */
+  if (object->value != 0 || (object->items && object->items->len != 0))
+    g_error ("object was not reset");
+  if (!object->items) {
+    object->items = g_array_new (FALSE, FALSE, sizeof (gint));
+    g_atomic_int_inc (&g_num_arrays);
+  }
+  object->value = value;
+  g_array_append_val (object->items, value);
+  return GST_VAAPI_MINI_OBJECT (object);
+}
+
+/* ------------------------------------------------------------------------ */
+/* --- Tests                                                            --- */
+/* ------------------------------------------------------------------------ */
+
+/* Creates g_objects objects per frame, which live for g_depth frames */
+static void
+decode_frames (guint num_frames)
+{
+  GstVaapiMiniObject **objects;
+  guint i, j, num_objects;
+
+  num_objects = 2 * g_objects * g_depth;
+  objects = g_new0 (GstVaapiMiniObject *, num_objects);
+  for (i = 0; i < num_frames; i++) {
+    GstVaapiMiniObject **const frame_objects =
+        &objects[2 * g_objects * (i % g_depth)];
+    for (j = 0; j < (guint) g_objects; j++) {
+      gst_vaapi_mini_object_replace (&frame_objects[2 * j], NULL);
+      gst_vaapi_mini_object_replace (&frame_objects[2 * j + 1], NULL);
+      frame_objects[2 * j] = gst_vaapi_mini_object_new (&g_test_object_class);
+      frame_objects[2 * j + 1] = test_array_object_new (i + 1);
+      if (!frame_objects[2 * j] || !frame_objects[2 * j + 1])
+        g_error ("could not create objects");
+    }
+  }
+  for (i = 0; i < num_objects; i++)
+    gst_vaapi_mini_object_replace (&objects[i], NULL);
+  g_free (objects);
+}
+
+static gpointer
+decode_thread (gpointer data)
+{
+  decode_frames (g_frames);
+  return NULL;
+}
+
+static void
+check_stats (const gchar * name, GstVaapiMiniObjectCache * cache,
+    guint64 max_allocations)
+{
+  GstVaapiMiniObjectCacheStats stats;
+
+  gst_vaapi_mini_object_cache_get_stats (cache, &stats);
+  g_print ("%-24s %10" G_GUINT64_FORMAT " %10" G_GUINT64_FORMAT " %8u\n",
+      name, stats.num_allocations, stats.num_reuses, stats.num_free);
+  check_at_most (name, stats.num_allocations, max_allocations);
+}
+
+static void
+clear_caches (void)
+{
+  gst_vaapi_mini_object_cache_clear (&g_test_object_class);
+  gst_vaapi_mini_object_cache_clear (&g_test_array_object_class);
+  if (g_atomic_int_get (&g_num_arrays) != 0)
+    g_error ("%d arrays leaked", g_atomic_int_get (&g_num_arrays));
+}
+
+int
+main (int argc, char *argv[])
+{
+  GThread **threads;
+  guint64 max_live_objects;
+  gint i;
+
+  if (!check_init (&argc, &argv, "- mini object recycling test", g_options))
+    return 1;
+
+  if (g_objects < 1)
+    g_objects = 1;
+  if (g_depth < 1)
+    g_depth = 1;
+  if (g_threads < 1)
+    g_threads = 1;
+
+  /* Keep all the objects a thread may release in the caches */
+  max_live_objects = (guint64) g_objects * g_depth;
+  g_test_object_cache.max_objects = max_live_objects * g_threads;
+  g_test_array_object_cache.max_objects = max_live_objects * g_threads;
+
+  g_print ("%-24s %10s %10s %8s\n", "class", "allocs", "reuses", "free");
+
+  /* Steady state: no allocation beyond the peak number of objects */
+  decode_frames (g_frames);
+  check_stats ("object", &g_test_object_cache, max_live_objects);
+  check_stats ("array-object", &g_test_array_object_cache,
+      max_live_objects);
+  if (g_num_finalized != g_frames * g_objects)
+    g_error ("%d objects finalized, expected %d", g_num_finalized,
+        g_frames * g_objects);
+  check_at_most ("arrays", g_atomic_int_get (&g_num_arrays),
+      max_live_objects);
+  clear_caches ();
+
+  /* Same with concurrent threads, sharing the caches */
+  threads = g_new (GThread *, g_threads);
+  for (i = 0; i < g_threads; i++)
+    threads[i] = g_thread_new ("decode", decode_thread, NULL);
+  for (i = 0; i < g_threads; i++)
+    g_thread_join (threads[i]);
+  g_free (threads);
+  check_stats ("object (threads)", &g_test_object_cache,
+      2 * max_live_objects * g_threads);
+  check_stats ("array-object (threads)", &g_test_array_object_cache,
+      2 * max_live_objects * g_threads);
+  clear_caches ();
+
+  g_print ("PASS\n");
+  return 0;
+}
@@ -0,0 +1,188 @@
+/*
+ *  test-paramsets.c - Test the parameter set cache
+ *
+ *  Copyright (C) 2026 agent <agent@local>
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation; either version 2.1
+ *  of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free
+ *  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *  Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Feeds parameter set caches, set up as the H.264 decoder does, with a
+ * synthetic stream repeating one SPS and two PPS before every key
+ * frame, the way broadcast streams do, with a new SPS every few key
+ * frames. Checks that only the parameter sets that changed are
+ * "parsed", that the PPS are parsed again after a new SPS, and that a
+ * repeated SPS yields the same parser info, which is what lets the
+ * decoder skip the context update. Then checks that only the last SPS
+ * is matched, that a new VPS invalidates the SPS and PPS as in the
+ * H.265 decoder, and that the caches release all their parser infos.
+ */
+
+#include "gst/vaapi/sysdeps.h"
+#include "gst/vaapi/gstvaapidecoder_paramsets.h"
+#include "check.h"
+
+static gint g_key_frames = 1000;
+static gint g_sequence_length = 10;
+
+static GOptionEntry g_options[] = {
+  {"key-frames", 'n', 0, G_OPTION_ARG_INT, &g_key_frames,
+      "number of key frames", NULL},
+  {"sequence-length", 'l', 0, G_OPTION_ARG_INT, &g_sequence_length,
+      "number of key frames with the same SPS", NULL},
+  {NULL,}
+};
+
+typedef struct
+{
+  GstVaapiMiniObject parent_instance;
+  guint id;
+} TestInfo;
+
+static gint g_num_infos;
+
+static void
+test_info_finalize (TestInfo * info)
+{
+  g_num_infos--;
+}
+
+static const GstVaapiMiniObjectClass g_test_info_class = {
+  .size = sizeof (TestInfo),
+  .finalize = (GDestroyNotify) test_info_finalize,
+};
+
+/* "Parses" the parameter set unless it is in @cache, as the decoders
+   do. Returns %TRUE if it was parsed. @info_ptr receives the parser
+   info the parameter set is decoded with */
+static gboolean
+parse_param_set (GstVaapiParamSetCache * cache, guint id, const guint8 * data,
+    guint size, TestInfo ** info_ptr)
+{
+  TestInfo *info;
+
+  info = gst_vaapi_param_set_cache_lookup (cache, data, size);
+  if (info) {
+    if (info->id != id)
+      g_error ("parameter set %u matched parameter set %u", id, info->id);
+    if (info_ptr)
+      *info_ptr = info;
+    return FALSE;
+  }
+
+  info = (TestInfo *) gst_vaapi_mini_object_new (&g_test_info_class);
+  if (!info)
+    g_error ("could not create parser info");
+  info->id = id;
+  g_num_infos++;
+
+  gst_vaapi_param_set_cache_insert (cache, id, data, size, info);
+  gst_vaapi_mini_object_unref (GST_VAAPI_MINI_OBJECT (info));
+  if (info_ptr)
+    *info_ptr = info;
+  return TRUE;
+}
+
+int
+main (int argc, char *argv[])
+{
+  GstVaapiParamSetCache vps_cache, sps_cache, pps_cache;
+  guint8 vps[12], sps[16], pps[2][8];
+  TestInfo *sps_info, *prev_sps_info = NULL;
+  guint num_sequences, num_contexts, num_parsed;
+  gint i;
+
+  if (!check_init (&argc, &argv, "- parameter set cache test", g_options))
+    return 1;
+
+  if (g_key_frames < 1)
+    g_key_frames = 1;
+  if (g_sequence_length < 1)
+    g_sequence_length = 1;
+  num_sequences = (g_key_frames + g_sequence_length - 1) / g_sequence_length;
+
+  /* Same setup as the H.264 decoder */
+  gst_vaapi_param_set_cache_init (&sps_cache, 32, TRUE, &pps_cache);
+  gst_vaapi_param_set_cache_init (&pps_cache, 256, FALSE, NULL);
+
+  memset (vps, 0x40, sizeof (vps));
+  memset (sps, 0x67, sizeof (sps));
+  memset (pps[0], 0x68, sizeof (pps[0]));
+  memset (pps[1], 0x68, sizeof (pps[1]));
+  pps[1][1] = 1;
+
+  num_contexts = 0;
+  for (i = 0; i < g_key_frames; i++) {
+    /* A new sequence only differs in its last byte */
+    if (i % g_sequence_length == 0)
+      sps[sizeof (sps) - 1] = i / g_sequence_length;
+
+    parse_param_set (&sps_cache, 0, sps, sizeof (sps), &sps_info);
+    parse_param_set (&pps_cache, 0, pps[0], sizeof (pps[0]), NULL);
+    parse_param_set (&pps_cache, 1, pps[1], sizeof (pps[1]), NULL);
+
+    /* The decoders only set up the context again for another SPS */
+    if (sps_info != prev_sps_info)
+      num_contexts++;
+    prev_sps_info = sps_info;
+  }
+
+  check_count ("SPS parsed", sps_cache.num_misses, num_sequences);
+  check_count ("SPS reused", sps_cache.num_hits,
+      g_key_frames - num_sequences);
+  check_count ("PPS parsed", pps_cache.num_misses, 2 * num_sequences);
+  check_count ("PPS reused", pps_cache.num_hits,
+      2 * (g_key_frames - num_sequences));
+  check_count ("context updates", num_contexts, num_sequences);
+
+  /* Only the last SPS may be reused, whatever its id */
+  gst_vaapi_param_set_cache_clear (&sps_cache);
+  num_parsed = 0;
+  num_parsed += parse_param_set (&sps_cache, 0, sps, sizeof (sps), NULL);
+  sps[0] = 0;
+  num_parsed += parse_param_set (&sps_cache, 1, sps, sizeof (sps), NULL);
+  sps[0] = 0x67;
+  num_parsed += parse_param_set (&sps_cache, 0, sps, sizeof (sps), NULL);
+  num_parsed += parse_param_set (&sps_cache, 0, sps, sizeof (sps), NULL);
+  check_count ("SPS parsed (last only)", num_parsed, 3);
+
+  /* Same setup as the H.265 decoder: a new VPS invalidates all the SPS
+     and PPS, and a repeated one none of them */
+  gst_vaapi_param_set_cache_finalize (&sps_cache);
+  gst_vaapi_param_set_cache_finalize (&pps_cache);
+  gst_vaapi_param_set_cache_init (&vps_cache, 16, TRUE, &sps_cache);
+  gst_vaapi_param_set_cache_init (&sps_cache, 16, TRUE, &pps_cache);
+  gst_vaapi_param_set_cache_init (&pps_cache, 64, FALSE, NULL);
+  num_parsed = 0;
+  for (i = 0; i < 4; i++) {
+    if (i == 2)
+      vps[sizeof (vps) - 1] = 1;
+    num_parsed += parse_param_set (&vps_cache, 0, vps, sizeof (vps), NULL);
+    num_parsed += parse_param_set (&sps_cache, 0, sps, sizeof (sps), NULL);
+    num_parsed += parse_param_set (&pps_cache, 0, pps[0], sizeof (pps[0]),
+        NULL);
+  }
+  check_count ("VPS/SPS/PPS parsed", num_parsed, 6);
+
+  gst_vaapi_param_set_cache_finalize (&vps_cache);
+  gst_vaapi_param_set_cache_finalize (&sps_cache);
+  gst_vaapi_param_set_cache_finalize (&pps_cache);
+  if (g_num_infos != 0)
+    g_error ("%d parser infos leaked", g_num_infos);
+
+  g_print ("PASS\n");
+  return 0;
+}